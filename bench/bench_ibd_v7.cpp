@@ -0,0 +1,301 @@
+/**
+ * QuantumPulse Initial Block Download Benchmark v7.0
+ *
+ * Local multi-process harness. Starts a seed quantumpulsed that mines a
+ * regtest chain, brings up additional seeds that download it, then starts
+ * a fresh node syncing from 1..N seeds over loopback and reports how fast
+ * it connects blocks. Each node runs in its own scratch directory with
+ * output discarded; everything is torn down with the "stop" RPC.
+ *
+ * Usage: bench_ibd [-quantumpulsed=./quantumpulsed] [-blocks=2000]
+ *                  [-txs=4] [-peers=1,2,4] [-baseport=19400]
+ */
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr uint64_t GENESIS_BLOCKS = 16;
+
+struct Node {
+  pid_t pid{-1};
+  int p2pPort{0};
+  int rpcPort{0};
+};
+
+std::vector<size_t> parseList(const std::string &s) {
+  std::vector<size_t> out;
+  size_t pos = 0;
+  while (pos < s.size()) {
+    out.push_back(std::strtoul(s.c_str() + pos, nullptr, 10));
+    size_t comma = s.find(',', pos);
+    pos = comma == std::string::npos ? s.size() : comma + 1;
+  }
+  return out;
+}
+
+Node spawn(const std::string &binary, const std::filesystem::path &dir,
+           int p2pPort, int rpcPort, std::vector<std::string> extra) {
+  std::filesystem::create_directories(dir);
+  std::vector<std::string> args{binary, "-daemon",
+                                "-port=" + std::to_string(p2pPort),
+                                "-rpcport=" + std::to_string(rpcPort)};
+  args.insert(args.end(), extra.begin(), extra.end());
+
+  Node node{-1, p2pPort, rpcPort};
+  node.pid = ::fork();
+  if (node.pid == 0) {
+    if (::chdir(dir.c_str()) != 0) {
+      ::_exit(127);
+    }
+    int devnull = ::open("/dev/null", O_WRONLY);
+    ::dup2(devnull, STDOUT_FILENO);
+    ::dup2(devnull, STDERR_FILENO);
+    std::vector<char *> argv;
+    for (auto &a : args) {
+      argv.push_back(a.data());
+    }
+    argv.push_back(nullptr);
+    ::execv(argv[0], argv.data());
+    ::_exit(127);
+  }
+  return node;
+}
+
+// One JSON-RPC call; returns the raw response body
+std::optional<std::string> rpc(int port, const std::string &method) {
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(port));
+  ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return std::nullopt;
+  }
+  std::string body =
+      R"({"jsonrpc": "2.0", "method": ")" + method + R"(", "id": 1})";
+  std::string request = "POST / HTTP/1.1\r\nHost: localhost\r\n"
+                        "Content-Length: " +
+                        std::to_string(body.size()) + "\r\n\r\n" + body;
+  ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+  std::string in;
+  char buf[4096];
+  while (true) {
+    size_t headerEnd = in.find("\r\n\r\n");
+    size_t pos = in.find("Content-Length: ");
+    if (headerEnd != std::string::npos && pos != std::string::npos) {
+      size_t total =
+          headerEnd + 4 + std::strtoul(in.c_str() + pos + 16, nullptr, 10);
+      if (in.size() >= total) {
+        ::close(fd);
+        return in.substr(headerEnd + 4, total - headerEnd - 4);
+      }
+    }
+    ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+      ::close(fd);
+      return std::nullopt;
+    }
+    in.append(buf, static_cast<size_t>(n));
+  }
+}
+
+// Numeric value following "key": in a flat JSON object
+std::optional<double> field(const std::string &json, const std::string &key) {
+  size_t pos = json.find("\"" + key + "\":");
+  if (pos == std::string::npos) {
+    return std::nullopt;
+  }
+  pos += key.size() + 3;
+  while (pos < json.size() && json[pos] == ' ') {
+    ++pos;
+  }
+  if (json.compare(pos, 4, "true") == 0) {
+    return 1;
+  }
+  if (json.compare(pos, 5, "false") == 0) {
+    return 0;
+  }
+  return std::strtod(json.c_str() + pos, nullptr);
+}
+
+uint64_t blockCount(const Node &node) {
+  auto reply = rpc(node.rpcPort, "getblockcount");
+  auto value = reply ? field(*reply, "result") : std::nullopt;
+  return value ? static_cast<uint64_t>(*value) : 0;
+}
+
+bool waitForHeight(const Node &node, uint64_t height,
+                   std::chrono::seconds timeout) {
+  auto deadline = Clock::now() + timeout;
+  while (Clock::now() < deadline) {
+    if (blockCount(node) >= height) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  return false;
+}
+
+void stop(Node &node) {
+  if (node.pid <= 0) {
+    return;
+  }
+  if (!rpc(node.rpcPort, "stop")) {
+    ::kill(node.pid, SIGTERM);
+  }
+  int status;
+  ::waitpid(node.pid, &status, 0);
+  node.pid = -1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string binary = "./quantumpulsed";
+  uint64_t blocks = 2000;
+  size_t txs = 4;
+  std::vector<size_t> peerCounts{1, 2, 4};
+  int basePort = 19400;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("-quantumpulsed=", 0) == 0) {
+      binary = arg.substr(15);
+    } else if (arg.rfind("-blocks=", 0) == 0) {
+      blocks = std::strtoull(arg.c_str() + 8, nullptr, 10);
+    } else if (arg.rfind("-txs=", 0) == 0) {
+      txs = std::strtoul(arg.c_str() + 5, nullptr, 10);
+    } else if (arg.rfind("-peers=", 0) == 0) {
+      peerCounts = parseList(arg.substr(7));
+    } else if (arg.rfind("-baseport=", 0) == 0) {
+      basePort = std::atoi(arg.c_str() + 10);
+    }
+  }
+  binary = std::filesystem::absolute(binary).string();
+  if (peerCounts.empty() || blocks == 0) {
+    std::cerr << "nothing to do\n";
+    return 1;
+  }
+  const size_t maxPeers =
+      std::max<size_t>(1, *std::max_element(peerCounts.begin(),
+                                            peerCounts.end()));
+
+  char scratch[] = "/tmp/qp_ibd_XXXXXX";
+  if (!::mkdtemp(scratch)) {
+    std::cerr << "mkdtemp failed\n";
+    return 1;
+  }
+  const std::filesystem::path root(scratch);
+  const uint64_t height = GENESIS_BLOCKS + blocks;
+  int nextPort = basePort;
+  auto ports = [&] {
+    nextPort += 2;
+    return std::pair{nextPort - 2, nextPort - 1};
+  };
+
+  std::cout << "QuantumPulse IBD benchmark (" << blocks << " blocks, " << txs
+            << " tx/block)\n";
+
+  // Seed 0 mines the chain; the others download it from seed 0
+  std::vector<Node> seeds;
+  auto [p2p0, rpc0] = ports();
+  auto mineStart = Clock::now();
+  seeds.push_back(spawn(binary, root / "seed0", p2p0, rpc0,
+                        {"-regtestblocks=" + std::to_string(blocks),
+                         "-regtesttxs=" + std::to_string(txs)}));
+  if (!waitForHeight(seeds[0], height, std::chrono::seconds(600))) {
+    std::cerr << "seed0 did not reach height " << height << "\n";
+    stop(seeds[0]);
+    std::filesystem::remove_all(root);
+    return 1;
+  }
+  std::cout << "seed0 mined in "
+            << std::chrono::duration<double>(Clock::now() - mineStart).count()
+            << "s\n";
+  const std::string seed0 = "-connect=127.0.0.1:" + std::to_string(p2p0);
+  for (size_t i = 1; i < maxPeers; ++i) {
+    auto [p2p, rpcPort] = ports();
+    seeds.push_back(spawn(binary, root / ("seed" + std::to_string(i)), p2p,
+                          rpcPort, {seed0}));
+  }
+  for (auto &seed : seeds) {
+    if (!waitForHeight(seed, height, std::chrono::seconds(600))) {
+      std::cerr << "seed on port " << seed.p2pPort << " did not sync\n";
+    }
+  }
+
+  std::cout << std::setw(6) << "peers" << std::setw(10) << "blocks"
+            << std::setw(10) << "wall s" << std::setw(12) << "blocks/s"
+            << std::setw(10) << "headers" << std::setw(8) << "stalls"
+            << std::setw(8) << "rereq" << std::setw(10) << "MB" << "\n";
+
+  int run = 0;
+  for (size_t peers : peerCounts) {
+    peers = std::clamp<size_t>(peers, 1, seeds.size());
+    std::string connect = "-connect=";
+    for (size_t i = 0; i < peers; ++i) {
+      connect += i ? ",127.0.0.1:" : "127.0.0.1:";
+      connect += std::to_string(seeds[i].p2pPort);
+    }
+    auto [p2p, rpcPort] = ports();
+    auto start = Clock::now();
+    Node target = spawn(binary, root / ("target" + std::to_string(run++)),
+                        p2p, rpcPort, {connect});
+
+    std::optional<std::string> info;
+    auto deadline = start + std::chrono::seconds(600);
+    while (Clock::now() < deadline) {
+      info = rpc(rpcPort, "getsyncinfo");
+      if (info && field(*info, "syncing") == 0.0 &&
+          field(*info, "attempts").value_or(0) > 0) {
+        break; // First sync finished, successfully or not
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    stop(target);
+
+    if (!info) {
+      std::cout << std::setw(6) << peers << "  no response\n";
+      continue;
+    }
+    std::cout << std::fixed << std::setprecision(2) << std::setw(6) << peers
+              << std::setw(10)
+              << static_cast<uint64_t>(field(*info, "downloaded").value_or(0))
+              << std::setw(10) << wall << std::setw(12)
+              << field(*info, "blockspersec").value_or(0) << std::setw(10)
+              << static_cast<uint64_t>(field(*info, "headers").value_or(0))
+              << std::setw(8)
+              << static_cast<uint64_t>(field(*info, "stalls").value_or(0))
+              << std::setw(8)
+              << static_cast<uint64_t>(field(*info, "rerequests").value_or(0))
+              << std::setw(10)
+              << field(*info, "bytes").value_or(0) / (1024.0 * 1024.0)
+              << std::defaultfloat << "\n";
+  }
+
+  for (auto &seed : seeds) {
+    stop(seed);
+  }
+  std::filesystem::remove_all(root);
+  return 0;
+}
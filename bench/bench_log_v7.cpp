@@ -0,0 +1,108 @@
+/**
+ * QuantumPulse Logger Throughput Benchmark v7.0
+ *
+ * Hammers Logging::Logger from many threads for a fixed duration and
+ * reports how many log() calls per second the callers complete, how many
+ * records reached the file and how many were dropped because the ring was
+ * full. Runs in a scratch directory that is removed afterwards.
+ *
+ * Usage: bench_log [-threads=32] [-seconds=3] [-keep]
+ */
+
+#include "quantumpulse_logging_v7.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using QuantumPulse::Logging::Logger;
+
+int main(int argc, char *argv[]) {
+  size_t threads = 32;
+  double seconds = 3.0;
+  bool keep = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("-threads=", 0) == 0) {
+      threads = std::strtoul(arg.c_str() + 9, nullptr, 10);
+    } else if (arg.rfind("-seconds=", 0) == 0) {
+      seconds = std::strtod(arg.c_str() + 9, nullptr);
+    } else if (arg == "-keep") {
+      keep = true;
+    }
+  }
+  if (threads == 0 || seconds <= 0) {
+    std::cerr << "nothing to do\n";
+    return 1;
+  }
+
+  // The logger opens logs/ relative to the working directory on first use
+  char scratch[] = "/tmp/qp_log_XXXXXX";
+  if (!::mkdtemp(scratch) || ::chdir(scratch) != 0) {
+    std::cerr << "scratch directory failed\n";
+    return 1;
+  }
+  Logger &logger = Logger::getInstance();
+
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::vector<uint64_t> calls(threads, 0);
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      const std::string msg =
+          "Transfer accepted from wallet_" + std::to_string(t) + " amount=42";
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      uint64_t n = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        logger.info(msg, "Bench", static_cast<int>(t % 16));
+        ++n;
+      }
+      calls[t] = n;
+    });
+  }
+
+  auto start = Clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop.store(true);
+  for (auto &w : workers) {
+    w.join();
+  }
+  double wall = std::chrono::duration<double>(Clock::now() - start).count();
+  auto drainStart = Clock::now();
+  logger.flush();
+  double drain =
+      std::chrono::duration<double>(Clock::now() - drainStart).count();
+
+  uint64_t total = 0;
+  for (uint64_t n : calls) {
+    total += n;
+  }
+  uint64_t dropped = logger.getDroppedCount();
+  std::cout << "QuantumPulse logger benchmark (" << threads << " threads, "
+            << seconds << "s)\n"
+            << std::fixed << std::setprecision(0)
+            << "log calls/s:   " << total / wall << "\n"
+            << "calls:         " << total << "\n"
+            << "written:       " << total - dropped << " ("
+            << (total - dropped) / wall << "/s)\n"
+            << "dropped:       " << dropped << "\n"
+            << std::setprecision(3) << "drain after:   " << drain << "s\n";
+
+  if (!keep) {
+    std::filesystem::remove_all(scratch);
+  } else {
+    std::cout << "logs kept in " << scratch << "\n";
+  }
+  return 0;
+}
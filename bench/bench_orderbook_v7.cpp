@@ -0,0 +1,281 @@
+/**
+ * QuantumPulse Order Book Benchmark v7.0
+ *
+ * Generates a reproducible stream of limit orders around a drifting mid
+ * price, cancels of earlier orders and market sweeps, then replays it
+ * through the MatchingEngine and through the string-keyed OrderBook.
+ * Reports orders per second for a straight replay and per-command match
+ * latency percentiles from a second, individually timed replay. Finally
+ * splits the stream across producer threads feeding the OrderBook
+ * sequencer while a reader polls depth, to show readers do not hold up
+ * matching. Last, replays the stream repeatedly into one archiving book,
+ * cancelling what still rests after each pass, to show resident memory
+ * stays level once finished orders leave it.
+ *
+ * Usage: bench_orderbook [-orders=1000000] [-seed=42] [-producers=4]
+ *                        [-passes=3]
+ */
+
+#include "quantumpulse_orderbook_v7.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using namespace QuantumPulse::Trading;
+
+namespace {
+
+struct Command {
+  enum Kind : uint8_t { LIMIT, MARKET, CANCEL } kind;
+  OrderSide side;
+  Ticks price;
+  Lots quantity;
+  uint32_t target; // CANCEL: index of an earlier command
+};
+
+std::vector<Command> generate(size_t count, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<Command> out;
+  out.reserve(count);
+  Ticks mid = 10000;
+  for (size_t i = 0; i < count; ++i) {
+    Command c{};
+    const uint64_t r = rng() % 100;
+    c.side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+    c.quantity = 1 + static_cast<Lots>(rng() % 100);
+    if (r < 30 && i > 0) {
+      c.kind = Command::CANCEL;
+      const size_t back = rng() % std::min<size_t>(i, 2000);
+      c.target = static_cast<uint32_t>(i - 1 - back);
+    } else if (r < 35) {
+      c.kind = Command::MARKET;
+    } else {
+      // Mostly passive, occasionally crossing by a few ticks
+      c.kind = Command::LIMIT;
+      const Ticks offset = static_cast<Ticks>(rng() % 50) - 5;
+      c.price = c.side == OrderSide::BUY ? mid - offset : mid + offset;
+      if (rng() % 64 == 0) {
+        mid += (rng() & 1) ? 1 : -1;
+      }
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+// Replays `commands` through `apply(i, command)`; returns commands/s, or
+// fills `latencies` (ns) when it is non-null
+template <typename Apply>
+double replay(const std::vector<Command> &commands, Apply apply,
+              std::vector<uint32_t> *latencies = nullptr) {
+  const auto start = Clock::now();
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (latencies) {
+      const auto t0 = Clock::now();
+      apply(i, commands[i]);
+      (*latencies)[i] = static_cast<uint32_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                               t0)
+              .count());
+    } else {
+      apply(i, commands[i]);
+    }
+  }
+  const double wall =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return static_cast<double>(commands.size()) / wall;
+}
+
+void printPercentiles(const char *label, std::vector<uint32_t> &ns) {
+  std::sort(ns.begin(), ns.end());
+  auto at = [&](double q) {
+    return ns[std::min(ns.size() - 1, static_cast<size_t>(q * ns.size()))];
+  };
+  std::cout << label << "p50 " << at(0.50) << " ns  p99 " << at(0.99)
+            << " ns  p99.9 " << at(0.999) << " ns  max " << ns.back()
+            << " ns\n";
+}
+
+struct EngineRun {
+  MatchingEngine engine{1 << 16};
+  std::vector<OrderHandle> handles;
+  uint64_t fills{0};
+
+  explicit EngineRun(size_t n) : handles(n, 0) {}
+
+  void operator()(size_t i, const Command &c) {
+    auto onFill = [&](const Fill &) { ++fills; };
+    switch (c.kind) {
+    case Command::CANCEL:
+      engine.cancel(handles[c.target]);
+      break;
+    case Command::MARKET:
+      engine.submit(i + 1, c.side, OrderType::MARKET, 0, c.quantity, onFill);
+      break;
+    default:
+      handles[i] = engine
+                       .submit(i + 1, c.side, OrderType::LIMIT, c.price,
+                               c.quantity, onFill)
+                       .handle;
+    }
+  }
+};
+
+struct BookRun {
+  OrderBook book;
+  std::vector<std::string> ids;
+
+  explicit BookRun(size_t n, OrderBook::Config config = {})
+      : book(std::move(config)), ids(n) {}
+
+  // Commands whose index % stride == lane; cancels of other lanes'
+  // orders are skipped
+  void lane(const std::vector<Command> &commands, size_t lane,
+            size_t stride) {
+    for (size_t i = lane; i < commands.size(); i += stride) {
+      const Command &c = commands[i];
+      if (c.kind != Command::CANCEL || c.target % stride == lane) {
+        (*this)(i, c);
+      }
+    }
+  }
+
+  void operator()(size_t i, const Command &c) {
+    switch (c.kind) {
+    case Command::CANCEL:
+      if (!ids[c.target].empty()) {
+        (void)book.cancelOrder(ids[c.target], "bench");
+      }
+      break;
+    default:
+      ids[i] = book.placeOrder(
+          "bench", c.side,
+          c.kind == Command::MARKET ? OrderType::MARKET : OrderType::LIMIT,
+          book.fromTicks(c.price), book.fromLots(c.quantity));
+    }
+  }
+};
+
+// Resident set size in MiB; 0 where /proc is unavailable
+double residentMiB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+    }
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t orders = 1000000;
+  uint64_t seed = 42;
+  size_t producers = 4;
+  size_t passes = 3;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("-orders=", 0) == 0) {
+      orders = std::strtoull(arg.c_str() + 8, nullptr, 10);
+    } else if (arg.rfind("-seed=", 0) == 0) {
+      seed = std::strtoull(arg.c_str() + 6, nullptr, 10);
+    } else if (arg.rfind("-producers=", 0) == 0) {
+      producers = std::strtoul(arg.c_str() + 11, nullptr, 10);
+    } else if (arg.rfind("-passes=", 0) == 0) {
+      passes = std::strtoul(arg.c_str() + 8, nullptr, 10);
+    }
+  }
+  if (orders == 0 || producers == 0) {
+    std::cerr << "nothing to do\n";
+    return 1;
+  }
+
+  const auto commands = generate(orders, seed);
+  std::vector<uint32_t> latencies(orders);
+  std::cout << "QuantumPulse order book benchmark (" << orders
+            << " commands, seed " << seed << ")\n"
+            << std::fixed << std::setprecision(0);
+
+  {
+    EngineRun run(orders);
+    std::cout << "MatchingEngine replay:  "
+              << replay(commands, std::ref(run)) << " orders/s ("
+              << run.fills << " fills, " << run.engine.restingOrders()
+              << " resting)\n";
+    EngineRun timed(orders);
+    replay(commands, std::ref(timed), &latencies);
+    printPercentiles("MatchingEngine latency: ", latencies);
+  }
+  {
+    BookRun run(orders);
+    std::cout << "OrderBook replay:       "
+              << replay(commands, std::ref(run)) << " orders/s ("
+              << run.book.getTradeCount() << " trades)\n";
+    BookRun timed(orders);
+    replay(commands, std::ref(timed), &latencies);
+    printPercentiles("OrderBook latency:      ", latencies);
+  }
+  {
+    BookRun run(orders);
+    std::atomic<bool> done{false};
+    uint64_t reads = 0;
+    std::thread reader([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        (void)run.book.getDepth(10);
+        ++reads;
+        std::this_thread::yield();
+      }
+    });
+    std::vector<std::thread> lanes;
+    const auto start = Clock::now();
+    for (size_t p = 0; p < producers; ++p) {
+      lanes.emplace_back([&, p] { run.lane(commands, p, producers); });
+    }
+    for (auto &lane : lanes) {
+      lane.join();
+    }
+    const double wall =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    done = true;
+    reader.join();
+    std::cout << "Sequenced, " << producers << " producers: "
+              << static_cast<double>(run.book.getSequence()) / wall
+              << " orders/s, depth reads " << static_cast<double>(reads) / wall
+              << "/s\n";
+  }
+  {
+    const std::string path = "bench_orderbook.qparc";
+    std::remove(path.c_str());
+    OrderBook::Config config;
+    config.archivePath = path;
+    BookRun run(orders, config);
+    for (size_t pass = 1; pass <= passes; ++pass) {
+      const double rate = replay(commands, std::ref(run));
+      for (const auto &id : run.ids) {
+        if (!id.empty()) {
+          (void)run.book.cancelOrder(id, "bench");
+        }
+      }
+      run.book.flushArchive();
+      std::cout << "Archiving, pass " << pass << ": " << rate
+                << " orders/s, " << run.book.getOpenOrderCount()
+                << " open, RSS " << residentMiB() << " MiB\n";
+    }
+    std::remove(path.c_str());
+  }
+  std::cout << "(per-command latency includes ~2 clock reads)\n";
+  return 0;
+}
@@ -0,0 +1,280 @@
+/**
+ * QuantumPulse RPC Server Benchmark v7.0
+ *
+ * Closed-loop HTTP/1.1 keep-alive load generator. Each connection sends a
+ * JSON-RPC request, waits for the response and sends the next one. Reports
+ * requests/sec and p50/p99/p99.9 latency per connection count.
+ *
+ * Without -connect an in-process Http::Server dispatching getblockcount
+ * through JsonRpc::Dispatcher is started on an ephemeral port; with
+ * -connect=host:port a running quantumpulsed is measured instead. With
+ * -batch=N each request is a JSON-RPC batch of N calls and calls/sec is
+ * reported alongside requests/sec.
+ *
+ * Usage: bench_rpc [-connect=host:port] [-conns=1000,5000,10000]
+ *                  [-seconds=5] [-threads=2] [-batch=1]
+ */
+
+#include "quantumpulse_http_v7.h"
+#include "quantumpulse_jsonrpc_v7.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace QuantumPulse;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::string makeRequest(size_t batch) {
+  std::string body;
+  for (size_t i = 0; i < batch; ++i) {
+    body += i ? "," : "";
+    body += R"({"jsonrpc": "2.0", "method": "getblockcount", "params": [], )"
+            R"("id": )" +
+            std::to_string(i + 1) + "}";
+  }
+  if (batch > 1) {
+    body = "[" + body + "]";
+  }
+  return "POST / HTTP/1.1\r\nHost: localhost\r\n"
+         "Content-Type: application/json\r\nContent-Length: " +
+         std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+struct ClientConn {
+  int fd{-1};
+  bool connected{false};
+  Clock::time_point sentAt;
+  std::string in;
+};
+
+// Bytes of a complete response at the front of `in`, or 0
+size_t responseLength(const std::string &in) {
+  size_t headerEnd = in.find("\r\n\r\n");
+  if (headerEnd == std::string::npos) {
+    return 0;
+  }
+  size_t pos = in.find("Content-Length: ");
+  if (pos == std::string::npos || pos > headerEnd) {
+    return 0;
+  }
+  size_t length = std::strtoul(in.c_str() + pos + 16, nullptr, 10);
+  size_t total = headerEnd + 4 + length;
+  return in.size() >= total ? total : 0;
+}
+
+struct WorkerResult {
+  uint64_t completed{0};
+  uint64_t failed{0};
+  std::vector<uint32_t> latenciesUs;
+};
+
+void runClient(const sockaddr_in &target, size_t connections, size_t batch,
+               Clock::time_point warmupEnd, Clock::time_point end,
+               WorkerResult &result) {
+  const std::string request = makeRequest(batch);
+  int ep = ::epoll_create1(0);
+  std::vector<ClientConn> conns(connections);
+
+  auto send = [&](ClientConn &c) {
+    c.sentAt = Clock::now();
+    if (::send(c.fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(request.size())) {
+      ++result.failed;
+    }
+  };
+
+  for (size_t i = 0; i < connections; ++i) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    ::connect(fd, reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+    conns[i].fd = fd;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = i;
+    ::epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+  }
+
+  std::vector<epoll_event> events(1024);
+  char buf[16384];
+  while (Clock::now() < end) {
+    int n = ::epoll_wait(ep, events.data(), static_cast<int>(events.size()),
+                         100);
+    for (int i = 0; i < n; ++i) {
+      ClientConn &c = conns[events[i].data.u64];
+      if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+        ++result.failed;
+        ::epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+        continue;
+      }
+      if (!c.connected && (events[i].events & EPOLLOUT)) {
+        c.connected = true;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = events[i].data.u64;
+        ::epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+        send(c);
+      }
+      if (events[i].events & EPOLLIN) {
+        ssize_t r;
+        while ((r = ::recv(c.fd, buf, sizeof(buf), 0)) > 0) {
+          c.in.append(buf, static_cast<size_t>(r));
+        }
+        size_t len;
+        while ((len = responseLength(c.in)) > 0) {
+          c.in.erase(0, len);
+          auto now = Clock::now();
+          if (now >= warmupEnd) {
+            ++result.completed;
+            result.latenciesUs.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - c.sentAt)
+                    .count()));
+          }
+          send(c);
+        }
+      }
+    }
+  }
+
+  for (auto &c : conns) {
+    ::close(c.fd);
+  }
+  ::close(ep);
+}
+
+std::vector<size_t> parseList(const std::string &s) {
+  std::vector<size_t> out;
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t comma = s.find(',', pos);
+    out.push_back(std::strtoul(s.substr(pos, comma - pos).c_str(), nullptr,
+                               10));
+    pos = comma == std::string::npos ? s.size() : comma + 1;
+  }
+  return out;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string connect;
+  std::vector<size_t> connCounts{1000, 5000, 10000};
+  int seconds = 5;
+  size_t threads = 2;
+  size_t batch = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("-connect=", 0) == 0) {
+      connect = arg.substr(9);
+    } else if (arg.rfind("-conns=", 0) == 0) {
+      connCounts = parseList(arg.substr(7));
+    } else if (arg.rfind("-seconds=", 0) == 0) {
+      seconds = std::max(1, std::atoi(arg.c_str() + 9));
+    } else if (arg.rfind("-threads=", 0) == 0) {
+      threads = std::max<size_t>(1, std::strtoul(arg.c_str() + 9, nullptr, 10));
+    } else if (arg.rfind("-batch=", 0) == 0) {
+      batch = std::clamp<size_t>(std::strtoul(arg.c_str() + 7, nullptr, 10), 1,
+                                 JsonRpc::Dispatcher::MAX_BATCH);
+    }
+  }
+
+  // Each connection needs a descriptor on both ends when in-process
+  rlimit limit{};
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+
+  JsonRpc::Dispatcher dispatcher;
+  dispatcher.add("getblockcount",
+                 [](const JsonRpc::Params &, JsonRpc::Reply &reply) {
+                   reply.result().number(uint64_t{16});
+                 });
+  std::unique_ptr<Http::Server> server;
+  sockaddr_in target{};
+  target.sin_family = AF_INET;
+  if (connect.empty()) {
+    Http::ServerConfig config;
+    config.bindAddress = "127.0.0.1";
+    config.maxConnections = 65536;
+    server = std::make_unique<Http::Server>(
+        config, [&dispatcher](const Http::Request &req) {
+          Http::Response res;
+          dispatcher.handle(req.body, res.body);
+          return res;
+        });
+    if (!server->start()) {
+      std::cerr << "failed to start in-process server\n";
+      return 1;
+    }
+    ::inet_pton(AF_INET, "127.0.0.1", &target.sin_addr);
+    target.sin_port = htons(server->getPort());
+  } else {
+    size_t colon = connect.rfind(':');
+    ::inet_pton(AF_INET, connect.substr(0, colon).c_str(), &target.sin_addr);
+    target.sin_port =
+        htons(static_cast<uint16_t>(std::atoi(connect.c_str() + colon + 1)));
+  }
+
+  std::cout << "QuantumPulse RPC benchmark (" << seconds << "s per run, "
+            << threads << " client threads, batch " << batch << ", fd limit "
+            << limit.rlim_cur << ")\n\n";
+  std::cout << std::left << std::setw(8) << "conns" << std::setw(12)
+            << "req/s" << std::setw(12) << "calls/s" << std::setw(10) << "p50 us" << std::setw(10)
+            << "p99 us" << std::setw(11) << "p99.9 us" << "errors\n";
+
+  for (size_t conns : connCounts) {
+    auto warmupEnd = Clock::now() + std::chrono::seconds(1);
+    auto end = warmupEnd + std::chrono::seconds(seconds);
+    std::vector<WorkerResult> results(threads);
+    std::vector<std::thread> clients;
+    for (size_t t = 0; t < threads; ++t) {
+      size_t share = conns / threads + (t < conns % threads ? 1 : 0);
+      clients.emplace_back(runClient, std::cref(target), share, batch,
+                           warmupEnd, end, std::ref(results[t]));
+    }
+    for (auto &c : clients) {
+      c.join();
+    }
+
+    WorkerResult total;
+    for (auto &r : results) {
+      total.completed += r.completed;
+      total.failed += r.failed;
+      total.latenciesUs.insert(total.latenciesUs.end(), r.latenciesUs.begin(),
+                               r.latenciesUs.end());
+    }
+    std::sort(total.latenciesUs.begin(), total.latenciesUs.end());
+    auto pct = [&](double p) -> uint32_t {
+      if (total.latenciesUs.empty()) {
+        return 0;
+      }
+      return total.latenciesUs[static_cast<size_t>(
+          p * (total.latenciesUs.size() - 1))];
+    };
+    double rate = static_cast<double>(total.completed) / seconds;
+    std::cout << std::setw(8) << conns << std::setw(12) << std::fixed
+              << std::setprecision(0) << rate << std::setw(12)
+              << rate * static_cast<double>(batch) << std::setw(10) << pct(0.50) << std::setw(10) << pct(0.99)
+              << std::setw(11) << pct(0.999) << total.failed << "\n";
+  }
+
+  if (server) {
+    server->stop();
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * QuantumPulse UTXO Set Benchmark v7.0
+ *
+ * Measures read throughput (validateInputs + getBalance) of the sharded
+ * UTXO set as reader threads increase, with one writer adding and spending
+ * outputs in the background.
+ *
+ * Usage: bench_utxo [utxo-count] [max-threads]
+ */
+
+#include "quantumpulse_utxo_v7.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace QuantumPulse::UTXO;
+
+namespace {
+
+std::string txidFor(size_t i) {
+  static const char digits[] = "0123456789abcdef";
+  std::string id(128, '0');
+  for (size_t n = 0; n < 16; ++n) {
+    id[n] = digits[(i >> (4 * n)) & 0xF];
+  }
+  return id;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  unsigned maxThreads = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                 : std::thread::hardware_concurrency();
+  constexpr size_t ADDRESSES = 1000;
+
+  UTXOSet set;
+  std::vector<std::string> txids(count);
+  for (size_t i = 0; i < count; ++i) {
+    txids[i] = txidFor(i);
+    UTXOutput u{};
+    u.txid = txids[i];
+    u.address = "addr" + std::to_string(i % ADDRESSES);
+    u.amount = 1.0;
+    set.addUTXO(u);
+  }
+
+  std::cout << "QuantumPulse UTXO benchmark (" << count << " outputs, "
+            << set.getShardCount() << " shards, 1 background writer)\n\n";
+  std::cout << std::left << std::setw(10) << "threads" << std::setw(16)
+            << "ops/sec" << "speedup\n";
+
+  double baseline = 0;
+  for (unsigned threads = 1; threads <= std::max(1u, maxThreads);
+       threads *= 2) {
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> ops{0};
+
+    std::thread writer([&] {
+      size_t n = count;
+      while (running.load(std::memory_order_relaxed)) {
+        UTXOutput u{};
+        u.txid = txidFor(n);
+        u.address = "addr" + std::to_string(n % ADDRESSES);
+        u.amount = 1.0;
+        set.addUTXO(u);
+        set.spendUTXO(u.txid, 0);
+        ++n;
+      }
+    });
+
+    std::vector<std::thread> readers;
+    for (unsigned t = 0; t < threads; ++t) {
+      readers.emplace_back([&, t] {
+        Transaction tx{};
+        tx.vin.resize(2);
+        tx.vout.push_back({1.5, "", "dest"});
+        uint64_t local = 0;
+        size_t i = t * 7919;
+        while (running.load(std::memory_order_relaxed)) {
+          tx.vin[0].txid = txids[i % count];
+          tx.vin[1].txid = txids[(i + 1) % count];
+          [[maybe_unused]] bool ok = set.validateInputs(tx);
+          [[maybe_unused]] double b =
+              set.getBalance("addr" + std::to_string(i % ADDRESSES));
+          local += 2;
+          i += 13;
+        }
+        ops.fetch_add(local);
+      });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    running = false;
+    for (auto &r : readers) {
+      r.join();
+    }
+    writer.join();
+
+    double rate = static_cast<double>(ops.load());
+    if (baseline == 0) {
+      baseline = rate;
+    }
+    std::cout << std::setw(10) << threads << std::setw(16) << std::fixed
+              << std::setprecision(0) << rate << std::setprecision(2)
+              << rate / baseline << "x\n";
+  }
+
+  return 0;
+}
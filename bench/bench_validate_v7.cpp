@@ -0,0 +1,100 @@
+/**
+ * QuantumPulse Chain Validation Benchmark v7.0
+ *
+ * Validates a synthetic chain block-by-block (the previous approach) and
+ * through the staged parallel ChainValidator, reporting blocks/sec for
+ * each.
+ *
+ * Usage: bench_validate [blocks] [txs-per-block]
+ */
+
+#include "quantumpulse_blockchain_v7.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace QuantumPulse;
+
+namespace {
+
+std::vector<Blockchain::Block> buildChain(size_t blocks, size_t txsPerBlock,
+                                          Crypto::CryptoManager &crypto) {
+  std::vector<Blockchain::Block> chain(1);
+  chain[0].prevHash = "genesis_0";
+  chain[0].hash = "genesis_hash";
+  for (size_t i = 1; i <= blocks; ++i) {
+    Blockchain::Block block;
+    block.prevHash = chain.back().hash;
+    block.hash = "0000" + std::to_string(i);
+    block.difficulty = 4;
+    block.reward = 0.5;
+    for (size_t t = 0; t < txsPerBlock; ++t) {
+      Blockchain::Transaction tx;
+      tx.sender = "sender";
+      tx.receiver = "receiver";
+      tx.txId = crypto.sha3_512_v11(
+          std::to_string(i) + ":" + std::to_string(t), 0);
+      tx.signature = "signed_v11_" + tx.txId;
+      tx.zkProof = "zk_proof_v11_" + tx.txId;
+      tx.multiSignatures.assign(10, "signature");
+      tx.expiresAt = time(nullptr) + 86400;
+      block.transactions.push_back(std::move(tx));
+    }
+    block.merkleRoot =
+        Blockchain::Block::computeMerkleRoot(block.transactions, crypto, 0);
+    chain.push_back(std::move(block));
+  }
+  return chain;
+}
+
+template <typename Fn> double seconds(Fn run) {
+  auto start = std::chrono::steady_clock::now();
+  run();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t blocks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+  size_t txsPerBlock = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 50;
+
+  Crypto::CryptoManager crypto;
+  auto chain = buildChain(blocks, txsPerBlock, crypto);
+  auto &pool = Concurrency::ThreadPool::getInstance();
+
+  std::cout << "QuantumPulse chain validation benchmark (" << blocks
+            << " blocks x " << txsPerBlock << " txs, " << pool.getThreadCount()
+            << " workers)\n\n";
+
+  bool sequentialOk = true;
+  double sequential = seconds([&] {
+    for (size_t i = 1; i < chain.size(); ++i) {
+      // Previous behaviour: one Block::validate() after another
+      sequentialOk &= chain[i].validate(crypto);
+    }
+  });
+
+  Blockchain::ChainValidationResult result;
+  double parallel = seconds(
+      [&] { result = Blockchain::ChainValidator(crypto).validate(chain); });
+
+  std::cout << std::left << std::setw(14) << "mode" << std::setw(14)
+            << "seconds" << "blocks/sec\n";
+  std::cout << std::fixed << std::setw(14) << "sequential" << std::setw(14)
+            << std::setprecision(3) << sequential << std::setprecision(0)
+            << blocks / sequential << (sequentialOk ? "" : "  (INVALID)")
+            << "\n";
+  std::cout << std::setw(14) << "pipeline" << std::setw(14)
+            << std::setprecision(3) << parallel << std::setprecision(0)
+            << blocks / parallel << (result.valid ? "" : "  (INVALID)")
+            << "\n";
+  std::cout << "\nspeedup: " << std::setprecision(2) << sequential / parallel
+            << "x\n";
+  return 0;
+}
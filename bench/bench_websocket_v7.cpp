@@ -0,0 +1,218 @@
+/**
+ * QuantumPulse WebSocket Fan-out Load Test v7.0
+ *
+ * Drives the server's FanOut engine with simulated subscribers instead of
+ * sockets (50k connections need more descriptors than a test box allows).
+ * Every subscriber takes trades, half also take book deltas and a tenth
+ * new blocks. One I/O thread drains ready subscribers as the server's
+ * epoll loop does; "slow" subscribers never accept a byte, so their
+ * queues fill and the slow-consumer policy applies.
+ *
+ * Reports the cost of one broadcast with a shared frame against encoding
+ * and framing the message per client (what the old broadcast loop did
+ * before its blocking send), publish latency percentiles, and delivery
+ * throughput.
+ *
+ * Usage: bench_websocket [-subscribers=50000] [-events=2000] [-slow=1]
+ *                        [-queue=262144] [-policy=disconnect|drop]
+ */
+
+#include "quantumpulse_websocket_v7.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using namespace QuantumPulse::WebSocket;
+
+namespace {
+
+double since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// ~500 bytes, the size of a busy book_delta
+std::string payload(size_t n) {
+  std::string out = "{\"from\":" + std::to_string(n) + ",\"to\":" +
+                    std::to_string(n + 9) + ",\"bids\":[";
+  for (int i = 0; i < 20; ++i) {
+    out += (i ? ",[" : "[") + std::to_string(10000 - i) + ".25,1.5]";
+  }
+  out += "],\"asks\":[";
+  for (int i = 0; i < 10; ++i) {
+    out += (i ? ",[" : "[") + std::to_string(10001 + i) + ".75,0.5]";
+  }
+  return out + "]}";
+}
+
+// The old per-client loop, minus the send: wrap and frame the message
+// once for every subscribed client
+size_t encodePerClient(size_t clients, EventType event,
+                       const std::string &data) {
+  size_t bytes = 0;
+  for (size_t i = 0; i < clients; ++i) {
+    std::string message = "{\"event\":\"" + std::string(eventName(event)) +
+                          "\",\"data\":" + data + "}";
+    bytes += encodeFrame(message)->size();
+  }
+  return bytes;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  size_t subscribers = 50000;
+  size_t events = 2000;
+  size_t slowPercent = 1;
+  FanOut::Config config;
+  config.maxQueuedBytes = 256 * 1024;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("-subscribers=", 0) == 0) {
+      subscribers = std::strtoull(arg.c_str() + 13, nullptr, 10);
+    } else if (arg.rfind("-events=", 0) == 0) {
+      events = std::strtoull(arg.c_str() + 8, nullptr, 10);
+    } else if (arg.rfind("-slow=", 0) == 0) {
+      slowPercent = std::strtoull(arg.c_str() + 6, nullptr, 10);
+    } else if (arg.rfind("-queue=", 0) == 0) {
+      config.maxQueuedBytes = std::strtoull(arg.c_str() + 7, nullptr, 10);
+    } else if (arg == "-policy=drop") {
+      config.policy = SlowConsumerPolicy::DROP;
+    }
+  }
+  if (subscribers == 0 || events == 0) {
+    std::cerr << "nothing to do\n";
+    return 1;
+  }
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool signalled = false;
+  FanOut fanOut(config, [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    signalled = true;
+    wake.notify_one();
+  });
+
+  const auto bit = [](EventType e) { return 1u << static_cast<int>(e); };
+  std::vector<FanOut::Handle> subs;
+  subs.reserve(subscribers);
+  const auto subscribeStart = Clock::now();
+  for (size_t i = 0; i < subscribers; ++i) {
+    uint32_t mask = bit(EventType::TRADE);
+    mask |= i % 2 ? bit(EventType::BOOK_DELTA) : 0;
+    mask |= i % 10 == 0 ? bit(EventType::NEW_BLOCK) : 0;
+    subs.push_back(fanOut.subscribe(i, mask));
+  }
+  const double subscribeSeconds = since(subscribeStart);
+  auto isSlow = [&](uint64_t id) { return id % 100 < slowPercent; };
+
+  std::cout << "QuantumPulse WebSocket fan-out load test (" << subscribers
+            << " subscribers, " << events << " events, " << slowPercent
+            << "% slow, "
+            << (config.policy == SlowConsumerPolicy::DROP ? "drop"
+                                                          : "disconnect")
+            << ")\n"
+            << std::fixed << std::setprecision(1)
+            << "Subscribe:            " << subscribeSeconds * 1e9 / subscribers
+            << " ns per subscriber\n";
+
+  const std::string data = payload(0);
+  {
+    const size_t rounds = 5;
+    const auto start = Clock::now();
+    size_t bytes = 0;
+    for (size_t r = 0; r < rounds; ++r) {
+      bytes += encodePerClient(subscribers, EventType::TRADE, data);
+    }
+    std::cout << "Per-client encoding:  " << since(start) * 1e3 / rounds
+              << " ms per broadcast (" << bytes / rounds / 1024
+              << " KiB built)\n";
+  }
+
+  // I/O thread: drain whatever became ready, as the server's epoll loop
+  std::atomic<bool> publishing{true};
+  uint64_t deliveredBytes = 0, deliveredFrames = 0, closed = 0;
+  std::thread io([&] {
+    std::vector<FanOut::Handle> ready;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake.wait_for(lock, std::chrono::milliseconds(1),
+                      [&] { return signalled; });
+        signalled = false;
+      }
+      fanOut.takeReady(ready);
+      if (ready.empty() && !publishing.load()) {
+        return;
+      }
+      for (const auto &sub : ready) {
+        const bool slow = isSlow(sub->id());
+        auto result =
+            fanOut.drain(*sub, [&](const char *, size_t size) -> ssize_t {
+              if (slow) {
+                return 0; // Socket buffer full for good
+              }
+              deliveredBytes += size;
+              ++deliveredFrames;
+              return static_cast<ssize_t>(size);
+            });
+        if (result == FanOut::Drain::CLOSED) {
+          fanOut.unsubscribe(sub);
+          ++closed;
+        }
+      }
+      ready.clear();
+    }
+  });
+
+  std::vector<uint32_t> latencies(events);
+  const auto start = Clock::now();
+  uint64_t queued = 0;
+  for (size_t i = 0; i < events; ++i) {
+    const EventType event = i % 50 == 49  ? EventType::NEW_BLOCK
+                            : i % 2 == 0 ? EventType::BOOK_DELTA
+                                         : EventType::TRADE;
+    const auto t0 = Clock::now();
+    const Frame frame = encodeFrame(
+        "{\"event\":\"" + std::string(eventName(event)) +
+        "\",\"data\":" + data + "}");
+    queued += fanOut.publish(event, frame);
+    latencies[i] = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                              t0)
+            .count());
+  }
+  const double publishSeconds = since(start);
+  publishing = false;
+  io.join();
+  const double totalSeconds = since(start);
+
+  std::sort(latencies.begin(), latencies.end());
+  auto at = [&](double q) {
+    return latencies[std::min(latencies.size() - 1,
+                              static_cast<size_t>(q * latencies.size()))];
+  };
+  std::cout << "Shared-frame publish: p50 " << at(0.5) << " us  p99 "
+            << at(0.99) << " us  max " << latencies.back()
+            << " us per broadcast (" << queued / events
+            << " queues each)\n"
+            << "Publisher:            " << events / publishSeconds
+            << " broadcasts/s\n"
+            << "Delivered:            " << deliveredFrames << " frames, "
+            << deliveredBytes / (1024.0 * 1024.0) << " MiB in "
+            << totalSeconds << " s (" << deliveredFrames / totalSeconds / 1e6
+            << "M frames/s)\n"
+            << "Slow subscribers:     " << fanOut.slowDisconnects()
+            << " disconnected, " << fanOut.droppedFrames()
+            << " frames dropped\n";
+  return 0;
+}
@@ -2,18 +2,18 @@
 #define QUANTUMPULSE_API_V7_H
 
 #include "quantumpulse_blockchain_v7.h"
+#include "quantumpulse_http_v7.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <cstring>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <netinet/in.h>
 #include <sstream>
 #include <string>
 #include <string_view>
-#include <sys/socket.h>
-#include <thread>
-#include <unistd.h>
+#include <utility>
 #include <vector>
 
 namespace QuantumPulse::API {
@@ -21,13 +21,28 @@ namespace QuantumPulse::API {
 // API Configuration
 struct APIConfig {
   static constexpr int DEFAULT_PORT = 8080;
-  static constexpr int MAX_CONNECTIONS = 100;
-  static constexpr int BUFFER_SIZE = 65536;
+  static constexpr int MAX_CONNECTIONS = 16384;
+  static constexpr size_t MAX_BODY_BYTES = 8 * 1024 * 1024;
   static constexpr int REQUEST_TIMEOUT_SEC = 30;
 };
 
 // HTTP Methods
 enum class HttpMethod { GET, POST, PUT, DELETE, OPTIONS, UNKNOWN };
+inline constexpr size_t HTTP_METHOD_COUNT = 6;
+
+[[nodiscard]] inline HttpMethod parseMethod(std::string_view s) noexcept {
+  if (s == "GET")
+    return HttpMethod::GET;
+  if (s == "POST")
+    return HttpMethod::POST;
+  if (s == "PUT")
+    return HttpMethod::PUT;
+  if (s == "DELETE")
+    return HttpMethod::DELETE;
+  if (s == "OPTIONS")
+    return HttpMethod::OPTIONS;
+  return HttpMethod::UNKNOWN;
+}
 
 // HTTP Status codes
 enum class HttpStatus {
@@ -67,8 +82,8 @@ struct HttpRequest {
   HttpMethod method{HttpMethod::UNKNOWN};
   std::string path;
   std::string body;
-  std::map<std::string, std::string> headers;
-  std::map<std::string, std::string> params;
+  std::map<std::string, std::string> headers; // Lower-case names
+  std::map<std::string, std::string> params;  // Query and path parameters
 
   [[nodiscard]] std::string getParam(const std::string &key) const noexcept {
     auto it = params.find(key);
@@ -88,34 +103,185 @@ struct HttpResponse {
     contentType = "application/json";
   }
 
-  [[nodiscard]] std::string build() const noexcept {
-    std::stringstream ss;
-    ss << "HTTP/1.1 " << statusToString(status) << "\r\n";
-    ss << "Content-Type: " << contentType << "\r\n";
-    ss << "Content-Length: " << body.length() << "\r\n";
-    ss << "Access-Control-Allow-Origin: *\r\n";
-    ss << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-    ss << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-    ss << "Connection: close\r\n";
-    for (const auto &[key, value] : headers) {
-      ss << key << ": " << value << "\r\n";
+  // Hand the response to the reactor, adding CORS headers
+  [[nodiscard]] Http::Response toHttp() && {
+    Http::Response res;
+    res.status = static_cast<int>(status);
+    res.contentType = std::move(contentType);
+    res.body = std::move(body);
+    res.headers.reserve(headers.size() + 3);
+    res.headers.emplace_back("Access-Control-Allow-Origin", "*");
+    res.headers.emplace_back("Access-Control-Allow-Methods",
+                             "GET, POST, PUT, DELETE, OPTIONS");
+    res.headers.emplace_back("Access-Control-Allow-Headers",
+                             "Content-Type, Authorization");
+    for (auto &[key, value] : headers) {
+      res.headers.emplace_back(key, std::move(value));
     }
-    ss << "\r\n";
-    ss << body;
-    return ss.str();
+    return res;
   }
 };
 
 // Route handler type
 using RouteHandler = std::function<HttpResponse(const HttpRequest &)>;
 
-// REST API Server
+// Route trie compiled from path patterns. Segments starting with ':' are
+// parameters ("/api/block/:height"); a literal segment wins over a
+// parameter at the same level unless only the parameter route handles the
+// request's method. Immutable once built, so matching takes no lock.
+class Router final {
+public:
+  enum class Match { Found, NotFound, MethodNotAllowed };
+
+  // Returns false, leaving the route unusable, if the pattern names a
+  // parameter differently from an earlier pattern at the same position
+  bool add(HttpMethod method, std::string_view pattern, RouteHandler handler) {
+    Node *node = &root_;
+    bool named = forEachSegment(pattern, [&](std::string_view seg) {
+      if (seg.front() == ':') {
+        if (!node->param) {
+          node->param = std::make_unique<Node>();
+          node->paramName.assign(seg.substr(1));
+        } else if (node->paramName != seg.substr(1)) {
+          return false;
+        }
+        node = node->param.get();
+        return true;
+      }
+      auto it = std::lower_bound(node->children.begin(),
+                                 node->children.end(), seg, byName);
+      if (it == node->children.end() || it->first != seg) {
+        it = node->children.emplace(it, std::string(seg),
+                                    std::make_unique<Node>());
+      }
+      node = it->second.get();
+      return true;
+    });
+    if (!named) {
+      return false;
+    }
+    node->handlers[static_cast<size_t>(method)] = std::move(handler);
+    node->terminal = true;
+    return true;
+  }
+
+  // On Found, `handler` is set and path parameters are added to `params`
+  Match match(HttpMethod method, std::string_view path,
+              const RouteHandler *&handler,
+              std::map<std::string, std::string> &params) const {
+    std::array<std::string_view, MAX_SEGMENTS> segs;
+    size_t count = 0;
+    bool fits = forEachSegment(path, [&](std::string_view seg) {
+      if (count == MAX_SEGMENTS) {
+        return false;
+      }
+      segs[count++] = seg;
+      return true;
+    });
+    if (!fits) {
+      return Match::NotFound;
+    }
+
+    std::array<std::pair<const Node *, std::string_view>, MAX_SEGMENTS>
+        bound;
+    size_t boundCount = 0;
+    bool pathMatched = false;
+    const Node *node = find(&root_, segs.data(), count, method, bound,
+                            boundCount, pathMatched);
+    if (!node) {
+      return pathMatched ? Match::MethodNotAllowed : Match::NotFound;
+    }
+    for (size_t i = 0; i < boundCount; ++i) {
+      params[bound[i].first->paramName] = std::string(bound[i].second);
+    }
+    handler = &node->handlers[static_cast<size_t>(method)];
+    return Match::Found;
+  }
+
+private:
+  static constexpr size_t MAX_SEGMENTS = 16;
+
+  struct Node {
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> children;
+    std::unique_ptr<Node> param;
+    std::string paramName;
+    std::array<RouteHandler, HTTP_METHOD_COUNT> handlers;
+    bool terminal{false};
+  };
+
+  Node root_;
+
+  static bool byName(const std::pair<std::string, std::unique_ptr<Node>> &child,
+                     std::string_view name) noexcept {
+    return child.first < name;
+  }
+
+  // Non-empty '/'-separated segments; stops early if `fn` returns false
+  template <typename Fn>
+  static bool forEachSegment(std::string_view path, Fn &&fn) {
+    size_t pos = 0;
+    while (pos < path.size()) {
+      size_t slash = path.find('/', pos);
+      size_t end = slash == std::string_view::npos ? path.size() : slash;
+      if (end > pos && !fn(path.substr(pos, end - pos))) {
+        return false;
+      }
+      pos = end + 1;
+    }
+    return true;
+  }
+
+  // Depth-first: literal child first, then the parameter child, to the
+  // first route with a handler for `method`. `pathMatched` records that
+  // some route matched the path without one. The parameter owner is
+  // recorded so its name can be bound on success.
+  static const Node *
+  find(const Node *node, const std::string_view *segs, size_t count,
+       HttpMethod method,
+       std::array<std::pair<const Node *, std::string_view>, MAX_SEGMENTS>
+           &bound,
+       size_t &boundCount, bool &pathMatched) {
+    if (count == 0) {
+      if (!node->terminal) {
+        return nullptr;
+      }
+      if (node->handlers[static_cast<size_t>(method)]) {
+        return node;
+      }
+      pathMatched = true;
+      return nullptr;
+    }
+    auto it = std::lower_bound(node->children.begin(), node->children.end(),
+                               segs[0], byName);
+    if (it != node->children.end() && it->first == segs[0]) {
+      if (auto *hit = find(it->second.get(), segs + 1, count - 1, method,
+                           bound, boundCount, pathMatched)) {
+        return hit;
+      }
+    }
+    if (node->param) {
+      size_t mark = boundCount;
+      bound[boundCount++] = {node, segs[0]};
+      if (auto *hit = find(node->param.get(), segs + 1, count - 1, method,
+                           bound, boundCount, pathMatched)) {
+        return hit;
+      }
+      boundCount = mark;
+    }
+    return nullptr;
+  }
+};
+
+// REST API Server. Connections are served by the Http::Server epoll
+// reactor: keep-alive, pipelined requests answered in order, and request
+// bodies parsed incrementally as they arrive. Routes are compiled into a
+// Router that request threads read without locking; addRoute() builds a
+// new one and publishes it, retiring the old one until shutdown.
 class APIServer final {
 public:
   explicit APIServer(Blockchain::Blockchain &blockchain,
                      int port = APIConfig::DEFAULT_PORT) noexcept
-      : blockchain_(blockchain), port_(port), running_(false),
-        serverSocket_(-1) {
+      : blockchain_(blockchain), port_(port) {
     setupRoutes();
     Logging::Logger::getInstance().info(
         "API Server initialized on port " + std::to_string(port), "API", 0);
@@ -133,91 +299,96 @@ public:
       return false;
     }
 
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket_ < 0) {
-      Logging::Logger::getInstance().error("Failed to create socket", "API", 0);
+    Http::ServerConfig config;
+    config.port = static_cast<uint16_t>(port_);
+    config.maxConnections = APIConfig::MAX_CONNECTIONS;
+    config.maxBodyBytes = APIConfig::MAX_BODY_BYTES;
+    config.idleTimeoutSec = APIConfig::REQUEST_TIMEOUT_SEC;
+    try {
+      server_ = std::make_unique<Http::Server>(
+          config, [this](Http::Request &request) { return handle(request); });
+    } catch (...) {
       return false;
     }
-
-    // Allow socket reuse
-    int opt = 1;
-    setsockopt(serverSocket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port_);
-
-    if (bind(serverSocket_, reinterpret_cast<sockaddr *>(&serverAddr),
-             sizeof(serverAddr)) < 0) {
+    if (!server_->start()) {
       Logging::Logger::getInstance().error("Failed to bind socket", "API", 0);
-      close(serverSocket_);
-      return false;
-    }
-
-    if (listen(serverSocket_, APIConfig::MAX_CONNECTIONS) < 0) {
-      Logging::Logger::getInstance().error("Failed to listen", "API", 0);
-      close(serverSocket_);
+      server_.reset();
       return false;
     }
 
     running_.store(true);
-    serverThread_ = std::thread(&APIServer::acceptLoop, this);
-
     Logging::Logger::getInstance().info(
-        "API Server started at http://localhost:" + std::to_string(port_),
+        "API Server started at http://localhost:" +
+            std::to_string(server_->getPort()),
         "API", 0);
     return true;
   }
 
   // Stop server
   void stop() noexcept {
-    if (!running_.load()) {
+    if (!running_.exchange(false)) {
       return;
     }
-
-    running_.store(false);
-
-    if (serverSocket_ >= 0) {
-      shutdown(serverSocket_, SHUT_RDWR);
-      close(serverSocket_);
-      serverSocket_ = -1;
-    }
-
-    if (serverThread_.joinable()) {
-      serverThread_.join();
-    }
-
+    server_->stop();
+    server_.reset();
     Logging::Logger::getInstance().info("API Server stopped", "API", 0);
   }
 
   // Check if running
   [[nodiscard]] bool isRunning() const noexcept { return running_.load(); }
 
-  // Add custom route
-  void addRoute(HttpMethod method, const std::string &path,
+  // Bound port (resolves an ephemeral port 0); 0 when stopped
+  [[nodiscard]] uint16_t getPort() const noexcept {
+    return server_ ? server_->getPort() : 0;
+  }
+
+  // Add custom route; `path` may contain ":name" parameter segments.
+  // Returns false if a parameter at the same position in another route
+  // has a different name.
+  bool addRoute(HttpMethod method, const std::string &path,
                 RouteHandler handler) noexcept {
     std::lock_guard<std::mutex> lock(routesMutex_);
-    routes_[{method, path}] = std::move(handler);
+    routes_.push_back({method, path, std::move(handler)});
+    auto next = std::make_unique<Router>();
+    for (const auto &route : routes_) {
+      if (!next->add(route.method, route.path, route.handler)) {
+        routes_.pop_back();
+        Logging::Logger::getInstance().error(
+            "Route " + path + " conflicts with a parameter name", "API", 0);
+        return false;
+      }
+    }
+    router_.store(next.get(), std::memory_order_release);
+    retired_.push_back(std::move(next));
+    return true;
   }
 
 private:
+  struct Route {
+    HttpMethod method;
+    std::string path;
+    RouteHandler handler;
+  };
+
   Blockchain::Blockchain &blockchain_;
   int port_;
-  std::atomic<bool> running_;
-  int serverSocket_;
-  std::thread serverThread_;
-  std::map<std::pair<HttpMethod, std::string>, RouteHandler> routes_;
-  mutable std::mutex routesMutex_;
+  std::atomic<bool> running_{false};
+  std::unique_ptr<Http::Server> server_;
+  std::vector<Route> routes_;
+  std::atomic<const Router *> router_{nullptr};
+  std::vector<std::unique_ptr<const Router>> retired_; // Includes current
+  mutable std::mutex routesMutex_;                     // Writers only
 
   void setupRoutes() noexcept {
     // GET /api/info - Blockchain info
     addRoute(HttpMethod::GET, "/api/info",
              [this](const HttpRequest &) { return handleInfo(); });
 
-    // GET /api/balance/:address
+    // GET /api/balance/:address (or /api/balance?address=)
     addRoute(HttpMethod::GET, "/api/balance",
              [this](const HttpRequest &req) { return handleBalance(req); });
+    addRoute(HttpMethod::GET, "/api/balance/:address",
+             [this](const HttpRequest &req) { return handleBalance(req); });
 
     // POST /api/transaction
     addRoute(HttpMethod::POST, "/api/transaction",
@@ -234,161 +405,63 @@ private:
     // GET /api/price
     addRoute(HttpMethod::GET, "/api/price",
              [this](const HttpRequest &) { return handlePrice(); });
-
-    // OPTIONS for CORS
-    addRoute(HttpMethod::OPTIONS, "/api", [](const HttpRequest &) {
-      HttpResponse res;
-      res.status = HttpStatus::OK;
-      res.body = "";
-      return res;
-    });
   }
 
-  void acceptLoop() noexcept {
-    while (running_.load()) {
-      sockaddr_in clientAddr{};
-      socklen_t clientLen = sizeof(clientAddr);
-
-      int clientSocket = accept(
-          serverSocket_, reinterpret_cast<sockaddr *>(&clientAddr), &clientLen);
-
-      if (clientSocket < 0) {
-        if (running_.load()) {
-          Logging::Logger::getInstance().warning("Failed to accept connection",
-                                                 "API", 0);
-        }
-        continue;
-      }
-
-      // Handle request in thread
-      std::thread(&APIServer::handleClient, this, clientSocket).detach();
-    }
-  }
-
-  void handleClient(int clientSocket) noexcept {
-    char buffer[APIConfig::BUFFER_SIZE];
-    ssize_t bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
+  // Runs on the reactor's worker pool
+  [[nodiscard]] Http::Response handle(Http::Request &raw) {
+    HttpRequest req;
+    req.method = parseMethod(raw.method);
 
-    if (bytesRead <= 0) {
-      close(clientSocket);
-      return;
+    // Handle CORS preflight
+    if (req.method == HttpMethod::OPTIONS) {
+      return HttpResponse{}.toHttp();
     }
 
-    buffer[bytesRead] = '\0';
+    req.path.assign(raw.path());
+    parseQuery(raw.query(), req.params);
 
-    HttpRequest request = parseRequest(buffer);
-    HttpResponse response = routeRequest(request);
-
-    std::string responseStr = response.build();
-    send(clientSocket, responseStr.c_str(), responseStr.length(), 0);
-
-    close(clientSocket);
-  }
-
-  [[nodiscard]] HttpRequest
-  parseRequest(const char *rawRequest) const noexcept {
-    HttpRequest req;
-    std::istringstream stream(rawRequest);
-    std::string line;
-
-    // Parse request line
-    if (std::getline(stream, line)) {
-      std::istringstream lineStream(line);
-      std::string methodStr, path;
-      lineStream >> methodStr >> path;
-
-      if (methodStr == "GET")
-        req.method = HttpMethod::GET;
-      else if (methodStr == "POST")
-        req.method = HttpMethod::POST;
-      else if (methodStr == "PUT")
-        req.method = HttpMethod::PUT;
-      else if (methodStr == "DELETE")
-        req.method = HttpMethod::DELETE;
-      else if (methodStr == "OPTIONS")
-        req.method = HttpMethod::OPTIONS;
-
-      // Parse path and query params
-      size_t queryPos = path.find('?');
-      if (queryPos != std::string::npos) {
-        std::string query = path.substr(queryPos + 1);
-        req.path = path.substr(0, queryPos);
-
-        // Parse query params
-        std::istringstream queryStream(query);
-        std::string param;
-        while (std::getline(queryStream, param, '&')) {
-          size_t eqPos = param.find('=');
-          if (eqPos != std::string::npos) {
-            req.params[param.substr(0, eqPos)] = param.substr(eqPos + 1);
-          }
-        }
+    const RouteHandler *handler = nullptr;
+    const Router *router = router_.load(std::memory_order_acquire);
+    auto match = router->match(req.method, req.path, handler, req.params);
+    if (match != Router::Match::Found) {
+      HttpResponse res;
+      if (match == Router::Match::MethodNotAllowed) {
+        res.status = HttpStatus::MethodNotAllowed;
+        res.setJSON(R"({"error":"Method not allowed"})");
       } else {
-        req.path = path;
+        res.status = HttpStatus::NotFound;
+        res.setJSON(R"({"error":"Endpoint not found"})");
       }
+      return std::move(res).toHttp();
     }
 
-    // Parse headers
-    while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-      size_t colonPos = line.find(':');
-      if (colonPos != std::string::npos) {
-        std::string key = line.substr(0, colonPos);
-        std::string value = line.substr(colonPos + 2);
-        if (!value.empty() && value.back() == '\r') {
-          value.pop_back();
-        }
-        req.headers[key] = value;
-      }
-    }
-
-    // Parse body
-    std::string body;
-    while (std::getline(stream, line)) {
-      body += line;
+    for (auto &[name, value] : raw.headers) {
+      req.headers.emplace(std::move(name), std::move(value));
     }
-    req.body = body;
-
-    return req;
-  }
-
-  [[nodiscard]] HttpResponse routeRequest(const HttpRequest &req) noexcept {
-    std::lock_guard<std::mutex> lock(routesMutex_);
-
-    // Handle CORS preflight
-    if (req.method == HttpMethod::OPTIONS) {
+    req.body = std::move(raw.body);
+    try {
+      return (*handler)(req).toHttp();
+    } catch (...) {
       HttpResponse res;
-      res.status = HttpStatus::OK;
-      return res;
-    }
-
-    // Find matching route
-    auto it = routes_.find({req.method, req.path});
-    if (it != routes_.end()) {
-      try {
-        return it->second(req);
-      } catch (...) {
-        HttpResponse res;
-        res.status = HttpStatus::InternalError;
-        res.setJSON(R"({"error":"Internal server error"})");
-        return res;
-      }
+      res.status = HttpStatus::InternalError;
+      res.setJSON(R"({"error":"Internal server error"})");
+      return std::move(res).toHttp();
     }
+  }
 
-    // Try matching with /api prefix for balance
-    if (req.path.find("/api/balance/") == 0) {
-      HttpRequest modReq = req;
-      modReq.params["address"] = req.path.substr(13);
-      modReq.path = "/api/balance";
-      auto balanceIt = routes_.find({HttpMethod::GET, "/api/balance"});
-      if (balanceIt != routes_.end()) {
-        return balanceIt->second(modReq);
+  static void parseQuery(std::string_view query,
+                         std::map<std::string, std::string> &params) {
+    while (!query.empty()) {
+      size_t amp = query.find('&');
+      std::string_view pair = query.substr(0, amp);
+      size_t eq = pair.find('=');
+      if (eq != std::string_view::npos) {
+        params[std::string(pair.substr(0, eq))] =
+            std::string(pair.substr(eq + 1));
       }
+      query = amp == std::string_view::npos ? std::string_view{}
+                                            : query.substr(amp + 1);
     }
-
-    HttpResponse res;
-    res.status = HttpStatus::NotFound;
-    res.setJSON(R"({"error":"Endpoint not found"})");
-    return res;
   }
 
   // API Handlers
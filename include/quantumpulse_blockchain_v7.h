@@ -7,6 +7,8 @@
 #include "quantumpulse_mining_v7.h"
 #include "quantumpulse_network_v7.h"
 #include "quantumpulse_sharding_v7.h"
+#include "quantumpulse_threadpool_v7.h"
+#include "quantumpulse_trace_v7.h"
 #include "quantumpulse_upgrades_v7.h"
 #include <atomic>
 #include <chrono>
@@ -22,7 +24,9 @@
 #include <optional>
 #include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace QuantumPulse::Blockchain {
@@ -149,12 +153,12 @@ public:
     // Assign to shard
     shardingManager.assignShard(txId, shardId);
 
-    Logging::Logger::getInstance().log(
-        "Transaction created: " + txId.substr(0, 16) + "...", Logging::INFO,
-        "Blockchain", shardId);
+    Logging::Logger::getInstance().logf(
+        Logging::INFO, "Blockchain", shardId, "Transaction created: {}...",
+        std::string_view(txId).substr(0, 16));
   }
 
-  bool verify(Crypto::CryptoManager &cryptoManager) const {
+  bool verify(const Crypto::CryptoManager &cryptoManager) const {
     // Check expiration
     if (time(nullptr) > expiresAt) {
       return false;
@@ -240,11 +244,7 @@ public:
     shardId = shardId_;
 
     // Calculate merkle root
-    std::string txData;
-    for (const auto &tx : transactions) {
-      txData += tx.serialize();
-    }
-    merkleRoot = cryptoManager.sha3_512_v11(txData, shardId);
+    merkleRoot = computeMerkleRoot(transactions, cryptoManager, shardId);
 
     // Block size limit (prevent DoS)
     if (transactions.size() > 10000) {
@@ -267,22 +267,65 @@ public:
 
     if (success) {
       miningManager.addMinedCoins(reward);
-      Logging::Logger::getInstance().log("Block mined: " + hash.substr(0, 16) +
-                                             "...",
-                                         Logging::INFO, "Blockchain", shardId);
+      Logging::Logger::getInstance().logf(
+          Logging::INFO, "Blockchain", shardId, "Block mined: {}...",
+          std::string_view(hash).substr(0, 16));
     }
     return success;
   }
 
-  bool validate(Crypto::CryptoManager &cryptoManager) const {
+  static std::string
+  computeMerkleRoot(const std::vector<Transaction> &txs,
+                    const Crypto::CryptoManager &cryptoManager, int shardId) {
+    std::string txData;
+    for (const auto &tx : txs) {
+      txData += tx.serialize();
+    }
+    return cryptoManager.sha3_512_v11(txData, shardId);
+  }
+
+  bool isGenesis() const { return prevHash.find("genesis_") == 0; }
+
+  // Header-only check: the hash is the PoW hash of the header fields and
+  // meets the target
+  bool checkProofOfWork(const Mining::MiningManager &miningManager) const {
+    return meetsDifficulty() &&
+           miningManager.checkProofOfWork(
+               prevHash + merkleRoot + std::to_string(timestamp), nonce,
+               shardId, hash);
+  }
+
+  // Same block without its transaction list
+  Block header() const {
+    Block h;
+    h.prevHash = prevHash;
+    h.hash = hash;
+    h.merkleRoot = merkleRoot;
+    h.timestamp = timestamp;
+    h.nonce = nonce;
+    h.difficulty = difficulty;
+    h.reward = reward;
+    h.shardId = shardId;
+    h.version = version;
+    return h;
+  }
+
+  // Hash meets difficulty target
+  bool meetsDifficulty() const {
+    if (difficulty < 0 || hash.size() < static_cast<size_t>(difficulty)) {
+      return false;
+    }
+    return hash.find_first_not_of('0') >= static_cast<size_t>(difficulty);
+  }
+
+  bool validate(const Crypto::CryptoManager &cryptoManager) const {
     // Genesis blocks are always valid
-    if (prevHash.find("genesis_") == 0) {
+    if (isGenesis()) {
       return !isOrphaned;
     }
 
     // Check hash meets difficulty target
-    std::string target(difficulty, '0');
-    if (hash.substr(0, difficulty) != target) {
+    if (!meetsDifficulty()) {
       return false;
     }
 
@@ -332,6 +375,108 @@ public:
   }
 };
 
+// Outcome of a full-chain validation run
+struct ChainValidationResult {
+  bool valid{true};
+  size_t failedIndex{0}; // First invalid block when !valid
+  std::string reason;
+};
+
+// Staged chain validator applying the same rules as Block::validate():
+// the header checks (orphan flag, proof of work) and every transaction's
+// signatures fan out across the thread pool. The reported failure is
+// always the lowest invalid block index, matching a sequential scan.
+class ChainValidator final {
+public:
+  static constexpr size_t BLOCK_GRAIN = 8;
+  static constexpr size_t TX_GRAIN = 64;
+
+  explicit ChainValidator(
+      const Crypto::CryptoManager &cryptoManager,
+      Concurrency::ThreadPool &pool = Concurrency::ThreadPool::getInstance())
+      : crypto_(cryptoManager), pool_(pool) {}
+
+  // Validate chain[firstIndex..]
+  ChainValidationResult validate(const std::vector<Block> &chain,
+                                 size_t firstIndex = 1) const {
+    const size_t count = chain.size();
+    if (firstIndex >= count) {
+      return {};
+    }
+
+    // Lowest failing index found by any parallel stage; later blocks are
+    // skipped once an earlier one has failed
+    std::atomic<size_t> firstFailure{count};
+    std::vector<std::atomic<const char *>> reasons(count);
+    auto fail = [&](size_t i, const char *reason) {
+      reasons[i].store(reason);
+      size_t current = firstFailure.load();
+      while (i < current && !firstFailure.compare_exchange_weak(current, i)) {
+      }
+    };
+
+    // Stage 1: per-block header checks
+    pool_.parallelFor(count - firstIndex, BLOCK_GRAIN,
+                      [&](size_t begin, size_t end) {
+                        for (size_t k = begin; k < end; ++k) {
+                          size_t i = firstIndex + k;
+                          if (i >= firstFailure.load()) {
+                            return;
+                          }
+                          if (const char *r = checkHeader(chain[i])) {
+                            fail(i, r);
+                          }
+                        }
+                      });
+
+    // Stage 2: transaction signatures, flattened across blocks
+    std::vector<std::pair<size_t, const Transaction *>> txs;
+    for (size_t i = firstIndex; i < count; ++i) {
+      if (!chain[i].isGenesis()) {
+        for (const auto &tx : chain[i].transactions) {
+          txs.emplace_back(i, &tx);
+        }
+      }
+    }
+    pool_.parallelFor(txs.size(), TX_GRAIN, [&](size_t begin, size_t end) {
+      for (size_t t = begin; t < end; ++t) {
+        auto [i, tx] = txs[t];
+        if (i >= firstFailure.load()) {
+          continue;
+        }
+        if (!tx->verify(crypto_)) {
+          fail(i, "transaction verification failed");
+        }
+      }
+    });
+
+    ChainValidationResult result;
+    if (const size_t bad = firstFailure.load(); bad < count) {
+      result.valid = false;
+      result.failedIndex = bad;
+      result.reason = reasons[bad].load();
+    }
+    return result;
+  }
+
+private:
+  const Crypto::CryptoManager &crypto_;
+  Concurrency::ThreadPool &pool_;
+
+  const char *checkHeader(const Block &block) const {
+    if (block.isOrphaned) {
+      return "orphaned block";
+    }
+    if (block.isGenesis()) {
+      return nullptr;
+    }
+    if (!block.meetsDifficulty()) {
+      return "hash does not meet difficulty target";
+    }
+    return nullptr;
+  }
+};
+
 // Main Blockchain class with enhanced security
 class Blockchain {
 public:
@@ -353,6 +498,7 @@ public:
       genesis.difficulty = 4;
       genesis.reward = 50.0;
       genesis.shardId = i;
+      heightByHash.emplace(genesis.hash, chain.size());
       chain.push_back(genesis);
     }
 
@@ -365,36 +511,41 @@ public:
   }
 
   bool addBlock(const Block &block) {
+    QP_TRACE_SCOPE("block.add", "chain");
+    QP_TRACE_SPAN(lockWait, "block.lock", "chain");
     std::unique_lock<std::shared_mutex> lock(chainMutex);
+    QP_TRACE_END(lockWait);
     ReentrancyGuard guard(isAddingBlock, "addBlock", block.shardId);
 
+    QP_TRACE_SPAN(validate, "block.validate", "chain");
     if (!block.validate(cryptoManager)) {
       Logging::Logger::getInstance().log("Block validation failed",
                                          Logging::ERROR, "Blockchain",
                                          block.shardId);
       return false;
     }
+    QP_TRACE_END(validate);
 
+    heightByHash.emplace(block.hash, chain.size());
     chain.push_back(block);
     totalMinedCoins.fetch_add(static_cast<int64_t>(block.reward * 100000000));
 
-    Logging::Logger::getInstance().log(
-        "Added block: " + block.hash.substr(0, 16) + "...", Logging::INFO,
-        "Blockchain", block.shardId);
+    Logging::Logger::getInstance().logf(
+        Logging::INFO, "Blockchain", block.shardId, "Added block: {}...",
+        std::string_view(block.hash).substr(0, 16));
     return true;
   }
 
   bool validateChain() const {
     std::shared_lock<std::shared_mutex> lock(chainMutex);
 
-    for (size_t i = 1; i < chain.size(); ++i) {
-      Crypto::CryptoManager cm;
-      if (!chain[i].validate(cm)) {
-        Logging::Logger::getInstance().log("Chain validation failed at block " +
-                                               std::to_string(i),
-                                           Logging::ERROR, "Blockchain", 0);
-        return false;
-      }
+    auto result = ChainValidator(cryptoManager).validate(chain);
+    if (!result.valid) {
+      Logging::Logger::getInstance().log(
+          "Chain validation failed at block " +
+              std::to_string(result.failedIndex) + ": " + result.reason,
+          Logging::ERROR, "Blockchain", 0);
+      return false;
     }
 
     Logging::Logger::getInstance().log("Chain validation passed for " +
@@ -436,7 +587,10 @@ public:
   // Transfer with reentrancy protection - privacy preserving
   bool transfer(const std::string &from, const std::string &to, double amount,
                 const std::string &privateKey, int shardId) {
+    QP_TRACE_SCOPE("transfer", "chain");
+    QP_TRACE_SPAN(lockWait, "transfer.lock", "chain");
     std::unique_lock<std::shared_mutex> lock(chainMutex);
+    QP_TRACE_END(lockWait);
     ReentrancyGuard guard(isTransferring, "transfer", shardId);
 
     // Validate inputs
@@ -566,6 +720,39 @@ public:
     return chain.size();
   }
 
+  // Copy of the block at `height`, if present
+  std::optional<Block> getBlock(size_t height) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex);
+    if (height >= chain.size()) {
+      return std::nullopt;
+    }
+    return chain[height];
+  }
+
+  // Height of the block with `hash`, if present
+  std::optional<size_t> getBlockHeight(const std::string &hash) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex);
+    auto it = heightByHash.find(hash);
+    return it != heightByHash.end() ? std::make_optional(it->second)
+                                    : std::nullopt;
+  }
+
+  std::optional<std::string> getBlockHash(size_t height) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex);
+    return height < chain.size() ? std::make_optional(chain[height].hash)
+                                 : std::nullopt;
+  }
+
+  // Headers (no transactions) of up to `max` blocks from `from`
+  std::vector<Block> getHeaders(size_t from, size_t max) const {
+    std::shared_lock<std::shared_mutex> lock(chainMutex);
+    std::vector<Block> headers;
+    for (size_t i = from; i < chain.size() && headers.size() < max; ++i) {
+      headers.push_back(chain[i].header());
+    }
+    return headers;
+  }
+
   Crypto::CryptoManager &getCryptoManager() { return cryptoManager; }
   Mining::MiningManager &getMiningManager() { return miningManager; }
   AI::AIManager &getAIManager() { return aiManager; }
@@ -575,6 +762,7 @@ public:
 
 private:
   std::vector<Block> chain;
+  std::unordered_map<std::string, size_t> heightByHash;
   std::map<std::string, double> balances;
   std::map<std::string, double> hiddenBalances; // Privacy: hidden from public
   std::map<std::string, std::string> accountPasswords;
@@ -0,0 +1,100 @@
+#ifndef QUANTUMPULSE_CHECKSUM_V7_H
+#define QUANTUMPULSE_CHECKSUM_V7_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace QuantumPulse::Checksum {
+
+namespace detail {
+
+// CRC-32C (Castagnoli), reflected polynomial
+constexpr std::array<uint32_t, 256> makeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+inline constexpr std::array<uint32_t, 256> CRC32C_TABLE = makeCrc32cTable();
+
+constexpr uint64_t rotl(uint64_t x, int b) noexcept {
+  return (x << b) | (x >> (64 - b));
+}
+
+struct SipState {
+  uint64_t v0, v1, v2, v3;
+
+  constexpr void round() noexcept {
+    v0 += v1;
+    v1 = rotl(v1, 13) ^ v0;
+    v0 = rotl(v0, 32);
+    v2 += v3;
+    v3 = rotl(v3, 16) ^ v2;
+    v0 += v3;
+    v3 = rotl(v3, 21) ^ v0;
+    v2 += v1;
+    v1 = rotl(v1, 17) ^ v2;
+    v2 = rotl(v2, 32);
+  }
+
+  constexpr void compress(uint64_t m) noexcept {
+    v3 ^= m;
+    round();
+    round();
+    v0 ^= m;
+  }
+};
+
+} // namespace detail
+
+// Integrity checksum for on-disk records and wire frames; not a MAC.
+// Pass a previous result as `crc` to continue over split buffers.
+[[nodiscard]] inline uint32_t crc32c(const void *data, size_t len,
+                                     uint32_t crc = 0) noexcept {
+  const auto *p = static_cast<const unsigned char *>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) {
+    crc = detail::CRC32C_TABLE[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// SipHash-2-4: keyed 64-bit hash for short identifiers derived from
+// attacker-chosen input, where an unkeyed hash could be steered into
+// collisions
+[[nodiscard]] inline uint64_t siphash24(uint64_t k0, uint64_t k1,
+                                        const void *data,
+                                        size_t len) noexcept {
+  const auto *p = static_cast<const unsigned char *>(data);
+  detail::SipState s{k0 ^ 0x736f6d6570736575ULL, k1 ^ 0x646f72616e646f6dULL,
+                     k0 ^ 0x6c7967656e657261ULL, k1 ^ 0x7465646279746573ULL};
+  size_t blocks = len / 8;
+  for (size_t i = 0; i < blocks; ++i, p += 8) {
+    uint64_t m = 0;
+    for (int b = 0; b < 8; ++b) {
+      m |= static_cast<uint64_t>(p[b]) << (8 * b);
+    }
+    s.compress(m);
+  }
+  uint64_t last = static_cast<uint64_t>(len) << 56;
+  for (size_t b = 0; b < len % 8; ++b) {
+    last |= static_cast<uint64_t>(p[b]) << (8 * b);
+  }
+  s.compress(last);
+  s.v2 ^= 0xFF;
+  for (int i = 0; i < 4; ++i) {
+    s.round();
+  }
+  return s.v0 ^ s.v1 ^ s.v2 ^ s.v3;
+}
+
+} // namespace QuantumPulse::Checksum
+
+#endif // QUANTUMPULSE_CHECKSUM_V7_H
@@ -2,6 +2,7 @@
 #define QUANTUMPULSE_CRYPTO_V7_H
 
 #include "quantumpulse_logging_v7.h"
+#include "quantumpulse_sha512_batch_v7.h"
 #include <algorithm>
 #include <array>
 #include <cstring>
@@ -78,6 +79,85 @@ private:
 };
 } // namespace SecureMemory
 
+// Raw SHA-512 digest as produced by the lock-free hashing path
+using Digest512 = std::array<unsigned char, SHA512_DIGEST_LENGTH>;
+
+// Lock-free hashing primitives. Each thread owns one reusable EVP_MD_CTX, so
+// hashing never allocates a context per call and never takes a shared lock.
+namespace Hashing {
+
+// Resolve the SHA-512 implementation once per process
+[[nodiscard]] inline const EVP_MD *sha512Algorithm() noexcept {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static EVP_MD *md = EVP_MD_fetch(nullptr, "SHA512", nullptr);
+  return md ? md : EVP_sha512();
+#else
+  return EVP_sha512();
+#endif
+}
+
+// Digest context owned by the calling thread, reused across calls
+class ThreadDigestContext final {
+public:
+  ThreadDigestContext() noexcept : ctx_(EVP_MD_CTX_new()) {}
+  ~ThreadDigestContext() noexcept {
+    if (ctx_) {
+      EVP_MD_CTX_free(ctx_);
+    }
+  }
+
+  ThreadDigestContext(const ThreadDigestContext &) = delete;
+  ThreadDigestContext &operator=(const ThreadDigestContext &) = delete;
+
+  [[nodiscard]] static EVP_MD_CTX *get() noexcept {
+    thread_local ThreadDigestContext context;
+    return context.ctx_;
+  }
+
+private:
+  EVP_MD_CTX *ctx_;
+};
+
+// SHA-512 into a caller-provided digest; returns false on OpenSSL failure
+[[nodiscard]] inline bool sha512(const void *data, size_t length,
+                                 unsigned char *out) noexcept {
+  EVP_MD_CTX *ctx = ThreadDigestContext::get();
+  if (!ctx) {
+    return false;
+  }
+  return EVP_DigestInit_ex(ctx, sha512Algorithm(), nullptr) == 1 &&
+         EVP_DigestUpdate(ctx, data, length) == 1 &&
+         EVP_DigestFinal_ex(ctx, out, nullptr) == 1;
+}
+
+[[nodiscard]] inline bool sha512(std::string_view data,
+                                 Digest512 &out) noexcept {
+  return sha512(data.data(), data.length(), out.data());
+}
+
+// Table-driven lowercase hex encoding; `out` must hold 2 * length chars
+inline void toHex(const unsigned char *bytes, size_t length,
+                  char *out) noexcept {
+  static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+  for (size_t i = 0; i < length; ++i) {
+    out[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+    out[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0F];
+  }
+}
+
+[[nodiscard]] inline std::string toHex(const unsigned char *bytes,
+                                       size_t length) {
+  std::string hex(length * 2, '\0');
+  toHex(bytes, length, hex.data());
+  return hex;
+}
+
+[[nodiscard]] inline std::string toHex(const Digest512 &digest) {
+  return toHex(digest.data(), digest.size());
+}
+
+} // namespace Hashing
+
 // Enhanced KeyPair with metadata
 struct KeyPair {
   std::string publicKey;
@@ -163,40 +243,65 @@ public:
   CryptoManager(const CryptoManager &) = delete;
   CryptoManager &operator=(const CryptoManager &) = delete;
 
-  // SHA3-512 hash (using SHA512 as simulation)
+  // SHA3-512 hash (using SHA512 as simulation). Lock-free: hashing runs on
+  // the calling thread's digest context and touches no member state.
   [[nodiscard]] std::string sha3_512_v11(std::string_view data,
-                                         int shardId) noexcept {
-    std::lock_guard<std::recursive_mutex> lock(cryptoMutex_);
-
+                                         int shardId) const noexcept {
     if (!validateInput(data, "hash", shardId)) {
       return "";
     }
 
-    SecureMemory::SecureBuffer<SHA512_DIGEST_LENGTH> hash;
-    EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
-    if (!mdctx) {
+    Digest512 digest;
+    if (!Hashing::sha512(data, digest)) {
       return "";
     }
 
-    bool success = (EVP_DigestInit_ex(mdctx, EVP_sha512(), nullptr) == 1) &&
-                   (EVP_DigestUpdate(mdctx, data.data(), data.length()) == 1) &&
-                   (EVP_DigestFinal_ex(mdctx, hash.data(), nullptr) == 1);
+    char shardBuf[16];
+    int shardLen = std::snprintf(shardBuf, sizeof(shardBuf), "%d", shardId);
 
-    EVP_MD_CTX_free(mdctx);
+    std::string hashStr(SHA512_DIGEST_LENGTH * 2 + 5 + shardLen, '\0');
+    Hashing::toHex(digest.data(), digest.size(), hashStr.data());
+    std::memcpy(hashStr.data() + SHA512_DIGEST_LENGTH * 2, "_v11_", 5);
+    std::memcpy(hashStr.data() + SHA512_DIGEST_LENGTH * 2 + 5, shardBuf,
+                shardLen);
+    return hashStr;
+  }
 
-    if (!success) {
-      return "";
+  // Batched sha3_512_v11: same validation and output format, but inputs are
+  // hashed several at a time through the multi-buffer SHA-512 kernel
+  [[nodiscard]] std::vector<std::string>
+  sha3_512_v11_batch(const std::vector<std::string> &inputs,
+                     int shardId) const {
+    std::vector<std::string> results(inputs.size());
+    std::vector<std::string_view> views;
+    std::vector<size_t> slots;
+    views.reserve(inputs.size());
+    slots.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (validateInput(inputs[i], "hash", shardId)) {
+        views.push_back(inputs[i]);
+        slots.push_back(i);
+      }
     }
 
-    std::string hashStr;
-    hashStr.reserve(SHA512_DIGEST_LENGTH * 2 + 16);
-    for (size_t i = 0; i < SHA512_DIGEST_LENGTH; ++i) {
-      char buf[3];
-      std::snprintf(buf, sizeof(buf), "%02x", hash.data()[i]);
-      hashStr += buf;
+    std::vector<Digest512> digests(views.size());
+    Sha512::hashBatch(views.data(), views.size(), digests.data());
+
+    const std::string suffix = "_v11_" + std::to_string(shardId);
+    for (size_t j = 0; j < slots.size(); ++j) {
+      std::string &out = results[slots[j]];
+      out.resize(SHA512_DIGEST_LENGTH * 2 + suffix.size());
+      Hashing::toHex(digests[j].data(), digests[j].size(), out.data());
+      std::memcpy(out.data() + SHA512_DIGEST_LENGTH * 2, suffix.data(),
+                  suffix.size());
     }
+    return results;
+  }
 
-    return hashStr + "_v11_" + std::to_string(shardId);
+  // Raw 64-byte SHA3-512 digest without validation or hex encoding
+  [[nodiscard]] static bool sha3_512_raw(std::string_view data,
+                                         Digest512 &out) noexcept {
+    return Hashing::sha512(data, out);
   }
 
   // HMAC-based transaction signing
@@ -237,8 +342,7 @@ public:
   verifyTransaction(std::string_view txId, std::string_view signature,
                     std::string_view sender,
                     [[maybe_unused]] int shardId) const noexcept {
-    std::lock_guard<std::recursive_mutex> lock(cryptoMutex_);
-
+    // Stateless check - no lock, so chain validation can fan out
     if (txId.empty() || signature.empty() || sender.empty()) {
       return false;
     }
@@ -278,7 +382,6 @@ public:
   [[nodiscard]] bool
   zkStarkVerify_v11(std::string_view proof,
                     [[maybe_unused]] int shardId) const noexcept {
-    std::lock_guard<std::recursive_mutex> lock(cryptoMutex_);
     return !proof.empty() && proof.find("zk_proof_v11_") == 0;
   }
 
@@ -286,8 +389,6 @@ public:
   [[nodiscard]] bool
   validateMultiSignature(const std::vector<std::string> &signatures,
                          [[maybe_unused]] int shardId) const noexcept {
-    std::lock_guard<std::recursive_mutex> lock(cryptoMutex_);
-
     if (signatures.size() < CryptoConfig::REQUIRED_SIGNATURES) {
       return false;
     }
@@ -0,0 +1,792 @@
+#ifndef QUANTUMPULSE_HTTP_V7_H
+#define QUANTUMPULSE_HTTP_V7_H
+
+#include "quantumpulse_logging_v7.h"
+#include "quantumpulse_threadpool_v7.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace QuantumPulse::Http {
+
+// Server tunables
+struct ServerConfig {
+  std::string bindAddress{"0.0.0.0"};
+  uint16_t port{0}; // 0 = ephemeral, see Server::getPort()
+  size_t reactorThreads{1};
+  size_t workerThreads{std::max(1u, std::thread::hardware_concurrency())};
+  size_t maxConnections{16384};
+  size_t maxHeaderBytes{16 * 1024};
+  size_t maxBodyBytes{1024 * 1024};
+  int idleTimeoutSec{60};
+  int backlog{4096};
+};
+
+// Parsed HTTP/1.1 request
+struct Request {
+  std::string method;
+  std::string target; // Path plus query string
+  std::string version;
+  std::vector<std::pair<std::string, std::string>> headers; // Lower-case names
+  std::string body;
+  bool keepAlive{true};
+
+  [[nodiscard]] std::string_view header(std::string_view name) const noexcept {
+    for (const auto &[key, value] : headers) {
+      if (key == name) {
+        return value;
+      }
+    }
+    return {};
+  }
+
+  [[nodiscard]] std::string_view path() const noexcept {
+    std::string_view t = target;
+    return t.substr(0, t.find('?'));
+  }
+
+  [[nodiscard]] std::string_view query() const noexcept {
+    std::string_view t = target;
+    size_t q = t.find('?');
+    return q == std::string_view::npos ? std::string_view{} : t.substr(q + 1);
+  }
+};
+
+// Response produced by a handler
+struct Response {
+  int status{200};
+  std::string contentType{"application/json"};
+  std::string body;
+  std::vector<std::pair<std::string, std::string>> headers;
+  bool close{false}; // Force Connection: close
+};
+
+// Handlers may move from the request (e.g. a large body); it is discarded
+// once the handler returns
+using Handler = std::function<Response(Request &)>;
+
+[[nodiscard]] inline const char *statusText(int status) noexcept {
+  switch (status) {
+  case 200:
+    return "OK";
+  case 201:
+    return "Created";
+  case 204:
+    return "No Content";
+  case 400:
+    return "Bad Request";
+  case 401:
+    return "Unauthorized";
+  case 403:
+    return "Forbidden";
+  case 404:
+    return "Not Found";
+  case 405:
+    return "Method Not Allowed";
+  case 413:
+    return "Payload Too Large";
+  case 429:
+    return "Too Many Requests";
+  case 431:
+    return "Request Header Fields Too Large";
+  case 500:
+    return "Internal Server Error";
+  case 501:
+    return "Not Implemented";
+  case 503:
+    return "Service Unavailable";
+  default:
+    return "Unknown";
+  }
+}
+
+// Serialize status line, headers and body straight into `out`
+inline void appendResponse(std::string &out, const Response &res,
+                           bool keepAlive) {
+  char line[64];
+  int n = std::snprintf(line, sizeof(line), "HTTP/1.1 %d ", res.status);
+  out.append(line, static_cast<size_t>(n));
+  out.append(statusText(res.status));
+  out.append("\r\nContent-Type: ");
+  out.append(res.contentType);
+  n = std::snprintf(line, sizeof(line), "\r\nContent-Length: %zu\r\n",
+                    res.body.size());
+  out.append(line, static_cast<size_t>(n));
+  out.append(keepAlive ? "Connection: keep-alive\r\n"
+                       : "Connection: close\r\n");
+  for (const auto &[key, value] : res.headers) {
+    out.append(key).append(": ").append(value).append("\r\n");
+  }
+  out.append("\r\n");
+  out.append(res.body);
+}
+
+// Incremental request parser. Feed it the connection's input buffer from
+// the current read offset; it remembers how far it has scanned, so a
+// request arriving in many small reads is never rescanned from the start.
+class RequestParser {
+public:
+  enum class Status { NeedMore, Complete, Error };
+
+  RequestParser(size_t maxHeaderBytes, size_t maxBodyBytes) noexcept
+      : maxHeaderBytes_(maxHeaderBytes), maxBodyBytes_(maxBodyBytes) {}
+
+  // On Complete, `consumed` is the request's size in bytes. On Error,
+  // errorStatus holds the HTTP status to answer with before closing.
+  Status parse(std::string_view input, Request &out, size_t &consumed,
+               int &errorStatus) {
+    if (headerEnd_ == 0) {
+      size_t from = scanned_ > 3 ? scanned_ - 3 : 0;
+      size_t end = input.find("\r\n\r\n", from);
+      if (end == std::string_view::npos) {
+        scanned_ = input.size();
+        if (input.size() > maxHeaderBytes_) {
+          errorStatus = 431;
+          return Status::Error;
+        }
+        return Status::NeedMore;
+      }
+      headerEnd_ = end + 4;
+      if (headerEnd_ > maxHeaderBytes_) {
+        errorStatus = 431;
+        return Status::Error;
+      }
+      if (!parseHead(input.substr(0, end), current_, errorStatus)) {
+        return Status::Error;
+      }
+    }
+
+    if (input.size() - headerEnd_ < contentLength_) {
+      return Status::NeedMore;
+    }
+    current_.body.assign(input.data() + headerEnd_, contentLength_);
+    out = std::move(current_);
+    consumed = headerEnd_ + contentLength_;
+    reset();
+    return Status::Complete;
+  }
+
+  // Total size of the request being parsed once its header is complete,
+  // so the caller can reserve room for the body; 0 before that
+  [[nodiscard]] size_t expectedBytes() const noexcept {
+    return headerEnd_ == 0 ? 0 : headerEnd_ + contentLength_;
+  }
+
+  void reset() noexcept {
+    scanned_ = 0;
+    headerEnd_ = 0;
+    contentLength_ = 0;
+    current_ = Request{};
+  }
+
+private:
+  size_t maxHeaderBytes_;
+  size_t maxBodyBytes_;
+  size_t scanned_{0};
+  size_t headerEnd_{0};
+  size_t contentLength_{0};
+  Request current_; // Head of a request whose body is still arriving
+
+  static std::string lower(std::string_view s) {
+    std::string r(s);
+    for (char &c : r) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return r;
+  }
+
+  static std::string_view trim(std::string_view s) noexcept {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+      s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+      s.remove_suffix(1);
+    }
+    return s;
+  }
+
+  bool parseHead(std::string_view head, Request &out, int &errorStatus) {
+    errorStatus = 400;
+    size_t lineEnd = head.find("\r\n");
+    std::string_view requestLine = head.substr(0, lineEnd);
+    size_t sp1 = requestLine.find(' ');
+    size_t sp2 = requestLine.rfind(' ');
+    if (sp1 == std::string_view::npos || sp2 == sp1) {
+      return false;
+    }
+    out.method.assign(requestLine.substr(0, sp1));
+    out.target.assign(requestLine.substr(sp1 + 1, sp2 - sp1 - 1));
+    out.version.assign(requestLine.substr(sp2 + 1));
+    if (out.version != "HTTP/1.1" && out.version != "HTTP/1.0") {
+      return false;
+    }
+    out.keepAlive = out.version == "HTTP/1.1";
+    out.headers.clear();
+
+    bool haveLength = false;
+    size_t pos = lineEnd == std::string_view::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size()) {
+      size_t next = head.find("\r\n", pos);
+      std::string_view line =
+          head.substr(pos, next == std::string_view::npos ? next : next - pos);
+      pos = next == std::string_view::npos ? head.size() : next + 2;
+      size_t colon = line.find(':');
+      if (colon == std::string_view::npos || colon == 0) {
+        return false;
+      }
+      std::string name = lower(line.substr(0, colon));
+      std::string_view value = trim(line.substr(colon + 1));
+
+      if (name == "content-length") {
+        size_t length = 0;
+        for (char c : value) {
+          if (c < '0' || c > '9') {
+            return false;
+          }
+          length = length * 10 + static_cast<size_t>(c - '0');
+          if (length > maxBodyBytes_) {
+            errorStatus = 413; // Also stops overflow on long digit runs
+            return false;
+          }
+        }
+        if (value.empty() || (haveLength && length != contentLength_)) {
+          return false;
+        }
+        contentLength_ = length;
+        haveLength = true;
+      } else if (name == "transfer-encoding") {
+        errorStatus = 501; // Chunked bodies are not accepted
+        return false;
+      } else if (name == "connection") {
+        std::string v = lower(value);
+        if (v == "close") {
+          out.keepAlive = false;
+        } else if (v == "keep-alive") {
+          out.keepAlive = true;
+        }
+      }
+      out.headers.emplace_back(std::move(name), std::string(value));
+    }
+    return true;
+  }
+};
+
+// Edge-triggered epoll HTTP/1.1 server. Reactor threads own the sockets:
+// they accept, read and parse, and write responses. Handlers run on a
+// fixed worker pool. Each connection has at most one request with a
+// handler at a time; pipelined requests wait in its input buffer, so
+// responses always go out in request order.
+class Server final {
+public:
+  Server(ServerConfig config, Handler handler)
+      : config_(std::move(config)), handler_(std::move(handler)) {}
+
+  ~Server() { stop(); }
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  // Bind, listen and start reactor and worker threads
+  bool start() {
+    if (running_.exchange(true)) {
+      return false;
+    }
+    listenFd_ = openListener();
+    if (listenFd_ < 0) {
+      running_ = false;
+      return false;
+    }
+    workers_ = std::make_unique<Concurrency::ThreadPool>(config_.workerThreads);
+
+    size_t count = std::max<size_t>(1, config_.reactorThreads);
+    for (size_t i = 0; i < count; ++i) {
+      reactors_.push_back(std::make_unique<Reactor>(*this));
+      if (!reactors_.back()->open()) {
+        stop();
+        return false;
+      }
+    }
+    if (!reactors_[0]->watchListener(listenFd_)) {
+      stop();
+      return false;
+    }
+    for (auto &r : reactors_) {
+      r->thread = std::thread([reactor = r.get()] { reactor->run(); });
+    }
+    Logging::Logger::getInstance().info(
+        "HTTP server listening on " + config_.bindAddress + ":" +
+            std::to_string(port_) + " (" + std::to_string(count) +
+            " reactors, " + std::to_string(workers_->getThreadCount()) +
+            " workers)",
+        "HTTP", 0);
+    return true;
+  }
+
+  // Stop accepting, close every connection and join all threads
+  void stop() {
+    if (!running_.exchange(false) && reactors_.empty()) {
+      return;
+    }
+    for (auto &r : reactors_) {
+      r->wake();
+    }
+    for (auto &r : reactors_) {
+      if (r->thread.joinable()) {
+        r->thread.join();
+      }
+    }
+    workers_.reset(); // Drains in-flight handlers first
+    reactors_.clear();
+    if (listenFd_ >= 0) {
+      ::close(listenFd_);
+      listenFd_ = -1;
+    }
+  }
+
+  [[nodiscard]] uint16_t getPort() const noexcept { return port_; }
+  [[nodiscard]] size_t getActiveConnections() const noexcept {
+    return active_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t getRequestCount() const noexcept {
+    return requests_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Connection {
+    int fd;
+    std::string in;
+    size_t inPos{0};
+    std::string out;
+    size_t outPos{0};
+    RequestParser parser;
+    bool busy{false};          // Handler running on a worker
+    bool closeAfterWrite{false};
+    bool eof{false}; // Peer finished sending
+    bool closed{false};
+    std::chrono::steady_clock::time_point lastActive;
+
+    Connection(int fd_, const ServerConfig &cfg)
+        : fd(fd_), parser(cfg.maxHeaderBytes, cfg.maxBodyBytes),
+          lastActive(std::chrono::steady_clock::now()) {}
+  };
+  using ConnectionPtr = std::shared_ptr<Connection>;
+
+  struct Completion {
+    ConnectionPtr conn;
+    std::string bytes;
+    bool keepAlive;
+  };
+
+  static constexpr size_t READ_CHUNK = 16 * 1024;
+  static constexpr int MAX_EVENTS = 256;
+
+  class Reactor {
+  public:
+    std::thread thread;
+
+    explicit Reactor(Server &server) : server_(server) {}
+
+    ~Reactor() {
+      for (auto &[fd, conn] : connections_) {
+        ::close(fd);
+        conn->closed = true;
+        server_.active_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      for (int fd : pendingFds_) {
+        ::close(fd);
+        server_.active_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      if (wakeFd_ >= 0) {
+        ::close(wakeFd_);
+      }
+      if (epollFd_ >= 0) {
+        ::close(epollFd_);
+      }
+    }
+
+    bool open() {
+      epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+      wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (epollFd_ < 0 || wakeFd_ < 0) {
+        return false;
+      }
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLET;
+      ev.data.ptr = &wakeFd_;
+      return ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev) == 0;
+    }
+
+    bool watchListener(int fd) {
+      listenFd_ = fd;
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLET;
+      ev.data.ptr = &listenFd_;
+      return ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    void wake() noexcept {
+      uint64_t one = 1;
+      [[maybe_unused]] ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    }
+
+    // Hand an accepted socket to this reactor (any thread)
+    void adopt(int fd) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingFds_.push_back(fd);
+      }
+      wake();
+    }
+
+    // Queue a finished response (worker threads)
+    void complete(Completion completion) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completions_.push_back(std::move(completion));
+      }
+      wake();
+    }
+
+    void run() {
+      epoll_event events[MAX_EVENTS];
+      auto lastSweep = std::chrono::steady_clock::now();
+      while (server_.running_.load(std::memory_order_relaxed)) {
+        int n = ::epoll_wait(epollFd_, events, MAX_EVENTS, 1000);
+        for (int i = 0; i < n; ++i) {
+          void *tag = events[i].data.ptr;
+          if (tag == &wakeFd_) {
+            drainWakeups();
+          } else if (tag == &listenFd_) {
+            acceptAll();
+          } else {
+            handleEvent(static_cast<Connection *>(tag), events[i].events);
+          }
+        }
+        graveyard_.clear(); // Closed this round; no stale events remain
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+          sweepIdle(now);
+          lastSweep = now;
+        }
+      }
+    }
+
+  private:
+    Server &server_;
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    int listenFd_{-1};
+    size_t nextReactor_{0};
+    std::unordered_map<int, ConnectionPtr> connections_;
+    std::vector<ConnectionPtr> graveyard_;
+    std::mutex mutex_;
+    std::vector<int> pendingFds_;
+    std::vector<Completion> completions_;
+
+    void acceptAll() {
+      while (true) {
+        int fd = ::accept4(listenFd_, nullptr, nullptr,
+                           SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return; // EAGAIN, or out of descriptors until the next edge
+        }
+        if (server_.active_.load(std::memory_order_relaxed) >=
+            server_.config_.maxConnections) {
+          ::close(fd);
+          continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        server_.active_.fetch_add(1, std::memory_order_relaxed);
+        auto &reactors = server_.reactors_;
+        Reactor *target = reactors[nextReactor_++ % reactors.size()].get();
+        if (target == this) {
+          addConnection(fd);
+        } else {
+          target->adopt(fd);
+        }
+      }
+    }
+
+    void addConnection(int fd) {
+      auto conn = std::make_shared<Connection>(fd, server_.config_);
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+      ev.data.ptr = conn.get();
+      if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        ::close(fd);
+        server_.active_.fetch_sub(1, std::memory_order_relaxed);
+        return;
+      }
+      connections_.emplace(fd, std::move(conn));
+    }
+
+    void drainWakeups() {
+      uint64_t value;
+      while (::read(wakeFd_, &value, sizeof(value)) > 0) {
+      }
+      std::vector<int> fds;
+      std::vector<Completion> done;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fds.swap(pendingFds_);
+        done.swap(completions_);
+      }
+      for (int fd : fds) {
+        addConnection(fd);
+      }
+      for (auto &c : done) {
+        Connection &conn = *c.conn;
+        conn.busy = false;
+        if (conn.closed) {
+          continue;
+        }
+        conn.out.append(c.bytes);
+        if (!c.keepAlive) {
+          conn.closeAfterWrite = true;
+        }
+        if (flush(conn) && !conn.closeAfterWrite) {
+          dispatch(conn);
+        }
+      }
+    }
+
+    void handleEvent(Connection *conn, uint32_t events) {
+      if (events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(*conn);
+        return;
+      }
+      if (conn->closed || ((events & EPOLLOUT) && !flush(*conn))) {
+        return;
+      }
+      if (events & (EPOLLIN | EPOLLRDHUP)) {
+        if (readAll(*conn)) {
+          dispatch(*conn);
+        }
+      }
+    }
+
+    // Read until EAGAIN; false if the connection was closed
+    bool readAll(Connection &conn) {
+      const size_t limit =
+          server_.config_.maxHeaderBytes + server_.config_.maxBodyBytes;
+      while (true) {
+        size_t used = conn.in.size();
+        conn.in.resize(used + READ_CHUNK);
+        ssize_t n = ::recv(conn.fd, conn.in.data() + used, READ_CHUNK, 0);
+        conn.in.resize(used + static_cast<size_t>(std::max<ssize_t>(0, n)));
+        if (n > 0) {
+          conn.lastActive = std::chrono::steady_clock::now();
+          if (conn.in.size() - conn.inPos > 2 * limit) {
+            closeConnection(conn); // Client is not reading responses
+            return false;
+          }
+          continue;
+        }
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          return true;
+        }
+        if (n == 0) {
+          conn.eof = true; // Answer what was already sent, then close
+          return true;
+        }
+        closeConnection(conn);
+        return false;
+      }
+    }
+
+    // Parse the next buffered request and hand it to a worker
+    void dispatch(Connection &conn) {
+      if (conn.busy || conn.closed || conn.closeAfterWrite) {
+        return;
+      }
+      Request request;
+      size_t consumed = 0;
+      int errorStatus = 400;
+      std::string_view pending(conn.in.data() + conn.inPos,
+                               conn.in.size() - conn.inPos);
+      auto status =
+          conn.parser.parse(pending, request, consumed, errorStatus);
+
+      if (status == RequestParser::Status::NeedMore) {
+        if (conn.eof) {
+          conn.closeAfterWrite = true;
+          flush(conn);
+          return;
+        }
+        compactInput(conn);
+        // Large body: grow the buffer once instead of on every read
+        conn.in.reserve(conn.inPos + conn.parser.expectedBytes());
+        return;
+      }
+      if (status == RequestParser::Status::Error) {
+        Response res;
+        res.status = errorStatus;
+        res.body = R"({"error": ")" + std::string(statusText(errorStatus)) +
+                   R"("})";
+        appendResponse(conn.out, res, false);
+        conn.closeAfterWrite = true;
+        flush(conn);
+        return;
+      }
+
+      conn.inPos += consumed;
+      compactInput(conn);
+      conn.busy = true;
+      server_.requests_.fetch_add(1, std::memory_order_relaxed);
+
+      auto self = connections_.at(conn.fd);
+      server_.workers_->post(
+          [this, self, request = std::move(request)]() mutable {
+            Response res;
+            try {
+              res = server_.handler_(request);
+            } catch (...) {
+              res = Response{};
+              res.status = 500;
+              res.body = R"({"error": "Internal Server Error"})";
+            }
+            bool keepAlive = request.keepAlive && !res.close;
+            Completion c{std::move(self), {}, keepAlive};
+            c.bytes.reserve(128 + res.body.size());
+            appendResponse(c.bytes, res, keepAlive);
+            complete(std::move(c));
+          });
+    }
+
+    static void compactInput(Connection &conn) {
+      if (conn.inPos == conn.in.size()) {
+        conn.in.clear();
+        conn.inPos = 0;
+      } else if (conn.inPos > READ_CHUNK && conn.inPos * 2 > conn.in.size()) {
+        conn.in.erase(0, conn.inPos);
+        conn.inPos = 0;
+      }
+    }
+
+    // Write buffered output; false if the connection was closed
+    bool flush(Connection &conn) {
+      while (conn.outPos < conn.out.size()) {
+        ssize_t n = ::send(conn.fd, conn.out.data() + conn.outPos,
+                           conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+        if (n > 0) {
+          conn.outPos += static_cast<size_t>(n);
+          continue;
+        }
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          return true; // Resume on EPOLLOUT
+        }
+        closeConnection(conn);
+        return false;
+      }
+      conn.out.clear();
+      conn.outPos = 0;
+      conn.lastActive = std::chrono::steady_clock::now();
+      if (conn.closeAfterWrite) {
+        closeConnection(conn);
+        return false;
+      }
+      return true;
+    }
+
+    void closeConnection(Connection &conn) {
+      if (conn.closed) {
+        return;
+      }
+      conn.closed = true;
+      ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+      ::close(conn.fd);
+      server_.active_.fetch_sub(1, std::memory_order_relaxed);
+      // Keep the object alive until the current event batch is done
+      auto it = connections_.find(conn.fd);
+      graveyard_.push_back(std::move(it->second));
+      connections_.erase(it);
+    }
+
+    void sweepIdle(std::chrono::steady_clock::time_point now) {
+      auto timeout = std::chrono::seconds(server_.config_.idleTimeoutSec);
+      std::vector<Connection *> idle;
+      for (auto &[fd, conn] : connections_) {
+        if (!conn->busy && now - conn->lastActive > timeout) {
+          idle.push_back(conn.get());
+        }
+      }
+      for (Connection *conn : idle) {
+        closeConnection(*conn);
+      }
+    }
+  };
+
+  ServerConfig config_;
+  Handler handler_;
+  std::atomic<bool> running_{false};
+  int listenFd_{-1};
+  uint16_t port_{0};
+  std::unique_ptr<Concurrency::ThreadPool> workers_;
+  std::vector<std::unique_ptr<Reactor>> reactors_;
+  std::atomic<size_t> active_{0};
+  std::atomic<uint64_t> requests_{0};
+
+  int openListener() {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      Logging::Logger::getInstance().error("Failed to create HTTP socket",
+                                           "HTTP", 0);
+      return -1;
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    if (::inet_pton(AF_INET, config_.bindAddress.c_str(), &addr.sin_addr) !=
+            1 ||
+        ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd, config_.backlog) < 0) {
+      Logging::Logger::getInstance().error(
+          "Failed to bind HTTP port " + std::to_string(config_.port), "HTTP",
+          0);
+      ::close(fd);
+      return -1;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    return fd;
+  }
+};
+
+} // namespace QuantumPulse::Http
+
+#endif // QUANTUMPULSE_HTTP_V7_H
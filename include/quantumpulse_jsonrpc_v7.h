@@ -0,0 +1,833 @@
+#ifndef QUANTUMPULSE_JSONRPC_V7_H
+#define QUANTUMPULSE_JSONRPC_V7_H
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace QuantumPulse::JsonRpc {
+
+// Standard JSON-RPC 2.0 error codes
+enum ErrorCode : int {
+  PARSE_ERROR = -32700,
+  INVALID_REQUEST = -32600,
+  METHOD_NOT_FOUND = -32601,
+  INVALID_PARAMS = -32602,
+  INTERNAL_ERROR = -32603,
+};
+
+namespace detail {
+
+// Cursor over a JSON text. Values are never materialised: strings come back
+// as views of their raw (still escaped) contents and compound values as
+// views of their full text, so parsing a request allocates nothing.
+class Reader {
+public:
+  static constexpr int MAX_DEPTH = 64;
+
+  explicit Reader(std::string_view text) noexcept : text_(text) {}
+
+  void skipWs() noexcept {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  [[nodiscard]] bool atEnd() noexcept {
+    skipWs();
+    return pos_ >= text_.size();
+  }
+
+  [[nodiscard]] char peek() noexcept {
+    skipWs();
+    return pos_ < text_.size() ? text_[pos_] : '\0';
+  }
+
+  bool consume(char c) noexcept {
+    if (peek() != c) {
+      return false;
+    }
+    ++pos_;
+    return true;
+  }
+
+  // String contents between the quotes; `escaped` reports backslashes
+  bool string(std::string_view &raw, bool &escaped) noexcept {
+    if (!consume('"')) {
+      return false;
+    }
+    size_t start = pos_;
+    escaped = false;
+    while (pos_ < text_.size()) {
+      char c = text_[pos_];
+      if (c == '"') {
+        raw = text_.substr(start, pos_ - start);
+        ++pos_;
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c == '\\') {
+        escaped = true;
+        ++pos_;
+      }
+      ++pos_;
+    }
+    return false;
+  }
+
+  // Full text of the next value, validated
+  bool value(std::string_view &slice, int depth = 0) noexcept {
+    char c = peek();
+    size_t start = pos_;
+    bool ok;
+    switch (c) {
+    case '"': {
+      std::string_view raw;
+      bool escaped;
+      ok = string(raw, escaped);
+      break;
+    }
+    case '{':
+    case '[':
+      ok = depth < MAX_DEPTH && compound(c, depth);
+      break;
+    case 't':
+      ok = literal("true");
+      break;
+    case 'f':
+      ok = literal("false");
+      break;
+    case 'n':
+      ok = literal("null");
+      break;
+    default:
+      ok = number();
+    }
+    if (ok) {
+      slice = text_.substr(start, pos_ - start);
+    }
+    return ok;
+  }
+
+  [[nodiscard]] size_t position() const noexcept { return pos_; }
+
+private:
+  std::string_view text_;
+  size_t pos_{0};
+
+  bool literal(std::string_view word) noexcept {
+    if (text_.substr(pos_, word.size()) != word) {
+      return false;
+    }
+    pos_ += word.size();
+    return true;
+  }
+
+  bool number() noexcept {
+    size_t start = pos_;
+    if (pos_ < text_.size() && text_[pos_] == '-') {
+      ++pos_;
+    }
+    size_t digits = pos_;
+    while (pos_ < text_.size() &&
+           ((text_[pos_] >= '0' && text_[pos_] <= '9') || text_[pos_] == '.' ||
+            text_[pos_] == 'e' || text_[pos_] == 'E' || text_[pos_] == '+' ||
+            text_[pos_] == '-')) {
+      ++pos_;
+    }
+    if (pos_ == digits) {
+      pos_ = start;
+      return false;
+    }
+    double ignored;
+    auto res = std::from_chars(text_.data() + start, text_.data() + pos_,
+                               ignored);
+    return res.ec != std::errc::invalid_argument &&
+           res.ptr == text_.data() + pos_;
+  }
+
+  bool compound(char open, int depth) noexcept {
+    const char close = open == '{' ? '}' : ']';
+    ++pos_;
+    if (consume(close)) {
+      return true;
+    }
+    while (true) {
+      std::string_view ignored;
+      if (open == '{') {
+        bool escaped;
+        if (!string(ignored, escaped) || !consume(':')) {
+          return false;
+        }
+      }
+      if (!value(ignored, depth + 1)) {
+        return false;
+      }
+      if (consume(close)) {
+        return true;
+      }
+      if (!consume(',')) {
+        return false;
+      }
+    }
+  }
+};
+
+inline void appendUtf8(std::string &out, uint32_t cp) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+inline bool hex4(std::string_view s, size_t at, uint32_t &out) noexcept {
+  if (at + 4 > s.size()) {
+    return false;
+  }
+  auto res = std::from_chars(s.data() + at, s.data() + at + 4, out, 16);
+  return res.ec == std::errc() && res.ptr == s.data() + at + 4;
+}
+
+// Decode the raw contents of a JSON string
+inline bool unescape(std::string_view raw, std::string &out) {
+  out.clear();
+  out.reserve(raw.size());
+  for (size_t i = 0; i < raw.size(); ++i) {
+    char c = raw[i];
+    if (c != '\\') {
+      out.push_back(c);
+      continue;
+    }
+    if (++i >= raw.size()) {
+      return false;
+    }
+    switch (raw[i]) {
+    case '"':
+    case '\\':
+    case '/':
+      out.push_back(raw[i]);
+      break;
+    case 'b':
+      out.push_back('\b');
+      break;
+    case 'f':
+      out.push_back('\f');
+      break;
+    case 'n':
+      out.push_back('\n');
+      break;
+    case 'r':
+      out.push_back('\r');
+      break;
+    case 't':
+      out.push_back('\t');
+      break;
+    case 'u': {
+      uint32_t cp;
+      if (!hex4(raw, i + 1, cp)) {
+        return false;
+      }
+      i += 4;
+      if (cp >= 0xD800 && cp < 0xDC00) {
+        uint32_t low;
+        if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' ||
+            !hex4(raw, i + 3, low) || low < 0xDC00 || low > 0xDFFF) {
+          return false;
+        }
+        i += 6;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      }
+      appendUtf8(out, cp);
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+// Streaming JSON writer appending to a caller-owned buffer. Commas are
+// inserted automatically; numbers go through std::to_chars on a stack
+// buffer, so no temporary strings are created.
+class Writer {
+public:
+  static constexpr int MAX_DEPTH = 32;
+
+  explicit Writer(std::string &out) noexcept : out_(out) {}
+
+  Writer &beginObject() { return open('{'); }
+  Writer &endObject() { return close('}'); }
+  Writer &beginArray() { return open('['); }
+  Writer &endArray() { return close(']'); }
+
+  Writer &key(std::string_view name) {
+    separate();
+    quoted(name);
+    out_.push_back(':');
+    afterKey_ = true;
+    return *this;
+  }
+
+  Writer &string(std::string_view s) {
+    separate();
+    quoted(s);
+    return *this;
+  }
+
+  Writer &number(int64_t v) { return integer(v); }
+  Writer &number(uint64_t v) { return integer(v); }
+  Writer &number(int v) { return integer(static_cast<int64_t>(v)); }
+  Writer &number(unsigned v) { return integer(static_cast<uint64_t>(v)); }
+
+  Writer &number(double v) {
+    separate();
+    if (!std::isfinite(v)) {
+      out_.append("null");
+      return *this;
+    }
+    // Shortest round-trip form; plain decimals for amounts and prices
+    char buf[64];
+    double mag = std::fabs(v);
+    auto res = (mag == 0 || (mag >= 1e-6 && mag < 1e15))
+                   ? std::to_chars(buf, buf + sizeof(buf), v,
+                                   std::chars_format::fixed)
+                   : std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, res.ptr);
+    return *this;
+  }
+
+  Writer &boolean(bool v) {
+    separate();
+    out_.append(v ? "true" : "false");
+    return *this;
+  }
+
+  Writer &null() {
+    separate();
+    out_.append("null");
+    return *this;
+  }
+
+  // Pre-encoded JSON value
+  Writer &raw(std::string_view json) {
+    separate();
+    out_.append(json);
+    return *this;
+  }
+
+  [[nodiscard]] std::string &buffer() noexcept { return out_; }
+
+private:
+  std::string &out_;
+  bool needComma_[MAX_DEPTH + 1] = {};
+  int depth_{0};
+  bool afterKey_{false};
+
+  void separate() {
+    if (afterKey_) {
+      afterKey_ = false;
+      return;
+    }
+    if (needComma_[depth_]) {
+      out_.push_back(',');
+    }
+    needComma_[depth_] = true;
+  }
+
+  Writer &open(char c) {
+    separate();
+    out_.push_back(c);
+    if (depth_ < MAX_DEPTH) {
+      needComma_[++depth_] = false;
+    }
+    return *this;
+  }
+
+  Writer &close(char c) {
+    out_.push_back(c);
+    if (depth_ > 0) {
+      --depth_;
+    }
+    return *this;
+  }
+
+  template <typename T> Writer &integer(T v) {
+    separate();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, res.ptr);
+    return *this;
+  }
+
+  void quoted(std::string_view s) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    out_.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+      auto c = static_cast<unsigned char>(s[i]);
+      if (c >= 0x20 && c != '"' && c != '\\') {
+        continue;
+      }
+      out_.append(s.data() + run, i - run);
+      run = i + 1;
+      out_.push_back('\\');
+      switch (c) {
+      case '"':
+      case '\\':
+        out_.push_back(static_cast<char>(c));
+        break;
+      case '\n':
+        out_.push_back('n');
+        break;
+      case '\r':
+        out_.push_back('r');
+        break;
+      case '\t':
+        out_.push_back('t');
+        break;
+      default:
+        out_.append("u00");
+        out_.push_back(HEX[c >> 4]);
+        out_.push_back(HEX[c & 0xF]);
+      }
+    }
+    out_.append(s.data() + run, s.size() - run);
+    out_.push_back('"');
+  }
+};
+
+// Request parameters: a view of the "params" array or object
+class Params {
+public:
+  Params() = default;
+  explicit Params(std::string_view raw) noexcept : raw_(raw) {}
+
+  [[nodiscard]] bool isArray() const noexcept {
+    return !raw_.empty() && raw_[0] == '[';
+  }
+  [[nodiscard]] bool isObject() const noexcept {
+    return !raw_.empty() && raw_[0] == '{';
+  }
+  [[nodiscard]] std::string_view raw() const noexcept { return raw_; }
+
+  // Number of positional parameters
+  [[nodiscard]] size_t size() const noexcept {
+    size_t n = 0;
+    forEach([&](std::string_view, std::string_view) {
+      ++n;
+      return true;
+    });
+    return n;
+  }
+
+  // Raw JSON of positional parameter `index`, or of named member `name`
+  [[nodiscard]] std::optional<std::string_view> at(size_t index) const {
+    std::optional<std::string_view> found;
+    size_t i = 0;
+    forEach([&](std::string_view, std::string_view v) {
+      if (i++ == index) {
+        found = v;
+        return false;
+      }
+      return true;
+    });
+    return found;
+  }
+
+  [[nodiscard]] std::optional<std::string_view>
+  get(std::string_view name) const {
+    std::optional<std::string_view> found;
+    forEach([&](std::string_view k, std::string_view v) {
+      if (k == name) {
+        found = v;
+        return false;
+      }
+      return true;
+    });
+    return found;
+  }
+
+  // Typed accessors for positional parameters; strings with escapes are
+  // decoded into `scratch`
+  [[nodiscard]] std::optional<std::string_view>
+  getString(size_t index, std::string &scratch) const {
+    auto v = at(index);
+    return v ? asString(*v, scratch) : std::nullopt;
+  }
+
+  [[nodiscard]] std::optional<double> getNumber(size_t index) const {
+    auto v = at(index);
+    return v ? asNumber(*v) : std::nullopt;
+  }
+
+  [[nodiscard]] std::optional<int64_t> getInteger(size_t index) const {
+    auto v = at(index);
+    if (!v) {
+      return std::nullopt;
+    }
+    int64_t out;
+    auto res = std::from_chars(v->data(), v->data() + v->size(), out);
+    if (res.ec != std::errc() || res.ptr != v->data() + v->size()) {
+      return std::nullopt;
+    }
+    return out;
+  }
+
+  static std::optional<std::string_view> asString(std::string_view json,
+                                                  std::string &scratch) {
+    detail::Reader r(json);
+    std::string_view raw;
+    bool escaped;
+    if (!r.string(raw, escaped)) {
+      return std::nullopt;
+    }
+    if (!escaped) {
+      return raw;
+    }
+    if (!detail::unescape(raw, scratch)) {
+      return std::nullopt;
+    }
+    return std::string_view(scratch);
+  }
+
+  static std::optional<double> asNumber(std::string_view json) noexcept {
+    double out;
+    auto res = std::from_chars(json.data(), json.data() + json.size(), out);
+    if (res.ec != std::errc() || res.ptr != json.data() + json.size()) {
+      return std::nullopt;
+    }
+    return out;
+  }
+
+private:
+  std::string_view raw_;
+
+  // Visit (key, value) pairs; keys are empty for arrays. Stops when `fn`
+  // returns false. `raw_` was validated when the request was parsed.
+  template <typename Fn> void forEach(Fn &&fn) const {
+    if (raw_.empty()) {
+      return;
+    }
+    const bool object = isObject();
+    detail::Reader r(raw_);
+    r.consume(object ? '{' : '[');
+    if (r.consume(object ? '}' : ']')) {
+      return;
+    }
+    while (true) {
+      std::string_view key, value;
+      bool escaped;
+      if (object && (!r.string(key, escaped) || !r.consume(':'))) {
+        return;
+      }
+      if (!r.value(value) || !fn(key, value) || !r.consume(',')) {
+        return;
+      }
+    }
+  }
+};
+
+// Result or error for one call. Handlers either write a result value
+// through result() or call error(); writing nothing yields null.
+class Reply {
+public:
+  Reply(std::string &out, size_t rollback) noexcept
+      : out_(out), rollback_(rollback), writer_(out) {}
+
+  Writer &result() noexcept { return writer_; }
+
+  void error(int code, std::string_view message) {
+    failed_ = true;
+    code_ = code;
+    message_.assign(message);
+  }
+
+  [[nodiscard]] bool failed() const noexcept { return failed_; }
+
+private:
+  friend class Dispatcher;
+  std::string &out_;
+  size_t rollback_;
+  Writer writer_;
+  bool failed_{false};
+  int code_{0};
+  std::string message_;
+};
+
+using MethodHandler = std::function<void(const Params &, Reply &)>;
+
+// JSON-RPC dispatcher. Accepts a single call or a batch array; each call
+// is parsed in one pass over the request body into views, then executed,
+// and every response is written straight into the output buffer. Requests
+// tagged "jsonrpc": "2.0" get 2.0 envelopes (and notifications get no
+// reply); anything else gets the Bitcoin Core style
+// {"result": ..., "error": ..., "id": ...} envelope.
+//
+// Methods are registered before serving starts; lookups take no lock.
+class Dispatcher {
+public:
+  static constexpr size_t MAX_BATCH = 1000;
+
+  void add(std::string name, MethodHandler handler) {
+    methods_[std::move(name)] = std::move(handler);
+  }
+
+  [[nodiscard]] bool has(std::string_view name) const {
+    return methods_.find(name) != methods_.end();
+  }
+
+  // Handle one request body, appending the response body to `out` (left
+  // empty when every call was a notification)
+  void handle(std::string_view body, std::string &out) const {
+    detail::Reader r(body);
+    std::vector<Call> calls;
+    bool batch = r.peek() == '[';
+
+    if (!parse(r, batch, calls)) {
+      Call bad;
+      bad.error = PARSE_ERROR;
+      writeError(out, bad, PARSE_ERROR, "Parse error");
+      return;
+    }
+    if (batch && (calls.empty() || calls.size() > MAX_BATCH)) {
+      Call bad;
+      bad.error = INVALID_REQUEST;
+      writeError(out, bad, INVALID_REQUEST,
+                 calls.empty() ? "Empty batch" : "Batch too large");
+      return;
+    }
+
+    if (batch) {
+      out.push_back('[');
+    }
+    const size_t open = out.size();
+    for (const auto &call : calls) {
+      size_t before = out.size();
+      if (before > open) {
+        out.push_back(',');
+      }
+      size_t mark = out.size();
+      execute(call, out);
+      if (out.size() == mark) {
+        out.resize(before); // Notification - drop the separator
+      }
+    }
+    if (batch) {
+      if (out.size() == open) {
+        out.pop_back(); // Only notifications: no response at all
+      } else {
+        out.push_back(']');
+      }
+    }
+  }
+
+  std::string handle(std::string_view body) const {
+    std::string out;
+    handle(body, out);
+    return out;
+  }
+
+private:
+  struct TransparentHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  struct Call {
+    std::string_view rawMethod;  // Into the request body
+    std::string methodStorage;   // Unescaped name, when it had escapes
+    bool methodEscaped{false};
+    std::string_view params;
+    std::string_view id{"null"};
+    bool hasId{false};
+    bool v2{false};
+    int error{0}; // Non-zero: invalid request
+
+    // Not stored as a view: `calls` may reallocate while a batch is
+    // parsed, and a short methodStorage moves with its Call
+    [[nodiscard]] std::string_view method() const noexcept {
+      return methodEscaped ? std::string_view(methodStorage) : rawMethod;
+    }
+  };
+
+  std::unordered_map<std::string, MethodHandler, TransparentHash,
+                     std::equal_to<>>
+      methods_;
+
+  static bool parse(detail::Reader &r, bool batch, std::vector<Call> &calls) {
+    if (!batch) {
+      calls.emplace_back();
+      if (!parseCall(r, calls.back())) {
+        return false;
+      }
+      return r.atEnd();
+    }
+    r.consume('[');
+    if (r.consume(']')) {
+      return r.atEnd();
+    }
+    while (true) {
+      calls.emplace_back();
+      if (!parseCall(r, calls.back())) {
+        return false;
+      }
+      if (r.consume(']')) {
+        return r.atEnd();
+      }
+      if (!r.consume(',')) {
+        return false;
+      }
+    }
+  }
+
+  // Parse one batch element. Returns false only on malformed JSON; a
+  // well-formed value that is not a valid call is flagged in `call.error`.
+  static bool parseCall(detail::Reader &r, Call &call) {
+    if (r.peek() != '{') {
+      std::string_view ignored;
+      call.error = INVALID_REQUEST;
+      return r.value(ignored);
+    }
+    r.consume('{');
+    bool haveMethod = false;
+    if (!r.consume('}')) {
+      while (true) {
+        std::string_view key, value;
+        bool escaped;
+        if (!r.string(key, escaped) || !r.consume(':') || !r.value(value)) {
+          return false;
+        }
+        if (key == "jsonrpc") {
+          call.v2 = value == "\"2.0\"";
+        } else if (key == "method") {
+          std::string_view raw;
+          detail::Reader mr(value);
+          if (!mr.string(raw, escaped)) {
+            call.error = INVALID_REQUEST;
+          } else if (escaped) {
+            if (!detail::unescape(raw, call.methodStorage)) {
+              return false;
+            }
+            call.methodEscaped = true;
+          } else {
+            call.rawMethod = raw;
+          }
+          haveMethod = true;
+        } else if (key == "params") {
+          if (value[0] != '[' && value[0] != '{') {
+            call.error = INVALID_REQUEST;
+          }
+          call.params = value;
+        } else if (key == "id") {
+          if (value[0] == '{' || value[0] == '[') {
+            call.error = INVALID_REQUEST;
+          } else {
+            call.id = value;
+            call.hasId = true;
+          }
+        }
+        if (r.consume('}')) {
+          break;
+        }
+        if (!r.consume(',')) {
+          return false;
+        }
+      }
+    }
+    if (!haveMethod) {
+      call.error = INVALID_REQUEST;
+    }
+    return true;
+  }
+
+  void execute(const Call &call, std::string &out) const {
+    if (call.error) {
+      writeError(out, call, call.error, "Invalid Request");
+      return;
+    }
+    auto it = methods_.find(call.method());
+    const bool notification = call.v2 && !call.hasId;
+    if (it == methods_.end()) {
+      if (!notification) {
+        writeError(out, call, METHOD_NOT_FOUND, "Method not found");
+      }
+      return;
+    }
+
+    const size_t mark = out.size();
+    out.append(call.v2 ? R"({"jsonrpc":"2.0","result":)" : R"({"result":)");
+    const size_t valueStart = out.size();
+    Reply reply(out, mark);
+    try {
+      it->second(Params(call.params), reply);
+    } catch (...) {
+      reply.error(INTERNAL_ERROR, "Internal error");
+    }
+
+    if (notification) {
+      out.resize(mark);
+      return;
+    }
+    if (reply.failed()) {
+      out.resize(mark);
+      writeError(out, call, reply.code_, reply.message_);
+      return;
+    }
+    if (out.size() == valueStart) {
+      out.append("null");
+    }
+    out.append(call.v2 ? R"(,"id":)" : R"(,"error":null,"id":)");
+    out.append(call.id);
+    out.push_back('}');
+  }
+
+  static void writeError(std::string &out, const Call &call, int code,
+                         std::string_view message) {
+    Writer w(out);
+    w.beginObject();
+    if (call.v2) {
+      w.key("jsonrpc").string("2.0");
+    } else {
+      w.key("result").null();
+    }
+    w.key("error")
+        .beginObject()
+        .key("code")
+        .number(code)
+        .key("message")
+        .string(message)
+        .endObject();
+    w.key("id").raw(call.id);
+    w.endObject();
+  }
+};
+
+} // namespace QuantumPulse::JsonRpc
+
+#endif // QUANTUMPULSE_JSONRPC_V7_H
@@ -0,0 +1,402 @@
+#ifndef QUANTUMPULSE_LOGFORMAT_V7_H
+#define QUANTUMPULSE_LOGFORMAT_V7_H
+
+#include "quantumpulse_serialize_v7.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+// Binary log file format (.qplog). The logger thread appends entries
+// without formatting any text; quantumpulse-logdump renders them offline.
+//
+//   file    := "QPLG" u16 version u16 reserved i64 startNs entry*
+//   entry   := u8 type body
+//   MODULE  := varint id, varint len, bytes       (first use of a module)
+//   FORMAT  := varint id, varint len, bytes       (first use of a format)
+//   EVENT   := zigzag dtNs, u8 level, varint module, zigzag shard,
+//              varint format, varint argsLen, args
+//   DROPPED := varint count                       (ring overflow)
+//
+// dtNs is relative to the previous event (startNs for the first one).
+// Format id 0 is reserved: its args are the raw text of a plain message.
+// Otherwise args are tagged values that fill the "{}" placeholders.
+namespace QuantumPulse::Logging::Binary {
+
+constexpr char MAGIC[4] = {'Q', 'P', 'L', 'G'};
+constexpr uint16_t VERSION = 1;
+constexpr uint64_t PLAIN_FORMAT = 0;
+
+enum class EntryType : uint8_t {
+  MODULE = 1,
+  FORMAT = 2,
+  EVENT = 3,
+  DROPPED = 4
+};
+
+enum class ArgType : uint8_t {
+  INT = 1,    // zigzag varint
+  UINT = 2,   // varint
+  DOUBLE = 3, // 8 bytes LE
+  STRING = 4, // varint length + bytes
+  BOOL = 5    // 1 byte
+};
+
+inline void putVarint(std::string &out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+[[nodiscard]] constexpr uint64_t zigzag(int64_t v) noexcept {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+[[nodiscard]] constexpr int64_t unzigzag(uint64_t v) noexcept {
+  return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline bool getVarint(Serialize::ByteReader &in, uint64_t &v) noexcept {
+  v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t b;
+    if (!in.u8(b)) {
+      return false;
+    }
+    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void putHeader(std::string &out, int64_t startNs) {
+  out.append(MAGIC, sizeof(MAGIC));
+  Serialize::putU16(out, VERSION);
+  Serialize::putU16(out, 0);
+  Serialize::putI64(out, startNs);
+}
+
+// Encodes log arguments into a fixed caller-side buffer. Arguments that
+// do not fit are cut (strings) or dropped (scalars) and truncated() is set.
+class ArgWriter {
+public:
+  ArgWriter(char *buf, size_t capacity) noexcept
+      : begin_(buf), pos_(buf), end_(buf + capacity) {}
+
+  template <typename T> void add(const T &v) noexcept {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_same_v<U, bool>) {
+      if (room(2)) {
+        *pos_++ = static_cast<char>(ArgType::BOOL);
+        *pos_++ = v ? 1 : 0;
+      }
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+      scalar(ArgType::INT, zigzag(static_cast<int64_t>(v)));
+    } else if constexpr (std::is_integral_v<U>) {
+      scalar(ArgType::UINT, static_cast<uint64_t>(v));
+    } else if constexpr (std::is_floating_point_v<U>) {
+      if (room(9)) {
+        *pos_++ = static_cast<char>(ArgType::DOUBLE);
+        double d = static_cast<double>(v);
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        for (int i = 0; i < 8; ++i) {
+          *pos_++ = static_cast<char>(bits >> (8 * i));
+        }
+      }
+    } else {
+      string(std::string_view(v));
+    }
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return static_cast<size_t>(pos_ - begin_);
+  }
+  [[nodiscard]] bool truncated() const noexcept { return truncated_; }
+
+private:
+  char *begin_;
+  char *pos_;
+  char *end_;
+  bool truncated_{false};
+
+  bool room(size_t n) noexcept {
+    if (static_cast<size_t>(end_ - pos_) < n) {
+      truncated_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  void varint(uint64_t v) noexcept {
+    while (v >= 0x80) {
+      *pos_++ = static_cast<char>(v | 0x80);
+      v >>= 7;
+    }
+    *pos_++ = static_cast<char>(v);
+  }
+
+  void scalar(ArgType type, uint64_t v) noexcept {
+    if (room(11)) {
+      *pos_++ = static_cast<char>(type);
+      varint(v);
+    }
+  }
+
+  void string(std::string_view s) noexcept {
+    // Tag plus a length that fits in at most 3 varint bytes
+    if (!room(4)) {
+      return;
+    }
+    size_t len = std::min(s.size(), static_cast<size_t>(end_ - pos_) - 4);
+    truncated_ |= len < s.size();
+    *pos_++ = static_cast<char>(ArgType::STRING);
+    varint(len);
+    std::memcpy(pos_, s.data(), len);
+    pos_ += len;
+  }
+};
+
+// One decoded EVENT; views point into the reader's input
+struct Event {
+  int64_t timestampNs{0};
+  uint8_t level{0};
+  int32_t shardId{0};
+  std::string_view module;
+  std::string_view format;
+  std::string_view args;
+  bool plain{false}; // args is the raw message text
+};
+
+// Sequential decoder over a whole .qplog file
+class Reader {
+public:
+  enum class Status { Event, End, Corrupt };
+
+  explicit Reader(std::string_view data) noexcept : data_(data), in_(data) {
+    valid_ = session();
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return valid_; }
+  [[nodiscard]] int64_t startNs() const noexcept { return startNs_; }
+  [[nodiscard]] uint64_t dropped() const noexcept { return dropped_; }
+  [[nodiscard]] size_t position() const noexcept { return in_.position(); }
+
+  // Advance to the next event, absorbing definition entries on the way
+  Status next(Event &ev) {
+    if (!valid_) {
+      return Status::Corrupt;
+    }
+    while (!in_.done()) {
+      if (data_.substr(in_.position(), sizeof(MAGIC)) ==
+          std::string_view(MAGIC, sizeof(MAGIC))) {
+        // Another process appended to the same file
+        if (!session()) {
+          return Status::Corrupt;
+        }
+        continue;
+      }
+      uint8_t type;
+      if (!in_.u8(type)) {
+        return Status::Corrupt;
+      }
+      switch (static_cast<EntryType>(type)) {
+      case EntryType::MODULE:
+      case EntryType::FORMAT: {
+        uint64_t id, len;
+        std::string_view text;
+        if (!varint(id) || !varint(len) || !in_.view(text, len)) {
+          return Status::Corrupt;
+        }
+        auto &table = type == static_cast<uint8_t>(EntryType::MODULE)
+                          ? modules_
+                          : formats_;
+        table[id] = text;
+        break;
+      }
+      case EntryType::DROPPED: {
+        uint64_t count;
+        if (!varint(count)) {
+          return Status::Corrupt;
+        }
+        dropped_ += count;
+        break;
+      }
+      case EntryType::EVENT:
+        return event(ev) ? Status::Event : Status::Corrupt;
+      default:
+        return Status::Corrupt;
+      }
+    }
+    return Status::End;
+  }
+
+private:
+  std::string_view data_;
+  Serialize::ByteReader in_;
+  bool valid_{false};
+  int64_t startNs_{0};
+  int64_t lastNs_{0};
+  uint64_t dropped_{0};
+  std::unordered_map<uint64_t, std::string_view> modules_;
+  std::unordered_map<uint64_t, std::string_view> formats_;
+
+  bool varint(uint64_t &v) noexcept { return getVarint(in_, v); }
+
+  // Parse a file header; ids restart with each session
+  bool session() noexcept {
+    std::string_view magic;
+    uint16_t version, reserved;
+    if (!in_.view(magic, sizeof(MAGIC)) ||
+        magic != std::string_view(MAGIC, sizeof(MAGIC)) ||
+        !in_.u16(version) || !in_.u16(reserved) || !in_.i64(startNs_) ||
+        version != VERSION) {
+      return false;
+    }
+    lastNs_ = startNs_;
+    modules_.clear();
+    formats_.clear();
+    return true;
+  }
+
+  bool event(Event &ev) {
+    uint64_t dt, module, shard, format, len;
+    if (!varint(dt) || !in_.u8(ev.level) || !varint(module) ||
+        !varint(shard) || !varint(format) || !varint(len) ||
+        !in_.view(ev.args, len)) {
+      return false;
+    }
+    lastNs_ += unzigzag(dt);
+    ev.timestampNs = lastNs_;
+    ev.shardId = static_cast<int32_t>(unzigzag(shard));
+    ev.plain = format == PLAIN_FORMAT;
+    auto m = modules_.find(module);
+    ev.module = m == modules_.end() ? std::string_view("?") : m->second;
+    if (!ev.plain) {
+      auto f = formats_.find(format);
+      if (f == formats_.end()) {
+        return false;
+      }
+      ev.format = f->second;
+    }
+    return true;
+  }
+};
+
+// Visit each tagged argument as (ArgType, int64, uint64, double, string)
+template <typename Visit>
+bool forEachArg(std::string_view args, Visit &&visit) {
+  Serialize::ByteReader in(args);
+  auto varint = [&](uint64_t &v) { return getVarint(in, v); };
+  while (!in.done()) {
+    uint8_t tag;
+    uint64_t u = 0;
+    double d = 0;
+    std::string_view s;
+    if (!in.u8(tag)) {
+      return false;
+    }
+    switch (static_cast<ArgType>(tag)) {
+    case ArgType::INT:
+    case ArgType::UINT:
+      if (!varint(u)) {
+        return false;
+      }
+      break;
+    case ArgType::DOUBLE:
+      if (!in.f64(d)) {
+        return false;
+      }
+      break;
+    case ArgType::STRING:
+      if (!varint(u) || !in.view(s, u)) {
+        return false;
+      }
+      break;
+    case ArgType::BOOL: {
+      uint8_t b;
+      if (!in.u8(b)) {
+        return false;
+      }
+      u = b;
+      break;
+    }
+    default:
+      return false;
+    }
+    visit(static_cast<ArgType>(tag), unzigzag(u), u, d, s);
+  }
+  return true;
+}
+
+// Render the message text: each "{}" takes the next argument; surplus
+// arguments are appended, missing ones leave the placeholder
+inline std::string renderMessage(const Event &ev) {
+  if (ev.plain) {
+    return std::string(ev.args);
+  }
+  std::string out;
+  size_t pos = 0;
+  auto emit = [&](ArgType type, int64_t i, uint64_t u, double d,
+                  std::string_view s) {
+    size_t hole = ev.format.find("{}", pos);
+    if (hole == std::string_view::npos) {
+      out.append(ev.format.substr(pos));
+      pos = ev.format.size();
+      out.push_back(' ');
+    } else {
+      out.append(ev.format.substr(pos, hole - pos));
+      pos = hole + 2;
+    }
+    char buf[32];
+    switch (type) {
+    case ArgType::INT:
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf), i).ptr);
+      break;
+    case ArgType::UINT:
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf), u).ptr);
+      break;
+    case ArgType::DOUBLE:
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf), d).ptr);
+      break;
+    case ArgType::BOOL:
+      out.append(u ? "true" : "false");
+      break;
+    default:
+      out.append(s);
+    }
+  };
+  if (!forEachArg(ev.args, emit)) {
+    out.append("<corrupt args>");
+  }
+  if (pos < ev.format.size()) {
+    out.append(ev.format.substr(pos));
+  }
+  return out;
+}
+
+// "YYYY-mm-dd HH:MM:SS.mmm" in local time
+inline std::string formatTimestamp(int64_t ns) {
+  const time_t seconds = static_cast<time_t>(ns / 1000000000);
+  std::tm tm{};
+  localtime_r(&seconds, &tm);
+  char buf[40];
+  size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+  std::snprintf(buf + n, sizeof(buf) - n, ".%03d",
+                static_cast<int>(ns / 1000000 % 1000));
+  return buf;
+}
+
+} // namespace QuantumPulse::Logging::Binary
+
+#endif // QUANTUMPULSE_LOGFORMAT_V7_H
@@ -1,8 +1,15 @@
 #ifndef QUANTUMPULSE_LOGGING_V7_H
 #define QUANTUMPULSE_LOGGING_V7_H
 
+#include "quantumpulse_logformat_v7.h"
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
@@ -10,12 +17,13 @@
 #include <iomanip>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <unistd.h>
 #include <unordered_map>
+#include <utility>
 
 namespace QuantumPulse::Logging {
 
@@ -50,9 +58,175 @@ logLevelToString(LogLevel level) noexcept {
   }
 }
 
-// Thread-safe, high-performance logger with async flushing
+// Fixed-size binary log record. Producers fill it in place; encoding for
+// disk happens on the logger thread. A plain record carries the message
+// text in payload; a formatted one points at a string literal and carries
+// its arguments encoded with Binary::ArgWriter. Overlong data is cut.
+struct LogRecord {
+  static constexpr size_t MODULE_CAPACITY = 24;
+  static constexpr size_t PAYLOAD_CAPACITY = 208;
+
+  int64_t timestampNs;  // System clock, since the epoch
+  const char *format;   // Static format string, or nullptr for plain text
+  int32_t shardId;
+  uint16_t payloadLength;
+  LogLevel level;
+  uint8_t moduleLength;
+  char module[MODULE_CAPACITY];
+  char payload[PAYLOAD_CAPACITY];
+
+  // Plain message; returns false if it was truncated
+  bool set(std::string_view msg, LogLevel lvl, std::string_view mod,
+           int shard) noexcept {
+    header(nullptr, lvl, mod, shard);
+    payloadLength =
+        static_cast<uint16_t>(std::min(msg.size(), PAYLOAD_CAPACITY));
+    std::memcpy(payload, msg.data(), payloadLength);
+    return payloadLength == msg.size();
+  }
+
+  // Format string plus arguments; returns false if any were truncated
+  template <typename... Args>
+  bool setFormatted(const char *fmt, LogLevel lvl, std::string_view mod,
+                    int shard, const Args &...args) noexcept {
+    header(fmt, lvl, mod, shard);
+    Binary::ArgWriter writer(payload, PAYLOAD_CAPACITY);
+    (writer.add(args), ...);
+    payloadLength = static_cast<uint16_t>(writer.size());
+    return !writer.truncated();
+  }
+
+  [[nodiscard]] std::string_view moduleView() const noexcept {
+    return {module, moduleLength};
+  }
+  [[nodiscard]] std::string_view payloadView() const noexcept {
+    return {payload, payloadLength};
+  }
+
+private:
+  void header(const char *fmt, LogLevel lvl, std::string_view mod,
+              int shard) noexcept {
+    timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    format = fmt;
+    shardId = shard;
+    level = lvl;
+    moduleLength =
+        static_cast<uint8_t>(std::min(mod.size(), MODULE_CAPACITY));
+    std::memcpy(module, mod.data(), moduleLength);
+  }
+};
+
+static_assert(sizeof(LogRecord) == 256);
+
+// Bounded lock-free multi-producer, single-consumer ring. Each cell
+// carries a sequence number (Vyukov's bounded queue): a producer claims a
+// slot with one CAS on the enqueue position and publishes it by bumping
+// the cell's sequence; the consumer reads published cells in order. A
+// full ring makes tryPush() fail instead of waiting.
+template <typename T> class MpscRing final {
+public:
+  // Capacity is rounded up to a power of two
+  explicit MpscRing(size_t capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Claim a slot and let `fill(T&)` write it; false when full
+  template <typename Fill> bool tryPush(Fill &&fill) noexcept {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::intptr_t>(seq) -
+                  static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueuePos_.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // Consumer has not freed this slot yet
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    fill(cell->item);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only: next published item, or nullptr
+  [[nodiscard]] T *front() noexcept {
+    return const_cast<T *>(std::as_const(*this).front());
+  }
+  [[nodiscard]] const T *front() const noexcept {
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    const Cell &cell = cells_[pos & mask_];
+    return cell.sequence.load(std::memory_order_acquire) == pos + 1
+               ? &cell.item
+               : nullptr;
+  }
+
+  // Consumer only: release the item returned by front()
+  void pop() noexcept {
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    cells_[pos & mask_].sequence.store(pos + mask_ + 1,
+                                       std::memory_order_release);
+    dequeuePos_.store(pos + 1, std::memory_order_release);
+  }
+
+  [[nodiscard]] size_t capacity() const noexcept { return mask_ + 1; }
+
+  // Slots claimed so far / released by the consumer so far
+  [[nodiscard]] size_t pushed() const noexcept {
+    return enqueuePos_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] size_t popped() const noexcept {
+    return dequeuePos_.load(std::memory_order_acquire);
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<size_t> enqueuePos_{0};
+  alignas(64) std::atomic<size_t> dequeuePos_{0};
+};
+
+using LogRing = MpscRing<LogRecord>;
+
+// Format string for Logger::logf(). Records keep only the pointer, so the
+// consteval constructor accepts nothing but a string literal.
+class LogFormat {
+public:
+  template <size_t N>
+  consteval LogFormat(const char (&text)[N]) noexcept : text_(text) {}
+
+  [[nodiscard]] const char *c_str() const noexcept { return text_; }
+
+private:
+  const char *text_;
+};
+
+// Asynchronous logger. log() copies the message into a LogRing slot and
+// returns; a background thread appends records to a binary .qplog file
+// (see quantumpulse_logformat_v7.h). When
+// the ring is full the message is dropped and counted rather than
+// blocking the caller.
 class Logger final {
 public:
+  static constexpr size_t RING_CAPACITY = 16384; // 4 MB of records
+
   // Singleton access
   [[nodiscard]] static Logger &getInstance() noexcept {
     static Logger instance;
@@ -68,31 +242,21 @@ public:
   // Main log function with modern interface
   void log(std::string_view message, LogLevel level, std::string_view module,
            int shardId) noexcept {
-    if (!isLoggingEnabled_.load(std::memory_order_relaxed)) {
-      return;
-    }
-
-    // Skip logs below minimum level
-    if (static_cast<uint8_t>(level) <
-        static_cast<uint8_t>(minLogLevel_.load())) {
-      return;
-    }
-
-    try {
-      std::string logEntry = formatLogEntry(message, level, module, shardId);
-
-      {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        logQueue_.push(std::move(logEntry));
-      }
+    submit(level, [&](LogRecord &record) {
+      return record.set(message, level, module, shardId);
+    });
+  }
 
-      // Auto-flush for critical logs or when queue is large
-      if (level >= LogLevel::CRITICAL || logQueue_.size() > 100) {
-        flush();
-      }
-    } catch (...) {
-      // Logging should never throw - silently fail
-    }
+  // Structured log: `format` is a string literal whose "{}" placeholders
+  // take `args` (integers, floats, bools, strings). Only the arguments are
+  // copied; the text is rendered by quantumpulse-logdump.
+  template <typename... Args>
+  void logf(LogLevel level, std::string_view module, int shardId,
+            LogFormat format, const Args &...args) noexcept {
+    submit(level, [&](LogRecord &record) {
+      return record.setFormatted(format.c_str(), level, module, shardId,
+                                 args...);
+    });
   }
 
   // Convenience methods
@@ -126,19 +290,16 @@ public:
     log(msg, LogLevel::AUDIT, module, shard);
   }
 
-  // Manual flush
+  // Block until everything logged before the call is written to the file
   void flush() noexcept {
     try {
-      std::lock_guard<std::mutex> lock(queueMutex_);
-      while (!logQueue_.empty()) {
-        if (logFile_.is_open()) {
-          logFile_ << logQueue_.front();
-        }
-        logQueue_.pop();
-      }
-      if (logFile_.is_open()) {
-        logFile_.flush();
-      }
+      const size_t target = ring_.pushed();
+      std::unique_lock<std::mutex> lock(wakeMutex_);
+      urgent_.store(true, std::memory_order_relaxed);
+      wake_.notify_one();
+      flushed_.wait(lock, [&] {
+        return written_ >= target || !running_;
+      });
     } catch (...) {
       // Silent fail
     }
@@ -157,72 +318,240 @@ public:
 
   // Statistics
   [[nodiscard]] size_t getQueueSize() const noexcept {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    return logQueue_.size();
+    return ring_.pushed() - ring_.popped();
+  }
+
+  // Messages discarded because the ring was full
+  [[nodiscard]] uint64_t getDroppedCount() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  // Binary log file of this process
+  [[nodiscard]] const std::string &getLogPath() const noexcept {
+    return logPath_;
+  }
+
+  // Messages whose text or arguments did not fit in a LogRecord
+  [[nodiscard]] uint64_t getTruncatedCount() const noexcept {
+    return truncated_.load(std::memory_order_relaxed);
   }
 
 private:
-  Logger() noexcept {
+  // Level filter, ring push and writer wakeup shared by log() and logf()
+  template <typename Fill> void submit(LogLevel level, Fill &&fill) noexcept {
+    if (!isLoggingEnabled_.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    // Skip logs below minimum level
+    if (static_cast<uint8_t>(level) <
+        static_cast<uint8_t>(minLogLevel_.load(std::memory_order_relaxed))) {
+      return;
+    }
+
+    bool complete = true;
+    bool pushed =
+        ring_.tryPush([&](LogRecord &record) { complete = fill(record); });
+    if (!pushed) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!complete) {
+      truncated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Critical logs reach the disk promptly; otherwise only wake an idle
+    // writer
+    if (level >= LogLevel::CRITICAL) {
+      urgent_.store(true, std::memory_order_relaxed);
+      wake_.notify_one();
+    } else if (writerIdle_.load(std::memory_order_relaxed)) {
+      wake_.notify_one();
+    }
+  }
+
+  Logger() noexcept : ring_(RING_CAPACITY) {
     try {
       std::filesystem::create_directories("logs/audit");
       std::filesystem::create_directories("logs/debug");
 
       auto now = std::chrono::system_clock::now();
       auto time = std::chrono::system_clock::to_time_t(now);
+      std::tm tm{};
+      localtime_r(&time, &tm);
       std::stringstream ss;
-      ss << std::put_time(std::localtime(&time), "%Y%m%d_%H%M%S");
-
-      std::string logPath = "logs/audit/quantumpulse_" + ss.str() + ".log";
-      logFile_.open(logPath, std::ios::app);
-
-      if (logFile_.is_open()) {
-        logFile_ << "=== QuantumPulse v7.0 Log Started ===\n";
-        logFile_ << "Timestamp: " << ss.str() << "\n";
-        logFile_ << "=====================================\n\n";
-      }
+      ss << std::put_time(&tm, "%Y%m%d_%H%M%S");
+
+      // Binary entries; render with quantumpulse-logdump. The pid keeps
+      // processes started in the same second in separate files.
+      logPath_ = "logs/audit/quantumpulse_" + ss.str() + "_" +
+                 std::to_string(::getpid()) + ".qplog";
+      logFile_.open(logPath_, std::ios::app | std::ios::binary);
+
+      lastNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now.time_since_epoch())
+                    .count();
+      Binary::putHeader(batch_, lastNs_);
+      writeBatch();
+      writer_ = std::thread(&Logger::writerLoop, this);
     } catch (...) {
       // Continue without logging
+      running_ = false;
     }
   }
 
   ~Logger() noexcept {
     try {
-      flush();
-      if (logFile_.is_open()) {
-        logFile_ << "\n=== Log Session Ended ===\n";
-        logFile_.close();
+      {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_ = false;
       }
+      wake_.notify_one();
+      if (writer_.joinable()) {
+        writer_.join();
+      }
+      drain(); // Anything logged while the writer shut down
+      logFile_.close();
     } catch (...) {
       // Silent cleanup
     }
   }
 
-  [[nodiscard]] std::string formatLogEntry(std::string_view message,
-                                           LogLevel level,
-                                           std::string_view module,
-                                           int shardId) const {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  now.time_since_epoch()) %
-              1000;
+  static constexpr auto IDLE_FLUSH_INTERVAL = std::chrono::milliseconds(50);
+
+  // Writer thread: drain, write in batches, sleep when idle. Producers
+  // notify only while the writer is idle, so a wakeup can be missed; the
+  // timed wait bounds the delay.
+  void writerLoop() {
+    while (true) {
+      size_t written = drain();
+      const size_t popped = ring_.popped();
+      bool urgent = urgent_.exchange(false, std::memory_order_relaxed);
+      if (written > 0 || urgent) {
+        logFile_.flush();
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        written_ = popped;
+        flushed_.notify_all();
+      }
+      if (written > 0) {
+        continue;
+      }
 
-    std::stringstream ss;
-    ss << "[" << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count() << "]";
-    ss << "[" << logLevelToString(level) << "]";
-    ss << "[" << module << "]";
-    ss << "[Shard:" << shardId << "] ";
-    ss << message << "\n";
+      std::unique_lock<std::mutex> lock(wakeMutex_);
+      if (!running_) {
+        flushed_.notify_all();
+        return;
+      }
+      writerIdle_.store(true, std::memory_order_relaxed);
+      wake_.wait_for(lock, IDLE_FLUSH_INTERVAL, [&] {
+        return !running_ || ring_.front() != nullptr ||
+               urgent_.load(std::memory_order_relaxed);
+      });
+      writerIdle_.store(false, std::memory_order_relaxed);
+    }
+  }
 
-    return ss.str();
+  // Encode and write every published record; returns how many
+  size_t drain() {
+    size_t count = 0;
+    batch_.clear();
+    while (const LogRecord *record = ring_.front()) {
+      encodeEntry(*record);
+      ring_.pop();
+      ++count;
+      if (batch_.size() >= 64 * 1024) {
+        writeBatch();
+      }
+    }
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped_) {
+      Serialize::putU8(batch_,
+                       static_cast<uint8_t>(Binary::EntryType::DROPPED));
+      Binary::putVarint(batch_, dropped - reportedDropped_);
+      reportedDropped_ = dropped;
+    }
+    writeBatch();
+    return count;
   }
 
-  std::ofstream logFile_;
-  mutable std::mutex queueMutex_;
-  std::queue<std::string> logQueue_;
+  void writeBatch() {
+    if (logFile_.is_open() && !batch_.empty()) {
+      logFile_.write(batch_.data(),
+                     static_cast<std::streamsize>(batch_.size()));
+    }
+    batch_.clear();
+  }
+
+  // Append an EVENT, preceded by MODULE/FORMAT definitions on first use
+  void encodeEntry(const LogRecord &record) {
+    const uint64_t module = intern(modules_, record.moduleView(),
+                                   Binary::EntryType::MODULE,
+                                   record.moduleView());
+    uint64_t format = Binary::PLAIN_FORMAT;
+    if (record.format) {
+      format = intern(formats_, record.format, Binary::EntryType::FORMAT,
+                      record.format);
+    }
+    Serialize::putU8(batch_, static_cast<uint8_t>(Binary::EntryType::EVENT));
+    Binary::putVarint(batch_, Binary::zigzag(record.timestampNs - lastNs_));
+    lastNs_ = record.timestampNs;
+    Serialize::putU8(batch_, static_cast<uint8_t>(record.level));
+    Binary::putVarint(batch_, module);
+    Binary::putVarint(batch_, Binary::zigzag(record.shardId));
+    Binary::putVarint(batch_, format);
+    Binary::putVarint(batch_, record.payloadLength);
+    batch_.append(record.payloadView());
+  }
+
+  template <typename Map, typename Key>
+  uint64_t intern(Map &ids, const Key &key, Binary::EntryType type,
+                  std::string_view text) {
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+      return it->second;
+    }
+    const uint64_t id = ids.size() + 1; // 0 is PLAIN_FORMAT
+    ids.emplace(typename Map::key_type(key), id);
+    Serialize::putU8(batch_, static_cast<uint8_t>(type));
+    Binary::putVarint(batch_, id);
+    Binary::putVarint(batch_, text.size());
+    batch_.append(text);
+    return id;
+  }
+
+  // Heterogeneous lookup so module names are not copied per record
+  struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const noexcept {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  LogRing ring_;
   std::atomic<bool> isLoggingEnabled_{true};
   std::atomic<LogLevel> minLogLevel_{LogLevel::DEBUG};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> truncated_{0};
+  std::atomic<bool> urgent_{false};
+  std::atomic<bool> writerIdle_{false};
+
+  std::mutex wakeMutex_; // Guards running_/written_; for wake_/flushed_
+  std::condition_variable wake_;
+  std::condition_variable flushed_;
+  bool running_{true};
+  size_t written_{0}; // Records flushed to the file
+  std::thread writer_;
+
+  std::string logPath_;
+
+  // Writer thread only
+  std::ofstream logFile_;
+  std::string batch_;
+  uint64_t reportedDropped_{0};
+  int64_t lastNs_{0};
+  std::unordered_map<std::string, uint64_t, StringHash, std::equal_to<>>
+      modules_;
+  std::unordered_map<const char *, uint64_t> formats_;
 };
 
 // Legacy compatibility - use enum values directly
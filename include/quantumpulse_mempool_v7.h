@@ -1,16 +1,22 @@
 #ifndef QUANTUMPULSE_MEMPOOL_V7_H
 #define QUANTUMPULSE_MEMPOOL_V7_H
 
+#include "quantumpulse_merkle_v7.h"
+#include "quantumpulse_trace_v7.h"
 #include "quantumpulse_utxo_v7.h"
 #include <algorithm>
 #include <map>
 #include <mutex>
-#include <queue>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace QuantumPulse::Mempool {
 
-// Mempool entry
+// Mempool entry. Ancestor/descendant totals include the entry itself and
+// are kept up to date incrementally as related transactions come and go.
 struct MempoolEntry {
   UTXO::Transaction tx;
   int64_t entryTime;
@@ -19,11 +25,91 @@ struct MempoolEntry {
   int descendantCount; // Number of descendant txs
   double modifiedFee;  // Fee after reordering
   int height;          // Block height when added
+  uint64_t sequence{0}; // Arrival order, breaks fee-rate ties
+
+  // Package bookkeeping (CPFP)
+  double ancestorFees{0.0};
+  int64_t ancestorVsize{0};
+  int64_t ancestorWeight{0};
+  double descendantFees{0.0};
+  int64_t descendantVsize{0};
+  std::vector<MempoolEntry *> parents;  // In-mempool inputs
+  std::vector<MempoolEntry *> children; // In-mempool spenders
+
+  [[nodiscard]] int64_t vsize() const noexcept {
+    return std::max<int64_t>(1, tx.vsize);
+  }
+
+  // Package rate used for selection; min() stops a rich parent from
+  // dragging a cheap child in ahead of its turn
+  [[nodiscard]] double ancestorScore() const noexcept {
+    return std::min(feeRate,
+                    ancestorFees / std::max<int64_t>(1, ancestorVsize));
+  }
+
+  // Package rate used for eviction; max() protects parents whose children
+  // pay for them
+  [[nodiscard]] double descendantScore() const noexcept {
+    return std::max(feeRate,
+                    descendantFees / std::max<int64_t>(1, descendantVsize));
+  }
 };
 
-// Transaction Mempool (Bitcoin Core-like)
+// Merkle root of the current block template, refreshed incrementally. Each
+// update diffs the new txid order against the previous template: unchanged
+// positions cost nothing, changed ones cost O(log n) hashes.
+class TemplateMerkleRoot final {
+public:
+  // Returns the number of leaves that had to be rehashed
+  size_t update(const std::vector<UTXO::Transaction> &txs) {
+    size_t changed = 0;
+    for (size_t i = 0; i < txs.size(); ++i) {
+      if (i < txids_.size() && txids_[i] == txs[i].txid) {
+        continue;
+      }
+      Merkle::IncrementalMerkleTree::Node leaf;
+      Crypto::Sha512::hash(txs[i].txid.data(), txs[i].txid.size(),
+                           leaf.data());
+      if (i < txids_.size()) {
+        txids_[i] = txs[i].txid;
+        tree_.replaceAt(i, leaf);
+      } else {
+        txids_.push_back(txs[i].txid);
+        tree_.append(leaf);
+      }
+      ++changed;
+    }
+    while (txids_.size() > txs.size()) {
+      txids_.pop_back();
+      tree_.removeTail();
+    }
+    return changed;
+  }
+
+  [[nodiscard]] Merkle::IncrementalMerkleTree::Node root() const noexcept {
+    return tree_.root();
+  }
+
+  [[nodiscard]] std::string rootHex() const { return tree_.rootHex(); }
+
+  [[nodiscard]] size_t size() const noexcept { return txids_.size(); }
+
+private:
+  std::vector<std::string> txids_;
+  Merkle::IncrementalMerkleTree tree_;
+};
+
+// Transaction Mempool (Bitcoin Core-like). Entries are owned by a txid hash
+// map and indexed three more ways through ordered sets of entry pointers
+// (hash map nodes never move): by ancestor package score for block
+// templates, by descendant package score for eviction, and by arrival time
+// for expiry. Package totals are updated incrementally on insert and remove,
+// so selection and eviction never rescan the pool.
 class TransactionMempool final {
 public:
+  // Stop filling a template after this many consecutive misfits
+  static constexpr size_t MAX_CONSECUTIVE_MISFITS = 1000;
+
   TransactionMempool(size_t maxSize = 300 * 1000000) noexcept // 300 MB default
       : maxSize_(maxSize) {
     Logging::Logger::getInstance().info("Mempool initialized (max " +
@@ -34,34 +120,43 @@ public:
 
   // Add transaction to mempool
   bool addTransaction(const UTXO::Transaction &tx) noexcept {
+    QP_TRACE_SCOPE("mempool.add", "mempool");
+    QP_TRACE_SPAN(lockWait, "mempool.lock", "mempool");
     std::lock_guard<std::mutex> lock(mutex_);
+    QP_TRACE_END(lockWait);
 
-    if (transactions_.count(tx.txid)) {
-      return false; // Already in mempool
-    }
-
-    // Check mempool size
-    if (currentSize_ + tx.size > maxSize_) {
-      evictLowFeeTxs(tx.size);
-    }
-
-    MempoolEntry entry;
-    entry.tx = tx;
-    entry.entryTime = std::time(nullptr);
-    entry.feeRate = tx.fee / tx.vsize;
-    entry.ancestorCount = 0;
-    entry.descendantCount = 0;
-    entry.modifiedFee = tx.fee;
-    entry.height = currentHeight_;
+    try {
+      if (transactions_.count(tx.txid)) {
+        return false; // Already in mempool
+      }
 
-    transactions_[tx.txid] = entry;
-    currentSize_ += tx.size;
+      MempoolEntry entry;
+      entry.tx = tx;
+      entry.entryTime = std::time(nullptr);
+      entry.feeRate = tx.fee / std::max(1, tx.vsize);
+      entry.ancestorCount = 0;
+      entry.descendantCount = 0;
+      entry.modifiedFee = tx.fee;
+      entry.height = currentHeight_;
+      entry.sequence = nextSequence_++;
+
+      // Check mempool size; never evict in favour of a cheaper transaction
+      if (currentSize_ + tx.size > maxSize_ &&
+          !evictLowFeeTxs(tx.size, entry.feeRate)) {
+        return false;
+      }
 
-    // Add to fee-sorted index
-    feeIndex_.push({tx.txid, entry.feeRate});
+      auto [it, inserted] = transactions_.emplace(tx.txid, std::move(entry));
+      linkEntry(&it->second);
+      currentSize_ += tx.size;
+      totalFee_ += tx.fee;
+    } catch (...) {
+      return false;
+    }
 
-    Logging::Logger::getInstance().info(
-        "TX added to mempool: " + tx.txid.substr(0, 16) + "...", "Mempool", 0);
+    Logging::Logger::getInstance().logf(
+        Logging::INFO, "Mempool", 0, "TX added to mempool: {}...",
+        std::string_view(tx.txid).substr(0, 16));
 
     return true;
   }
@@ -70,42 +165,67 @@ public:
   bool removeTransaction(const std::string &txid) noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    if (!transactions_.count(txid)) {
+    auto it = transactions_.find(txid);
+    if (it == transactions_.end()) {
       return false;
     }
+    eraseEntry(&it->second);
+    return true;
+  }
 
-    currentSize_ -= transactions_[txid].tx.size;
-    transactions_.erase(txid);
+  // Remove a transaction together with everything that spends it
+  size_t removeWithDescendants(const std::string &txid) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    return true;
+    auto it = transactions_.find(txid);
+    if (it == transactions_.end()) {
+      return 0;
+    }
+    return eraseWithDescendants(&it->second);
   }
 
-  // Get transactions for block template (highest fee first)
+  // Get transactions for block template, best ancestor package first.
+  // Parents always precede children in the result.
   std::vector<UTXO::Transaction>
   getBlockTemplate(size_t maxWeight = 4000000) noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
     std::vector<UTXO::Transaction> result;
-    size_t currentWeight = 0;
-
-    // Sort by fee rate
-    std::vector<MempoolEntry> sorted;
-    for (const auto &[txid, entry] : transactions_) {
-      sorted.push_back(entry);
+    try {
+      PackageSelector selector(*this, maxWeight);
+      for (const MempoolEntry *entry : selector.run()) {
+        result.push_back(entry->tx);
+      }
+    } catch (...) {
+      result.clear(); // Allocation failure - no partial package sets
     }
-    std::sort(sorted.begin(), sorted.end(),
-              [](const MempoolEntry &a, const MempoolEntry &b) {
-                return a.feeRate > b.feeRate;
-              });
+    return result;
+  }
 
-    for (const auto &entry : sorted) {
-      if (currentWeight + entry.tx.weight <= maxWeight) {
-        result.push_back(entry.tx);
-        currentWeight += entry.tx.weight;
-      }
+  // Block template plus an incremental refresh of its Merkle root
+  std::vector<UTXO::Transaction>
+  getBlockTemplate(TemplateMerkleRoot &merkle,
+                   size_t maxWeight = 4000000) noexcept {
+    auto txs = getBlockTemplate(maxWeight);
+    try {
+      merkle.update(txs);
+    } catch (...) {
+      // Allocation failure - caller keeps the previous root
     }
+    return txs;
+  }
 
-    return result;
+  // Drop transactions (and their descendants) that arrived before `cutoff`;
+  // returns count removed
+  size_t expireOlderThan(int64_t cutoff) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t removed = 0;
+    while (!byEntryTime_.empty() &&
+           (*byEntryTime_.begin())->entryTime < cutoff) {
+      removed += eraseWithDescendants(*byEntryTime_.begin());
+    }
+    return removed;
   }
 
   // Get transaction from mempool
@@ -113,12 +233,27 @@ public:
   getTransaction(const std::string &txid) const noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    if (transactions_.count(txid)) {
-      return transactions_.at(txid).tx;
+    auto it = transactions_.find(txid);
+    if (it != transactions_.end()) {
+      return it->second.tx;
     }
     return std::nullopt;
   }
 
+  // Snapshot of an entry including its package totals
+  std::optional<MempoolEntry> getEntry(const std::string &txid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = transactions_.find(txid);
+    if (it == transactions_.end()) {
+      return std::nullopt;
+    }
+    MempoolEntry copy = it->second;
+    copy.parents.clear();
+    copy.children.clear();
+    return copy;
+  }
+
   // Check if transaction in mempool
   bool hasTransaction(const std::string &txid) const noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -138,11 +273,15 @@ public:
 
   double getTotalFee() const noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
-    double total = 0.0;
-    for (const auto &[txid, entry] : transactions_) {
-      total += entry.tx.fee;
-    }
-    return total;
+    return totalFee_;
+  }
+
+  // Lowest descendant package score in the pool (0 when empty)
+  double getMinFeeRate() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byDescendantScore_.empty()
+               ? 0.0
+               : (*byDescendantScore_.rbegin())->descendantScore();
   }
 
   // Get mempool stats
@@ -153,43 +292,409 @@ public:
     stats["bytes"] = currentSize_;
     stats["usage"] = (double)currentSize_ / maxSize_ * 100;
     stats["maxmempool"] = maxSize_;
+    stats["evicted"] = evictedCount_;
     return stats;
   }
 
   void setHeight(int height) noexcept { currentHeight_ = height; }
 
 private:
+  // Highest ancestor score first; sequence breaks ties (older first)
+  struct AncestorScoreOrder {
+    bool operator()(const MempoolEntry *a, const MempoolEntry *b) const {
+      double sa = a->ancestorScore(), sb = b->ancestorScore();
+      if (sa != sb) {
+        return sa > sb;
+      }
+      return a->sequence < b->sequence;
+    }
+  };
+
+  // Highest descendant score first; eviction takes from the back
+  struct DescendantScoreOrder {
+    bool operator()(const MempoolEntry *a, const MempoolEntry *b) const {
+      double sa = a->descendantScore(), sb = b->descendantScore();
+      if (sa != sb) {
+        return sa > sb;
+      }
+      return a->sequence < b->sequence;
+    }
+  };
+
+  // Oldest arrival first
+  struct EntryTimeOrder {
+    bool operator()(const MempoolEntry *a, const MempoolEntry *b) const {
+      if (a->entryTime != b->entryTime) {
+        return a->entryTime < b->entryTime;
+      }
+      return a->sequence < b->sequence;
+    }
+  };
+
+  using EntryMap = std::unordered_map<std::string, MempoolEntry>;
+  using EntryList = std::vector<MempoolEntry *>;
+
   mutable std::mutex mutex_;
-  std::map<std::string, MempoolEntry> transactions_;
+  EntryMap transactions_;
+  std::set<const MempoolEntry *, AncestorScoreOrder> byAncestorScore_;
+  std::set<const MempoolEntry *, DescendantScoreOrder> byDescendantScore_;
+  std::set<const MempoolEntry *, EntryTimeOrder> byEntryTime_;
+  // Input txid -> pool entries spending it, so a parent arriving after
+  // its children can find them
+  std::unordered_multimap<std::string, MempoolEntry *> spenders_;
   size_t maxSize_;
   size_t currentSize_{0};
+  double totalFee_{0.0};
+  uint64_t nextSequence_{0};
+  size_t evictedCount_{0};
   int currentHeight_{0};
 
-  struct FeeEntry {
-    std::string txid;
-    double feeRate;
-    bool operator<(const FeeEntry &other) const {
-      return feeRate < other.feeRate;
+  // Greedy ancestor-package selection (Bitcoin Core's addPackageTxs): once
+  // a package is taken, its in-pool descendants get "modified" package
+  // totals with the included ancestors subtracted, and compete from a
+  // separate queue against the untouched ancestor-score index.
+  class PackageSelector {
+  public:
+    PackageSelector(const TransactionMempool &pool, size_t maxWeight)
+        : pool_(pool), maxWeight_(maxWeight) {}
+
+    std::vector<const MempoolEntry *> run() {
+      auto next = pool_.byAncestorScore_.begin();
+      const auto end = pool_.byAncestorScore_.end();
+      size_t misfits = 0;
+
+      while (true) {
+        while (next != end &&
+               (inBlock_.count(*next) || modified_.count(*next))) {
+          ++next;
+        }
+
+        const MempoolEntry *candidate = nullptr;
+        Package package;
+        if (!queue_.empty() &&
+            (next == end || queue_.begin()->score >= (*next)->ancestorScore())) {
+          // The modified totals stay until the entry is included, so a
+          // misfit is not retried from the ancestor-score index with
+          // included ancestors counted again
+          candidate = queue_.begin()->entry;
+          package = modified_.at(candidate);
+          queue_.erase(queue_.begin());
+        } else if (next != end) {
+          candidate = *next++;
+          package = {candidate->ancestorFees, candidate->ancestorVsize,
+                     candidate->ancestorWeight};
+        } else {
+          break;
+        }
+
+        size_t weight = static_cast<size_t>(std::max<int64_t>(0, package.weight));
+        if (weight_ + weight > maxWeight_) {
+          if (++misfits >= MAX_CONSECUTIVE_MISFITS || weight_ >= maxWeight_) {
+            break;
+          }
+          continue;
+        }
+        misfits = 0;
+        addPackage(candidate);
+        weight_ += weight;
+      }
+      return std::move(selected_);
+    }
+
+  private:
+    struct Package {
+      double fees{0.0};
+      int64_t vsize{0};
+      int64_t weight{0};
+    };
+    struct QueueKey {
+      double score;
+      uint64_t sequence;
+      const MempoolEntry *entry;
+      bool operator<(const QueueKey &o) const {
+        return score != o.score ? score > o.score : sequence < o.sequence;
+      }
+    };
+
+    const TransactionMempool &pool_;
+    size_t maxWeight_;
+    size_t weight_{0};
+    std::vector<const MempoolEntry *> selected_;
+    std::unordered_set<const MempoolEntry *> inBlock_;
+    std::unordered_map<const MempoolEntry *, Package> modified_;
+    std::set<QueueKey> queue_;
+
+    static double score(const MempoolEntry *e, const Package &p) noexcept {
+      return std::min(e->feeRate, p.fees / std::max<int64_t>(1, p.vsize));
+    }
+
+    void addPackage(const MempoolEntry *entry) {
+      EntryList package;
+      for (MempoolEntry *a : collect(entry, &MempoolEntry::parents)) {
+        if (!inBlock_.count(a)) {
+          package.push_back(a);
+        }
+      }
+      package.push_back(const_cast<MempoolEntry *>(entry));
+
+      // Fewer ancestors first is a valid topological order
+      std::sort(package.begin(), package.end(),
+                [](const MempoolEntry *a, const MempoolEntry *b) {
+                  return a->ancestorCount < b->ancestorCount;
+                });
+
+      for (const MempoolEntry *p : package) {
+        inBlock_.insert(p);
+        selected_.push_back(p);
+        dropModified(p);
+      }
+      for (const MempoolEntry *p : package) {
+        for (const MempoolEntry *d : collect(p, &MempoolEntry::children)) {
+          if (inBlock_.count(d)) {
+            continue;
+          }
+          auto [it, fresh] = modified_.try_emplace(
+              d, Package{d->ancestorFees, d->ancestorVsize, d->ancestorWeight});
+          if (!fresh) {
+            queue_.erase({score(d, it->second), d->sequence, d});
+          }
+          it->second.fees -= p->tx.fee;
+          it->second.vsize -= p->vsize();
+          it->second.weight -= p->tx.weight;
+          queue_.insert({score(d, it->second), d->sequence, d});
+        }
+      }
+    }
+
+    void dropModified(const MempoolEntry *e) {
+      auto it = modified_.find(e);
+      if (it != modified_.end()) {
+        queue_.erase({score(e, it->second), e->sequence, e});
+        modified_.erase(it);
+      }
     }
   };
-  std::priority_queue<FeeEntry> feeIndex_;
 
-  void evictLowFeeTxs(size_t needed) {
-    // Evict lowest fee transactions until we have space
-    std::vector<std::pair<std::string, double>> sorted;
-    for (const auto &[txid, entry] : transactions_) {
-      sorted.push_back({txid, entry.feeRate});
+  // Transitive closure over parents or children (excluding `start`)
+  static EntryList collect(const MempoolEntry *start,
+                           EntryList MempoolEntry::*edges) {
+    EntryList result;
+    std::unordered_set<const MempoolEntry *> seen{start};
+    EntryList stack(start->*edges);
+    while (!stack.empty()) {
+      MempoolEntry *e = stack.back();
+      stack.pop_back();
+      if (!seen.insert(e).second) {
+        continue;
+      }
+      result.push_back(e);
+      stack.insert(stack.end(), (e->*edges).begin(), (e->*edges).end());
     }
-    std::sort(sorted.begin(), sorted.end(),
-              [](const auto &a, const auto &b) { return a.second < b.second; });
+    return result;
+  }
 
-    size_t freed = 0;
-    for (const auto &[txid, _] : sorted) {
-      if (freed >= needed)
-        break;
-      freed += transactions_[txid].tx.size;
-      transactions_.erase(txid);
+  void index(const MempoolEntry *entry) {
+    byAncestorScore_.insert(entry);
+    byDescendantScore_.insert(entry);
+    byEntryTime_.insert(entry);
+  }
+
+  void unindex(const MempoolEntry *entry) noexcept {
+    byAncestorScore_.erase(entry);
+    byDescendantScore_.erase(entry);
+    byEntryTime_.erase(entry);
+  }
+
+  // Apply `update` to an indexed entry's package totals and reposition it
+  template <typename Fn> void reindex(MempoolEntry *entry, Fn &&update) {
+    byAncestorScore_.erase(entry);
+    byDescendantScore_.erase(entry);
+    update(*entry);
+    byAncestorScore_.insert(entry);
+    byDescendantScore_.insert(entry);
+  }
+
+  // Wire a freshly inserted entry to its in-pool parents and to in-pool
+  // children that arrived before it. Without waiting children only the
+  // entry's ancestors change, so their descendant totals are bumped in
+  // place; otherwise every connected entry is recounted.
+  void linkEntry(MempoolEntry *entry) {
+    for (const auto &input : entry->tx.vin) {
+      if (spends(entry, input.txid)) {
+        continue; // Several outputs of the same parent
+      }
+      spenders_.emplace(input.txid, entry);
+      auto parent = transactions_.find(input.txid);
+      if (parent != transactions_.end()) {
+        entry->parents.push_back(&parent->second);
+        parent->second.children.push_back(entry);
+      }
+    }
+    auto [first, last] = spenders_.equal_range(entry->tx.txid);
+    for (auto it = first; it != last; ++it) {
+      entry->children.push_back(it->second);
+      it->second->parents.push_back(entry);
+    }
+
+    const EntryList ancestors = collect(entry, &MempoolEntry::parents);
+    countAncestors(*entry, ancestors);
+    if (!entry->children.empty()) {
+      const EntryList descendants = collect(entry, &MempoolEntry::children);
+      countDescendants(*entry, descendants);
+      index(entry);
+      recount(ancestors, descendants);
+      return;
+    }
+
+    countDescendants(*entry, {});
+    for (MempoolEntry *a : ancestors) {
+      reindex(a, [entry](MempoolEntry &e) {
+        e.descendantCount += 1;
+        e.descendantFees += entry->tx.fee;
+        e.descendantVsize += entry->vsize();
+      });
+    }
+    index(entry);
+  }
+
+  // Remove one entry. A root or a leaf is subtracted from the totals on
+  // its one connected side; removing a middle entry can disconnect its
+  // ancestors from its descendants, so both sides are recounted.
+  void eraseEntry(MempoolEntry *entry) noexcept {
+    EntryList ancestors, descendants;
+    try {
+      ancestors = collect(entry, &MempoolEntry::parents);
+      descendants = collect(entry, &MempoolEntry::children);
+    } catch (...) {
+      // Totals may drift on allocation failure; links are still cleaned up
+    }
+    for (MempoolEntry *p : entry->parents) {
+      std::erase(p->children, entry);
     }
+    for (MempoolEntry *c : entry->children) {
+      std::erase(c->parents, entry);
+    }
+    for (const auto &input : entry->tx.vin) {
+      auto [first, last] = spenders_.equal_range(input.txid);
+      for (auto it = first; it != last; ++it) {
+        if (it->second == entry) {
+          spenders_.erase(it);
+          break;
+        }
+      }
+    }
+
+    unindex(entry);
+    currentSize_ -= entry->tx.size;
+    totalFee_ -= entry->tx.fee;
+
+    try {
+      if (!ancestors.empty() && !descendants.empty()) {
+        recount(ancestors, descendants);
+      } else {
+        for (MempoolEntry *a : ancestors) {
+          reindex(a, [entry](MempoolEntry &e) {
+            e.descendantCount -= 1;
+            e.descendantFees -= entry->tx.fee;
+            e.descendantVsize -= entry->vsize();
+          });
+        }
+        for (MempoolEntry *d : descendants) {
+          reindex(d, [entry](MempoolEntry &e) {
+            e.ancestorCount -= 1;
+            e.ancestorFees -= entry->tx.fee;
+            e.ancestorVsize -= entry->vsize();
+            e.ancestorWeight -= entry->tx.weight;
+          });
+        }
+      }
+    } catch (...) {
+    }
+    transactions_.erase(entry->tx.txid);
+  }
+
+  // Whether `entry` is already registered as a spender of `txid`
+  bool spends(const MempoolEntry *entry, const std::string &txid) const {
+    auto [first, last] = spenders_.equal_range(txid);
+    return std::any_of(first, last,
+                       [entry](const auto &kv) { return kv.second == entry; });
+  }
+
+  static void countAncestors(MempoolEntry &e, const EntryList &ancestors) {
+    e.ancestorCount = static_cast<int>(ancestors.size()) + 1;
+    e.ancestorFees = e.tx.fee;
+    e.ancestorVsize = e.vsize();
+    e.ancestorWeight = e.tx.weight;
+    for (const MempoolEntry *a : ancestors) {
+      e.ancestorFees += a->tx.fee;
+      e.ancestorVsize += a->vsize();
+      e.ancestorWeight += a->tx.weight;
+    }
+  }
+
+  static void countDescendants(MempoolEntry &e, const EntryList &descendants) {
+    e.descendantCount = static_cast<int>(descendants.size()) + 1;
+    e.descendantFees = e.tx.fee;
+    e.descendantVsize = e.vsize();
+    for (const MempoolEntry *d : descendants) {
+      e.descendantFees += d->tx.fee;
+      e.descendantVsize += d->vsize();
+    }
+  }
+
+  // Recount the descendant totals of `ancestors` and the ancestor totals
+  // of `descendants` from the current links
+  void recount(const EntryList &ancestors, const EntryList &descendants) {
+    for (MempoolEntry *a : ancestors) {
+      EntryList below = collect(a, &MempoolEntry::children);
+      reindex(a, [&](MempoolEntry &e) { countDescendants(e, below); });
+    }
+    for (MempoolEntry *d : descendants) {
+      EntryList above = collect(d, &MempoolEntry::parents);
+      reindex(d, [&](MempoolEntry &e) { countAncestors(e, above); });
+    }
+  }
+
+  // Remove an entry and all of its descendants, leaves first
+  size_t eraseWithDescendants(const MempoolEntry *root) noexcept {
+    EntryList doomed;
+    try {
+      doomed = collect(root, &MempoolEntry::children);
+    } catch (...) {
+    }
+    std::sort(doomed.begin(), doomed.end(),
+              [](const MempoolEntry *a, const MempoolEntry *b) {
+                return a->ancestorCount > b->ancestorCount;
+              });
+    for (MempoolEntry *d : doomed) {
+      eraseEntry(d);
+    }
+    eraseEntry(const_cast<MempoolEntry *>(root));
+    return doomed.size() + 1;
+  }
+
+  // Evict lowest descendant-score packages until `needed` bytes fit. Fails
+  // without evicting anything if that would remove a package paying at
+  // least `incomingFeeRate`.
+  bool evictLowFeeTxs(size_t needed, double incomingFeeRate) noexcept {
+    size_t available = maxSize_ > currentSize_ ? maxSize_ - currentSize_ : 0;
+    size_t reclaimable = available;
+    for (auto it = byDescendantScore_.rbegin();
+         it != byDescendantScore_.rend() && reclaimable < needed; ++it) {
+      if ((*it)->descendantScore() >= incomingFeeRate) {
+        return false;
+      }
+      reclaimable += (*it)->tx.size;
+    }
+    if (reclaimable < needed) {
+      return false;
+    }
+
+    while (maxSize_ - std::min(maxSize_, currentSize_) < needed &&
+           !byDescendantScore_.empty()) {
+      evictedCount_ += eraseWithDescendants(*byDescendantScore_.rbegin());
+    }
+    return true;
   }
 };
 
@@ -2,7 +2,10 @@
 #define QUANTUMPULSE_MERKLE_V7_H
 
 #include "quantumpulse_crypto_v7.h"
+#include "quantumpulse_threadpool_v7.h"
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace QuantumPulse::Merkle {
@@ -12,8 +15,12 @@ class MerkleTree final {
 public:
   MerkleTree() = default;
 
-  // Build merkle tree from transaction IDs
+  // Build merkle tree from transaction IDs. Every level is kept so proofs
+  // for the same txid set do not rebuild the tree.
   std::string buildTree(const std::vector<std::string> &txids) noexcept {
+    levels_.clear();
+    leafCount_ = 0;
+
     if (txids.empty()) {
       return sha3Hash("");
     }
@@ -22,37 +29,34 @@ public:
       return txids[0];
     }
 
-    std::vector<std::string> current = txids;
-
-    // Duplicate last if odd number
-    if (current.size() % 2 != 0) {
-      current.push_back(current.back());
-    }
+    levels_.push_back(txids);
 
-    while (current.size() > 1) {
-      std::vector<std::string> next;
+    while (levels_.back().size() > 1) {
+      auto &current = levels_.back();
 
-      for (size_t i = 0; i < current.size(); i += 2) {
-        std::string combined = current[i] + current[i + 1];
-        next.push_back(sha3Hash(combined));
+      // Duplicate last if odd number
+      if (current.size() % 2 != 0) {
+        current.push_back(current.back());
       }
 
-      current = next;
-
-      // Duplicate last if odd
-      if (current.size() > 1 && current.size() % 2 != 0) {
-        current.push_back(current.back());
+      std::vector<std::string> next;
+      next.reserve(current.size() / 2);
+      for (size_t i = 0; i < current.size(); i += 2) {
+        next.push_back(sha3Hash(current[i] + current[i + 1]));
       }
+      levels_.push_back(std::move(next));
     }
 
-    root_ = current[0];
+    leafCount_ = txids.size();
+    root_ = levels_.back()[0];
     return root_;
   }
 
   // Get merkle root
   std::string getRoot() const noexcept { return root_; }
 
-  // Generate merkle proof for transaction
+  // Generate merkle proof for transaction; reuses the last built tree when
+  // it was built from the same txids
   std::vector<std::pair<std::string, bool>>
   getProof(const std::vector<std::string> &txids, size_t index) noexcept {
 
@@ -62,33 +66,18 @@ public:
       return proof;
     }
 
-    std::vector<std::string> current = txids;
-    if (current.size() % 2 != 0) {
-      current.push_back(current.back());
+    if (!isBuiltFrom(txids)) {
+      buildTree(txids);
     }
 
     size_t idx = index;
-
-    while (current.size() > 1) {
+    for (size_t level = 0; level + 1 < levels_.size(); ++level) {
       // Get sibling
       size_t siblingIdx = (idx % 2 == 0) ? idx + 1 : idx - 1;
       bool isRight = (idx % 2 == 0);
 
-      proof.push_back({current[siblingIdx], isRight});
-
-      // Move to parent level
-      std::vector<std::string> next;
-      for (size_t i = 0; i < current.size(); i += 2) {
-        std::string combined = current[i] + current[i + 1];
-        next.push_back(sha3Hash(combined));
-      }
-
-      current = next;
+      proof.push_back({levels_[level][siblingIdx], isRight});
       idx = idx / 2;
-
-      if (current.size() > 1 && current.size() % 2 != 0) {
-        current.push_back(current.back());
-      }
     }
 
     return proof;
@@ -123,13 +112,257 @@ public:
 
 private:
   std::string root_;
+  std::vector<std::vector<std::string>> levels_;
+  size_t leafCount_{0};
   mutable Crypto::CryptoManager crypto_;
 
+  // Leaves of levels_[0] match txids (level 0 may carry a duplicated tail)
+  bool isBuiltFrom(const std::vector<std::string> &txids) const noexcept {
+    return !levels_.empty() && leafCount_ == txids.size() &&
+           std::equal(txids.begin(), txids.end(), levels_[0].begin());
+  }
+
   std::string sha3Hash(const std::string &data) const {
     return crypto_.sha3_512_v11(data, 0);
   }
 };
 
+// Binary Merkle engine. All levels live in one contiguous buffer of raw
+// 64-byte nodes (leaves first, root last), each level is hashed in parallel
+// through the multi-buffer SHA-512 kernel, and the built tree is retained so
+// every proof is an O(log n) walk over stored siblings.
+class MerkleEngine final {
+public:
+  using Node = Crypto::Digest512;
+  using Proof = std::vector<std::pair<Node, bool>>; // sibling, isRight
+
+  // Parent ranges smaller than this are hashed on the calling thread
+  static constexpr size_t PARALLEL_GRAIN = 512;
+
+  explicit MerkleEngine(Concurrency::ThreadPool *pool = nullptr) noexcept
+      : pool_(pool) {}
+
+  // Build from precomputed leaf nodes
+  void build(const std::vector<Node> &leaves) {
+    layout(leaves.size());
+    std::copy(leaves.begin(), leaves.end(), nodes_.begin());
+    hashLevels();
+  }
+
+  // Build from transaction ids; each leaf is SHA-512 of the txid string
+  void buildFromTxids(const std::vector<std::string> &txids) {
+    layout(txids.size());
+    std::vector<std::string_view> views(txids.begin(), txids.end());
+    forRange(views.size(), [&](size_t begin, size_t end) {
+      Crypto::Sha512::hashBatch(views.data() + begin, end - begin,
+                                nodes_.data() + begin);
+    });
+    hashLevels();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return leafCount() == 0; }
+
+  [[nodiscard]] size_t leafCount() const noexcept {
+    return levelSizes_.empty() ? 0 : levelSizes_[0];
+  }
+
+  [[nodiscard]] size_t levelCount() const noexcept {
+    return levelSizes_.size();
+  }
+
+  // Root of the last build (all-zero node for an empty tree)
+  [[nodiscard]] Node root() const noexcept {
+    return nodes_.empty() ? Node{} : nodes_.back();
+  }
+
+  [[nodiscard]] std::string rootHex() const {
+    return Crypto::Hashing::toHex(root());
+  }
+
+  [[nodiscard]] const Node &leaf(size_t index) const noexcept {
+    return nodes_[index];
+  }
+
+  // Sibling path for a leaf; O(log n), no hashing
+  [[nodiscard]] Proof getProof(size_t index) const {
+    Proof proof;
+    if (index >= leafCount()) {
+      return proof;
+    }
+    proof.reserve(levelSizes_.size());
+    for (size_t level = 0; level + 1 < levelSizes_.size(); ++level) {
+      size_t size = levelSizes_[level];
+      size_t sibling = (index % 2 == 0) ? std::min(index + 1, size - 1)
+                                        : index - 1;
+      proof.emplace_back(nodes_[levelOffsets_[level] + sibling],
+                         index % 2 == 0);
+      index /= 2;
+    }
+    return proof;
+  }
+
+  // Verify a proof against a root (SPV verification)
+  [[nodiscard]] static bool verifyProof(const Node &leaf, const Proof &proof,
+                                        const Node &root) noexcept {
+    Node current = leaf;
+    unsigned char pair[2 * Crypto::Sha512::DIGEST_SIZE];
+    for (const auto &[sibling, isRight] : proof) {
+      const Node &left = isRight ? current : sibling;
+      const Node &right = isRight ? sibling : current;
+      std::memcpy(pair, left.data(), left.size());
+      std::memcpy(pair + left.size(), right.data(), right.size());
+      Crypto::Sha512::hash(pair, sizeof(pair), current.data());
+    }
+    return current == root;
+  }
+
+private:
+  Concurrency::ThreadPool *pool_;
+  std::vector<Node> nodes_;
+  std::vector<size_t> levelOffsets_;
+  std::vector<size_t> levelSizes_;
+
+  // Size the single node buffer for every level up front
+  void layout(size_t leaves) {
+    levelOffsets_.clear();
+    levelSizes_.clear();
+    size_t total = 0;
+    for (size_t size = leaves; size > 0;) {
+      levelOffsets_.push_back(total);
+      levelSizes_.push_back(size);
+      total += size;
+      size = (size == 1) ? 0 : (size + 1) / 2;
+    }
+    nodes_.assign(total, Node{});
+  }
+
+  template <typename Fn> void forRange(size_t count, Fn &&fn) {
+    if (pool_ && count > PARALLEL_GRAIN) {
+      pool_->parallelFor(count, PARALLEL_GRAIN, fn);
+    } else {
+      fn(0, count);
+    }
+  }
+
+  // Parent i = H(child 2i || child 2i+1); children are adjacent in the
+  // buffer, so each pair is hashed in place. An odd tail pairs with itself.
+  void hashLevels() {
+    static_assert(sizeof(Node) == Crypto::Sha512::DIGEST_SIZE,
+                  "nodes must be densely packed");
+    for (size_t level = 0; level + 1 < levelSizes_.size(); ++level) {
+      const Node *children = nodes_.data() + levelOffsets_[level];
+      Node *parents = nodes_.data() + levelOffsets_[level + 1];
+      size_t childCount = levelSizes_[level];
+      size_t parentCount = levelSizes_[level + 1];
+
+      forRange(parentCount, [&](size_t begin, size_t end) {
+        std::vector<std::string_view> pairs;
+        pairs.reserve(end - begin);
+        unsigned char oddPair[2 * Crypto::Sha512::DIGEST_SIZE];
+        for (size_t i = begin; i < end; ++i) {
+          const auto *left =
+              reinterpret_cast<const char *>(children[2 * i].data());
+          if (2 * i + 1 < childCount) {
+            pairs.emplace_back(left, 2 * sizeof(Node));
+          } else {
+            std::memcpy(oddPair, left, sizeof(Node));
+            std::memcpy(oddPair + sizeof(Node), left, sizeof(Node));
+            pairs.emplace_back(reinterpret_cast<const char *>(oddPair),
+                               sizeof(oddPair));
+          }
+        }
+        Crypto::Sha512::hashBatch(pairs.data(), pairs.size(), parents + begin);
+      });
+    }
+  }
+};
+
+// Incremental Merkle accumulator with the same tree shape as MerkleEngine
+// (odd tail paired with itself). append, replaceAt and removeTail touch only
+// the path from the changed leaf to the root: O(log n) hashes each.
+class IncrementalMerkleTree final {
+public:
+  using Node = MerkleEngine::Node;
+
+  void append(const Node &leaf) {
+    if (levels_.empty()) {
+      levels_.emplace_back();
+    }
+    levels_[0].push_back(leaf);
+    updatePath(levels_[0].size() - 1);
+  }
+
+  bool replaceAt(size_t index, const Node &leaf) {
+    if (index >= size()) {
+      return false;
+    }
+    levels_[0][index] = leaf;
+    updatePath(index);
+    return true;
+  }
+
+  bool removeTail() {
+    if (size() == 0) {
+      return false;
+    }
+    levels_[0].pop_back();
+    if (levels_[0].empty()) {
+      levels_.clear();
+    } else {
+      updatePath(levels_[0].size() - 1);
+    }
+    return true;
+  }
+
+  void clear() noexcept { levels_.clear(); }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return levels_.empty() ? 0 : levels_[0].size();
+  }
+
+  [[nodiscard]] const Node &leaf(size_t index) const noexcept {
+    return levels_[0][index];
+  }
+
+  // Current root (all-zero node when empty)
+  [[nodiscard]] Node root() const noexcept {
+    return levels_.empty() ? Node{} : levels_.back()[0];
+  }
+
+  [[nodiscard]] std::string rootHex() const {
+    return Crypto::Hashing::toHex(root());
+  }
+
+private:
+  std::vector<std::vector<Node>> levels_;
+
+  // Rehash ancestors of `index`, resizing each parent level to
+  // ceil(size / 2) so growth and shrinkage at the tail stay consistent
+  void updatePath(size_t index) {
+    unsigned char pair[2 * Crypto::Sha512::DIGEST_SIZE];
+    size_t level = 0;
+    while (levels_[level].size() > 1) {
+      if (levels_.size() == level + 1) {
+        levels_.emplace_back();
+      }
+      const auto &children = levels_[level];
+      size_t parent = index / 2;
+      size_t left = parent * 2;
+      size_t right = std::min(left + 1, children.size() - 1);
+
+      levels_[level + 1].resize((children.size() + 1) / 2);
+
+      std::memcpy(pair, children[left].data(), sizeof(Node));
+      std::memcpy(pair + sizeof(Node), children[right].data(), sizeof(Node));
+      Crypto::Sha512::hash(pair, sizeof(pair),
+                           levels_[level + 1][parent].data());
+      index = parent;
+      ++level;
+    }
+    levels_.resize(level + 1);
+  }
+};
+
 // Block Header structure (Bitcoin-like)
 struct BlockHeader {
   int version;
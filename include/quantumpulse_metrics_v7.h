@@ -2,28 +2,237 @@
 #define QUANTUMPULSE_METRICS_V7_H
 
 #include "quantumpulse_logging_v7.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <charconv>
 #include <chrono>
+#include <cmath>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace QuantumPulse::Metrics {
 
 // Metric types
 enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
 
-// Single metric
-struct Metric {
+// Updates are spread over this many cache-line-sized stripes. Each thread
+// sticks to one stripe, so threads rarely share a line; stripes are summed
+// only when scraped.
+constexpr size_t STRIPES = 16;
+
+namespace detail {
+
+// Stripe of the calling thread, assigned round-robin on first use
+inline size_t threadStripe() noexcept {
+  static std::atomic<size_t> next{0};
+  thread_local const size_t stripe =
+      next.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+  return stripe;
+}
+
+struct alignas(64) PaddedCounter {
+  std::atomic<uint64_t> value{0};
+};
+
+// Fixed log-linear buckets: values below 8 get their own bucket, then
+// each power of two is split into 8 equal sub-buckets (at most 12.5%
+// relative error). Values at or above 2^36 land in the last bucket.
+struct HistogramLayout {
+  static constexpr unsigned SUB_BITS = 3;
+  static constexpr uint64_t SUB = 1u << SUB_BITS;
+  static constexpr unsigned MAX_EXPONENT = 35;
+  static constexpr size_t BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB;
+
+  [[nodiscard]] static constexpr size_t index(uint64_t v) noexcept {
+    if (v < SUB) {
+      return static_cast<size_t>(v);
+    }
+    const unsigned e = static_cast<unsigned>(std::bit_width(v)) - 1;
+    if (e > MAX_EXPONENT) {
+      return BUCKETS - 1;
+    }
+    return (e - SUB_BITS + 1) * SUB + ((v >> (e - SUB_BITS)) & (SUB - 1));
+  }
+
+  // Largest value that maps to bucket `i`
+  [[nodiscard]] static constexpr uint64_t upperBound(size_t i) noexcept {
+    if (i < SUB) {
+      return i;
+    }
+    const unsigned e = static_cast<unsigned>(i / SUB) + SUB_BITS - 1;
+    const uint64_t width = uint64_t{1} << (e - SUB_BITS);
+    return (SUB + i % SUB) * width + width - 1;
+  }
+};
+
+struct alignas(64) HistogramStripe {
+  std::array<std::atomic<uint64_t>, HistogramLayout::BUCKETS> buckets{};
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sum{0};
+};
+
+// Prometheus label value escaping: backslash, double quote and newline
+inline void appendLabelValue(std::string &out, std::string_view value) {
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+}
+
+struct Entry {
   std::string name;
+  std::string labels; // Rendered label set, e.g. endpoint="blocks"
   std::string help;
   MetricType type;
-  std::atomic<double> value{0};
-  std::map<std::string, std::string> labels;
+  double scale{1.0}; // Histogram: exported value = observed value * scale
+
+  std::array<PaddedCounter, STRIPES> counter{};
+  alignas(64) std::atomic<double> gauge{0};
+  std::unique_ptr<HistogramStripe[]> histogram;
+};
+
+} // namespace detail
+
+// Handle to a registered counter; copying is cheap and a default handle
+// ignores updates
+class Counter {
+public:
+  Counter() noexcept = default;
+
+  void inc(uint64_t delta = 1) noexcept {
+    if (entry_) {
+      entry_->counter[detail::threadStripe()].value.fetch_add(
+          delta, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] uint64_t value() const noexcept {
+    uint64_t total = 0;
+    if (entry_) {
+      for (const auto &c : entry_->counter) {
+        total += c.value.load(std::memory_order_relaxed);
+      }
+    }
+    return total;
+  }
+
+private:
+  friend class PrometheusExporter;
+  explicit Counter(detail::Entry *entry) noexcept : entry_(entry) {}
+  detail::Entry *entry_{nullptr};
+};
+
+// Handle to a registered gauge
+class Gauge {
+public:
+  Gauge() noexcept = default;
+
+  void set(double value) noexcept {
+    if (entry_) {
+      entry_->gauge.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  void add(double delta) noexcept {
+    if (entry_) {
+      double current = entry_->gauge.load(std::memory_order_relaxed);
+      while (!entry_->gauge.compare_exchange_weak(
+          current, current + delta, std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  [[nodiscard]] double value() const noexcept {
+    return entry_ ? entry_->gauge.load(std::memory_order_relaxed) : 0;
+  }
+
+private:
+  friend class PrometheusExporter;
+  explicit Gauge(detail::Entry *entry) noexcept : entry_(entry) {}
+  detail::Entry *entry_{nullptr};
+};
+
+// Merged view of a histogram at one point in time
+struct HistogramSnapshot {
+  std::array<uint64_t, detail::HistogramLayout::BUCKETS> buckets{};
+  uint64_t count{0};
+  uint64_t sum{0};
+
+  // Upper bound of the bucket holding quantile q (0..1), in observed units
+  [[nodiscard]] uint64_t quantile(double q) const noexcept {
+    if (count == 0) {
+      return 0;
+    }
+    const auto rank = static_cast<uint64_t>(
+        std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        return detail::HistogramLayout::upperBound(i);
+      }
+    }
+    return detail::HistogramLayout::upperBound(buckets.size() - 1);
+  }
+};
+
+// Handle to a registered histogram of non-negative integer observations
+// (e.g. microseconds or bytes)
+class Histogram {
+public:
+  Histogram() noexcept = default;
+
+  void observe(uint64_t value) noexcept {
+    if (entry_) {
+      auto &stripe = entry_->histogram[detail::threadStripe()];
+      stripe.buckets[detail::HistogramLayout::index(value)].fetch_add(
+          1, std::memory_order_relaxed);
+      stripe.count.fetch_add(1, std::memory_order_relaxed);
+      stripe.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] HistogramSnapshot snapshot() const noexcept {
+    return merge(entry_);
+  }
+
+private:
+  friend class PrometheusExporter;
+  explicit Histogram(detail::Entry *entry) noexcept : entry_(entry) {}
+  detail::Entry *entry_{nullptr};
+
+  static HistogramSnapshot merge(const detail::Entry *entry) noexcept {
+    HistogramSnapshot snap;
+    if (!entry) {
+      return snap;
+    }
+    for (size_t s = 0; s < STRIPES; ++s) {
+      const auto &stripe = entry->histogram[s];
+      for (size_t i = 0; i < snap.buckets.size(); ++i) {
+        snap.buckets[i] += stripe.buckets[i].load(std::memory_order_relaxed);
+      }
+      snap.count += stripe.count.load(std::memory_order_relaxed);
+      snap.sum += stripe.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+  }
 };
 
-// Prometheus-compatible metrics exporter
+// Prometheus-compatible metrics registry. Register a metric once and keep
+// the returned handle: updates through a handle are lock-free. The
+// name-based methods are kept for convenience and take the registry lock.
 class PrometheusExporter final {
 public:
   PrometheusExporter() noexcept {
@@ -32,149 +241,339 @@ public:
         "Prometheus metrics exporter initialized", "Metrics", 0);
   }
 
+  PrometheusExporter(const PrometheusExporter &) = delete;
+  PrometheusExporter &operator=(const PrometheusExporter &) = delete;
+
+  // Render one label as name="value" with the value escaped, for the
+  // `labels` argument of counter(), gauge() and histogram()
+  [[nodiscard]] static std::string label(std::string_view name,
+                                         std::string_view value) {
+    std::string out(name);
+    out += "=\"";
+    detail::appendLabelValue(out, value);
+    out += '"';
+    return out;
+  }
+
+  // Register (or look up) a counter; `labels` is a rendered label set
+  Counter counter(const std::string &name, const std::string &help,
+                  const std::string &labels = "") {
+    return Counter(entry(name, labels, help, MetricType::COUNTER));
+  }
+
+  Gauge gauge(const std::string &name, const std::string &help,
+              const std::string &labels = "") {
+    return Gauge(entry(name, labels, help, MetricType::GAUGE));
+  }
+
+  // Observations are exported multiplied by `scale`, e.g. 1e-6 to record
+  // microseconds and expose seconds
+  Histogram histogram(const std::string &name, const std::string &help,
+                      double scale = 1.0, const std::string &labels = "") {
+    detail::Entry *e = entry(name, labels, help, MetricType::HISTOGRAM);
+    if (e) {
+      e->scale = scale;
+    }
+    return Histogram(e);
+  }
+
   // Register counter
   void registerCounter(const std::string &name,
                        const std::string &help) noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    metrics_[name] = {name, help, MetricType::COUNTER, {0}, {}};
+    try {
+      counter(name, help);
+    } catch (...) {
+    }
   }
 
   // Register gauge
   void registerGauge(const std::string &name,
                      const std::string &help) noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    metrics_[name] = {name, help, MetricType::GAUGE, {0}, {}};
+    try {
+      gauge(name, help);
+    } catch (...) {
+    }
   }
 
-  // Increment counter
-  void incrementCounter(const std::string &name, double delta = 1.0) noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = metrics_.find(name);
-    if (it != metrics_.end()) {
-      double current = it->second.value.load();
-      it->second.value.store(current + delta);
-    }
+  // Increment counter; unregistered names are ignored
+  void incrementCounter(const std::string &name, uint64_t delta = 1) noexcept {
+    Counter(find(name, MetricType::COUNTER)).inc(delta);
   }
 
   // Set gauge value
   void setGauge(const std::string &name, double value) noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = metrics_.find(name);
-    if (it != metrics_.end()) {
-      it->second.value.store(value);
-    }
+    Gauge(find(name, MetricType::GAUGE)).set(value);
   }
 
-  // Get metric value
+  // Get metric value (counter total or gauge)
   [[nodiscard]] double getMetricValue(const std::string &name) const noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = metrics_.find(name);
-    if (it != metrics_.end()) {
-      return it->second.value.load();
+    detail::Entry *e = find(name, MetricType::COUNTER);
+    if (e) {
+      return static_cast<double>(Counter(e).value());
     }
-    return 0;
+    return Gauge(find(name, MetricType::GAUGE)).value();
+  }
+
+  // Render every metric in the Prometheus text format into a per-thread
+  // buffer that is reused between calls. The view is valid until the
+  // calling thread's next scrape(); other threads never write to it.
+  [[nodiscard]] std::string_view scrape() const {
+    thread_local std::string buffer;
+    buffer.clear();
+    scrapeTo(buffer);
+    return buffer;
+  }
+
+  // Append the Prometheus text to `out` (e.g. an HTTP response body); safe
+  // from any number of threads
+  void scrapeTo(std::string &out) const {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    render(out);
   }
 
   // Export in Prometheus format
   [[nodiscard]] std::string exportMetrics() const noexcept {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
+    try {
+      std::string out;
+      scrapeTo(out);
+      return out;
+    } catch (...) {
+      return {};
+    }
+  }
 
-    std::stringstream ss;
+  // Update blockchain metrics
+  void updateBlockchainMetrics(int chainLength, double minedCoins,
+                               int activePeers, double hashrate) noexcept {
+    chainLength_.set(chainLength);
+    minedCoins_.set(minedCoins);
+    activePeers_.set(activePeers);
+    hashrate_.set(hashrate);
+  }
 
-    for (const auto &[name, metric] : metrics_) {
-      // HELP line
-      ss << "# HELP " << metric.name << " " << metric.help << "\n";
+  // Increment transaction counter
+  void recordTransaction() noexcept { transactions_.inc(); }
 
-      // TYPE line
-      ss << "# TYPE " << metric.name << " ";
-      switch (metric.type) {
-      case MetricType::COUNTER:
-        ss << "counter";
-        break;
-      case MetricType::GAUGE:
-        ss << "gauge";
-        break;
-      case MetricType::HISTOGRAM:
-        ss << "histogram";
-        break;
+  // Increment block counter
+  void recordBlock() noexcept { blocksMined_.inc(); }
+
+  // Record API request. Each endpoint's counter is registered on first
+  // use and cached in a lock-free table, so later requests only hash the
+  // name and bump a stripe. Endpoints past ENDPOINT_SLOTS count only
+  // towards the total.
+  void recordAPIRequest(std::string_view endpoint) noexcept {
+    apiRequests_.inc();
+    const size_t hash = std::hash<std::string_view>{}(endpoint);
+    for (size_t probe = 0; probe < ENDPOINT_SLOTS; ++probe) {
+      auto &slot = endpoints_[(hash + probe) % ENDPOINT_SLOTS];
+      const EndpointCounter *cached = slot.load(std::memory_order_acquire);
+      if (!cached && !(cached = addEndpoint(slot, endpoint))) {
+        return;
       }
-      ss << "\n";
-
-      // Value line
-      ss << metric.name;
-      if (!metric.labels.empty()) {
-        ss << "{";
-        bool first = true;
-        for (const auto &[k, v] : metric.labels) {
-          if (!first)
-            ss << ",";
-          ss << k << "=\"" << v << "\"";
-          first = false;
-        }
-        ss << "}";
+      if (cached->endpoint == endpoint) {
+        cached->counter.inc();
+        return;
       }
-      ss << " " << metric.value.load() << "\n\n";
     }
+  }
 
-    return ss.str();
+  // Record WebSocket connection
+  void recordWSConnection() noexcept { wsConnections_.inc(); }
+
+  static constexpr size_t ENDPOINT_SLOTS = 256;
+
+private:
+  struct EndpointCounter {
+    std::string endpoint;
+    mutable Counter counter;
+  };
+
+  mutable std::mutex metricsMutex_;
+  // Keyed by name + labels so a family's series are adjacent
+  std::map<std::string, std::unique_ptr<detail::Entry>> metrics_;
+
+  Gauge chainLength_, minedCoins_, activePeers_, hashrate_;
+  Counter transactions_, blocksMined_, apiRequests_, wsConnections_;
+
+  // Open-addressed by endpoint hash; a slot is written once, under
+  // endpointMutex_, and never cleared
+  std::array<std::atomic<const EndpointCounter *>, ENDPOINT_SLOTS>
+      endpoints_{};
+  std::mutex endpointMutex_;
+  std::vector<std::unique_ptr<EndpointCounter>> endpointStore_;
+
+  // Fill an empty slot with `endpoint`'s counter; returns whatever the slot
+  // holds afterwards (possibly another endpoint), or nullptr on failure
+  const EndpointCounter *
+  addEndpoint(std::atomic<const EndpointCounter *> &slot,
+              std::string_view endpoint) noexcept {
+    try {
+      std::lock_guard<std::mutex> lock(endpointMutex_);
+      if (auto *cached = slot.load(std::memory_order_relaxed)) {
+        return cached;
+      }
+      auto added = std::make_unique<EndpointCounter>();
+      added->endpoint = endpoint;
+      added->counter = counter("quantumpulse_api_endpoint_requests_total",
+                               "API requests by endpoint",
+                               label("endpoint", endpoint));
+      endpointStore_.push_back(std::move(added));
+      slot.store(endpointStore_.back().get(), std::memory_order_release);
+      return endpointStore_.back().get();
+    } catch (...) {
+      return nullptr;
+    }
   }
 
-  // Update blockchain metrics
-  void updateBlockchainMetrics(int chainLength, double minedCoins,
-                               int activePeers, double hashrate) noexcept {
-    setGauge("quantumpulse_chain_length", chainLength);
-    setGauge("quantumpulse_mined_coins_total", minedCoins);
-    setGauge("quantumpulse_active_peers", activePeers);
-    setGauge("quantumpulse_hashrate_mhs", hashrate);
+  detail::Entry *entry(const std::string &name, const std::string &labels,
+                       const std::string &help, MetricType type) {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    auto &slot = metrics_[name + '{' + labels];
+    if (!slot) {
+      slot = std::make_unique<detail::Entry>();
+      slot->name = name;
+      slot->labels = labels;
+      slot->help = help;
+      slot->type = type;
+      if (type == MetricType::HISTOGRAM) {
+        slot->histogram = std::make_unique<detail::HistogramStripe[]>(STRIPES);
+      }
+    }
+    return slot->type == type ? slot.get() : nullptr;
   }
 
-  // Increment transaction counter
-  void recordTransaction() noexcept {
-    incrementCounter("quantumpulse_transactions_total");
+  detail::Entry *find(const std::string &name, MetricType type) const noexcept {
+    try {
+      std::lock_guard<std::mutex> lock(metricsMutex_);
+      auto it = metrics_.find(name + '{');
+      return it != metrics_.end() && it->second->type == type
+                 ? it->second.get()
+                 : nullptr;
+    } catch (...) {
+      return nullptr;
+    }
   }
 
-  // Increment block counter
-  void recordBlock() noexcept {
-    incrementCounter("quantumpulse_blocks_mined_total");
+  // Caller holds metricsMutex_
+  void render(std::string &out) const {
+    const std::string *family = nullptr;
+    for (const auto &[key, e] : metrics_) {
+      if (!family || *family != e->name) {
+        family = &e->name;
+        out += "# HELP ";
+        out += e->name;
+        out += ' ';
+        out += e->help;
+        out += "\n# TYPE ";
+        out += e->name;
+        out += e->type == MetricType::COUNTER ? " counter\n"
+               : e->type == MetricType::GAUGE ? " gauge\n"
+                                              : " histogram\n";
+      }
+      switch (e->type) {
+      case MetricType::COUNTER:
+        sample(out, e->name, "", e->labels, "",
+               static_cast<double>(Counter(e.get()).value()));
+        break;
+      case MetricType::GAUGE:
+        sample(out, e->name, "", e->labels, "", Gauge(e.get()).value());
+        break;
+      case MetricType::HISTOGRAM:
+        histogramSamples(out, *e);
+        break;
+      }
+    }
   }
 
-  // Record API request
-  void recordAPIRequest(const std::string &endpoint) noexcept {
-    incrementCounter("quantumpulse_api_requests_total");
-    incrementCounter("quantumpulse_api_" + endpoint + "_total");
+  static void number(std::string &out, double v) {
+    char buf[32];
+    if (v == std::floor(v) && std::fabs(v) < 1e15) {
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf),
+                                    static_cast<int64_t>(v))
+                          .ptr);
+    } else {
+      // 12 significant digits hide scale rounding noise (1.5e-05, not
+      // 1.4999999999999999e-05)
+      out.append(buf, std::to_chars(buf, buf + sizeof(buf), v,
+                                    std::chars_format::general, 12)
+                          .ptr);
+    }
   }
 
-  // Record WebSocket connection
-  void recordWSConnection() noexcept {
-    incrementCounter("quantumpulse_ws_connections_total");
+  // name[suffix]{labels,extra} value
+  static void sample(std::string &out, std::string_view name,
+                     std::string_view suffix, std::string_view labels,
+                     std::string_view extra, double value) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra.empty()) {
+      out += '{';
+      out += labels;
+      if (!labels.empty() && !extra.empty()) {
+        out += ',';
+      }
+      out += extra;
+      out += '}';
+    }
+    out += ' ';
+    number(out, value);
+    out += '\n';
   }
 
-private:
-  mutable std::mutex metricsMutex_;
-  std::map<std::string, Metric> metrics_;
+  // Cumulative buckets at each power-of-two boundary, then +Inf
+  static void histogramSamples(std::string &out, const detail::Entry &e) {
+    const HistogramSnapshot snap = Histogram::merge(&e);
+    using Layout = detail::HistogramLayout;
+    uint64_t seen = 0;
+    std::string le;
+    for (size_t i = 0; i < Layout::BUCKETS - 1; ++i) {
+      seen += snap.buckets[i];
+      if ((i + 1) % Layout::SUB != 0) {
+        continue;
+      }
+      le = "le=\"";
+      number(le, static_cast<double>(Layout::upperBound(i)) * e.scale);
+      le += '"';
+      sample(out, e.name, "_bucket", e.labels, le,
+             static_cast<double>(seen));
+    }
+    sample(out, e.name, "_bucket", e.labels, "le=\"+Inf\"",
+           static_cast<double>(snap.count));
+    sample(out, e.name, "_sum", e.labels, "",
+           static_cast<double>(snap.sum) * e.scale);
+    sample(out, e.name, "_count", e.labels, "",
+           static_cast<double>(snap.count));
+  }
 
   void initializeMetrics() noexcept {
-    // Blockchain metrics
-    registerGauge("quantumpulse_chain_length",
-                  "Current blockchain length in blocks");
-    registerGauge("quantumpulse_mined_coins_total", "Total coins mined so far");
-    registerGauge("quantumpulse_active_peers", "Number of connected peers");
-    registerGauge("quantumpulse_hashrate_mhs", "Network hashrate in MH/s");
-    registerGauge("quantumpulse_difficulty", "Current mining difficulty");
-    registerGauge("quantumpulse_mempool_size",
-                  "Number of pending transactions");
-
-    // Counters
-    registerCounter("quantumpulse_transactions_total",
-                    "Total transactions processed");
-    registerCounter("quantumpulse_blocks_mined_total", "Total blocks mined");
-    registerCounter("quantumpulse_api_requests_total", "Total API requests");
-    registerCounter("quantumpulse_ws_connections_total",
-                    "Total WebSocket connections");
-
-    // Price
-    registerGauge("quantumpulse_price_usd", "Current QP price in USD");
-    setGauge("quantumpulse_price_usd", 600000);
+    try {
+      // Blockchain metrics
+      chainLength_ = gauge("quantumpulse_chain_length",
+                           "Current blockchain length in blocks");
+      minedCoins_ = gauge("quantumpulse_mined_coins_total",
+                          "Total coins mined so far");
+      activePeers_ =
+          gauge("quantumpulse_active_peers", "Number of connected peers");
+      hashrate_ =
+          gauge("quantumpulse_hashrate_mhs", "Network hashrate in MH/s");
+      gauge("quantumpulse_difficulty", "Current mining difficulty");
+      gauge("quantumpulse_mempool_size", "Number of pending transactions");
+
+      // Counters
+      transactions_ = counter("quantumpulse_transactions_total",
+                              "Total transactions processed");
+      blocksMined_ =
+          counter("quantumpulse_blocks_mined_total", "Total blocks mined");
+      apiRequests_ =
+          counter("quantumpulse_api_requests_total", "Total API requests");
+      wsConnections_ = counter("quantumpulse_ws_connections_total",
+                               "Total WebSocket connections");
+
+      // Price
+      gauge("quantumpulse_price_usd", "Current QP price in USD").set(600000);
+    } catch (...) {
+      // Handles stay inert
+    }
   }
 };
 
@@ -2,6 +2,7 @@
 #define QUANTUMPULSE_MINING_V7_H
 
 #include "quantumpulse_logging_v7.h"
+#include "quantumpulse_trace_v7.h"
 #include <atomic>
 #include <chrono>
 #include <cmath>
@@ -51,6 +52,7 @@ public:
     }
 
     // Simulate PoW mining
+    QP_TRACE_SCOPE("mining.pow", "mining");
     std::string target(difficulty, '0');
     auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -150,6 +152,13 @@ public:
     return std::max(reward, MiningConfig::MIN_REWARD);
   }
 
+  // Recompute the proof-of-work hash for a header and compare
+  [[nodiscard]] bool checkProofOfWork(const std::string &data, int nonce,
+                                      int shardId,
+                                      std::string_view hash) const noexcept {
+    return generateHash(data, nonce, shardId) == hash;
+  }
+
 private:
   std::atomic<int64_t> totalMinedCoins_;
   int currentDifficulty_;
@@ -165,7 +174,7 @@ private:
     std::string hashStr;
     hashStr.reserve(64);
     for (int i = 0; i < 64; ++i) {
-      hashStr += "0123456789abcdef"[(hash >> (i % 16)) & 0xF];
+      hashStr += "0123456789abcdef"[(hash >> (4 * (i % 16))) & 0xF];
     }
     return hashStr;
   }
@@ -4,6 +4,7 @@
 #include "quantumpulse_logging_v7.h"
 #include <algorithm>
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <string>
 #include <string_view>
@@ -21,6 +22,11 @@ struct NetworkConfig {
 // Thread-safe network manager
 class NetworkManager final {
 public:
+  // Performs the sync against the known peers ("host:port"); installed
+  // by the node, e.g. running a Network::HeadersFirstSync
+  using SyncHandler = std::function<void(const std::vector<std::string> &,
+                                         int shardId)>;
+
   NetworkManager() noexcept : peerCount_(0), isSyncing_(false) {
     Logging::Logger::getInstance().info(
         "NetworkManager initialized - P2P with TLS 1.3 ready", "Network", 0);
@@ -50,22 +56,41 @@ public:
         "Network", shardId);
   }
 
-  // Sync chain with network
-  void syncChain(int shardId) noexcept {
+  void setSyncHandler(SyncHandler handler) noexcept {
     std::lock_guard<std::mutex> lock(networkMutex_);
+    syncHandler_ = std::move(handler);
+  }
 
-    if (isSyncing_.load(std::memory_order_relaxed)) {
+  // Sync chain with network. Blocks until the handler returns; concurrent
+  // calls while a sync is running return immediately.
+  void syncChain(int shardId) noexcept {
+    bool expected = false;
+    if (!isSyncing_.compare_exchange_strong(expected, true)) {
       return;
     }
 
-    isSyncing_.store(true, std::memory_order_relaxed);
+    SyncHandler handler;
+    std::vector<std::string> peers;
+    {
+      std::lock_guard<std::mutex> lock(networkMutex_);
+      handler = syncHandler_;
+      peers = peers_;
+      syncCount_++;
+    }
 
     Logging::Logger::getInstance().info("Syncing chain for shard " +
                                             std::to_string(shardId),
                                         "Network", shardId);
-
-    syncCount_++;
-    isSyncing_.store(false, std::memory_order_relaxed);
+    if (handler) {
+      try {
+        handler(peers, shardId);
+      } catch (const std::exception &e) {
+        Logging::Logger::getInstance().error(
+            std::string("Chain sync failed: ") + e.what(), "Network",
+            shardId);
+      }
+    }
+    isSyncing_.store(false);
   }
 
   // Discover peers
@@ -130,6 +155,13 @@ public:
 
   [[nodiscard]] size_t getSyncCount() const noexcept { return syncCount_; }
 
+  [[nodiscard]] bool isSyncing() const noexcept { return isSyncing_.load(); }
+
+  [[nodiscard]] std::vector<std::string> getPeers() const {
+    std::lock_guard<std::mutex> lock(networkMutex_);
+    return peers_;
+  }
+
 private:
   std::vector<std::string> peers_;
   std::string lastBroadcast_;
@@ -137,6 +169,7 @@ private:
   std::atomic<bool> isSyncing_;
   size_t broadcastCount_{0};
   size_t syncCount_{0};
+  SyncHandler syncHandler_;
   mutable std::mutex networkMutex_;
 };
 
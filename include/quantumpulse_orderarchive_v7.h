@@ -0,0 +1,408 @@
+#ifndef QUANTUMPULSE_ORDERARCHIVE_V7_H
+#define QUANTUMPULSE_ORDERARCHIVE_V7_H
+
+#include "quantumpulse_logformat_v7.h"
+#include "quantumpulse_serialize_v7.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Order book archive (.qparc): finished orders and executed trades,
+// appended by the book's archiver thread and queried by time range. An
+// order is filed under the time it finished, a trade under the time it
+// executed.
+//
+//   file    := "QPAR" u16 version u16 reserved segment*
+//   segment := u8 kind, varint rows, zigzag minTs, zigzag maxTs,
+//              varint bodyLen, body
+//   body    := column*                  (each: varint len, bytes)
+//
+// A segment holds up to SEGMENT_ROWS rows of one kind stored column by
+// column, numbers and prices as zigzag deltas from the previous row, so
+// a query skips every segment outside its [minTs, maxTs] without
+// decoding it. Timestamps are milliseconds since the epoch; an order's
+// finish time is stored as a zigzag offset from its placement time.
+namespace QuantumPulse::Trading::Archive {
+
+constexpr char MAGIC[4] = {'Q', 'P', 'A', 'R'};
+constexpr uint16_t VERSION = 2;
+constexpr size_t HEADER_BYTES = sizeof(MAGIC) + 4;
+constexpr size_t SEGMENT_ROWS = 4096;
+constexpr size_t MAX_SEGMENT_HEADER = 1 + 4 * 10; // u8 and four varints
+
+enum class SegmentKind : uint8_t { ORDERS = 1, TRADES = 2 };
+
+// Enum fields hold the numeric OrderSide / OrderType / OrderStatus. An
+// OPEN or PARTIAL row is an order still resting when the book shut down.
+struct OrderRow {
+  uint64_t number{0}; // "ord_N"
+  std::string userId;
+  uint8_t side{0};
+  uint8_t type{0};
+  uint8_t status{0};
+  int64_t price{0}; // Ticks
+  int64_t quantity{0}; // Lots
+  int64_t filled{0};
+  int64_t timestamp{0}; // Placement time
+  int64_t finished{0};  // Filled, cancelled or book shut down; indexed
+};
+
+struct TradeRow {
+  uint64_t number{0}; // "trd_N"
+  uint64_t buyOrder{0};
+  uint64_t sellOrder{0};
+  int64_t price{0};
+  int64_t quantity{0};
+  int64_t timestamp{0};
+};
+
+inline void putHeader(std::string &out) {
+  out.append(MAGIC, sizeof(MAGIC));
+  Serialize::putU16(out, VERSION);
+  Serialize::putU16(out, 0);
+}
+
+// What recover() found in an existing archive
+struct Tail {
+  bool usable{false};    // Absent, empty, or an archive of this version
+  uint64_t bytes{0};     // End of the last complete segment
+  uint64_t dropped{0};   // Bytes of a torn final segment that were cut off
+  uint64_t lastOrder{0}; // Highest order and trade numbers archived
+  uint64_t lastTrade{0};
+};
+
+// Check the archive at `path` before appending to it. Walks the segment
+// headers, decoding only each segment's number column, and cuts off a
+// final segment torn by a crash mid-write so new segments start on a
+// boundary and numbering continues past everything already archived.
+inline Tail recover(const std::string &path) noexcept {
+  Tail tail;
+  try {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+      tail.usable = !ec;
+      return tail;
+    }
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+      return tail;
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::string buf;
+    auto readAt = [&](uint64_t offset, uint64_t n) {
+      buf.resize(static_cast<size_t>(std::min(n, size - offset)));
+      file.seekg(static_cast<std::streamoff>(offset));
+      file.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+      return static_cast<bool>(file);
+    };
+    std::string header;
+    putHeader(header);
+    if (!readAt(0, HEADER_BYTES) || header.compare(0, buf.size(), buf) != 0) {
+      return tail; // Not an archive of this version
+    }
+
+    uint64_t offset = size < HEADER_BYTES ? 0 : HEADER_BYTES;
+    tail.bytes = offset;
+    while (offset < size && readAt(offset, MAX_SEGMENT_HEADER)) {
+      Serialize::ByteReader in(buf);
+      uint8_t kind;
+      uint64_t rows, minTs, maxTs, length, columnLength;
+      using Logging::Binary::getVarint;
+      if (!in.u8(kind) || !getVarint(in, rows) || !getVarint(in, minTs) ||
+          !getVarint(in, maxTs) || !getVarint(in, length) ||
+          rows > SEGMENT_ROWS || length > size - offset - in.position() ||
+          (kind != static_cast<uint8_t>(SegmentKind::ORDERS) &&
+           kind != static_cast<uint8_t>(SegmentKind::TRADES))) {
+        break;
+      }
+      const uint64_t body = offset + in.position();
+      if (!readAt(body, std::min<uint64_t>(length, 10))) {
+        break;
+      }
+      Serialize::ByteReader lengthIn(buf);
+      if (!getVarint(lengthIn, columnLength) ||
+          columnLength > length - lengthIn.position() ||
+          !readAt(body + lengthIn.position(), columnLength)) {
+        break;
+      }
+      // Column 0 holds the row numbers as zigzag deltas
+      Serialize::ByteReader numbers(buf);
+      int64_t number = 0, highest = 0;
+      uint64_t v = 0, row = 0;
+      for (; row < rows && getVarint(numbers, v); ++row) {
+        number += Logging::Binary::unzigzag(v);
+        highest = std::max(highest, number);
+      }
+      if (row < rows) {
+        break;
+      }
+      auto &last = kind == static_cast<uint8_t>(SegmentKind::ORDERS)
+                       ? tail.lastOrder
+                       : tail.lastTrade;
+      last = std::max(last, static_cast<uint64_t>(highest));
+      offset = body + length;
+      tail.bytes = offset;
+    }
+    if (tail.bytes < size) {
+      file.close();
+      std::filesystem::resize_file(path, tail.bytes);
+      tail.dropped = size - tail.bytes;
+    }
+    tail.usable = true;
+  } catch (...) {
+    tail.usable = false;
+  }
+  return tail;
+}
+
+// Accumulates rows of one kind and encodes them as a segment
+class SegmentBuilder {
+public:
+  explicit SegmentBuilder(SegmentKind kind) noexcept : kind_(kind) {}
+
+  void add(const OrderRow &row) {
+    delta(0, static_cast<int64_t>(row.number));
+    delta(1, row.timestamp);
+    columns_[2].push_back(static_cast<char>(row.side | row.type << 1 |
+                                            row.status << 2));
+    delta(3, row.price);
+    Logging::Binary::putVarint(columns_[4],
+                               static_cast<uint64_t>(row.quantity));
+    Logging::Binary::putVarint(columns_[5], static_cast<uint64_t>(row.filled));
+    Logging::Binary::putVarint(columns_[6], row.userId.size());
+    columns_[6] += row.userId;
+    Logging::Binary::putVarint(
+        columns_[7], Logging::Binary::zigzag(row.finished - row.timestamp));
+    count(row.finished);
+  }
+
+  void add(const TradeRow &row) {
+    delta(0, static_cast<int64_t>(row.number));
+    delta(1, row.timestamp);
+    delta(2, static_cast<int64_t>(row.buyOrder));
+    delta(3, static_cast<int64_t>(row.sellOrder));
+    delta(4, row.price);
+    Logging::Binary::putVarint(columns_[5],
+                               static_cast<uint64_t>(row.quantity));
+    count(row.timestamp);
+  }
+
+  [[nodiscard]] size_t rows() const noexcept { return rows_; }
+
+  // Append the segment to `out` and start an empty one
+  void finish(std::string &out) {
+    if (rows_ == 0) {
+      return;
+    }
+    std::string body;
+    const size_t used =
+        kind_ == SegmentKind::ORDERS ? ORDER_COLUMNS : TRADE_COLUMNS;
+    for (const auto &column : std::span(columns_).first(used)) {
+      Logging::Binary::putVarint(body, column.size());
+      body += column;
+    }
+    Serialize::putU8(out, static_cast<uint8_t>(kind_));
+    Logging::Binary::putVarint(out, rows_);
+    Logging::Binary::putVarint(out, Logging::Binary::zigzag(minTs_));
+    Logging::Binary::putVarint(out, Logging::Binary::zigzag(maxTs_));
+    Logging::Binary::putVarint(out, body.size());
+    out += body;
+    *this = SegmentBuilder(kind_);
+  }
+
+private:
+  static constexpr size_t ORDER_COLUMNS = 8;
+  static constexpr size_t TRADE_COLUMNS = 6;
+  static constexpr size_t COLUMNS = ORDER_COLUMNS;
+
+  SegmentKind kind_;
+  size_t rows_{0};
+  int64_t minTs_{std::numeric_limits<int64_t>::max()};
+  int64_t maxTs_{std::numeric_limits<int64_t>::min()};
+  std::array<std::string, COLUMNS> columns_;
+  std::array<int64_t, COLUMNS> previous_{};
+
+  void delta(size_t column, int64_t value) {
+    Logging::Binary::putVarint(
+        columns_[column], Logging::Binary::zigzag(value - previous_[column]));
+    previous_[column] = value;
+  }
+
+  void count(int64_t timestamp) noexcept {
+    ++rows_;
+    minTs_ = std::min(minTs_, timestamp);
+    maxTs_ = std::max(maxTs_, timestamp);
+  }
+};
+
+// Decoder over a whole .qparc file
+class Reader {
+public:
+  explicit Reader(std::string_view data) noexcept : data_(data) {
+    Serialize::ByteReader in(data_);
+    std::string_view magic;
+    uint16_t version = 0, reserved = 0;
+    valid_ = in.view(magic, sizeof(MAGIC)) &&
+             magic == std::string_view(MAGIC, sizeof(MAGIC)) &&
+             in.u16(version) && version == VERSION && in.u16(reserved);
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return valid_; }
+
+  // Segments the last scan() passed over without decoding
+  [[nodiscard]] size_t segmentsSkipped() const noexcept { return skipped_; }
+
+  // Calls onOrder(const OrderRow &) for orders finished and
+  // onTrade(const TradeRow &) for trades executed in [from, to]. Returns
+  // false if the file is damaged or ends inside a segment (a node stopped
+  // mid-write); rows before that point are still delivered.
+  template <typename OnOrder, typename OnTrade>
+  bool scan(int64_t from, int64_t to, OnOrder &&onOrder, OnTrade &&onTrade) {
+    skipped_ = 0;
+    if (!valid_) {
+      return false;
+    }
+    Serialize::ByteReader in(data_);
+    std::string_view header;
+    in.view(header, sizeof(MAGIC) + 4);
+    while (!in.done()) {
+      uint8_t kind;
+      uint64_t rows, minTs, maxTs, length;
+      std::string_view body;
+      if (!in.u8(kind) || !varint(in, rows) || !varint(in, minTs) ||
+          !varint(in, maxTs) || !varint(in, length) ||
+          !in.view(body, length)) {
+        return false;
+      }
+      if (Logging::Binary::unzigzag(maxTs) < from ||
+          Logging::Binary::unzigzag(minTs) > to) {
+        ++skipped_;
+        continue;
+      }
+      bool ok = false;
+      if (kind == static_cast<uint8_t>(SegmentKind::ORDERS)) {
+        ok = orders(body, rows, from, to, onOrder);
+      } else if (kind == static_cast<uint8_t>(SegmentKind::TRADES)) {
+        ok = trades(body, rows, from, to, onTrade);
+      }
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  std::string_view data_;
+  bool valid_{false};
+  size_t skipped_{0};
+
+  static bool varint(Serialize::ByteReader &in, uint64_t &v) noexcept {
+    return Logging::Binary::getVarint(in, v);
+  }
+
+  // Split a body into `n` column readers
+  static bool columns(std::string_view body, size_t n,
+                      std::vector<Serialize::ByteReader> &out) {
+    Serialize::ByteReader in(body);
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t length;
+      std::string_view bytes;
+      if (!varint(in, length) || !in.view(bytes, length)) {
+        return false;
+      }
+      out.emplace_back(bytes);
+    }
+    return true;
+  }
+
+  static bool delta(Serialize::ByteReader &in, int64_t &value) noexcept {
+    uint64_t v;
+    if (!varint(in, v)) {
+      return false;
+    }
+    value += Logging::Binary::unzigzag(v);
+    return true;
+  }
+
+  static bool plain(Serialize::ByteReader &in, int64_t &value) noexcept {
+    uint64_t v;
+    if (!varint(in, v)) {
+      return false;
+    }
+    value = static_cast<int64_t>(v);
+    return true;
+  }
+
+  template <typename OnOrder>
+  static bool orders(std::string_view body, uint64_t rows, int64_t from,
+                     int64_t to, OnOrder &onOrder) {
+    std::vector<Serialize::ByteReader> col;
+    if (!columns(body, 8, col)) {
+      return false;
+    }
+    OrderRow row;
+    int64_t number = 0;
+    for (uint64_t i = 0; i < rows; ++i) {
+      uint8_t flags;
+      uint64_t length, age;
+      std::string_view user;
+      if (!delta(col[0], number) || !delta(col[1], row.timestamp) ||
+          !col[2].u8(flags) || !delta(col[3], row.price) ||
+          !plain(col[4], row.quantity) || !plain(col[5], row.filled) ||
+          !varint(col[6], length) || !col[6].view(user, length) ||
+          !varint(col[7], age)) {
+        return false;
+      }
+      row.finished = row.timestamp + Logging::Binary::unzigzag(age);
+      if (row.finished < from || row.finished > to) {
+        continue;
+      }
+      row.number = static_cast<uint64_t>(number);
+      row.side = flags & 1;
+      row.type = flags >> 1 & 1;
+      row.status = flags >> 2;
+      row.userId.assign(user);
+      onOrder(std::as_const(row));
+    }
+    return true;
+  }
+
+  template <typename OnTrade>
+  static bool trades(std::string_view body, uint64_t rows, int64_t from,
+                     int64_t to, OnTrade &onTrade) {
+    std::vector<Serialize::ByteReader> col;
+    if (!columns(body, 6, col)) {
+      return false;
+    }
+    TradeRow row;
+    int64_t number = 0, buy = 0, sell = 0;
+    for (uint64_t i = 0; i < rows; ++i) {
+      if (!delta(col[0], number) || !delta(col[1], row.timestamp) ||
+          !delta(col[2], buy) || !delta(col[3], sell) ||
+          !delta(col[4], row.price) || !plain(col[5], row.quantity)) {
+        return false;
+      }
+      if (row.timestamp < from || row.timestamp > to) {
+        continue;
+      }
+      row.number = static_cast<uint64_t>(number);
+      row.buyOrder = static_cast<uint64_t>(buy);
+      row.sellOrder = static_cast<uint64_t>(sell);
+      onTrade(std::as_const(row));
+    }
+    return true;
+  }
+};
+
+} // namespace QuantumPulse::Trading::Archive
+
+#endif // QUANTUMPULSE_ORDERARCHIVE_V7_H
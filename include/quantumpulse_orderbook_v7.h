@@ -2,14 +2,34 @@
 #define QUANTUMPULSE_ORDERBOOK_V7_H
 
 #include "quantumpulse_logging_v7.h"
+#include "quantumpulse_orderarchive_v7.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace QuantumPulse::Trading {
 
 // Order types
@@ -44,262 +64,1534 @@ struct Trade {
   int64_t timestamp;
 };
 
-// Order Book
-class OrderBook final {
+// Prices are whole ticks and quantities whole lots, so matching never
+// compares or accumulates floating point values
+using Ticks = int64_t;
+using Lots = int64_t;
+
+// Resting order handle: pool slot in the low 32 bits, slot generation in
+// the high 32. Reusing a slot bumps its generation, so a stale handle is
+// detected instead of cancelling someone else's order. 0 is never valid.
+using OrderHandle = uint64_t;
+
+// One execution against a resting (maker) order
+struct Fill {
+  uint64_t makerOrderId;
+  uint64_t takerOrderId;
+  OrderSide takerSide;
+  Ticks price; // Maker price
+  Lots quantity;
+  Lots makerRemaining; // 0 once the maker has left the book
+};
+
+struct SubmitResult {
+  OrderHandle handle{0}; // Non-zero if the remainder now rests
+  Lots filled{0};
+  Lots remaining{0}; // Resting (limit) or discarded (market)
+};
+
+// Price-time priority matching on integer prices. Orders live in a pool
+// and are chained into a FIFO per price level through intrusive links,
+// so fills pop the head of a level and cancels unlink in O(1) without
+// searching. Levels sit in ordered maps whose nodes never move, which
+// lets the best bid and ask be cached as plain pointers.
+// Not thread-safe; the owner serializes access.
+class MatchingEngine final {
 public:
-  OrderBook() noexcept {
-    Logging::Logger::getInstance().info("Order Book initialized", "Trading", 0);
+  explicit MatchingEngine(size_t reserveOrders = 1024) {
+    pool_.reserve(reserveOrders);
   }
 
-  // Place order
-  [[nodiscard]] std::string placeOrder(const std::string &userId,
-                                       OrderSide side, OrderType type,
-                                       double price, double quantity) noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
-
-    Order order;
-    order.orderId = "ord_" + std::to_string(nextOrderId_++);
-    order.userId = userId;
-    order.side = side;
-    order.type = type;
-    order.price = price;
-    order.quantity = quantity;
-    order.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-                          std::chrono::system_clock::now().time_since_epoch())
-                          .count();
-
-    orders_[order.orderId] = order;
+  MatchingEngine(const MatchingEngine &) = delete;
+  MatchingEngine &operator=(const MatchingEngine &) = delete;
 
+  // Match `quantity` against the opposite side, calling onFill(const
+  // Fill &) per execution, then rest any limit remainder. Market orders
+  // ignore `price` and never rest.
+  template <typename OnFill>
+  SubmitResult submit(uint64_t orderId, OrderSide side, OrderType type,
+                      Ticks price, Lots quantity, OnFill &&onFill) {
+    SubmitResult result;
+    const bool market = type == OrderType::MARKET;
+    Lots remaining = quantity;
     if (side == OrderSide::BUY) {
-      buyOrders_[price].push_back(order.orderId);
+      remaining = take(asks_, bestAsk_, orderId, side, remaining, onFill,
+                       [&](Ticks ask) { return market || ask <= price; });
+    } else {
+      remaining = take(bids_, bestBid_, orderId, side, remaining, onFill,
+                       [&](Ticks bid) { return market || bid >= price; });
+    }
+    result.filled = quantity - remaining;
+    result.remaining = remaining;
+    if (remaining > 0 && !market) {
+      result.handle = side == OrderSide::BUY
+                          ? rest(bids_, bestBid_, orderId, side, price,
+                                 remaining)
+                          : rest(asks_, bestAsk_, orderId, side, price,
+                                 remaining);
+    }
+    return result;
+  }
+
+  // Remove a resting order; returns the quantity it still had, or 0 if
+  // the handle is stale (filled, cancelled or never issued)
+  Lots cancel(OrderHandle handle) noexcept {
+    Node *node = resolve(handle);
+    if (!node) {
+      return 0;
+    }
+    const Lots remaining = node->remaining;
+    const uint32_t index = slotOf(handle);
+    if (node->side == OrderSide::BUY) {
+      unlink(bids_, bestBid_, index);
     } else {
-      sellOrders_[price].push_back(order.orderId);
+      unlink(asks_, bestAsk_, index);
+    }
+    return remaining;
+  }
+
+  // Remaining quantity of a resting order, 0 if the handle is stale
+  [[nodiscard]] Lots remaining(OrderHandle handle) const noexcept {
+    const Node *node = resolve(handle);
+    return node ? node->remaining : 0;
+  }
+
+  [[nodiscard]] std::optional<Ticks> bestBid() const noexcept {
+    return bestBid_ ? std::optional(bestBid_->price) : std::nullopt;
+  }
+
+  [[nodiscard]] std::optional<Ticks> bestAsk() const noexcept {
+    return bestAsk_ ? std::optional(bestAsk_->price) : std::nullopt;
+  }
+
+  // Calls visit(price, totalLots, orderCount) for up to `levels` levels,
+  // best first
+  template <typename Visit>
+  void forEachLevel(OrderSide side, size_t levels, Visit &&visit) const {
+    auto walk = [&](const auto &book) {
+      for (auto it = book.begin(); it != book.end() && levels > 0;
+           ++it, --levels) {
+        visit(it->first, it->second.total, it->second.count);
+      }
+    };
+    side == OrderSide::BUY ? walk(bids_) : walk(asks_);
+  }
+
+  // Total resting quantity at `price`, 0 if there is no such level
+  [[nodiscard]] Lots levelTotal(OrderSide side, Ticks price) const noexcept {
+    auto total = [&](const auto &book) {
+      auto it = book.find(price);
+      return it != book.end() ? it->second.total : Lots{0};
+    };
+    return side == OrderSide::BUY ? total(bids_) : total(asks_);
+  }
+
+  [[nodiscard]] size_t restingOrders() const noexcept { return resting_; }
+
+  [[nodiscard]] size_t levelCount(OrderSide side) const noexcept {
+    return side == OrderSide::BUY ? bids_.size() : asks_.size();
+  }
+
+private:
+  static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+  struct Level {
+    Ticks price{0};
+    Lots total{0};
+    uint32_t count{0};
+    uint32_t head{NIL};
+    uint32_t tail{NIL};
+  };
+
+  struct Node {
+    uint64_t orderId{0};
+    Lots remaining{0};
+    Level *level{nullptr}; // nullptr while the slot is free
+    uint32_t prev{NIL};
+    uint32_t next{NIL}; // Also links the free list
+    uint32_t generation{0};
+    OrderSide side{OrderSide::BUY};
+  };
+
+  // Bids best (highest) first, asks best (lowest) first
+  std::map<Ticks, Level, std::greater<>> bids_;
+  std::map<Ticks, Level> asks_;
+  Level *bestBid_{nullptr};
+  Level *bestAsk_{nullptr};
+  std::vector<Node> pool_;
+  uint32_t freeHead_{NIL};
+  size_t resting_{0};
+
+  static uint32_t slotOf(OrderHandle handle) noexcept {
+    return static_cast<uint32_t>(handle);
+  }
+
+  Node *resolve(OrderHandle handle) noexcept {
+    return const_cast<Node *>(std::as_const(*this).resolve(handle));
+  }
+
+  const Node *resolve(OrderHandle handle) const noexcept {
+    const uint32_t index = slotOf(handle);
+    if (index >= pool_.size()) {
+      return nullptr;
+    }
+    const Node &node = pool_[index];
+    if (!node.level ||
+        node.generation != static_cast<uint32_t>(handle >> 32)) {
+      return nullptr;
+    }
+    return &node;
+  }
+
+  uint32_t allocate() {
+    if (freeHead_ != NIL) {
+      const uint32_t index = freeHead_;
+      freeHead_ = pool_[index].next;
+      return index;
+    }
+    pool_.emplace_back();
+    return static_cast<uint32_t>(pool_.size() - 1);
+  }
+
+  void release(uint32_t index) noexcept {
+    Node &node = pool_[index];
+    node.level = nullptr;
+    ++node.generation;
+    node.next = freeHead_;
+    freeHead_ = index;
+    --resting_;
+  }
+
+  template <typename Book>
+  OrderHandle rest(Book &book, Level *&best, uint64_t orderId, OrderSide side,
+                   Ticks price, Lots quantity) {
+    const uint32_t index = allocate();
+    auto [it, inserted] = book.try_emplace(price);
+    Level &level = it->second;
+    if (inserted) {
+      level.price = price;
+      if (it == book.begin()) {
+        best = &level;
+      }
+    }
+    Node &node = pool_[index];
+    node.orderId = orderId;
+    node.remaining = quantity;
+    node.level = &level;
+    node.side = side;
+    node.prev = level.tail;
+    node.next = NIL;
+    if (level.tail != NIL) {
+      pool_[level.tail].next = index;
+    } else {
+      level.head = index;
+    }
+    level.tail = index;
+    level.total += quantity;
+    ++level.count;
+    ++resting_;
+    if (node.generation == 0) {
+      node.generation = 1;
+    }
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+  }
+
+  // Unlink and free a node, dropping its level once empty
+  template <typename Book>
+  void unlink(Book &book, Level *&best, uint32_t index) noexcept {
+    Node &node = pool_[index];
+    Level &level = *node.level;
+    if (node.prev != NIL) {
+      pool_[node.prev].next = node.next;
+    } else {
+      level.head = node.next;
+    }
+    if (node.next != NIL) {
+      pool_[node.next].prev = node.prev;
+    } else {
+      level.tail = node.prev;
+    }
+    level.total -= node.remaining;
+    --level.count;
+    release(index);
+    if (level.count == 0) {
+      const bool wasBest = &level == best;
+      book.erase(level.price);
+      if (wasBest) {
+        best = book.empty() ? nullptr : &book.begin()->second;
+      }
+    }
+  }
+
+  template <typename Book, typename OnFill, typename Crosses>
+  Lots take(Book &book, Level *&best, uint64_t takerId, OrderSide takerSide,
+            Lots remaining, OnFill &onFill, Crosses crosses) {
+    while (remaining > 0 && best && crosses(best->price)) {
+      const uint32_t index = best->head;
+      Node &maker = pool_[index];
+      const Lots qty = std::min(remaining, maker.remaining);
+      maker.remaining -= qty;
+      best->total -= qty;
+      remaining -= qty;
+      onFill(Fill{maker.orderId, takerId, takerSide, best->price, qty,
+                  maker.remaining});
+      if (maker.remaining == 0) {
+        unlink(book, best, index);
+      }
+    }
+    return remaining;
+  }
+};
+
+// Incremental market data. Every change to the book emits events with
+// consecutive sequence numbers: a LEVEL event carries the new total at
+// one price (0 = the level is gone), a TRADE event one execution.
+struct MarketEvent {
+  enum class Kind : uint8_t { LEVEL, TRADE };
+  uint64_t sequence{0};
+  Kind kind{Kind::LEVEL};
+  OrderSide side{OrderSide::BUY}; // LEVEL: book side; TRADE: taker side
+  Ticks price{0};
+  Lots quantity{0};
+  uint64_t buyOrder{0};  // TRADE only
+  uint64_t sellOrder{0}; // TRADE only
+  int64_t timestamp{0};
+};
+
+// Every price level at one point in the event stream
+struct BookSnapshot {
+  uint64_t sequence{0}; // Last event reflected
+  std::vector<std::pair<Ticks, Lots>> bids; // Best first
+  std::vector<std::pair<Ticks, Lots>> asks;
+};
+
+// Client-side copy of the book: load a snapshot, then apply the events
+// that follow it
+class L2Book final {
+public:
+  void load(const BookSnapshot &snapshot) {
+    sequence_ = snapshot.sequence;
+    bids_.clear();
+    asks_.clear();
+    for (const auto &[price, lots] : snapshot.bids) {
+      bids_[price] = lots;
     }
+    for (const auto &[price, lots] : snapshot.asks) {
+      asks_[price] = lots;
+    }
+  }
 
-    // Try to match
-    matchOrders();
+  // False on a sequence gap; the copy is stale and needs a new snapshot.
+  // Events the snapshot already covers are skipped.
+  bool apply(const MarketEvent &event) {
+    if (event.sequence <= sequence_) {
+      return true;
+    }
+    if (event.sequence != sequence_ + 1) {
+      return false;
+    }
+    sequence_ = event.sequence;
+    if (event.kind == MarketEvent::Kind::LEVEL) {
+      auto set = [&](auto &book) {
+        if (event.quantity > 0) {
+          book[event.price] = event.quantity;
+        } else {
+          book.erase(event.price);
+        }
+      };
+      event.side == OrderSide::BUY ? set(bids_) : set(asks_);
+    }
+    return true;
+  }
 
-    Logging::Logger::getInstance().info(
-        "Order placed: " + order.orderId + " " +
-            (side == OrderSide::BUY ? "BUY" : "SELL") + " " +
-            std::to_string(quantity) + " @ $" + std::to_string(price),
-        "Trading", 0);
+  [[nodiscard]] uint64_t sequence() const noexcept { return sequence_; }
+  [[nodiscard]] const std::map<Ticks, Lots, std::greater<>> &
+  bids() const noexcept {
+    return bids_;
+  }
+  [[nodiscard]] const std::map<Ticks, Lots> &asks() const noexcept {
+    return asks_;
+  }
+
+private:
+  uint64_t sequence_{0};
+  std::map<Ticks, Lots, std::greater<>> bids_;
+  std::map<Ticks, Lots> asks_;
+};
+
+// Open and recently finished orders as readers see them. The matcher is
+// the only writer. Orders and each user's open-order list are spread
+// over SHARDS shards, each behind its own shared_mutex; a reader holds
+// one shard only while copying an entry, so lookups never queue behind
+// the matcher's commands and delay it by at most that copy.
+class OrderIndex {
+public:
+  static constexpr size_t SHARDS = 64;
+
+  // Published order fields; prices in ticks, sizes in lots
+  struct Entry {
+    std::string userId;
+    OrderSide side{OrderSide::BUY};
+    OrderType type{OrderType::LIMIT};
+    OrderStatus status{OrderStatus::OPEN};
+    Ticks price{0};
+    Lots quantity{0};
+    Lots filled{0};
+    int64_t timestamp{0};
+  };
+
+  [[nodiscard]] std::optional<Entry> find(uint64_t number) const {
+    const OrderShard &shard = orderShard(number);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.orders.find(number);
+    return it != shard.orders.end() ? std::optional<Entry>(it->second)
+                                    : std::nullopt;
+  }
+
+  // Numbers of `userId`'s open orders, in no particular order
+  [[nodiscard]] std::vector<uint64_t>
+  openOrders(const std::string &userId) const {
+    const UserShard &shard = userShard(userId);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.open.find(userId);
+    return it != shard.open.end() ? it->second : std::vector<uint64_t>();
+  }
 
-    return order.orderId;
+  // Matcher side
+  void put(uint64_t number, const Entry &entry) {
+    OrderShard &shard = orderShard(number);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.orders.insert_or_assign(number, entry);
+  }
+
+  void update(uint64_t number, Lots filled, OrderStatus status) noexcept {
+    OrderShard &shard = orderShard(number);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.orders.find(number);
+    if (it != shard.orders.end()) {
+      it->second.filled = filled;
+      it->second.status = status;
+    }
+  }
+
+  void erase(uint64_t number) noexcept {
+    OrderShard &shard = orderShard(number);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.orders.erase(number);
+  }
+
+  // Append to the user's open list; returns the order's slot in it
+  size_t addOpen(const std::string &userId, uint64_t number) {
+    UserShard &shard = userShard(userId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto &list = shard.open[userId];
+    list.push_back(number);
+    return list.size() - 1;
+  }
+
+  // Swap-erase `slot` from the user's open list (empty lists are dropped);
+  // returns the number now in `slot`, or 0 if it was the last one
+  uint64_t removeOpen(const std::string &userId, size_t slot) noexcept {
+    UserShard &shard = userShard(userId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.open.find(userId);
+    if (it == shard.open.end() || slot >= it->second.size()) {
+      return 0;
+    }
+    auto &list = it->second;
+    const uint64_t moved = slot + 1 < list.size() ? list.back() : 0;
+    list[slot] = list.back();
+    list.pop_back();
+    if (list.empty()) {
+      shard.open.erase(it);
+    }
+    return moved;
+  }
+
+private:
+  struct alignas(64) OrderShard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint64_t, Entry> orders;
+  };
+
+  struct alignas(64) UserShard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, std::vector<uint64_t>> open;
+  };
+
+  std::array<OrderShard, SHARDS> orders_;
+  std::array<UserShard, SHARDS> users_;
+
+  OrderShard &orderShard(uint64_t number) noexcept {
+    return orders_[number % SHARDS];
+  }
+  const OrderShard &orderShard(uint64_t number) const noexcept {
+    return orders_[number % SHARDS];
+  }
+  UserShard &userShard(const std::string &userId) noexcept {
+    return users_[std::hash<std::string>{}(userId) % SHARDS];
+  }
+  const UserShard &userShard(const std::string &userId) const noexcept {
+    return users_[std::hash<std::string>{}(userId) % SHARDS];
+  }
+};
+
+// Order book with the string-keyed API used by the RPC and WebSocket
+// layers. Prices and quantities are rounded to the configured tick and
+// lot size on entry.
+//
+// A single matcher thread owns the MatchingEngine. placeOrder() and
+// cancelOrder() push a Command into a lock-free MPSC ring and wait for
+// the matcher to acknowledge it; the matcher applies commands in ring
+// order and stamps each with a sequence number, so the commands it
+// journals determine every fill and can be replayed into a fresh book.
+// Readers never take a lock the matcher needs: depth is published after
+// each batch of commands behind a seqlock and trades go to a fixed tape of
+// per-slot seqlocks. Order lookups read an OrderIndex the matcher updates
+// as it applies each command; it holds only open orders (listed by user)
+// and the last Config::recentOrders finished ones. With
+// Config::archivePath set, finished orders and every trade go to an
+// append-only archive file (quantumpulse_orderarchive_v7.h), so memory
+// stays flat however long the book runs. Market data subscribers take
+// getSnapshot() once and follow the MarketEvent ring with
+// readEvents()/waitForEvents().
+class OrderBook final {
+public:
+  static constexpr size_t COMMAND_CAPACITY = 16384;
+  static constexpr size_t DEPTH_LEVELS = 64; // Per side, for getDepth()
+  static constexpr size_t TAPE_CAPACITY = 4096; // For getRecentTrades()
+  static constexpr size_t EVENT_CAPACITY = 65536; // For readEvents()
+  static constexpr size_t ARCHIVE_CAPACITY = 16384; // Rows awaiting write
+  static constexpr auto ARCHIVE_SEAL_INTERVAL = std::chrono::seconds(1);
+
+  // SNAPSHOT is a query: never journaled and given no sequence number
+  struct Command {
+    enum class Kind : uint8_t { PLACE, CANCEL, SNAPSHOT };
+    Kind kind{Kind::PLACE};
+    OrderSide side{OrderSide::BUY};
+    OrderType type{OrderType::LIMIT};
+    Ticks price{0};
+    Lots quantity{0};
+    uint64_t order{0};     // CANCEL: number N of "ord_N"
+    int64_t timestamp{0};  // Stamped by the matcher when 0
+    uint64_t sequence{0};  // Assigned by the matcher
+    std::string userId;
+  };
+
+  struct Config {
+    double tickSize{0.01};
+    double lotSize{1e-8};
+    int matcherCpu{-1}; // Pin the matcher thread to this CPU; -1 = no pin
+    // Runs on the matcher thread for every command, in the order applied,
+    // and must not throw. replay() of the same commands into a new book
+    // reproduces this one.
+    std::function<void(const Command &)> journal;
+    // Finished orders getOrder() still answers for, newest kept
+    size_t recentOrders{65536};
+    // Append finished orders and trades to this file; "" = no archive.
+    // Order and trade numbers continue after the highest ones in it.
+    std::string archivePath;
+  };
+
+  OrderBook() noexcept : OrderBook(Config{}) {}
+
+  explicit OrderBook(Config config) noexcept
+      : config_(std::move(config)),
+        recovered_(archiving() ? Archive::recover(config_.archivePath)
+                               : Archive::Tail{}),
+        commands_(COMMAND_CAPACITY),
+        tape_(std::make_unique<TapeSlot[]>(TAPE_CAPACITY)),
+        events_(std::make_unique<EventSlot[]>(EVENT_CAPACITY)),
+        tradeCount_(recovered_.lastTrade), orderCount_(recovered_.lastOrder),
+        archive_(archiving() ? ARCHIVE_CAPACITY : 0),
+        archiving_(archiving()),
+        archiver_(archiving() ? std::thread([this] { archiveLoop(); })
+                              : std::thread()),
+        matcher_([this] { run(); }) {
+    Logging::Logger::getInstance().info("Order Book initialized", "Trading", 0);
+  }
+
+  ~OrderBook() {
+    stopping_.store(true, std::memory_order_release);
+    wakeMatcher(true);
+    matcher_.join();
+    if (archiver_.joinable()) {
+      // Orders still resting are archived as they stand, so the archive
+      // holds every order number this book handed out
+      const int64_t now = nowMs();
+      for (const auto &[number, record] : open_) {
+        archiveOrder(number, record, now);
+      }
+      {
+        std::lock_guard<std::mutex> lock(archiveMutex_);
+        archiving_ = false;
+      }
+      archiveWake_.notify_one();
+      archiver_.join();
+    }
+  }
+
+  OrderBook(const OrderBook &) = delete;
+  OrderBook &operator=(const OrderBook &) = delete;
+
+  // Place order; returns "" if the quantity (or a limit price) rounds to
+  // zero. Market orders fill what they can and discard the rest.
+  [[nodiscard]] std::string placeOrder(const std::string &userId,
+                                       OrderSide side, OrderType type,
+                                       double price, double quantity) noexcept {
+    try {
+      Command cmd;
+      cmd.kind = Command::Kind::PLACE;
+      cmd.side = side;
+      cmd.type = type;
+      cmd.price = type == OrderType::LIMIT ? toTicks(price) : 0;
+      cmd.quantity = toLots(quantity);
+      cmd.userId = userId;
+      Completion done;
+      execute(std::move(cmd), done);
+      return done.order ? orderIdOf(done.order) : std::string();
+    } catch (...) {
+      return {};
+    }
   }
 
   // Cancel order
   bool cancelOrder(const std::string &orderId,
                    const std::string &userId) noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
-
-    auto it = orders_.find(orderId);
-    if (it == orders_.end())
+    const uint64_t number = numberOf(orderId);
+    if (!number) {
       return false;
-    if (it->second.userId != userId)
+    }
+    try {
+      Command cmd;
+      cmd.kind = Command::Kind::CANCEL;
+      cmd.order = number;
+      cmd.userId = userId;
+      Completion done;
+      execute(std::move(cmd), done);
+      return done.ok;
+    } catch (...) {
       return false;
-    if (it->second.status != OrderStatus::OPEN &&
-        it->second.status != OrderStatus::PARTIAL)
+    }
+  }
+
+  // Apply a journaled command, keeping its timestamp; true if accepted
+  bool replay(const Command &command) noexcept {
+    try {
+      Command cmd = command;
+      cmd.sequence = 0;
+      Completion done;
+      execute(std::move(cmd), done);
+      return done.ok;
+    } catch (...) {
       return false;
+    }
+  }
 
-    it->second.status = OrderStatus::CANCELLED;
-    removeFromBook(it->second);
+  // Full book at an exact event sequence. Served by the matcher between
+  // commands, so it costs one pass over the levels; take it once and
+  // follow with readEvents().
+  [[nodiscard]] BookSnapshot getSnapshot() noexcept {
+    BookSnapshot snapshot;
+    Command cmd;
+    cmd.kind = Command::Kind::SNAPSHOT;
+    Completion done;
+    done.snapshot = &snapshot;
+    execute(std::move(cmd), done);
+    return snapshot;
+  }
 
-    Logging::Logger::getInstance().info("Order cancelled: " + orderId,
-                                        "Trading", 0);
+  // Append events with sequence > `after` to `out`, at most `max`.
+  // False if some were already overwritten; reload a snapshot.
+  bool readEvents(uint64_t after, std::vector<MarketEvent> &out,
+                  size_t max = EVENT_CAPACITY) const {
+    const uint64_t latest = eventCount_.load(std::memory_order_acquire);
+    if (latest > after + EVENT_CAPACITY) {
+      return false;
+    }
+    const uint64_t end = std::min<uint64_t>(latest, after + max);
+    for (uint64_t n = after + 1; n <= end; ++n) {
+      const EventSlot &slot = events_[(n - 1) % EVENT_CAPACITY];
+      const uint64_t version = slot.version.load(std::memory_order_acquire);
+      MarketEvent event;
+      event.sequence = n;
+      event.kind = static_cast<MarketEvent::Kind>(
+          slot.kind.load(std::memory_order_relaxed));
+      event.side =
+          static_cast<OrderSide>(slot.side.load(std::memory_order_relaxed));
+      event.price = slot.price.load(std::memory_order_relaxed);
+      event.quantity = slot.quantity.load(std::memory_order_relaxed);
+      event.buyOrder = slot.buyOrder.load(std::memory_order_relaxed);
+      event.sellOrder = slot.sellOrder.load(std::memory_order_relaxed);
+      event.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version != 2 * n ||
+          slot.version.load(std::memory_order_relaxed) != version) {
+        return false; // Lapped while reading
+      }
+      out.push_back(event);
+    }
     return true;
   }
 
-  // Get order
+  // Sequence number of the newest market event
+  [[nodiscard]] uint64_t getEventSequence() const noexcept {
+    return eventCount_.load(std::memory_order_acquire);
+  }
+
+  // Block until there are events past `after` or wakeEventWaiters() is
+  // called; returns the newest event sequence. A waiter that stops on a
+  // flag passes it as `running`: it is checked after the epoch is read,
+  // so clearing it and then calling wakeEventWaiters() always wakes the
+  // waiter, even when it has not started waiting yet.
+  uint64_t waitForEvents(uint64_t after,
+                         const std::atomic<bool> *running = nullptr) const
+      noexcept {
+    const uint32_t epoch = eventEpoch_.load(std::memory_order_acquire);
+    const uint64_t latest = eventCount_.load(std::memory_order_acquire);
+    if (latest > after || (running && !running->load())) {
+      return latest;
+    }
+    eventEpoch_.wait(epoch, std::memory_order_acquire);
+    return eventCount_.load(std::memory_order_acquire);
+  }
+
+  void wakeEventWaiters() noexcept {
+    eventEpoch_.fetch_add(1, std::memory_order_release);
+    eventEpoch_.notify_all();
+  }
+
+  // Open or recently finished order (Config::recentOrders); nullopt for
+  // anything older, which only the archive still holds
   [[nodiscard]] std::optional<Order>
   getOrder(const std::string &orderId) const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
-    auto it = orders_.find(orderId);
-    return it != orders_.end() ? std::optional(it->second) : std::nullopt;
+    std::optional<Order> found;
+    const uint64_t number = numberOf(orderId);
+    if (!number) {
+      return found;
+    }
+    try {
+      if (auto entry = index_.find(number)) {
+        found = toOrder(number, *entry);
+      }
+    } catch (...) {
+      found.reset();
+    }
+    return found;
   }
 
-  // Get user orders
+  // Open orders of `userId`, oldest first. An order that finishes while
+  // the list is read is left out.
   [[nodiscard]] std::vector<Order>
   getUserOrders(const std::string &userId) const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
     std::vector<Order> result;
-    for (const auto &[id, order] : orders_) {
-      if (order.userId == userId) {
-        result.push_back(order);
+    try {
+      std::vector<uint64_t> numbers = index_.openOrders(userId);
+      std::sort(numbers.begin(), numbers.end());
+      result.reserve(numbers.size());
+      for (uint64_t number : numbers) {
+        auto entry = index_.find(number);
+        if (entry && (entry->status == OrderStatus::OPEN ||
+                      entry->status == OrderStatus::PARTIAL)) {
+          result.push_back(toOrder(number, *entry));
+        }
       }
+    } catch (...) {
+      result.clear();
     }
     return result;
   }
 
-  // Get order book depth
+  // Block until every order finished and trade executed so far is in the
+  // archive file; returns at once without Config::archivePath
+  void flushArchive() noexcept {
+    if (!archiving()) {
+      return;
+    }
+    try {
+      const size_t target = archive_.pushed();
+      std::unique_lock<std::mutex> lock(archiveMutex_);
+      archiveUrgent_ = true;
+      archiveWake_.notify_one();
+      archiveFlushed_.wait(
+          lock, [&] { return archived_ >= target || !archiving_; });
+    } catch (...) {
+      // Silent fail
+    }
+  }
+
+  // Get order book depth as (price, quantity), best level first; at most
+  // DEPTH_LEVELS per side
   [[nodiscard]] std::pair<std::vector<std::pair<double, double>>,
                           std::vector<std::pair<double, double>>>
   getDepth(int levels = 10) const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
-
     std::vector<std::pair<double, double>> bids, asks;
+    if (levels <= 0) {
+      return {bids, asks};
+    }
+    const DepthView view = readDepth();
+    const auto n = static_cast<size_t>(levels);
+    for (size_t i = 0; i < std::min<size_t>(n, view.bidLevels); ++i) {
+      bids.emplace_back(fromTicks(view.bids[i].first),
+                        fromLots(view.bids[i].second));
+    }
+    for (size_t i = 0; i < std::min<size_t>(n, view.askLevels); ++i) {
+      asks.emplace_back(fromTicks(view.asks[i].first),
+                        fromLots(view.asks[i].second));
+    }
+    return {bids, asks};
+  }
 
-    // Best bids (highest prices first)
-    int count = 0;
-    for (auto it = buyOrders_.rbegin();
-         it != buyOrders_.rend() && count < levels; ++it, ++count) {
-      double totalQty = 0;
-      for (const auto &orderId : it->second) {
-        auto orderIt = orders_.find(orderId);
-        if (orderIt != orders_.end() &&
-            orderIt->second.status == OrderStatus::OPEN) {
-          totalQty += orderIt->second.remainingQuantity();
-        }
+  // Get the last `count` trades executed at or after `since` (ms since the
+  // epoch), oldest first. The tape holds the last TAPE_CAPACITY trades;
+  // older ones are only in the archive.
+  [[nodiscard]] std::vector<Trade>
+  getRecentTrades(int count = 50, int64_t since = 0) const noexcept {
+    std::vector<Trade> result;
+    const uint64_t total = tradeCount_.load(std::memory_order_acquire);
+    const uint64_t oldest = total - std::min<uint64_t>(total, TAPE_CAPACITY);
+    const auto n = static_cast<size_t>(std::max(0, count));
+    result.reserve(std::min<uint64_t>(n, total - oldest));
+    // Newest first; the tape is in execution order, so the walk stops at
+    // the first trade older than `since`
+    for (uint64_t t = total; t > oldest && result.size() < n; --t) {
+      const TapeSlot &slot = tape_[(t - 1) % TAPE_CAPACITY];
+      const uint64_t version = slot.version.load(std::memory_order_acquire);
+      if (version != 2 * t) {
+        break; // Overwritten by a newer trade, and so is everything older
       }
-      if (totalQty > 0)
-        bids.emplace_back(it->first, totalQty);
+      Trade trade{"trd_" + std::to_string(t),
+                  orderIdOf(slot.buyOrder.load(std::memory_order_relaxed)),
+                  orderIdOf(slot.sellOrder.load(std::memory_order_relaxed)),
+                  fromTicks(slot.price.load(std::memory_order_relaxed)),
+                  fromLots(slot.quantity.load(std::memory_order_relaxed)),
+                  slot.timestamp.load(std::memory_order_relaxed)};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.version.load(std::memory_order_relaxed) != version) {
+        break;
+      }
+      if (trade.timestamp < since) {
+        break;
+      }
+      result.push_back(std::move(trade));
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+  // Get best bid/ask (0 for an empty side)
+  [[nodiscard]] std::pair<double, double> getBestBidAsk() const noexcept {
+    const DepthView view = readDepth();
+    return {view.bidLevels ? fromTicks(view.bids[0].first) : 0,
+            view.askLevels ? fromTicks(view.asks[0].first) : 0};
+  }
+
+  // Stats
+  [[nodiscard]] size_t getOpenOrderCount() const noexcept {
+    return readDepth().openOrders;
+  }
+
+  // Trades executed, counting those already in Config::archivePath
+  [[nodiscard]] size_t getTradeCount() const noexcept {
+    return tradeCount_.load(std::memory_order_acquire);
+  }
+
+  // Sequence number of the last command reflected in getDepth()
+  [[nodiscard]] uint64_t getSequence() const noexcept {
+    return readDepth().sequence;
+  }
+
+  [[nodiscard]] Ticks toTicks(double price) const noexcept {
+    return std::llround(price / config_.tickSize);
+  }
+  [[nodiscard]] Lots toLots(double quantity) const noexcept {
+    return std::llround(quantity / config_.lotSize);
+  }
+  [[nodiscard]] double fromTicks(Ticks ticks) const noexcept {
+    return static_cast<double>(ticks) * config_.tickSize;
+  }
+  [[nodiscard]] double fromLots(Lots lots) const noexcept {
+    return static_cast<double>(lots) * config_.lotSize;
+  }
+
+private:
+  static constexpr size_t BATCH = 256; // Commands per depth publication
+
+  // Open order N ("ord_N"); matcher thread only
+  struct Record : OrderIndex::Entry {
+    OrderHandle handle{0};
+    size_t userSlot{0}; // Position in the user's OrderIndex open list
+  };
+
+  // One row on its way to the archiver
+  struct ArchiveItem {
+    Archive::SegmentKind kind{Archive::SegmentKind::ORDERS};
+    Archive::OrderRow order;
+    Archive::TradeRow trade;
+  };
+
+  // Trade N lives in slot (N - 1) % TAPE_CAPACITY; version is 2N - 1
+  // while the matcher writes it and 2N once complete
+  struct TapeSlot {
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint64_t> buyOrder{0};
+    std::atomic<uint64_t> sellOrder{0};
+    std::atomic<Ticks> price{0};
+    std::atomic<Lots> quantity{0};
+    std::atomic<int64_t> timestamp{0};
+  };
+
+  // Event N lives in slot (N - 1) % EVENT_CAPACITY, versioned like the
+  // trade tape
+  struct EventSlot {
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint8_t> kind{0};
+    std::atomic<uint8_t> side{0};
+    std::atomic<Ticks> price{0};
+    std::atomic<Lots> quantity{0};
+    std::atomic<uint64_t> buyOrder{0};
+    std::atomic<uint64_t> sellOrder{0};
+    std::atomic<int64_t> timestamp{0};
+  };
+
+  // Top of book, rewritten after each batch; odd version = being written
+  struct DepthSnapshot {
+    std::atomic<uint64_t> version{0};
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> openOrders{0};
+    std::atomic<uint32_t> bidLevels{0};
+    std::atomic<uint32_t> askLevels{0};
+    std::array<std::atomic<Ticks>, DEPTH_LEVELS> bidPrice{};
+    std::array<std::atomic<Lots>, DEPTH_LEVELS> bidLots{};
+    std::array<std::atomic<Ticks>, DEPTH_LEVELS> askPrice{};
+    std::array<std::atomic<Lots>, DEPTH_LEVELS> askLots{};
+  };
+
+  // Consistent copy of a DepthSnapshot
+  struct DepthView {
+    uint64_t sequence{0};
+    uint64_t openOrders{0};
+    uint32_t bidLevels{0};
+    uint32_t askLevels{0};
+    std::array<std::pair<Ticks, Lots>, DEPTH_LEVELS> bids;
+    std::array<std::pair<Ticks, Lots>, DEPTH_LEVELS> asks;
+  };
+
+  // Filled in by the matcher before `done` is set, then left alone
+  struct Completion {
+    std::atomic<bool> done{false};
+    uint64_t order{0}; // PLACE: order number, 0 if rejected
+    bool ok{false};
+    BookSnapshot *snapshot{nullptr}; // SNAPSHOT: filled by the matcher
+  };
+
+  struct Pending {
+    Command command;
+    Completion *completion{nullptr};
+  };
+
+  const Config config_;
+  const Archive::Tail recovered_; // Existing archive, checked on open
+  Logging::MpscRing<Pending> commands_;
+  std::unique_ptr<TapeSlot[]> tape_;
+  std::unique_ptr<EventSlot[]> events_;
+  DepthSnapshot depth_;
+  alignas(64) std::atomic<uint64_t> tradeCount_;
+  std::atomic<uint64_t> eventCount_{0};
+  std::atomic<uint32_t> eventEpoch_{0};
+  alignas(64) std::atomic<uint64_t> acked_{0}; // Batches acknowledged
+  alignas(64) std::atomic<uint32_t> wakeups_{0};
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> stopping_{false};
+
+  // Matcher thread only
+  MatchingEngine engine_{4096}; // Initial pool; grows on demand
+  uint64_t sequence_{0};
+  uint64_t orderCount_;
+  uint64_t announced_{0}; // Events covered by the last epoch bump
+  std::vector<std::pair<OrderSide, Ticks>> touched_; // Levels this command
+  std::unordered_map<uint64_t, Record> open_;
+  std::vector<uint64_t> finishedRing_; // Finished orders left in index_
+  size_t finishedHead_{0};
+
+  OrderIndex index_; // Written by the matcher, read by anyone
+
+  // Archiver thread; the matcher is the only producer
+  Logging::MpscRing<ArchiveItem> archive_;
+  std::mutex archiveMutex_; // Guards the fields below
+  std::condition_variable archiveWake_;
+  std::condition_variable archiveFlushed_;
+  bool archiving_;
+  bool archiveUrgent_{false};
+  size_t archived_{0}; // Rows popped and written to the file
+
+  std::thread archiver_;
+  std::thread matcher_; // Last: starts once everything above exists
+
+  bool archiving() const noexcept { return !config_.archivePath.empty(); }
+
+  static int64_t nowMs() noexcept {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  static std::string orderIdOf(uint64_t number) {
+    return "ord_" + std::to_string(number);
+  }
+
+  // N for a well-formed "ord_N", else 0; the matcher checks it exists
+  static uint64_t numberOf(const std::string &orderId) noexcept {
+    if (orderId.size() <= 4 || orderId.size() > 4 + 18 ||
+        orderId.compare(0, 4, "ord_") != 0) {
+      return 0;
+    }
+    uint64_t number = 0;
+    for (size_t i = 4; i < orderId.size(); ++i) {
+      const char c = orderId[i];
+      if (c < '0' || c > '9') {
+        return 0;
+      }
+      number = number * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return number;
+  }
+
+  Order toOrder(uint64_t number, const OrderIndex::Entry &r) const {
+    Order order;
+    order.orderId = orderIdOf(number);
+    order.userId = r.userId;
+    order.side = r.side;
+    order.type = r.type;
+    order.price = fromTicks(r.price);
+    order.quantity = fromLots(r.quantity);
+    order.filled = fromLots(r.filled);
+    order.status = r.status;
+    order.timestamp = r.timestamp;
+    return order;
+  }
+
+  DepthView readDepth() const noexcept {
+    DepthView view;
+    while (true) {
+      const uint64_t version = depth_.version.load(std::memory_order_acquire);
+      if (version & 1) {
+        std::this_thread::yield(); // Matcher is mid-publish
+        continue;
+      }
+      constexpr auto relaxed = std::memory_order_relaxed;
+      view.sequence = depth_.sequence.load(relaxed);
+      view.openOrders = depth_.openOrders.load(relaxed);
+      view.bidLevels = std::min<uint32_t>(depth_.bidLevels.load(relaxed),
+                                          DEPTH_LEVELS);
+      view.askLevels = std::min<uint32_t>(depth_.askLevels.load(relaxed),
+                                          DEPTH_LEVELS);
+      for (uint32_t i = 0; i < view.bidLevels; ++i) {
+        view.bids[i] = {depth_.bidPrice[i].load(relaxed),
+                        depth_.bidLots[i].load(relaxed)};
+      }
+      for (uint32_t i = 0; i < view.askLevels; ++i) {
+        view.asks[i] = {depth_.askPrice[i].load(relaxed),
+                        depth_.askLots[i].load(relaxed)};
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (depth_.version.load(relaxed) == version) {
+        return view;
+      }
+    }
+  }
+
+  // Queue a command and wait until the matcher has applied it
+  void execute(Command &&cmd, Completion &completion) noexcept {
+    while (!commands_.tryPush([&](Pending &pending) {
+      pending.command = std::move(cmd);
+      pending.completion = &completion;
+    })) {
+      std::this_thread::yield(); // Ring full; the matcher is behind
+    }
+    wakeMatcher(false);
+    for (int spin = 0; spin < 64; ++spin) {
+      if (completion.done.load(std::memory_order_acquire)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    uint64_t seen = acked_.load(std::memory_order_acquire);
+    while (!completion.done.load(std::memory_order_acquire)) {
+      acked_.wait(seen, std::memory_order_acquire);
+      seen = acked_.load(std::memory_order_acquire);
+    }
+  }
+
+  void wakeMatcher(bool always) noexcept {
+    // Pairs with the fence in idle(): either the matcher sees the new
+    // command or we see it going to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (always || sleeping_.load(std::memory_order_relaxed)) {
+      wakeups_.fetch_add(1, std::memory_order_release);
+      wakeups_.notify_one();
     }
+  }
 
-    // Best asks (lowest prices first)
-    count = 0;
-    for (auto it = sellOrders_.begin();
-         it != sellOrders_.end() && count < levels; ++it, ++count) {
-      double totalQty = 0;
-      for (const auto &orderId : it->second) {
-        auto orderIt = orders_.find(orderId);
-        if (orderIt != orders_.end() &&
-            orderIt->second.status == OrderStatus::OPEN) {
-          totalQty += orderIt->second.remainingQuantity();
+  void run() noexcept {
+    pin();
+    std::array<Completion *, BATCH> batch;
+    while (true) {
+      size_t n = 0;
+      while (n < BATCH) {
+        Pending *pending = commands_.front();
+        if (!pending) {
+          break;
+        }
+        apply(pending->command, *pending->completion);
+        batch[n++] = pending->completion;
+        commands_.pop();
+      }
+      if (n > 0) {
+        // Publish before acknowledging, so a caller's own command is
+        // visible to its next read
+        publish();
+        for (size_t i = 0; i < n; ++i) {
+          batch[i]->done.store(true, std::memory_order_release);
+        }
+        acked_.fetch_add(1, std::memory_order_release);
+        acked_.notify_all();
+        if (eventCount_.load(std::memory_order_relaxed) != announced_) {
+          announced_ = eventCount_.load(std::memory_order_relaxed);
+          wakeEventWaiters();
         }
+      } else if (stopping_.load(std::memory_order_acquire)) {
+        return;
+      } else {
+        idle();
       }
-      if (totalQty > 0)
-        asks.emplace_back(it->first, totalQty);
     }
+  }
 
-    return {bids, asks};
+  void idle() noexcept {
+    for (int spin = 0; spin < 64; ++spin) {
+      if (commands_.front() || stopping_.load(std::memory_order_relaxed)) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+    const uint32_t seen = wakeups_.load(std::memory_order_acquire);
+    sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!commands_.front() && !stopping_.load(std::memory_order_relaxed)) {
+      wakeups_.wait(seen, std::memory_order_acquire);
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
   }
 
-  // Get recent trades
-  [[nodiscard]] std::vector<Trade>
-  getRecentTrades(int count = 50) const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
+  void pin() noexcept {
+#ifdef __linux__
+    if (config_.matcherCpu >= 0) {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(config_.matcherCpu, &cpus);
+      if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        Logging::Logger::getInstance().warning(
+            "Could not pin order matcher to CPU " +
+                std::to_string(config_.matcherCpu),
+            "Trading", 0);
+      }
+    }
+#endif
+  }
 
-    std::vector<Trade> result;
-    int start = std::max(0, static_cast<int>(trades_.size()) - count);
-    for (size_t i = start; i < trades_.size(); ++i) {
-      result.push_back(trades_[i]);
+  void apply(Command &cmd, Completion &completion) noexcept {
+    switch (cmd.kind) {
+    case Command::Kind::SNAPSHOT:
+      snapshot(*completion.snapshot);
+      completion.ok = true;
+      return;
+    default:
+      break;
     }
-    return result;
+    cmd.sequence = ++sequence_;
+    if (!cmd.timestamp) {
+      cmd.timestamp = nowMs();
+    }
+    if (config_.journal) {
+      config_.journal(cmd);
+    }
+    if (cmd.kind == Command::Kind::PLACE) {
+      completion.order = place(cmd);
+      completion.ok = completion.order != 0;
+    } else {
+      completion.ok = cancel(cmd);
+    }
+    emitLevels(cmd.timestamp);
   }
 
-  // Get best bid/ask
-  [[nodiscard]] std::pair<double, double> getBestBidAsk() const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
+  void snapshot(BookSnapshot &out) noexcept {
+    try {
+      out.sequence = eventCount_.load(std::memory_order_relaxed);
+      out.bids.reserve(engine_.levelCount(OrderSide::BUY));
+      out.asks.reserve(engine_.levelCount(OrderSide::SELL));
+      constexpr size_t all = std::numeric_limits<size_t>::max();
+      engine_.forEachLevel(OrderSide::BUY, all,
+                           [&](Ticks price, Lots lots, uint32_t) {
+                             out.bids.emplace_back(price, lots);
+                           });
+      engine_.forEachLevel(OrderSide::SELL, all,
+                           [&](Ticks price, Lots lots, uint32_t) {
+                             out.asks.emplace_back(price, lots);
+                           });
+    } catch (...) {
+      out = {};
+    }
+  }
 
-    double bestBid = buyOrders_.empty() ? 0 : buyOrders_.rbegin()->first;
-    double bestAsk = sellOrders_.empty() ? 0 : sellOrders_.begin()->first;
+  void touch(OrderSide side, Ticks price) noexcept {
+    for (const auto &level : touched_) {
+      if (level.first == side && level.second == price) {
+        return;
+      }
+    }
+    try {
+      touched_.emplace_back(side, price);
+    } catch (...) {
+    }
+  }
 
-    return {bestBid, bestAsk};
+  // One LEVEL event per level the command changed, with its final total
+  void emitLevels(int64_t timestamp) noexcept {
+    for (const auto &[side, price] : touched_) {
+      MarketEvent event;
+      event.kind = MarketEvent::Kind::LEVEL;
+      event.side = side;
+      event.price = price;
+      event.quantity = engine_.levelTotal(side, price);
+      event.timestamp = timestamp;
+      emit(event);
+    }
+    touched_.clear();
   }
 
-  // Stats
-  [[nodiscard]] size_t getOpenOrderCount() const noexcept {
-    std::lock_guard<std::mutex> lock(bookMutex_);
-    size_t count = 0;
-    for (const auto &[id, order] : orders_) {
-      if (order.status == OrderStatus::OPEN ||
-          order.status == OrderStatus::PARTIAL) {
-        count++;
+  void emit(const MarketEvent &event) noexcept {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    const uint64_t n = eventCount_.load(relaxed) + 1;
+    EventSlot &slot = events_[(n - 1) % EVENT_CAPACITY];
+    slot.version.store(2 * n - 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.kind.store(static_cast<uint8_t>(event.kind), relaxed);
+    slot.side.store(static_cast<uint8_t>(event.side), relaxed);
+    slot.price.store(event.price, relaxed);
+    slot.quantity.store(event.quantity, relaxed);
+    slot.buyOrder.store(event.buyOrder, relaxed);
+    slot.sellOrder.store(event.sellOrder, relaxed);
+    slot.timestamp.store(event.timestamp, relaxed);
+    slot.version.store(2 * n, std::memory_order_release);
+    eventCount_.store(n, std::memory_order_release);
+  }
+
+  uint64_t place(Command &cmd) noexcept {
+    const bool limit = cmd.type == OrderType::LIMIT;
+    if (cmd.quantity <= 0 || (limit && cmd.price <= 0)) {
+      return 0;
+    }
+    const uint64_t number = orderCount_ + 1;
+    try {
+      Record record;
+      record.userId = std::move(cmd.userId);
+      record.side = cmd.side;
+      record.type = cmd.type;
+      record.price = limit ? cmd.price : 0;
+      record.quantity = cmd.quantity;
+      record.timestamp = cmd.timestamp;
+
+      const SubmitResult result = engine_.submit(
+          number, cmd.side, cmd.type, cmd.price, cmd.quantity,
+          [&](const Fill &f) { recordFill(f, cmd.timestamp); });
+
+      orderCount_ = number;
+      record.filled = result.filled;
+      if (result.remaining == 0) {
+        record.status = OrderStatus::FILLED;
+      } else if (!result.handle) {
+        record.status = OrderStatus::CANCELLED; // Unfilled market remainder
+      } else if (result.filled > 0) {
+        record.status = OrderStatus::PARTIAL;
       }
+      if (result.handle) {
+        touch(cmd.side, cmd.price);
+        record.handle = result.handle;
+        index(number, open_.emplace(number, std::move(record)).first->second);
+      } else {
+        index_.put(number, record);
+        retire(number, record, cmd.timestamp);
+      }
+      return number;
+    } catch (...) {
+      return 0;
     }
-    return count;
   }
 
-  [[nodiscard]] size_t getTradeCount() const noexcept { return trades_.size(); }
+  bool cancel(const Command &cmd) noexcept {
+    auto it = open_.find(cmd.order);
+    if (it == open_.end() || it->second.userId != cmd.userId) {
+      return false;
+    }
+    Record &record = it->second;
+    engine_.cancel(record.handle);
+    touch(record.side, record.price);
+    record.handle = 0;
+    record.status = OrderStatus::CANCELLED;
+    close(it, cmd.timestamp);
+    return true;
+  }
 
-private:
-  mutable std::mutex bookMutex_;
-  std::map<std::string, Order> orders_;
-  std::map<double, std::vector<std::string>> buyOrders_; // price -> order IDs
-  std::map<double, std::vector<std::string>> sellOrders_;
-  std::vector<Trade> trades_;
-  int nextOrderId_{1};
-  int nextTradeId_{1};
-
-  void matchOrders() noexcept {
-    while (!buyOrders_.empty() && !sellOrders_.empty()) {
-      double bestBid = buyOrders_.rbegin()->first;
-      double bestAsk = sellOrders_.begin()->first;
-
-      if (bestBid < bestAsk)
-        break; // No match
-
-      auto &buyOrderIds = buyOrders_.rbegin()->second;
-      auto &sellOrderIds = sellOrders_.begin()->second;
-
-      if (buyOrderIds.empty() || sellOrderIds.empty())
-        break;
+  void recordFill(const Fill &f, int64_t timestamp) noexcept {
+    auto it = open_.find(f.makerOrderId);
+    if (it != open_.end()) {
+      Record &maker = it->second;
+      maker.filled += f.quantity;
+      if (f.makerRemaining == 0) {
+        maker.handle = 0;
+        maker.status = OrderStatus::FILLED;
+        close(it, timestamp);
+      } else {
+        maker.status = OrderStatus::PARTIAL;
+        index_.update(f.makerOrderId, maker.filled, maker.status);
+      }
+    }
+
+    const bool buy = f.takerSide == OrderSide::BUY;
+    touch(buy ? OrderSide::SELL : OrderSide::BUY, f.price);
+    MarketEvent event;
+    event.kind = MarketEvent::Kind::TRADE;
+    event.side = f.takerSide;
+    event.price = f.price;
+    event.quantity = f.quantity;
+    event.buyOrder = buy ? f.takerOrderId : f.makerOrderId;
+    event.sellOrder = buy ? f.makerOrderId : f.takerOrderId;
+    event.timestamp = timestamp;
+    emit(event);
+
+    const uint64_t t = tradeCount_.load(std::memory_order_relaxed) + 1;
+    TapeSlot &slot = tape_[(t - 1) % TAPE_CAPACITY];
+    constexpr auto relaxed = std::memory_order_relaxed;
+    slot.version.store(2 * t - 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.buyOrder.store(event.buyOrder, relaxed);
+    slot.sellOrder.store(event.sellOrder, relaxed);
+    slot.price.store(f.price, relaxed);
+    slot.quantity.store(f.quantity, relaxed);
+    slot.timestamp.store(timestamp, relaxed);
+    slot.version.store(2 * t, std::memory_order_release);
+    tradeCount_.store(t, std::memory_order_release);
+
+    if (archiving()) {
+      pushArchive([&](ArchiveItem &item) {
+        item.kind = Archive::SegmentKind::TRADES;
+        item.trade = {t,          event.buyOrder, event.sellOrder,
+                      f.price,    f.quantity,     timestamp};
+      });
+    }
+  }
+
+  // Publish a resting order and add it to its owner's list
+  void index(uint64_t number, Record &record) {
+    index_.put(number, record);
+    record.userSlot = index_.addOpen(record.userId, number);
+  }
+
+  // Take an order finished at `finishedAt` off the book's indexes and
+  // retire it
+  void close(std::unordered_map<uint64_t, Record>::iterator it,
+             int64_t finishedAt) noexcept {
+    Record &record = it->second;
+    if (const uint64_t moved = index_.removeOpen(record.userId,
+                                                 record.userSlot)) {
+      open_.find(moved)->second.userSlot = record.userSlot;
+    }
+    index_.update(it->first, record.filled, record.status);
+    retire(it->first, record, finishedAt);
+    open_.erase(it);
+  }
+
+  // Archive a finished order, already final in index_, and leave it there
+  // for getOrder() until Config::recentOrders newer ones have finished
+  void retire(uint64_t number, const Record &record,
+              int64_t finishedAt) noexcept {
+    archiveOrder(number, record, finishedAt);
+    const size_t keep = config_.recentOrders;
+    try {
+      if (keep == 0) {
+        index_.erase(number);
+      } else if (finishedRing_.size() < keep) {
+        finishedRing_.push_back(number);
+      } else {
+        index_.erase(finishedRing_[finishedHead_]);
+        finishedRing_[finishedHead_] = number;
+        finishedHead_ = (finishedHead_ + 1) % keep;
+      }
+    } catch (...) {
+      index_.erase(number); // Not kept; getOrder() reports it as unknown
+    }
+  }
+
+  void archiveOrder(uint64_t number, const Record &record,
+                    int64_t finishedAt) noexcept {
+    if (!archiving()) {
+      return;
+    }
+    try {
+      Archive::OrderRow row;
+      row.number = number;
+      row.userId = record.userId;
+      row.side = static_cast<uint8_t>(record.side);
+      row.type = static_cast<uint8_t>(record.type);
+      row.status = static_cast<uint8_t>(record.status);
+      row.price = record.price;
+      row.quantity = record.quantity;
+      row.filled = record.filled;
+      row.timestamp = record.timestamp;
+      row.finished = finishedAt;
+      pushArchive([&](ArchiveItem &item) {
+        item.kind = Archive::SegmentKind::ORDERS;
+        item.order = std::move(row);
+      });
+    } catch (...) {
+      // Dropped from the archive
+    }
+  }
+
+  // The archiver sleeps between seal intervals; wake it at half full so
+  // the matcher rarely finds the ring full
+  template <typename Fill> void pushArchive(Fill &&fill) noexcept {
+    while (!archive_.tryPush(fill)) {
+      archiveWake_.notify_one();
+      std::this_thread::yield(); // Archiver is behind on disk
+    }
+    if (archive_.pushed() - archive_.popped() == archive_.capacity() / 2) {
+      archiveWake_.notify_one();
+    }
+  }
+
+  // Archiver thread: pack rows into segments and append each one once it
+  // is full, on flushArchive(), or ARCHIVE_SEAL_INTERVAL after it opened
+  void archiveLoop() noexcept {
+    Archive::SegmentBuilder orders(Archive::SegmentKind::ORDERS);
+    Archive::SegmentBuilder trades(Archive::SegmentKind::TRADES);
+    std::ofstream file;
+    std::string out;
+    auto opened = std::chrono::steady_clock::now();
+    try {
+      if (recovered_.usable) {
+        file.open(config_.archivePath, std::ios::app | std::ios::binary);
+      }
+      if (recovered_.bytes == 0) {
+        Archive::putHeader(out);
+      }
+      if (recovered_.dropped) {
+        Logging::Logger::getInstance().warning(
+            "Cut " + std::to_string(recovered_.dropped) +
+                " bytes of a torn segment from " + config_.archivePath,
+            "Trading", 0);
+      }
+    } catch (...) {
+    }
+    if (!file) {
+      Logging::Logger::getInstance().error(
+          "Could not open order archive " + config_.archivePath, "Trading",
+          0);
+    }
 
-      std::string buyId = buyOrderIds.front();
-      std::string sellId = sellOrderIds.front();
-
-      auto &buyOrder = orders_[buyId];
-      auto &sellOrder = orders_[sellId];
-
-      double matchQty =
-          std::min(buyOrder.remainingQuantity(), sellOrder.remainingQuantity());
-      double matchPrice = sellOrder.price; // Maker price
-
-      // Execute trade
-      Trade trade;
-      trade.tradeId = "trd_" + std::to_string(nextTradeId_++);
-      trade.buyOrderId = buyId;
-      trade.sellOrderId = sellId;
-      trade.price = matchPrice;
-      trade.quantity = matchQty;
-      trade.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::system_clock::now().time_since_epoch())
-                            .count();
-
-      trades_.push_back(trade);
-
-      // Update orders
-      buyOrder.filled += matchQty;
-      sellOrder.filled += matchQty;
-
-      buyOrder.status = (buyOrder.filled >= buyOrder.quantity)
-                            ? OrderStatus::FILLED
-                            : OrderStatus::PARTIAL;
-      sellOrder.status = (sellOrder.filled >= sellOrder.quantity)
-                             ? OrderStatus::FILLED
-                             : OrderStatus::PARTIAL;
-
-      // Remove filled orders from book
-      if (buyOrder.status == OrderStatus::FILLED) {
-        buyOrderIds.erase(buyOrderIds.begin());
-        if (buyOrderIds.empty()) {
-          buyOrders_.erase(std::prev(buyOrders_.end()));
+    bool stopping = false;
+    while (true) {
+      size_t drained = 0;
+      while (ArchiveItem *item = archive_.front()) {
+        if (orders.rows() + trades.rows() == 0) {
+          opened = std::chrono::steady_clock::now();
+        }
+        try {
+          if (item->kind == Archive::SegmentKind::ORDERS) {
+            orders.add(item->order);
+          } else {
+            trades.add(item->trade);
+          }
+          if (orders.rows() == Archive::SEGMENT_ROWS) {
+            orders.finish(out);
+          }
+          if (trades.rows() == Archive::SEGMENT_ROWS) {
+            trades.finish(out);
+          }
+        } catch (...) {
+          // Row lost
         }
+        archive_.pop();
+        ++drained;
       }
 
-      if (sellOrder.status == OrderStatus::FILLED) {
-        sellOrderIds.erase(sellOrderIds.begin());
-        if (sellOrderIds.empty()) {
-          sellOrders_.erase(sellOrders_.begin());
+      bool urgent;
+      {
+        std::lock_guard<std::mutex> lock(archiveMutex_);
+        urgent = std::exchange(archiveUrgent_, false);
+      }
+      if (urgent || stopping ||
+          std::chrono::steady_clock::now() - opened >=
+              ARCHIVE_SEAL_INTERVAL) {
+        try {
+          orders.finish(out);
+          trades.finish(out);
+        } catch (...) {
         }
       }
+      if (!out.empty()) {
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        file.flush();
+        out.clear();
+      }
+      {
+        std::lock_guard<std::mutex> lock(archiveMutex_);
+        archived_ = archive_.popped() - orders.rows() - trades.rows();
+      }
+      archiveFlushed_.notify_all();
+      if (drained > 0) {
+        continue;
+      }
 
-      Logging::Logger::getInstance().info(
-          "Trade executed: " + trade.tradeId + " " + std::to_string(matchQty) +
-              " @ $" + std::to_string(matchPrice),
-          "Trading", 0);
+      std::unique_lock<std::mutex> lock(archiveMutex_);
+      if (stopping) {
+        archiveFlushed_.notify_all();
+        return;
+      }
+      stopping = !archiving_;
+      if (!stopping) {
+        // pushArchive() notifies without the lock; a missed wakeup is
+        // repeated while the ring stays full
+        archiveWake_.wait_for(lock, ARCHIVE_SEAL_INTERVAL, [&] {
+          return !archiving_ || archiveUrgent_ || archive_.front();
+        });
+      }
     }
   }
 
-  void removeFromBook(const Order &order) noexcept {
-    auto &book = (order.side == OrderSide::BUY) ? buyOrders_ : sellOrders_;
-    auto it = book.find(order.price);
-    if (it != book.end()) {
-      auto &ids = it->second;
-      ids.erase(std::remove(ids.begin(), ids.end(), order.orderId), ids.end());
-      if (ids.empty())
-        book.erase(it);
-    }
+  void publish() noexcept {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    const uint64_t version = depth_.version.load(relaxed);
+    depth_.version.store(version + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    depth_.sequence.store(sequence_, relaxed);
+    depth_.openOrders.store(engine_.restingOrders(), relaxed);
+    uint32_t n = 0;
+    engine_.forEachLevel(OrderSide::BUY, DEPTH_LEVELS,
+                         [&](Ticks price, Lots lots, uint32_t) {
+                           depth_.bidPrice[n].store(price, relaxed);
+                           depth_.bidLots[n++].store(lots, relaxed);
+                         });
+    depth_.bidLevels.store(n, relaxed);
+    n = 0;
+    engine_.forEachLevel(OrderSide::SELL, DEPTH_LEVELS,
+                         [&](Ticks price, Lots lots, uint32_t) {
+                           depth_.askPrice[n].store(price, relaxed);
+                           depth_.askLots[n++].store(lots, relaxed);
+                         });
+    depth_.askLevels.store(n, relaxed);
+    depth_.version.store(version + 2, std::memory_order_release);
   }
 };
 
@@ -1,15 +1,29 @@
 #ifndef QUANTUMPULSE_P2P_PROTOCOL_V7_H
 #define QUANTUMPULSE_P2P_PROTOCOL_V7_H
 
+#include "quantumpulse_blockchain_v7.h"
+#include "quantumpulse_checksum_v7.h"
 #include "quantumpulse_crypto_v7.h"
 #include "quantumpulse_logging_v7.h"
+#include "quantumpulse_serialize_v7.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <deque>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <random>
 #include <set>
 #include <string>
+#include <string_view>
+#include <sys/uio.h>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace QuantumPulse::P2P {
@@ -40,6 +54,9 @@ enum class MessageType {
   BLOCKTXN     // Block transactions
 };
 
+inline constexpr uint8_t MESSAGE_TYPE_COUNT =
+    static_cast<uint8_t>(MessageType::BLOCKTXN) + 1;
+
 // Peer information
 struct PeerInfo {
   std::string address;
@@ -57,7 +74,8 @@ struct PeerInfo {
   std::set<std::string> services;
 };
 
-// Network message
+// Network message; `payload` is the binary encoding of one of the
+// message structs below
 struct NetworkMessage {
   MessageType type;
   std::string payload;
@@ -72,6 +90,867 @@ struct InvItem {
   std::string hash;
 };
 
+inline constexpr int INV_TX = 1;
+inline constexpr int INV_BLOCK = 2;
+
+// ---------------------------------------------------------------------------
+// Wire framing
+//
+// Every message is a 16-byte header followed by its payload:
+//   magic u32 | type u8 | reserved u8[3] | length u32 | crc32c(payload) u32
+// all little-endian. The magic is F9 BE B4 D9 on the wire.
+// ---------------------------------------------------------------------------
+
+inline constexpr uint32_t MAINNET_MAGIC = 0xD9B4BEF9;
+inline constexpr size_t FRAME_HEADER_SIZE = 16;
+inline constexpr size_t MAX_PAYLOAD_SIZE = 32 * 1024 * 1024;
+
+// Append one framed message to `out`
+inline void appendFrame(std::string &out, MessageType type,
+                        std::string_view payload,
+                        uint32_t magic = MAINNET_MAGIC) {
+  out.reserve(out.size() + FRAME_HEADER_SIZE + payload.size());
+  Serialize::putU32(out, magic);
+  Serialize::putU8(out, static_cast<uint8_t>(type));
+  out.append(3, '\0');
+  Serialize::putU32(out, static_cast<uint32_t>(payload.size()));
+  Serialize::putU32(out,
+                    Checksum::crc32c(payload.data(), payload.size()));
+  out.append(payload);
+}
+
+inline std::string encodeFrame(MessageType type, std::string_view payload,
+                               uint32_t magic = MAINNET_MAGIC) {
+  std::string out;
+  appendFrame(out, type, payload, magic);
+  return out;
+}
+
+// A decoded message; `payload` points into the decoder's buffer
+struct Frame {
+  MessageType type{MessageType::PING};
+  std::string_view payload;
+};
+
+// Streaming frame decoder. Bytes may arrive split or coalesced in any
+// way; next() yields each complete, checksum-verified frame in order.
+// Receive straight into the buffer with prepare()/commit() or copy in
+// with feed(). Payload views stay valid until the next prepare()/feed().
+class FrameDecoder {
+public:
+  enum class Status { NeedMore, Ready, Error };
+  enum class Error { None, BadMagic, BadType, TooLarge, BadChecksum };
+
+  explicit FrameDecoder(uint32_t magic = MAINNET_MAGIC,
+                        size_t maxPayload = MAX_PAYLOAD_SIZE) noexcept
+      : magic_(magic), maxPayload_(maxPayload) {}
+
+  char *prepare(size_t n) {
+    compact();
+    size_t used = buf_.size();
+    buf_.resize(used + n);
+    reserved_ = n;
+    return buf_.data() + used;
+  }
+
+  void commit(size_t n) noexcept {
+    buf_.resize(buf_.size() - reserved_ + std::min(n, reserved_));
+    reserved_ = 0;
+  }
+
+  void feed(const char *data, size_t len) {
+    compact();
+    buf_.append(data, len);
+  }
+
+  Status next(Frame &out) {
+    if (error_ != Error::None) {
+      return Status::Error;
+    }
+    if (buf_.size() - pos_ < FRAME_HEADER_SIZE) {
+      return Status::NeedMore;
+    }
+    const auto *h = reinterpret_cast<const unsigned char *>(buf_.data() + pos_);
+    if (Serialize::getLE(h, 4) != magic_) {
+      return fail(Error::BadMagic);
+    }
+    if (h[4] >= MESSAGE_TYPE_COUNT) {
+      return fail(Error::BadType);
+    }
+    size_t length = Serialize::getLE(h + 8, 4);
+    if (length > maxPayload_) {
+      return fail(Error::TooLarge);
+    }
+    if (buf_.size() - pos_ < FRAME_HEADER_SIZE + length) {
+      // Room for the rest of the frame in one allocation
+      buf_.reserve(pos_ + FRAME_HEADER_SIZE + length);
+      return Status::NeedMore;
+    }
+    const char *payload = buf_.data() + pos_ + FRAME_HEADER_SIZE;
+    if (Checksum::crc32c(payload, length) != Serialize::getLE(h + 12, 4)) {
+      return fail(Error::BadChecksum);
+    }
+    out.type = static_cast<MessageType>(h[4]);
+    out.payload = std::string_view(payload, length);
+    pos_ += FRAME_HEADER_SIZE + length;
+    return Status::Ready;
+  }
+
+  [[nodiscard]] Error error() const noexcept { return error_; }
+  [[nodiscard]] size_t buffered() const noexcept {
+    return buf_.size() - pos_;
+  }
+
+private:
+  uint32_t magic_;
+  size_t maxPayload_;
+  std::string buf_;
+  size_t pos_{0};
+  size_t reserved_{0};
+  Error error_{Error::None};
+
+  Status fail(Error e) noexcept {
+    error_ = e;
+    return Status::Error;
+  }
+
+  void compact() {
+    if (pos_ == 0) {
+      return;
+    }
+    buf_.erase(0, pos_);
+    pos_ = 0;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Payload codecs. Encoders append to a caller-owned buffer; decoders
+// return std::nullopt on truncated or oversized input.
+// ---------------------------------------------------------------------------
+
+namespace Codec {
+
+inline constexpr size_t MAX_INV_ITEMS = 50000;
+inline constexpr size_t MAX_HEADERS = 2000;
+inline constexpr size_t MAX_BLOCK_TXS = 100000;
+inline constexpr size_t MAX_MULTISIGS = 16;
+
+inline void encodeTransaction(std::string &out,
+                              const Blockchain::Transaction &tx) {
+  Serialize::putBytes(out, tx.sender);
+  Serialize::putBytes(out, tx.receiver);
+  Serialize::putBytes(out, tx.txId);
+  Serialize::putBytes(out, tx.signature);
+  Serialize::putBytes(out, tx.zkProof);
+  Serialize::putU32(out, static_cast<uint32_t>(tx.multiSignatures.size()));
+  for (const auto &sig : tx.multiSignatures) {
+    Serialize::putBytes(out, sig);
+  }
+  Serialize::putDouble(out, tx.amount);
+  Serialize::putDouble(out, tx.fee);
+  Serialize::putI64(out, tx.timestamp);
+  Serialize::putI64(out, tx.expiresAt);
+  Serialize::putU32(out, static_cast<uint32_t>(tx.shardId));
+  Serialize::putU8(out, static_cast<uint8_t>(tx.status));
+}
+
+inline bool decodeTransaction(Serialize::ByteReader &r,
+                              Blockchain::Transaction &tx) {
+  uint32_t sigs, shard;
+  int64_t timestamp, expiresAt;
+  uint8_t status;
+  if (!r.bytes(tx.sender) || !r.bytes(tx.receiver) || !r.bytes(tx.txId) ||
+      !r.bytes(tx.signature) || !r.bytes(tx.zkProof) || !r.u32(sigs) ||
+      sigs > MAX_MULTISIGS) {
+    return false;
+  }
+  tx.multiSignatures.resize(sigs);
+  for (auto &sig : tx.multiSignatures) {
+    if (!r.bytes(sig)) {
+      return false;
+    }
+  }
+  if (!r.f64(tx.amount) || !r.f64(tx.fee) || !r.i64(timestamp) ||
+      !r.i64(expiresAt) || !r.u32(shard) || !r.u8(status) ||
+      status > static_cast<uint8_t>(Blockchain::TransactionStatus::Expired)) {
+    return false;
+  }
+  tx.timestamp = static_cast<time_t>(timestamp);
+  tx.expiresAt = static_cast<time_t>(expiresAt);
+  tx.shardId = static_cast<int>(shard);
+  tx.status = static_cast<Blockchain::TransactionStatus>(status);
+  return true;
+}
+
+// Block fields without the transaction list
+inline void encodeBlockHeader(std::string &out, const Blockchain::Block &b) {
+  Serialize::putBytes(out, b.prevHash);
+  Serialize::putBytes(out, b.hash);
+  Serialize::putBytes(out, b.merkleRoot);
+  Serialize::putI64(out, b.timestamp);
+  Serialize::putU32(out, static_cast<uint32_t>(b.nonce));
+  Serialize::putU32(out, static_cast<uint32_t>(b.difficulty));
+  Serialize::putDouble(out, b.reward);
+  Serialize::putU32(out, static_cast<uint32_t>(b.shardId));
+  Serialize::putU32(out, static_cast<uint32_t>(b.version));
+}
+
+inline bool decodeBlockHeader(Serialize::ByteReader &r,
+                              Blockchain::Block &b) {
+  int64_t timestamp;
+  uint32_t nonce, difficulty, shard, version;
+  if (!r.bytes(b.prevHash) || !r.bytes(b.hash) || !r.bytes(b.merkleRoot) ||
+      !r.i64(timestamp) || !r.u32(nonce) || !r.u32(difficulty) ||
+      !r.f64(b.reward) || !r.u32(shard) || !r.u32(version)) {
+    return false;
+  }
+  b.timestamp = static_cast<time_t>(timestamp);
+  b.nonce = static_cast<int>(nonce);
+  b.difficulty = static_cast<int>(difficulty);
+  b.shardId = static_cast<int>(shard);
+  b.version = static_cast<int>(version);
+  return true;
+}
+
+inline void encodeBlock(std::string &out, const Blockchain::Block &b) {
+  encodeBlockHeader(out, b);
+  Serialize::putU32(out, static_cast<uint32_t>(b.transactions.size()));
+  for (const auto &tx : b.transactions) {
+    encodeTransaction(out, tx);
+  }
+}
+
+inline bool decodeBlock(Serialize::ByteReader &r, Blockchain::Block &b) {
+  uint32_t count;
+  if (!decodeBlockHeader(r, b) || !r.u32(count) || count > MAX_BLOCK_TXS) {
+    return false;
+  }
+  b.transactions.clear();
+  b.transactions.reserve(std::min<size_t>(count, r.remaining() / 64));
+  for (uint32_t i = 0; i < count; ++i) {
+    if (!decodeTransaction(r, b.transactions.emplace_back())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace Codec
+
+// INV and GETDATA (and NOTFOUND) share one layout
+struct InvMessage {
+  std::vector<InvItem> items;
+
+  void encode(std::string &out) const {
+    Serialize::putU32(out, static_cast<uint32_t>(items.size()));
+    for (const auto &item : items) {
+      Serialize::putU8(out, static_cast<uint8_t>(item.type));
+      Serialize::putBytes(out, item.hash);
+    }
+  }
+
+  static std::optional<InvMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    uint32_t count;
+    if (!r.u32(count) || count > Codec::MAX_INV_ITEMS) {
+      return std::nullopt;
+    }
+    InvMessage msg;
+    msg.items.reserve(std::min<size_t>(count, r.remaining() / 5));
+    for (uint32_t i = 0; i < count; ++i) {
+      uint8_t type;
+      InvItem item;
+      if (!r.u8(type) || !r.bytes(item.hash)) {
+        return std::nullopt;
+      }
+      item.type = type;
+      msg.items.push_back(std::move(item));
+    }
+    return r.done() ? std::make_optional(std::move(msg)) : std::nullopt;
+  }
+};
+
+using GetDataMessage = InvMessage;
+
+struct TxMessage {
+  Blockchain::Transaction tx;
+
+  void encode(std::string &out) const { Codec::encodeTransaction(out, tx); }
+
+  static std::optional<TxMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    TxMessage msg;
+    if (!Codec::decodeTransaction(r, msg.tx) || !r.done()) {
+      return std::nullopt;
+    }
+    return msg;
+  }
+};
+
+struct BlockMessage {
+  Blockchain::Block block;
+
+  void encode(std::string &out) const { Codec::encodeBlock(out, block); }
+
+  static std::optional<BlockMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    BlockMessage msg;
+    if (!Codec::decodeBlock(r, msg.block) || !r.done()) {
+      return std::nullopt;
+    }
+    return msg;
+  }
+};
+
+// Block headers only; decoded blocks have no transactions
+struct HeadersMessage {
+  std::vector<Blockchain::Block> headers;
+
+  void encode(std::string &out) const {
+    Serialize::putU32(out, static_cast<uint32_t>(headers.size()));
+    for (const auto &h : headers) {
+      Codec::encodeBlockHeader(out, h);
+    }
+  }
+
+  static std::optional<HeadersMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    uint32_t count;
+    if (!r.u32(count) || count > Codec::MAX_HEADERS) {
+      return std::nullopt;
+    }
+    HeadersMessage msg;
+    msg.headers.resize(count);
+    for (auto &h : msg.headers) {
+      if (!Codec::decodeBlockHeader(r, h)) {
+        return std::nullopt;
+      }
+    }
+    return r.done() ? std::make_optional(std::move(msg)) : std::nullopt;
+  }
+};
+
+// Block locator (newest first) and optional stop hash
+struct GetHeadersMessage {
+  static constexpr size_t MAX_LOCATOR = 101;
+
+  std::vector<std::string> locator;
+  std::string stopHash;
+
+  void encode(std::string &out) const {
+    Serialize::putU32(out, static_cast<uint32_t>(locator.size()));
+    for (const auto &hash : locator) {
+      Serialize::putBytes(out, hash);
+    }
+    Serialize::putBytes(out, stopHash);
+  }
+
+  static std::optional<GetHeadersMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    uint32_t count;
+    if (!r.u32(count) || count > MAX_LOCATOR) {
+      return std::nullopt;
+    }
+    GetHeadersMessage msg;
+    msg.locator.resize(count);
+    for (auto &hash : msg.locator) {
+      if (!r.bytes(hash)) {
+        return std::nullopt;
+      }
+    }
+    if (!r.bytes(msg.stopHash) || !r.done()) {
+      return std::nullopt;
+    }
+    return msg;
+  }
+};
+
+struct VersionMessage {
+  int32_t version{70015};
+  uint64_t services{0};
+  int64_t timestamp{0};
+  int32_t startHeight{0};
+  std::string userAgent{"/QuantumPulse:7.0.0/"};
+
+  void encode(std::string &out) const {
+    Serialize::putU32(out, static_cast<uint32_t>(version));
+    Serialize::putU64(out, services);
+    Serialize::putI64(out, timestamp);
+    Serialize::putU32(out, static_cast<uint32_t>(startHeight));
+    Serialize::putBytes(out, userAgent);
+  }
+
+  static std::optional<VersionMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    VersionMessage msg;
+    uint32_t version, height;
+    if (!r.u32(version) || !r.u64(msg.services) || !r.i64(msg.timestamp) ||
+        !r.u32(height) || !r.bytes(msg.userAgent) || !r.done()) {
+      return std::nullopt;
+    }
+    msg.version = static_cast<int32_t>(version);
+    msg.startHeight = static_cast<int32_t>(height);
+    return msg;
+  }
+};
+
+// PING and PONG
+struct PingMessage {
+  uint64_t nonce{0};
+
+  void encode(std::string &out) const { Serialize::putU64(out, nonce); }
+
+  static std::optional<PingMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    PingMessage msg;
+    if (!r.u64(msg.nonce) || !r.done()) {
+      return std::nullopt;
+    }
+    return msg;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Compact block relay
+//
+// A new block travels as its header plus a 6-byte short ID per
+// transaction. The receiver fills in bodies it has already seen, asks for
+// the rest with one GETBLOCKTXN and gets them back in one BLOCKTXN. Short
+// IDs are SipHash-2-4 of the txid keyed by the block hash and a nonce
+// chosen per announcement, so colliding transactions cannot be crafted in
+// advance.
+// ---------------------------------------------------------------------------
+
+inline constexpr size_t SHORT_ID_BYTES = 6;
+inline constexpr uint64_t SHORT_ID_MASK =
+    (uint64_t{1} << (8 * SHORT_ID_BYTES)) - 1;
+
+class ShortIdHasher {
+public:
+  ShortIdHasher(std::string_view blockHash, uint64_t nonce) noexcept
+      : k0_(Checksum::siphash24(0, nonce, blockHash.data(),
+                                blockHash.size())),
+        k1_(Checksum::siphash24(1, nonce, blockHash.data(),
+                                blockHash.size())) {}
+
+  uint64_t operator()(std::string_view txId) const noexcept {
+    return Checksum::siphash24(k0_, k1_, txId.data(), txId.size()) &
+           SHORT_ID_MASK;
+  }
+
+private:
+  uint64_t k0_;
+  uint64_t k1_;
+};
+
+struct PrefilledTransaction {
+  uint32_t index; // Position in the block
+  Blockchain::Transaction tx;
+};
+
+struct CompactBlockMessage {
+  Blockchain::Block header; // No transactions
+  uint64_t nonce{0};
+  std::vector<uint64_t> shortIds; // Non-prefilled transactions, in order
+  std::vector<PrefilledTransaction> prefilled; // Ascending index
+
+  // `prefill(tx)` picks transactions peers are unlikely to have seen,
+  // e.g. ones this node created and never relayed
+  template <typename Prefill>
+  static CompactBlockMessage fromBlock(const Blockchain::Block &block,
+                                       uint64_t nonce, Prefill &&prefill) {
+    CompactBlockMessage msg;
+    msg.header = block.header();
+    msg.nonce = nonce;
+    ShortIdHasher shortId(block.hash, nonce);
+    msg.shortIds.reserve(block.transactions.size());
+    for (size_t i = 0; i < block.transactions.size(); ++i) {
+      const auto &tx = block.transactions[i];
+      if (prefill(tx)) {
+        msg.prefilled.push_back({static_cast<uint32_t>(i), tx});
+      } else {
+        msg.shortIds.push_back(shortId(tx.txId));
+      }
+    }
+    return msg;
+  }
+
+  static CompactBlockMessage fromBlock(const Blockchain::Block &block,
+                                       uint64_t nonce) {
+    return fromBlock(block, nonce,
+                     [](const Blockchain::Transaction &) { return false; });
+  }
+
+  [[nodiscard]] size_t txCount() const noexcept {
+    return shortIds.size() + prefilled.size();
+  }
+
+  void encode(std::string &out) const {
+    Codec::encodeBlockHeader(out, header);
+    Serialize::putU64(out, nonce);
+    Serialize::putU32(out, static_cast<uint32_t>(shortIds.size()));
+    for (uint64_t id : shortIds) {
+      for (size_t b = 0; b < SHORT_ID_BYTES; ++b) {
+        out.push_back(static_cast<char>(id >> (8 * b)));
+      }
+    }
+    Serialize::putU32(out, static_cast<uint32_t>(prefilled.size()));
+    for (const auto &p : prefilled) {
+      Serialize::putU32(out, p.index);
+      Codec::encodeTransaction(out, p.tx);
+    }
+  }
+
+  static std::optional<CompactBlockMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    CompactBlockMessage msg;
+    uint32_t count;
+    if (!Codec::decodeBlockHeader(r, msg.header) || !r.u64(msg.nonce) ||
+        !r.u32(count) || count > Codec::MAX_BLOCK_TXS ||
+        r.remaining() / SHORT_ID_BYTES < count) {
+      return std::nullopt;
+    }
+    msg.shortIds.resize(count);
+    for (auto &id : msg.shortIds) {
+      std::string_view bytes;
+      r.view(bytes, SHORT_ID_BYTES);
+      id = Serialize::getLE(
+          reinterpret_cast<const unsigned char *>(bytes.data()),
+          SHORT_ID_BYTES);
+    }
+    if (!r.u32(count) || count > Codec::MAX_BLOCK_TXS - msg.shortIds.size()) {
+      return std::nullopt;
+    }
+    msg.prefilled.resize(count);
+    const size_t total = msg.txCount();
+    for (size_t i = 0; i < count; ++i) {
+      auto &p = msg.prefilled[i];
+      if (!r.u32(p.index) || p.index >= total ||
+          (i > 0 && p.index <= msg.prefilled[i - 1].index) ||
+          !Codec::decodeTransaction(r, p.tx)) {
+        return std::nullopt;
+      }
+    }
+    return r.done() ? std::make_optional(std::move(msg)) : std::nullopt;
+  }
+};
+
+// Positions of the transactions a compact block could not fill
+struct GetBlockTxnMessage {
+  std::string blockHash;
+  std::vector<uint32_t> indexes; // Ascending
+
+  void encode(std::string &out) const {
+    Serialize::putBytes(out, blockHash);
+    Serialize::putU32(out, static_cast<uint32_t>(indexes.size()));
+    for (uint32_t i : indexes) {
+      Serialize::putU32(out, i);
+    }
+  }
+
+  static std::optional<GetBlockTxnMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    GetBlockTxnMessage msg;
+    uint32_t count;
+    if (!r.bytes(msg.blockHash) || !r.u32(count) ||
+        count > Codec::MAX_BLOCK_TXS || r.remaining() / 4 < count) {
+      return std::nullopt;
+    }
+    msg.indexes.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      r.u32(msg.indexes[i]);
+      if (i > 0 && msg.indexes[i] <= msg.indexes[i - 1]) {
+        return std::nullopt;
+      }
+    }
+    return r.done() ? std::make_optional(std::move(msg)) : std::nullopt;
+  }
+};
+
+// Reply to GETBLOCKTXN, transactions in the requested order
+struct BlockTxnMessage {
+  std::string blockHash;
+  std::vector<Blockchain::Transaction> txs;
+
+  void encode(std::string &out) const {
+    Serialize::putBytes(out, blockHash);
+    Serialize::putU32(out, static_cast<uint32_t>(txs.size()));
+    for (const auto &tx : txs) {
+      Codec::encodeTransaction(out, tx);
+    }
+  }
+
+  static std::optional<BlockTxnMessage> decode(std::string_view payload) {
+    Serialize::ByteReader r(payload);
+    BlockTxnMessage msg;
+    uint32_t count;
+    if (!r.bytes(msg.blockHash) || !r.u32(count) ||
+        count > Codec::MAX_BLOCK_TXS) {
+      return std::nullopt;
+    }
+    msg.txs.reserve(std::min<size_t>(count, r.remaining() / 64));
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!Codec::decodeTransaction(r, msg.txs.emplace_back())) {
+        return std::nullopt;
+      }
+    }
+    return r.done() ? std::make_optional(std::move(msg)) : std::nullopt;
+  }
+};
+
+// Transactions relayed to this node, kept so compact blocks can be rebuilt
+// without downloading the bodies again. The oldest entry goes when full.
+class TxRelayPool {
+public:
+  explicit TxRelayPool(size_t capacity = 50000) noexcept
+      : capacity_(std::max<size_t>(1, capacity)) {}
+
+  // False if already present
+  bool add(const Blockchain::Transaction &tx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (byId_.count(tx.txId)) {
+      return false;
+    }
+    if (byId_.size() >= capacity_) {
+      byId_.erase(order_.front());
+      order_.pop_front();
+    }
+    order_.push_back(tx.txId);
+    byId_.emplace(tx.txId, Entry{tx, std::prev(order_.end())});
+    return true;
+  }
+
+  // Drop transactions that made it into a block
+  void erase(const std::vector<Blockchain::Transaction> &txs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &tx : txs) {
+      auto it = byId_.find(tx.txId);
+      if (it != byId_.end()) {
+        order_.erase(it->second.position);
+        byId_.erase(it);
+      }
+    }
+  }
+
+  // Visit every pooled transaction; `fn` must not call back into the pool
+  template <typename Fn> void forEach(Fn &&fn) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &[id, entry] : byId_) {
+      fn(entry.tx);
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return byId_.size();
+  }
+
+private:
+  struct Entry {
+    Blockchain::Transaction tx;
+    std::list<std::string>::iterator position;
+  };
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> byId_;
+  std::list<std::string> order_; // Oldest first
+};
+
+// A block being rebuilt from a compact announcement
+class PartialBlock {
+public:
+  enum class Status { Complete, NeedTxs, Invalid };
+
+  // Place prefilled transactions and match short IDs against the pool.
+  // Invalid means the announcement repeats a short ID; fetch the full
+  // block instead.
+  Status init(const CompactBlockMessage &msg, const TxRelayPool &pool) {
+    header_ = msg.header;
+    const size_t total = msg.txCount();
+    slots_.assign(total, std::nullopt);
+    missing_.clear();
+
+    std::vector<bool> prefilled(total, false);
+    for (const auto &p : msg.prefilled) {
+      slots_[p.index] = p.tx;
+      prefilled[p.index] = true;
+    }
+    std::unordered_map<uint64_t, uint32_t> slotById;
+    slotById.reserve(msg.shortIds.size());
+    uint32_t slot = 0;
+    for (uint64_t id : msg.shortIds) {
+      while (prefilled[slot]) {
+        ++slot;
+      }
+      if (!slotById.emplace(id, slot++).second) {
+        return Status::Invalid;
+      }
+    }
+
+    // Two pooled transactions behind one short ID: ask for the real one
+    std::vector<bool> ambiguous(total, false);
+    ShortIdHasher shortId(msg.header.hash, msg.nonce);
+    pool.forEach([&](const Blockchain::Transaction &tx) {
+      auto it = slotById.find(shortId(tx.txId));
+      if (it == slotById.end()) {
+        return;
+      }
+      auto &target = slots_[it->second];
+      if (!target && !ambiguous[it->second]) {
+        target = tx;
+      } else if (target && target->txId != tx.txId) {
+        target.reset();
+        ambiguous[it->second] = true;
+      }
+    });
+
+    for (uint32_t i = 0; i < total; ++i) {
+      if (!slots_[i]) {
+        missing_.push_back(i);
+      }
+    }
+    return missing_.empty() ? Status::Complete : Status::NeedTxs;
+  }
+
+  // Ascending indexes to request with GETBLOCKTXN
+  [[nodiscard]] const std::vector<uint32_t> &missing() const noexcept {
+    return missing_;
+  }
+
+  [[nodiscard]] const std::string &hash() const noexcept {
+    return header_.hash;
+  }
+
+  Status fill(BlockTxnMessage &&msg) {
+    if (msg.blockHash != header_.hash || msg.txs.size() != missing_.size()) {
+      return Status::Invalid;
+    }
+    for (size_t i = 0; i < missing_.size(); ++i) {
+      slots_[missing_[i]] = std::move(msg.txs[i]);
+    }
+    missing_.clear();
+    return Status::Complete;
+  }
+
+  // The assembled block, or nullopt if it does not match the header's
+  // merkle root (a short ID collision or a bad BLOCKTXN)
+  std::optional<Blockchain::Block>
+  take(const Crypto::CryptoManager &crypto) {
+    if (!missing_.empty()) {
+      return std::nullopt;
+    }
+    Blockchain::Block block = std::move(header_);
+    block.transactions.reserve(slots_.size());
+    for (auto &slot : slots_) {
+      block.transactions.push_back(std::move(*slot));
+    }
+    slots_.clear();
+    if (Blockchain::Block::computeMerkleRoot(block.transactions, crypto,
+                                             block.shardId) !=
+        block.merkleRoot) {
+      return std::nullopt;
+    }
+    return block;
+  }
+
+private:
+  Blockchain::Block header_;
+  std::vector<std::optional<Blockchain::Transaction>> slots_;
+  std::vector<uint32_t> missing_;
+};
+
+// Outbound frames for one peer. Any thread may queue; the connection's
+// writer drains the queue with writev(), so a burst of small messages
+// leaves in one system call.
+class SendQueue {
+public:
+  static constexpr int MAX_IOV = 64;
+
+  explicit SendQueue(uint32_t magic = MAINNET_MAGIC) noexcept
+      : magic_(magic) {}
+
+  void push(std::string frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytes_ += frame.size();
+    frames_.push_back(std::move(frame));
+  }
+
+  template <typename Message>
+  void push(MessageType type, const Message &msg) {
+    std::string payload;
+    msg.encode(payload);
+    push(type, std::string_view(payload));
+  }
+
+  void push(MessageType type, std::string_view payload) {
+    push(encodeFrame(type, payload, magic_));
+  }
+
+  // Write queued frames until the queue is empty or the socket would
+  // block. Returns false on a socket error.
+  bool flush(int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!frames_.empty()) {
+      iovec iov[MAX_IOV];
+      int count = 0;
+      for (auto it = frames_.begin(); it != frames_.end() && count < MAX_IOV;
+           ++it, ++count) {
+        size_t skip = count == 0 ? headOffset_ : 0;
+        iov[count].iov_base = it->data() + skip;
+        iov[count].iov_len = it->size() - skip;
+      }
+      ssize_t n = ::writev(fd, iov, count);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      ++writeCalls_;
+      consume(static_cast<size_t>(n));
+    }
+    return true;
+  }
+
+  [[nodiscard]] size_t pendingBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+  }
+
+  [[nodiscard]] size_t pendingFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_.size();
+  }
+
+  [[nodiscard]] uint64_t getWriteCalls() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writeCalls_;
+  }
+
+private:
+  uint32_t magic_;
+  mutable std::mutex mutex_;
+  std::deque<std::string> frames_;
+  size_t headOffset_{0}; // Bytes of frames_.front() already written
+  size_t bytes_{0};
+  uint64_t writeCalls_{0};
+
+  void consume(size_t n) {
+    bytes_ -= n;
+    while (n > 0) {
+      size_t left = frames_.front().size() - headOffset_;
+      if (n < left) {
+        headOffset_ += n;
+        return;
+      }
+      n -= left;
+      headOffset_ = 0;
+      frames_.pop_front();
+    }
+  }
+};
+
 // P2P Network Manager (Bitcoin Core-like)
 class NetworkManager final {
 public:
@@ -89,99 +968,149 @@ public:
   bool connectPeer(const std::string &address, int port) noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    if (peers_.size() >= maxPeers_) {
-      return false;
-    }
-
     std::string peerKey = address + ":" + std::to_string(port);
-    if (peers_.count(peerKey)) {
-      return false; // Already connected
+    if (!registerLocked(peerKey, address, port, false)) {
+      return false;
     }
 
-    PeerInfo peer;
-    peer.address = address;
-    peer.port = port;
-    peer.connectedTime = std::time(nullptr);
-    peer.lastSeen = peer.connectedTime;
-    peer.bytesReceived = 0;
-    peer.bytesSent = 0;
-    peer.inbound = false;
-    peer.version = 70015;
-    peer.userAgent = "/QuantumPulse:7.0.0/";
-    peer.pingTime = 0.0;
-    peer.banScore = 0;
-
-    peers_[peerKey] = peer;
-
     // Send version message
     sendVersion(peerKey);
 
     return true;
   }
 
+  // Register a live connection for relays without queueing VERSION (the
+  // connection does its own handshake); it drains the returned queue.
+  // nullptr when full, already attached or banned
+  std::shared_ptr<SendQueue> attachPeer(const std::string &peerKey,
+                                        bool inbound) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto banned = bannedPeers_.find(peerKey);
+    if (banned != bannedPeers_.end()) {
+      if (banned->second > std::time(nullptr)) {
+        return nullptr;
+      }
+      bannedPeers_.erase(banned);
+    }
+
+    auto colon = peerKey.rfind(':');
+    std::string address = peerKey.substr(0, colon);
+    int port = 0;
+    if (colon != std::string::npos) {
+      std::from_chars(peerKey.data() + colon + 1,
+                      peerKey.data() + peerKey.size(), port);
+    }
+    if (!registerLocked(peerKey, address, port, inbound)) {
+      return nullptr;
+    }
+    return sendQueues_[peerKey];
+  }
+
   // Disconnect peer
   void disconnectPeer(const std::string &peerKey) noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
     peers_.erase(peerKey);
+    sendQueues_.erase(peerKey);
   }
 
-  // Send message to peer
+  // Queue a framed message for a peer
   void sendMessage(const std::string &peerKey,
                    const NetworkMessage &msg) noexcept {
+    std::string frame = encodeFrame(msg.type, msg.payload, magic());
     std::lock_guard<std::mutex> lock(mutex_);
-
-    if (peers_.count(peerKey)) {
-      peers_[peerKey].bytesSent += msg.length;
-      outboundQueue_.push({peerKey, msg});
-    }
+    queueLocked(peerKey, std::move(frame));
   }
 
-  // Broadcast to all peers
-  void broadcast(const NetworkMessage &msg) noexcept {
+  // Broadcast to all peers but `except` (the peer a relayed message came
+  // from); the frame is encoded once
+  void broadcast(const NetworkMessage &msg,
+                 const std::string &except = {}) noexcept {
+    std::string frame = encodeFrame(msg.type, msg.payload, magic());
     std::lock_guard<std::mutex> lock(mutex_);
 
-    for (auto &[peerKey, peer] : peers_) {
-      peer.bytesSent += msg.length;
-      outboundQueue_.push({peerKey, msg});
+    for (const auto &entry : peers_) {
+      if (entry.first != except) {
+        queueLocked(entry.first, frame);
+      }
     }
   }
 
   // Announce transaction
   void announceTransaction(const std::string &txid) noexcept {
-    NetworkMessage msg;
-    msg.type = MessageType::INV;
-    msg.payload = "1:" + txid; // Type 1 = TX
-    msg.timestamp = std::time(nullptr);
-    msg.length = msg.payload.length();
-
-    broadcast(msg);
+    broadcast(makeMessage(MessageType::INV, InvMessage{{{INV_TX, txid}}}));
+    std::lock_guard<std::mutex> lock(mutex_);
     announcedTxs_.insert(txid);
   }
 
   // Announce block
   void announceBlock(const std::string &blockHash, int height) noexcept {
-    NetworkMessage msg;
-    msg.type = MessageType::INV;
-    msg.payload = "2:" + blockHash; // Type 2 = Block
-    msg.timestamp = std::time(nullptr);
-    msg.length = msg.payload.length();
+    broadcast(
+        makeMessage(MessageType::INV, InvMessage{{{INV_BLOCK, blockHash}}}));
+
+    Logging::Logger::getInstance().info(
+        "Block announced: " + blockHash.substr(0, 16) + "... at height " +
+            std::to_string(height),
+        "P2P", 0);
+  }
 
-    broadcast(msg);
+  // Relay a new block as a compact block; peers rebuild it from their
+  // relay pool and fetch only the transactions they have not seen
+  void relayBlock(const Blockchain::Block &block,
+                  const std::string &except = {}) noexcept {
+    uint64_t nonce;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      nonce = rng_();
+      ++blocksRelayed_;
+    }
+    broadcast(makeMessage(MessageType::CMPCTBLOCK,
+                          CompactBlockMessage::fromBlock(block, nonce)),
+              except);
 
     Logging::Logger::getInstance().info(
-        "Block announced: " + blockHash.substr(0, 16) + "...", "P2P", 0);
+        "Compact block relayed: " + block.hash.substr(0, 16) + "... (" +
+            std::to_string(block.transactions.size()) + " txs)",
+        "P2P", block.shardId);
+  }
+
+  // Relay a newly accepted transaction in full so peers can fill compact
+  // blocks from their relay pool
+  void relayTransaction(const Blockchain::Transaction &tx,
+                        const std::string &except = {}) noexcept {
+    broadcast(makeMessage(MessageType::TX, TxMessage{tx}), except);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++txRelayed_;
   }
 
   // Request block
   void requestBlock(const std::string &peerKey,
                     const std::string &blockHash) noexcept {
+    sendMessage(peerKey, makeMessage(MessageType::GETDATA,
+                                     GetDataMessage{{{INV_BLOCK, blockHash}}}));
+  }
+
+  // Outbound queue for a peer's connection to drain, or nullptr
+  std::shared_ptr<SendQueue>
+  getSendQueue(const std::string &peerKey) const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sendQueues_.find(peerKey);
+    return it != sendQueues_.end() ? it->second : nullptr;
+  }
+
+  // Wire magic as read from a frame header
+  [[nodiscard]] uint32_t magic() const noexcept {
+    return static_cast<uint32_t>(Serialize::getLE(networkMagic_.data(), 4));
+  }
+
+  template <typename Message>
+  static NetworkMessage makeMessage(MessageType type, const Message &body) {
     NetworkMessage msg;
-    msg.type = MessageType::GETDATA;
-    msg.payload = "2:" + blockHash;
+    msg.type = type;
+    body.encode(msg.payload);
     msg.timestamp = std::time(nullptr);
     msg.length = msg.payload.length();
-
-    sendMessage(peerKey, msg);
+    return msg;
   }
 
   // Get peer info
@@ -205,16 +1134,22 @@ public:
   std::map<std::string, int64_t> getStats() const noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    int64_t totalReceived = 0, totalSent = 0;
+    int64_t totalReceived = 0, totalSent = 0, queued = 0;
     for (const auto &[key, peer] : peers_) {
       totalReceived += peer.bytesReceived;
       totalSent += peer.bytesSent;
     }
+    for (const auto &[key, queue] : sendQueues_) {
+      queued += static_cast<int64_t>(queue->pendingBytes());
+    }
 
     return {{"peers", peers_.size()},
             {"bytesReceived", totalReceived},
             {"bytesSent", totalSent},
+            {"queuedBytes", queued},
             {"txAnnounced", announcedTxs_.size()},
+            {"txRelayed", txRelayed_},
+            {"blocksRelayed", blocksRelayed_},
             {"port", port_}};
   }
 
@@ -236,6 +1171,7 @@ public:
 
     bannedPeers_[peerKey] = std::time(nullptr) + banTime;
     peers_.erase(peerKey);
+    sendQueues_.erase(peerKey);
 
     Logging::Logger::getInstance().warning("Peer banned: " + peerKey, "P2P", 0);
   }
@@ -251,16 +1187,55 @@ private:
   std::map<std::string, int64_t> bannedPeers_;
   std::vector<std::pair<std::string, int>> seedNodes_;
 
-  std::queue<std::pair<std::string, NetworkMessage>> outboundQueue_;
+  std::map<std::string, std::shared_ptr<SendQueue>> sendQueues_;
+  std::mt19937_64 rng_{std::random_device{}()}; // Compact block nonces
+  int64_t txRelayed_ = 0;
+  int64_t blocksRelayed_ = 0;
 
-  void sendVersion(const std::string &peerKey) {
-    NetworkMessage msg;
-    msg.type = MessageType::VERSION;
-    msg.payload = "70015:/QuantumPulse:7.0.0/";
-    msg.timestamp = std::time(nullptr);
-    msg.length = msg.payload.length();
+  // Caller holds mutex_
+  bool registerLocked(const std::string &peerKey, const std::string &address,
+                      int port, bool inbound) {
+    if (peers_.size() >= maxPeers_ || peers_.count(peerKey)) {
+      return false;
+    }
 
-    sendMessage(peerKey, msg);
+    PeerInfo peer;
+    peer.address = address;
+    peer.port = port;
+    peer.connectedTime = std::time(nullptr);
+    peer.lastSeen = peer.connectedTime;
+    peer.bytesReceived = 0;
+    peer.bytesSent = 0;
+    peer.inbound = inbound;
+    peer.version = 70015;
+    peer.userAgent = "/QuantumPulse:7.0.0/";
+    peer.startingHeight = 0;
+    peer.pingTime = 0.0;
+    peer.banScore = 0;
+
+    peers_[peerKey] = peer;
+    sendQueues_[peerKey] = std::make_shared<SendQueue>(magic());
+    return true;
+  }
+
+  // Caller holds mutex_
+  void queueLocked(const std::string &peerKey, std::string frame) {
+    auto it = sendQueues_.find(peerKey);
+    if (it == sendQueues_.end()) {
+      return;
+    }
+    peers_[peerKey].bytesSent += static_cast<int64_t>(frame.size());
+    it->second->push(std::move(frame));
+  }
+
+  // Caller holds mutex_ (called from connectPeer)
+  void sendVersion(const std::string &peerKey) {
+    VersionMessage version;
+    version.timestamp = std::time(nullptr);
+    queueLocked(peerKey,
+                encodeFrame(MessageType::VERSION,
+                            makeMessage(MessageType::VERSION, version).payload,
+                            magic()));
   }
 };
 
@@ -0,0 +1,217 @@
+#ifndef QUANTUMPULSE_POW_V7_H
+#define QUANTUMPULSE_POW_V7_H
+
+#include "quantumpulse_crypto_v7.h"
+#include "quantumpulse_sha512_v7.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace QuantumPulse::Mining {
+
+// Fixed-layout binary block header (little-endian, 184 bytes):
+//   [0,4)    version
+//   [4,8)    difficulty (leading zero nibbles required)
+//   [8,16)   timestamp
+//   [16,80)  previous block hash (raw SHA-512)
+//   [80,144) merkle root (raw SHA-512)
+//   [144,176) miner id (first 32 bytes of SHA-512(miner address))
+//   [176,184) nonce
+// The first 128 bytes never change while a template is being mined, so they
+// are absorbed once into a SHA-512 midstate.
+struct PowHeader {
+  static constexpr size_t SIZE = 184;
+  static constexpr size_t NONCE_OFFSET = 176;
+  static constexpr size_t MINER_ID_SIZE = 32;
+
+  uint32_t version{7};
+  uint32_t difficulty{0};
+  int64_t timestamp{0};
+  Crypto::Digest512 prevHash{};
+  Crypto::Digest512 merkleRoot{};
+  std::array<unsigned char, MINER_ID_SIZE> minerId{};
+  uint64_t nonce{0};
+
+  void setMiner(std::string_view minerAddress) noexcept {
+    Crypto::Digest512 digest{};
+    [[maybe_unused]] bool ok = Crypto::Hashing::sha512(minerAddress, digest);
+    std::copy_n(digest.begin(), MINER_ID_SIZE, minerId.begin());
+  }
+
+  void serialize(unsigned char *out) const noexcept {
+    storeLE(out, version, 4);
+    storeLE(out + 4, difficulty, 4);
+    storeLE(out + 8, static_cast<uint64_t>(timestamp), 8);
+    std::memcpy(out + 16, prevHash.data(), prevHash.size());
+    std::memcpy(out + 80, merkleRoot.data(), merkleRoot.size());
+    std::memcpy(out + 144, minerId.data(), minerId.size());
+    storeLE(out + NONCE_OFFSET, nonce, 8);
+  }
+
+  static void storeLE(unsigned char *out, uint64_t value,
+                      size_t bytes) noexcept {
+    for (size_t i = 0; i < bytes; ++i) {
+      out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+  }
+};
+
+// Double SHA-512 of a header with the constant prefix pre-absorbed. Each
+// attempt patches the nonce into a pre-padded final block, so one attempt
+// costs exactly two compression calls and no allocation.
+class PowMidstate final {
+public:
+  explicit PowMidstate(const PowHeader &header) noexcept {
+    unsigned char bytes[PowHeader::SIZE];
+    header.serialize(bytes);
+
+    size_t consumed = Crypto::Sha512::absorbBlocks(prefix_, bytes,
+                                                   PowHeader::SIZE);
+    tailOffset_ = PowHeader::NONCE_OFFSET - consumed;
+
+    // Pre-pad the final block of the first hash (tail fits in one block)
+    std::memcpy(tailBlock_, bytes + consumed, PowHeader::SIZE - consumed);
+    tailBlock_[PowHeader::SIZE - consumed] = 0x80;
+    Crypto::Sha512::storeBE64(tailBlock_ + Crypto::Sha512::BLOCK_SIZE - 8,
+                              PowHeader::SIZE * 8);
+
+    // Pre-pad the single block of the second hash (64-byte message)
+    outerBlock_[Crypto::Sha512::DIGEST_SIZE] = 0x80;
+    Crypto::Sha512::storeBE64(outerBlock_ + Crypto::Sha512::BLOCK_SIZE - 8,
+                              Crypto::Sha512::DIGEST_SIZE * 8);
+  }
+
+  // Double SHA-512 of the header with `nonce`; thread-safe (no mutation)
+  void hash(uint64_t nonce, Crypto::Digest512 &out) const noexcept {
+    unsigned char block[Crypto::Sha512::BLOCK_SIZE];
+    unsigned char outer[Crypto::Sha512::BLOCK_SIZE];
+    std::memcpy(block, tailBlock_, sizeof(block));
+    std::memcpy(outer, outerBlock_, sizeof(outer));
+    PowHeader::storeLE(block + tailOffset_, nonce, 8);
+
+    auto h = prefix_.h;
+    Crypto::Sha512::compress(h, block);
+    for (int i = 0; i < 8; ++i) {
+      Crypto::Sha512::storeBE64(outer + 8 * i, h[i]);
+    }
+
+    h = Crypto::Sha512::INITIAL_STATE;
+    Crypto::Sha512::compress(h, outer);
+    for (int i = 0; i < 8; ++i) {
+      Crypto::Sha512::storeBE64(out.data() + 8 * i, h[i]);
+    }
+  }
+
+private:
+  Crypto::Sha512::State prefix_;
+  size_t tailOffset_{0};
+  unsigned char tailBlock_[Crypto::Sha512::BLOCK_SIZE] = {};
+  unsigned char outerBlock_[Crypto::Sha512::BLOCK_SIZE] = {};
+};
+
+// Check leading zero nibbles directly on the raw digest
+[[nodiscard]] inline bool meetsTarget(const Crypto::Digest512 &digest,
+                                      int difficulty) noexcept {
+  if (difficulty <= 0) {
+    return true;
+  }
+  if (difficulty > static_cast<int>(digest.size() * 2)) {
+    return false;
+  }
+  int fullBytes = difficulty / 2;
+  for (int i = 0; i < fullBytes; ++i) {
+    if (digest[i] != 0) {
+      return false;
+    }
+  }
+  return (difficulty % 2 == 0) || (digest[fullBytes] >> 4) == 0;
+}
+
+// Result of a successful nonce search
+struct PowResult {
+  uint64_t nonce{0};
+  Crypto::Digest512 hash{};
+  unsigned workerId{0};
+};
+
+// Multi-threaded nonce search. The requested nonce range is split into one
+// contiguous slice per worker; the first worker to hit the target stops the
+// others.
+class PowEngine final {
+public:
+  explicit PowEngine(unsigned threads = std::thread::hardware_concurrency())
+      : threads_(std::max(1u, threads)) {}
+
+  PowEngine(const PowEngine &) = delete;
+  PowEngine &operator=(const PowEngine &) = delete;
+
+  [[nodiscard]] std::optional<PowResult>
+  search(const PowHeader &header, uint64_t startNonce, uint64_t count,
+         const std::atomic<bool> &keepRunning) {
+    const PowMidstate midstate(header);
+    const int difficulty = static_cast<int>(header.difficulty);
+
+    std::atomic<bool> found{false};
+    std::optional<PowResult> result;
+    std::mutex resultMutex;
+
+    auto worker = [&](unsigned id, uint64_t first, uint64_t last) {
+      Crypto::Digest512 digest;
+      uint64_t local = 0;
+      for (uint64_t nonce = first; nonce < last; ++nonce) {
+        midstate.hash(nonce, digest);
+        ++local;
+        if (meetsTarget(digest, difficulty)) {
+          std::lock_guard<std::mutex> lock(resultMutex);
+          if (!found.exchange(true)) {
+            result = PowResult{nonce, digest, id};
+          }
+          break;
+        }
+        if ((local & (CHECK_INTERVAL - 1)) == 0) {
+          totalHashes_.fetch_add(CHECK_INTERVAL, std::memory_order_relaxed);
+          local = 0;
+          if (found.load(std::memory_order_relaxed) ||
+              !keepRunning.load(std::memory_order_relaxed)) {
+            break;
+          }
+        }
+      }
+      totalHashes_.fetch_add(local, std::memory_order_relaxed);
+    };
+
+    uint64_t slice = count / threads_;
+    std::vector<std::thread> workers;
+    workers.reserve(threads_);
+    for (unsigned i = 0; i < threads_; ++i) {
+      uint64_t first = startNonce + i * slice;
+      uint64_t last = (i + 1 == threads_) ? startNonce + count : first + slice;
+      workers.emplace_back(worker, i, first, last);
+    }
+    for (auto &t : workers) {
+      t.join();
+    }
+    return result;
+  }
+
+  [[nodiscard]] uint64_t getTotalHashes() const noexcept {
+    return totalHashes_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] unsigned getThreadCount() const noexcept { return threads_; }
+
+private:
+  static constexpr uint64_t CHECK_INTERVAL = 4096;
+
+  unsigned threads_;
+  std::atomic<uint64_t> totalHashes_{0};
+};
+
+} // namespace QuantumPulse::Mining
+
+#endif // QUANTUMPULSE_POW_V7_H
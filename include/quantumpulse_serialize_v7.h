@@ -0,0 +1,126 @@
+#ifndef QUANTUMPULSE_SERIALIZE_V7_H
+#define QUANTUMPULSE_SERIALIZE_V7_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Little-endian binary encoding shared by the on-disk stores and the P2P
+// wire codecs. Strings are u32 length-prefixed.
+namespace QuantumPulse::Serialize {
+
+inline void putU8(std::string &out, uint8_t v) {
+  out.push_back(static_cast<char>(v));
+}
+
+inline void putU16(std::string &out, uint16_t v) {
+  for (int i = 0; i < 2; ++i) {
+    out.push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+inline void putU32(std::string &out, uint32_t v) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+inline void putU64(std::string &out, uint64_t v) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>(v >> (8 * i)));
+  }
+}
+
+inline void putI64(std::string &out, int64_t v) {
+  putU64(out, static_cast<uint64_t>(v));
+}
+
+inline void putDouble(std::string &out, double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  putU64(out, bits);
+}
+
+inline void putBytes(std::string &out, std::string_view s) {
+  putU32(out, static_cast<uint32_t>(s.size()));
+  out.append(s);
+}
+
+inline uint64_t getLE(const unsigned char *p, int bytes) noexcept {
+  uint64_t v = 0;
+  for (int i = 0; i < bytes; ++i) {
+    v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  }
+  return v;
+}
+
+// Bounds-checked little-endian reader over a record payload
+class ByteReader {
+public:
+  explicit ByteReader(std::string_view data) noexcept : data_(data) {}
+
+  bool u8(uint8_t &v) noexcept { return fixed(&v, 1); }
+  bool u16(uint16_t &v) noexcept { return fixed(&v, 2); }
+  bool u32(uint32_t &v) noexcept {
+    uint64_t w;
+    return fixed(&w, 4) && (v = static_cast<uint32_t>(w), true);
+  }
+  bool u64(uint64_t &v) noexcept { return fixed(&v, 8); }
+  bool i64(int64_t &v) noexcept {
+    uint64_t w;
+    return u64(w) && (v = static_cast<int64_t>(w), true);
+  }
+  bool f64(double &v) noexcept {
+    uint64_t bits;
+    return u64(bits) && (std::memcpy(&v, &bits, sizeof(v)), true);
+  }
+  bool raw(void *out, size_t n) noexcept {
+    if (data_.size() - pos_ < n) {
+      return false;
+    }
+    std::memcpy(out, data_.data() + pos_, n);
+    pos_ += n;
+    return true;
+  }
+  bool bytes(std::string &out) {
+    uint32_t len;
+    if (!u32(len) || data_.size() - pos_ < len) {
+      return false;
+    }
+    out.assign(data_.data() + pos_, len);
+    pos_ += len;
+    return true;
+  }
+  bool view(std::string_view &out, size_t n) noexcept {
+    if (data_.size() - pos_ < n) {
+      return false;
+    }
+    out = data_.substr(pos_, n);
+    pos_ += n;
+    return true;
+  }
+  [[nodiscard]] size_t position() const noexcept { return pos_; }
+  [[nodiscard]] size_t remaining() const noexcept {
+    return data_.size() - pos_;
+  }
+  [[nodiscard]] bool done() const noexcept { return pos_ == data_.size(); }
+
+private:
+  std::string_view data_;
+  size_t pos_{0};
+
+  template <typename T> bool fixed(T *out, int n) noexcept {
+    if (data_.size() - pos_ < static_cast<size_t>(n)) {
+      return false;
+    }
+    *out = static_cast<T>(getLE(
+        reinterpret_cast<const unsigned char *>(data_.data() + pos_), n));
+    pos_ += n;
+    return true;
+  }
+};
+
+} // namespace QuantumPulse::Serialize
+
+#endif // QUANTUMPULSE_SERIALIZE_V7_H
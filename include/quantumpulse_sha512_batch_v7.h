@@ -0,0 +1,343 @@
+#ifndef QUANTUMPULSE_SHA512_BATCH_V7_H
+#define QUANTUMPULSE_SHA512_BATCH_V7_H
+
+#include "quantumpulse_sha512_v7.h"
+#include <algorithm>
+#include <string_view>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QUANTUMPULSE_SHA512_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace QuantumPulse::Crypto::Sha512 {
+
+// Multi-buffer SHA-512: hashes 4 (AVX2) or 8 (AVX-512) independent messages
+// at once, one message per 64-bit SIMD lane. The kernel is chosen at runtime
+// from CPU features; the scalar kernel is always available.
+
+using Digest = std::array<unsigned char, DIGEST_SIZE>;
+
+enum class BatchKernel : uint8_t { Scalar = 0, AVX2 = 1, AVX512 = 2 };
+
+[[nodiscard]] constexpr std::string_view
+batchKernelName(BatchKernel kernel) noexcept {
+  switch (kernel) {
+  case BatchKernel::AVX2:
+    return "avx2x4";
+  case BatchKernel::AVX512:
+    return "avx512x8";
+  default:
+    return "scalar";
+  }
+}
+
+[[nodiscard]] constexpr size_t batchLanes(BatchKernel kernel) noexcept {
+  switch (kernel) {
+  case BatchKernel::AVX2:
+    return 4;
+  case BatchKernel::AVX512:
+    return 8;
+  default:
+    return 1;
+  }
+}
+
+[[nodiscard]] inline bool batchKernelSupported(BatchKernel kernel) noexcept {
+#ifdef QUANTUMPULSE_SHA512_X86_KERNELS
+  switch (kernel) {
+  case BatchKernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+  case BatchKernel::AVX512:
+    return __builtin_cpu_supports("avx512f");
+  default:
+    return true;
+  }
+#else
+  return kernel == BatchKernel::Scalar;
+#endif
+}
+
+// Widest kernel the running CPU supports (detected once)
+[[nodiscard]] inline BatchKernel detectBatchKernel() noexcept {
+  static const BatchKernel best = [] {
+    if (batchKernelSupported(BatchKernel::AVX512)) {
+      return BatchKernel::AVX512;
+    }
+    if (batchKernelSupported(BatchKernel::AVX2)) {
+      return BatchKernel::AVX2;
+    }
+    return BatchKernel::Scalar;
+  }();
+  return best;
+}
+
+namespace detail {
+
+// Per-lane view of a message as a sequence of padded 128-byte blocks. Full
+// blocks are read in place; only the final one or two blocks are copied.
+struct LaneCursor {
+  const unsigned char *data{nullptr};
+  size_t fullBlocks{0};
+  size_t totalBlocks{0};
+  unsigned char tail[2 * BLOCK_SIZE];
+
+  void reset(std::string_view message) noexcept {
+    data = reinterpret_cast<const unsigned char *>(message.data());
+    fullBlocks = message.size() / BLOCK_SIZE;
+    size_t rem = message.size() - fullBlocks * BLOCK_SIZE;
+    size_t tailBlocks = (rem + 17 <= BLOCK_SIZE) ? 1 : 2;
+    std::memset(tail, 0, sizeof(tail));
+    std::memcpy(tail, data + fullBlocks * BLOCK_SIZE, rem);
+    tail[rem] = 0x80;
+    storeBE64(tail + tailBlocks * BLOCK_SIZE - 8,
+              static_cast<uint64_t>(message.size()) * 8);
+    totalBlocks = fullBlocks + tailBlocks;
+  }
+
+  [[nodiscard]] const unsigned char *block(size_t i) const noexcept {
+    return i < fullBlocks ? data + i * BLOCK_SIZE
+                          : tail + (i - fullBlocks) * BLOCK_SIZE;
+  }
+};
+
+inline constexpr unsigned char ZERO_BLOCK[BLOCK_SIZE] = {};
+
+#ifdef QUANTUMPULSE_SHA512_X86_KERNELS
+
+#define QP_ROTR256(x, n)                                                       \
+  _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+
+__attribute__((target("avx2"))) inline void
+hashGroupAvx2(const std::string_view *messages, size_t lanes,
+              Digest *out) noexcept {
+  LaneCursor cursor[4];
+  size_t maxBlocks = 0;
+  for (size_t l = 0; l < 4; ++l) {
+    if (l < lanes) {
+      cursor[l].reset(messages[l]);
+      maxBlocks = std::max(maxBlocks, cursor[l].totalBlocks);
+    }
+  }
+
+  __m256i h[8];
+  for (int i = 0; i < 8; ++i) {
+    h[i] = _mm256_set1_epi64x(static_cast<long long>(INITIAL_STATE[i]));
+  }
+
+  for (size_t b = 0; b < maxBlocks; ++b) {
+    const unsigned char *p[4];
+    for (size_t l = 0; l < 4; ++l) {
+      p[l] = (l < lanes && b < cursor[l].totalBlocks) ? cursor[l].block(b)
+                                                      : ZERO_BLOCK;
+    }
+
+    __m256i w[80];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = _mm256_set_epi64x(static_cast<long long>(loadBE64(p[3] + 8 * i)),
+                               static_cast<long long>(loadBE64(p[2] + 8 * i)),
+                               static_cast<long long>(loadBE64(p[1] + 8 * i)),
+                               static_cast<long long>(loadBE64(p[0] + 8 * i)));
+    }
+    for (int i = 16; i < 80; ++i) {
+      __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(QP_ROTR256(w[i - 15], 1), QP_ROTR256(w[i - 15], 8)),
+          _mm256_srli_epi64(w[i - 15], 7));
+      __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(QP_ROTR256(w[i - 2], 19), QP_ROTR256(w[i - 2], 61)),
+          _mm256_srli_epi64(w[i - 2], 6));
+      w[i] = _mm256_add_epi64(_mm256_add_epi64(w[i - 16], s0),
+                              _mm256_add_epi64(w[i - 7], s1));
+    }
+
+    __m256i a = h[0], bb = h[1], c = h[2], d = h[3];
+    __m256i e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 80; ++i) {
+      __m256i S1 = _mm256_xor_si256(
+          _mm256_xor_si256(QP_ROTR256(e, 14), QP_ROTR256(e, 18)),
+          QP_ROTR256(e, 41));
+      __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f),
+                                    _mm256_andnot_si256(e, g));
+      __m256i t1 = _mm256_add_epi64(
+          _mm256_add_epi64(_mm256_add_epi64(k, S1), ch),
+          _mm256_add_epi64(
+              _mm256_set1_epi64x(static_cast<long long>(ROUND_CONSTANTS[i])),
+              w[i]));
+      __m256i S0 = _mm256_xor_si256(
+          _mm256_xor_si256(QP_ROTR256(a, 28), QP_ROTR256(a, 34)),
+          QP_ROTR256(a, 39));
+      __m256i maj = _mm256_xor_si256(
+          _mm256_xor_si256(_mm256_and_si256(a, bb), _mm256_and_si256(a, c)),
+          _mm256_and_si256(bb, c));
+      __m256i t2 = _mm256_add_epi64(S0, maj);
+      k = g;
+      g = f;
+      f = e;
+      e = _mm256_add_epi64(d, t1);
+      d = c;
+      c = bb;
+      bb = a;
+      a = _mm256_add_epi64(t1, t2);
+    }
+    h[0] = _mm256_add_epi64(h[0], a);
+    h[1] = _mm256_add_epi64(h[1], bb);
+    h[2] = _mm256_add_epi64(h[2], c);
+    h[3] = _mm256_add_epi64(h[3], d);
+    h[4] = _mm256_add_epi64(h[4], e);
+    h[5] = _mm256_add_epi64(h[5], f);
+    h[6] = _mm256_add_epi64(h[6], g);
+    h[7] = _mm256_add_epi64(h[7], k);
+
+    // Emit lanes whose message ended on this block
+    for (size_t l = 0; l < lanes; ++l) {
+      if (cursor[l].totalBlocks == b + 1) {
+        alignas(32) uint64_t words[4];
+        for (int i = 0; i < 8; ++i) {
+          _mm256_store_si256(reinterpret_cast<__m256i *>(words), h[i]);
+          storeBE64(out[l].data() + 8 * i, words[l]);
+        }
+      }
+    }
+  }
+}
+
+#undef QP_ROTR256
+
+// GCC's AVX-512 intrinsics seed results from _mm512_undefined_*(), which
+// trips -Wmaybe-uninitialized once inlined here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f"))) inline void
+hashGroupAvx512(const std::string_view *messages, size_t lanes,
+                Digest *out) noexcept {
+  LaneCursor cursor[8];
+  size_t maxBlocks = 0;
+  for (size_t l = 0; l < 8; ++l) {
+    if (l < lanes) {
+      cursor[l].reset(messages[l]);
+      maxBlocks = std::max(maxBlocks, cursor[l].totalBlocks);
+    }
+  }
+
+  __m512i h[8];
+  for (int i = 0; i < 8; ++i) {
+    h[i] = _mm512_set1_epi64(static_cast<long long>(INITIAL_STATE[i]));
+  }
+
+  for (size_t b = 0; b < maxBlocks; ++b) {
+    const unsigned char *p[8];
+    for (size_t l = 0; l < 8; ++l) {
+      p[l] = (l < lanes && b < cursor[l].totalBlocks) ? cursor[l].block(b)
+                                                      : ZERO_BLOCK;
+    }
+
+    __m512i w[80];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = _mm512_set_epi64(static_cast<long long>(loadBE64(p[7] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[6] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[5] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[4] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[3] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[2] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[1] + 8 * i)),
+                              static_cast<long long>(loadBE64(p[0] + 8 * i)));
+    }
+    for (int i = 16; i < 80; ++i) {
+      __m512i s0 = _mm512_ternarylogic_epi64(
+          _mm512_ror_epi64(w[i - 15], 1), _mm512_ror_epi64(w[i - 15], 8),
+          _mm512_srli_epi64(w[i - 15], 7), 0x96);
+      __m512i s1 = _mm512_ternarylogic_epi64(
+          _mm512_ror_epi64(w[i - 2], 19), _mm512_ror_epi64(w[i - 2], 61),
+          _mm512_srli_epi64(w[i - 2], 6), 0x96);
+      w[i] = _mm512_add_epi64(_mm512_add_epi64(w[i - 16], s0),
+                              _mm512_add_epi64(w[i - 7], s1));
+    }
+
+    __m512i a = h[0], bb = h[1], c = h[2], d = h[3];
+    __m512i e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 80; ++i) {
+      // 0x96 = a ^ b ^ c, 0xCA = a ? b : c, 0xE8 = majority(a, b, c)
+      __m512i S1 = _mm512_ternarylogic_epi64(
+          _mm512_ror_epi64(e, 14), _mm512_ror_epi64(e, 18),
+          _mm512_ror_epi64(e, 41), 0x96);
+      __m512i ch = _mm512_ternarylogic_epi64(e, f, g, 0xCA);
+      __m512i t1 = _mm512_add_epi64(
+          _mm512_add_epi64(_mm512_add_epi64(k, S1), ch),
+          _mm512_add_epi64(
+              _mm512_set1_epi64(static_cast<long long>(ROUND_CONSTANTS[i])),
+              w[i]));
+      __m512i S0 = _mm512_ternarylogic_epi64(
+          _mm512_ror_epi64(a, 28), _mm512_ror_epi64(a, 34),
+          _mm512_ror_epi64(a, 39), 0x96);
+      __m512i maj = _mm512_ternarylogic_epi64(a, bb, c, 0xE8);
+      __m512i t2 = _mm512_add_epi64(S0, maj);
+      k = g;
+      g = f;
+      f = e;
+      e = _mm512_add_epi64(d, t1);
+      d = c;
+      c = bb;
+      bb = a;
+      a = _mm512_add_epi64(t1, t2);
+    }
+    h[0] = _mm512_add_epi64(h[0], a);
+    h[1] = _mm512_add_epi64(h[1], bb);
+    h[2] = _mm512_add_epi64(h[2], c);
+    h[3] = _mm512_add_epi64(h[3], d);
+    h[4] = _mm512_add_epi64(h[4], e);
+    h[5] = _mm512_add_epi64(h[5], f);
+    h[6] = _mm512_add_epi64(h[6], g);
+    h[7] = _mm512_add_epi64(h[7], k);
+
+    for (size_t l = 0; l < lanes; ++l) {
+      if (cursor[l].totalBlocks == b + 1) {
+        alignas(64) uint64_t words[8];
+        for (int i = 0; i < 8; ++i) {
+          _mm512_store_si512(words, h[i]);
+          storeBE64(out[l].data() + 8 * i, words[l]);
+        }
+      }
+    }
+  }
+}
+
+#pragma GCC diagnostic pop
+
+#endif // QUANTUMPULSE_SHA512_X86_KERNELS
+
+} // namespace detail
+
+// Hash `count` independent messages into `out[0..count)`. Messages of
+// similar length get the best lane utilisation; unsupported kernels fall
+// back to scalar.
+inline void hashBatch(const std::string_view *messages, size_t count,
+                      Digest *out,
+                      BatchKernel kernel = detectBatchKernel()) noexcept {
+  if (!batchKernelSupported(kernel)) {
+    kernel = BatchKernel::Scalar;
+  }
+
+  size_t i = 0;
+#ifdef QUANTUMPULSE_SHA512_X86_KERNELS
+  const size_t lanes = batchLanes(kernel);
+  // A partial group still pays for a full vector pass, so only use SIMD when
+  // at least two lanes are occupied
+  for (; i < count && count - i >= 2 && kernel != BatchKernel::Scalar;
+       i += lanes) {
+    size_t group = std::min(lanes, count - i);
+    if (kernel == BatchKernel::AVX512) {
+      detail::hashGroupAvx512(messages + i, group, out + i);
+    } else {
+      detail::hashGroupAvx2(messages + i, group, out + i);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    hash(messages[i].data(), messages[i].size(), out[i].data());
+  }
+}
+
+} // namespace QuantumPulse::Crypto::Sha512
+
+#endif // QUANTUMPULSE_SHA512_BATCH_V7_H
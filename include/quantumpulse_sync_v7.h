@@ -0,0 +1,946 @@
+#ifndef QUANTUMPULSE_SYNC_V7_H
+#define QUANTUMPULSE_SYNC_V7_H
+
+#include "quantumpulse_blockchain_v7.h"
+#include "quantumpulse_logging_v7.h"
+#include "quantumpulse_p2p_protocol_v7.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace QuantumPulse::Network {
+
+// Initial block download tunables
+struct SyncConfig {
+  size_t windowBlocks{1024};     // Max blocks fetched ahead of the tip
+  size_t maxInFlightPerPeer{64}; // Outstanding GETDATA items per peer
+  std::chrono::milliseconds stallTimeout{2000};
+  std::chrono::milliseconds pollInterval{50};
+  std::chrono::milliseconds handshakeTimeout{5000};
+};
+
+struct SyncStats {
+  uint64_t headers{0};
+  uint64_t blocks{0}; // Connected to the chain
+  uint64_t bytesReceived{0};
+  uint64_t rerequests{0};
+  uint64_t stalls{0};
+  size_t peers{0};
+  double headerSeconds{0};
+  double blockSeconds{0};
+
+  [[nodiscard]] double blocksPerSecond() const noexcept {
+    return blockSeconds > 0 ? static_cast<double>(blocks) / blockSeconds : 0;
+  }
+};
+
+namespace detail {
+
+inline void setReadTimeout(int fd, std::chrono::milliseconds timeout) {
+  timeval tv{};
+  tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+} // namespace detail
+
+// Blocking TCP connection to a numeric "a.b.c.d:port"; -1 on failure
+inline int connectEndpoint(const std::string &endpoint) {
+  size_t colon = endpoint.rfind(':');
+  if (colon == std::string::npos) {
+    return -1;
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(
+      std::strtoul(endpoint.c_str() + colon + 1, nullptr, 10)));
+  if (::inet_pton(AF_INET, endpoint.substr(0, colon).c_str(),
+                  &addr.sin_addr) != 1) {
+    return -1;
+  }
+  int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Serving side of the block protocol: answers handshakes, pings, header
+// requests and block requests from the local chain, and accepts new
+// blocks relayed as compact blocks. Relayed transactions go into `pool`
+// (if given) so later compact blocks can be rebuilt from it.
+class PeerService {
+public:
+  static constexpr size_t READ_CHUNK = 65536;
+  static constexpr int RELAY_POLL_MS = 50; // Relay latency bound in serve()
+
+  // Per-connection relay state: compact blocks waiting for BLOCKTXN and
+  // blocks fetched in full because they could not be rebuilt
+  struct Session {
+    std::unordered_map<std::string, P2P::PartialBlock> partial;
+    std::unordered_set<std::string> fullRequested;
+    std::string peerKey;     // Skipped when relaying what this peer sent
+    bool versionSent{false}; // Our VERSION is out; answer theirs with VERACK
+  };
+
+  // A connection registered with the NetworkManager for relays
+  struct Link {
+    P2P::SendQueue *relay{nullptr}; // Frames relayed from other peers
+    std::string peerKey;
+    bool outbound{false}; // We dialled: send VERSION first
+  };
+
+  // With a `network`, transactions and blocks accepted from one peer are
+  // relayed to all the others
+  explicit PeerService(Blockchain::Blockchain &chain,
+                       P2P::TxRelayPool *pool = nullptr,
+                       P2P::NetworkManager *network = nullptr) noexcept
+      : chain_(chain), pool_(pool), network_(network) {}
+
+  // Answer one message into `out`; false if its payload does not decode
+  bool handle(const P2P::Frame &frame, P2P::SendQueue &out) const {
+    Session session;
+    return handle(frame, out, session);
+  }
+
+  bool handle(const P2P::Frame &frame, P2P::SendQueue &out,
+              Session &session) const {
+    using P2P::MessageType;
+    switch (frame.type) {
+    case MessageType::VERSION: {
+      if (!P2P::VersionMessage::decode(frame.payload)) {
+        return false;
+      }
+      if (!session.versionSent) {
+        out.push(MessageType::VERSION, versionMessage());
+        session.versionSent = true;
+      }
+      out.push(MessageType::VERACK, std::string_view{});
+      return true;
+    }
+    case MessageType::PING: {
+      auto ping = P2P::PingMessage::decode(frame.payload);
+      if (!ping) {
+        return false;
+      }
+      out.push(MessageType::PONG, *ping);
+      return true;
+    }
+    case MessageType::GETHEADERS: {
+      auto request = P2P::GetHeadersMessage::decode(frame.payload);
+      if (!request) {
+        return false;
+      }
+      // Headers follow the first locator entry we know
+      P2P::HeadersMessage reply;
+      for (const auto &hash : request->locator) {
+        if (auto height = chain_.getBlockHeight(hash)) {
+          reply.headers =
+              chain_.getHeaders(*height + 1, P2P::Codec::MAX_HEADERS);
+          break;
+        }
+      }
+      for (size_t i = 0; i < reply.headers.size(); ++i) {
+        if (reply.headers[i].hash == request->stopHash) {
+          reply.headers.resize(i + 1);
+          break;
+        }
+      }
+      out.push(MessageType::HEADERS, reply);
+      return true;
+    }
+    case MessageType::GETDATA: {
+      auto request = P2P::GetDataMessage::decode(frame.payload);
+      if (!request) {
+        return false;
+      }
+      P2P::InvMessage notFound;
+      for (auto &item : request->items) {
+        std::optional<Blockchain::Block> block;
+        if (item.type == P2P::INV_BLOCK) {
+          if (auto height = chain_.getBlockHeight(item.hash)) {
+            block = chain_.getBlock(*height);
+          }
+        }
+        if (block) {
+          out.push(MessageType::BLOCK, P2P::BlockMessage{std::move(*block)});
+        } else {
+          notFound.items.push_back(std::move(item));
+        }
+      }
+      if (!notFound.items.empty()) {
+        out.push(MessageType::NOTFOUND, notFound);
+      }
+      return true;
+    }
+    case MessageType::TX: {
+      auto msg = P2P::TxMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      // The pool drops repeats, so a relay loop ends at the first node
+      // that has already seen the transaction
+      if (pool_ && msg->tx.verify(chain_.getCryptoManager()) &&
+          pool_->add(msg->tx) && network_) {
+        network_->relayTransaction(msg->tx, session.peerKey);
+      }
+      return true;
+    }
+    case MessageType::CMPCTBLOCK: {
+      auto msg = P2P::CompactBlockMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      if (!extendsTip(msg->header) || session.partial.count(msg->header.hash)) {
+        return true;
+      }
+      static const P2P::TxRelayPool noPool(1);
+      P2P::PartialBlock partial;
+      auto status = partial.init(*msg, pool_ ? *pool_ : noPool);
+      if (status == P2P::PartialBlock::Status::NeedTxs) {
+        out.push(MessageType::GETBLOCKTXN,
+                 P2P::GetBlockTxnMessage{partial.hash(), partial.missing()});
+        session.partial.emplace(partial.hash(), std::move(partial));
+      } else if (status == P2P::PartialBlock::Status::Invalid ||
+                 !connect(partial.take(chain_.getCryptoManager()), session)) {
+        requestFull(msg->header.hash, out, session);
+      }
+      return true;
+    }
+    case MessageType::BLOCKTXN: {
+      auto msg = P2P::BlockTxnMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      auto it = session.partial.find(msg->blockHash);
+      if (it == session.partial.end()) {
+        return true; // Not asked for
+      }
+      P2P::PartialBlock partial = std::move(it->second);
+      session.partial.erase(it);
+      if (partial.fill(std::move(*msg)) == P2P::PartialBlock::Status::Invalid ||
+          !connect(partial.take(chain_.getCryptoManager()), session)) {
+        requestFull(partial.hash(), out, session);
+      }
+      return true;
+    }
+    case MessageType::BLOCK: {
+      auto msg = P2P::BlockMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      if (session.fullRequested.erase(msg->block.hash) &&
+          extendsTip(msg->block)) {
+        connect(std::move(msg->block), session);
+      }
+      return true;
+    }
+    case MessageType::GETBLOCKTXN: {
+      auto request = P2P::GetBlockTxnMessage::decode(frame.payload);
+      if (!request) {
+        return false;
+      }
+      auto height = chain_.getBlockHeight(request->blockHash);
+      auto block = height ? chain_.getBlock(*height) : std::nullopt;
+      if (!block) {
+        out.push(MessageType::NOTFOUND,
+                 P2P::InvMessage{{{P2P::INV_BLOCK, request->blockHash}}});
+        return true;
+      }
+      P2P::BlockTxnMessage reply{std::move(request->blockHash), {}};
+      reply.txs.reserve(request->indexes.size());
+      for (uint32_t i : request->indexes) {
+        if (i >= block->transactions.size()) {
+          return false;
+        }
+        reply.txs.push_back(std::move(block->transactions[i]));
+      }
+      out.push(MessageType::BLOCKTXN, reply);
+      return true;
+    }
+    default:
+      return true; // Not served by this node yet
+    }
+  }
+
+  // Serve one blocking connection until EOF, a protocol error or !running.
+  // Frames may arrive split across reads or several per read; the replies
+  // to one read leave together in a single writev(). Frames relayed to the
+  // link's queue are written between reads, at most RELAY_POLL_MS late.
+  void serve(int fd, const std::atomic<bool> &running) const {
+    serve(fd, running, Link{});
+  }
+
+  void serve(int fd, const std::atomic<bool> &running, Link link) const {
+    P2P::FrameDecoder decoder;
+    P2P::SendQueue out;
+    Session session;
+    session.peerKey = std::move(link.peerKey);
+    if (link.outbound) {
+      out.push(P2P::MessageType::VERSION, versionMessage());
+      session.versionSent = true;
+      if (!out.flush(fd)) {
+        return;
+      }
+    }
+    pollfd pfd{fd, POLLIN, 0};
+    while (running) {
+      if (link.relay && !link.relay->flush(fd)) {
+        return;
+      }
+      int ready = ::poll(&pfd, 1, RELAY_POLL_MS);
+      if (ready < 0 && errno != EINTR) {
+        return;
+      }
+      if (ready <= 0) {
+        continue;
+      }
+
+      char *buf = decoder.prepare(READ_CHUNK);
+      ssize_t bytes = ::recv(fd, buf, READ_CHUNK, 0);
+      decoder.commit(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+      if (bytes <= 0) {
+        return;
+      }
+
+      P2P::Frame frame;
+      P2P::FrameDecoder::Status status;
+      bool ok = true;
+      while (ok && (status = decoder.next(frame)) ==
+                       P2P::FrameDecoder::Status::Ready) {
+        ok = handle(frame, out, session);
+      }
+      if (!out.flush(fd) || !ok ||
+          status == P2P::FrameDecoder::Status::Error) {
+        Logging::Logger::getInstance().warning(
+            "Dropping peer after malformed message", "P2P", 0);
+        return;
+      }
+    }
+  }
+
+private:
+  Blockchain::Blockchain &chain_;
+  P2P::TxRelayPool *pool_;
+  P2P::NetworkManager *network_;
+
+  P2P::VersionMessage versionMessage() const {
+    P2P::VersionMessage version;
+    version.timestamp = std::time(nullptr);
+    version.startHeight = static_cast<int32_t>(chain_.getChainLength());
+    return version;
+  }
+
+  // New block on top of our tip with valid work
+  bool extendsTip(const Blockchain::Block &header) const {
+    auto tip = chain_.getBlockHash(chain_.getChainLength() - 1);
+    return tip && header.prevHash == *tip &&
+           !chain_.getBlockHeight(header.hash) &&
+           header.checkProofOfWork(chain_.getMiningManager());
+  }
+
+  bool connect(std::optional<Blockchain::Block> block,
+               const Session &session) const {
+    if (!block || !chain_.addBlock(*block)) {
+      return false;
+    }
+    if (pool_) {
+      pool_->erase(block->transactions);
+    }
+    if (network_) {
+      network_->relayBlock(*block, session.peerKey);
+    }
+    return true;
+  }
+
+  static void requestFull(const std::string &hash, P2P::SendQueue &out,
+                          Session &session) {
+    out.push(P2P::MessageType::GETDATA,
+             P2P::GetDataMessage{{{P2P::INV_BLOCK, hash}}});
+    session.fullRequested.insert(hash);
+  }
+};
+
+// Headers-first initial block download.
+//
+// 1. Handshake with every peer and learn its height.
+// 2. Fetch the header chain from the best peer (falling back to the next
+//    one on failure), checking linkage and proof of work for every header
+//    before any body is requested.
+// 3. Fetch bodies from all peers in parallel, within a sliding window of
+//    blocks ahead of the next block to connect. Each body is checked
+//    against its header (fields and merkle root) on the peer's thread.
+//    Requests not answered within stallTimeout are handed to other peers
+//    and the slow peer is benched for a while.
+// 4. Connect blocks to the chain strictly in height order.
+class HeadersFirstSync {
+public:
+  explicit HeadersFirstSync(Blockchain::Blockchain &chain,
+                            SyncConfig config = {}) noexcept
+      : chain_(chain), config_(config) {}
+
+  ~HeadersFirstSync() { closeAll(); }
+
+  HeadersFirstSync(const HeadersFirstSync &) = delete;
+  HeadersFirstSync &operator=(const HeadersFirstSync &) = delete;
+
+  // Sync from "host:port" peers. True when every announced header was
+  // connected (including the case where peers had nothing new).
+  bool run(const std::vector<std::string> &endpoints) {
+    std::vector<int> fds;
+    for (const auto &endpoint : endpoints) {
+      int fd = connectEndpoint(endpoint);
+      if (fd >= 0) {
+        fds.push_back(fd);
+      } else {
+        Logging::Logger::getInstance().warning(
+            "Sync peer unreachable: " + endpoint, "Network", 0);
+      }
+    }
+    return runOnSockets(std::move(fds));
+  }
+
+  // Same, over connected sockets; takes ownership of the descriptors
+  bool runOnSockets(std::vector<int> fds) {
+    for (int fd : fds) {
+      auto peer = std::make_unique<Peer>();
+      peer->fd = fd;
+      detail::setReadTimeout(fd, config_.pollInterval);
+      peers_.push_back(std::move(peer));
+    }
+    for (auto &peer : peers_) {
+      peer->alive = handshake(*peer);
+    }
+    aliveCount_ = static_cast<size_t>(std::count_if(
+        peers_.begin(), peers_.end(), [](const auto &p) { return p->alive; }));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stats_.peers = aliveCount_;
+    }
+    if (aliveCount_ == 0) {
+      closeAll();
+      return false;
+    }
+
+    auto start = Clock::now();
+    bool headersOk = fetchHeaders();
+    auto headersDone = Clock::now();
+    bool ok = headersOk && fetchBlocks();
+    auto blocksDone = Clock::now();
+    closeAll();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.headers = headers_.size();
+    stats_.headerSeconds = seconds(headersDone - start);
+    stats_.blockSeconds = seconds(blocksDone - headersDone);
+    Logging::Logger::getInstance().logf(
+        Logging::INFO, "Network", 0,
+        "Sync finished: {}/{} blocks from {} peers, {} blocks/s, "
+        "{} re-requests",
+        stats_.blocks, headers_.size(), stats_.peers,
+        static_cast<int64_t>(stats_.blocksPerSecond()), stats_.rerequests);
+    return ok;
+  }
+
+  [[nodiscard]] SyncStats getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SyncStats stats = stats_;
+    stats.bytesReceived = bytesReceived_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t NO_PEER = static_cast<size_t>(-1);
+
+  struct Peer {
+    int fd{-1};
+    P2P::FrameDecoder decoder;
+    P2P::SendQueue out;
+    int32_t startHeight{0};
+    bool alive{false};
+    std::unordered_set<size_t> requested; // Item indices awaiting a reply
+    Clock::time_point benchedUntil{};
+  };
+
+  enum class State : uint8_t { Pending, InFlight, Received };
+
+  struct Item {
+    State state{State::Pending};
+    size_t peer{NO_PEER};  // Peer last asked / that delivered
+    size_t avoid{NO_PEER}; // Peer that stalled or failed on this block
+    uint32_t failures{0};
+    Clock::time_point sentAt{};
+    std::optional<Blockchain::Block> block;
+  };
+
+  enum class ReadResult { Frame, Timeout, Closed };
+
+  Blockchain::Blockchain &chain_;
+  SyncConfig config_;
+  std::vector<std::unique_ptr<Peer>> peers_;
+
+  // Header chain; read-only once the body phase starts
+  std::vector<Blockchain::Block> headers_;
+  std::unordered_map<std::string, size_t> indexByHash_;
+
+  mutable std::mutex mutex_; // Guards everything below
+  std::condition_variable cv_;
+  std::vector<Item> items_;
+  size_t next_{0}; // Next item to connect
+  size_t aliveCount_{0};
+  bool done_{false};
+  SyncStats stats_;
+  std::atomic<uint64_t> bytesReceived_{0};
+
+  static double seconds(Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+  }
+
+  void closeAll() {
+    for (auto &peer : peers_) {
+      if (peer->fd >= 0) {
+        ::close(peer->fd);
+        peer->fd = -1;
+      }
+    }
+  }
+
+  // Next frame from a peer, reading until `deadline`. The payload view is
+  // valid until the next call for the same peer.
+  ReadResult readFrame(Peer &p, P2P::Frame &frame,
+                       Clock::time_point deadline) {
+    while (true) {
+      auto status = p.decoder.next(frame);
+      if (status == P2P::FrameDecoder::Status::Ready) {
+        return ReadResult::Frame;
+      }
+      if (status == P2P::FrameDecoder::Status::Error) {
+        return ReadResult::Closed;
+      }
+      char *buf = p.decoder.prepare(PeerService::READ_CHUNK);
+      ssize_t n = ::recv(p.fd, buf, PeerService::READ_CHUNK, 0);
+      p.decoder.commit(n > 0 ? static_cast<size_t>(n) : 0);
+      if (n > 0) {
+        bytesReceived_.fetch_add(static_cast<uint64_t>(n),
+                                 std::memory_order_relaxed);
+        continue;
+      }
+      if (n < 0 &&
+          (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        if (Clock::now() >= deadline) {
+          return ReadResult::Timeout;
+        }
+        continue;
+      }
+      return ReadResult::Closed;
+    }
+  }
+
+  // Keep-alive traffic any state must answer
+  static void answerPing(Peer &p, const P2P::Frame &frame) {
+    if (frame.type == P2P::MessageType::PING) {
+      if (auto ping = P2P::PingMessage::decode(frame.payload)) {
+        p.out.push(P2P::MessageType::PONG, *ping);
+      }
+    }
+  }
+
+  bool handshake(Peer &p) {
+    P2P::VersionMessage version;
+    version.timestamp = std::time(nullptr);
+    version.startHeight = static_cast<int32_t>(chain_.getChainLength());
+    p.out.push(P2P::MessageType::VERSION, version);
+    if (!p.out.flush(p.fd)) {
+      return false;
+    }
+    bool gotVersion = false, gotVerack = false;
+    auto deadline = Clock::now() + config_.handshakeTimeout;
+    P2P::Frame frame;
+    while (!(gotVersion && gotVerack)) {
+      if (readFrame(p, frame, deadline) != ReadResult::Frame) {
+        return false;
+      }
+      if (frame.type == P2P::MessageType::VERSION) {
+        auto theirs = P2P::VersionMessage::decode(frame.payload);
+        if (!theirs) {
+          return false;
+        }
+        p.startHeight = theirs->startHeight;
+        gotVersion = true;
+      } else if (frame.type == P2P::MessageType::VERACK) {
+        gotVerack = true;
+      } else {
+        answerPing(p, frame);
+      }
+    }
+    return p.out.flush(p.fd);
+  }
+
+  // Exponentially spaced locator from our tip back to height 0
+  std::vector<std::string> locator() const {
+    std::vector<std::string> hashes;
+    const size_t limit = P2P::GetHeadersMessage::MAX_LOCATOR - 1;
+    size_t step = 1;
+    size_t h = chain_.getChainLength();
+    while (h-- > 0 && hashes.size() < limit) {
+      if (auto hash = chain_.getBlockHash(h)) {
+        hashes.push_back(std::move(*hash));
+      }
+      if (hashes.size() >= 10) {
+        step *= 2;
+      }
+      if (h < step) {
+        break;
+      }
+      h -= step - 1;
+    }
+    if (auto genesis = chain_.getBlockHash(0)) {
+      if (hashes.empty() || hashes.back() != *genesis) {
+        hashes.push_back(std::move(*genesis));
+      }
+    }
+    return hashes;
+  }
+
+  // Header chain from the highest peer; falls back to the next best peer
+  // if one stops answering or sends an invalid header
+  bool fetchHeaders() {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < peers_.size(); ++i) {
+      if (peers_[i]->alive) {
+        order.push_back(i);
+      }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return peers_[a]->startHeight > peers_[b]->startHeight;
+    });
+
+    const auto tip = chain_.getBlockHash(chain_.getChainLength() - 1);
+    if (!tip) {
+      return false;
+    }
+    const auto baseLocator = locator();
+    auto &mining = chain_.getMiningManager();
+
+    for (size_t id : order) {
+      Peer &p = *peers_[id];
+      while (true) {
+        P2P::GetHeadersMessage request;
+        request.locator = headers_.empty()
+                              ? baseLocator
+                              : std::vector<std::string>{headers_.back().hash};
+        p.out.push(P2P::MessageType::GETHEADERS, request);
+        if (!p.out.flush(p.fd)) {
+          break;
+        }
+
+        std::optional<P2P::HeadersMessage> reply;
+        auto deadline = Clock::now() + config_.handshakeTimeout;
+        P2P::Frame frame;
+        while (!reply) {
+          if (readFrame(p, frame, deadline) != ReadResult::Frame) {
+            break;
+          }
+          if (frame.type == P2P::MessageType::HEADERS) {
+            reply = P2P::HeadersMessage::decode(frame.payload);
+            if (!reply) {
+              break;
+            }
+          } else {
+            answerPing(p, frame);
+          }
+        }
+        if (!reply) {
+          break;
+        }
+
+        // Every header must extend the previous one with valid work
+        const std::string *prev =
+            headers_.empty() ? &*tip : &headers_.back().hash;
+        bool valid = true;
+        for (const auto &h : reply->headers) {
+          if (h.prevHash != *prev || h.isGenesis() ||
+              !h.checkProofOfWork(mining)) {
+            valid = false;
+            break;
+          }
+          prev = &h.hash;
+        }
+        if (!valid) {
+          Logging::Logger::getInstance().warning(
+              "Invalid header chain from sync peer", "Network", 0);
+          break;
+        }
+        for (auto &h : reply->headers) {
+          headers_.push_back(std::move(h));
+        }
+        if (reply->headers.size() < P2P::Codec::MAX_HEADERS) {
+          return true; // Peer has nothing further
+        }
+      }
+      p.alive = false; // Failed mid-way; carry on from the next peer
+      --aliveCount_;
+    }
+    return !headers_.empty() && aliveCount_ > 0;
+  }
+
+  bool fetchBlocks() {
+    if (headers_.empty()) {
+      return true;
+    }
+    indexByHash_.reserve(headers_.size());
+    for (size_t i = 0; i < headers_.size(); ++i) {
+      indexByHash_.emplace(headers_[i].hash, i);
+    }
+    items_.assign(headers_.size(), Item{});
+
+    std::vector<std::thread> workers;
+    for (size_t id = 0; id < peers_.size(); ++id) {
+      if (peers_[id]->alive) {
+        workers.emplace_back(&HeadersFirstSync::worker, this, id);
+      }
+    }
+
+    bool ok = true;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (next_ < items_.size()) {
+      cv_.wait_for(lock, config_.pollInterval, [&] {
+        return items_[next_].state == State::Received || aliveCount_ == 0;
+      });
+
+      // Connect in order; validation against the chain happens here
+      while (next_ < items_.size() &&
+             items_[next_].state == State::Received) {
+        Item &item = items_[next_];
+        Blockchain::Block block = std::move(*item.block);
+        item.block.reset();
+        lock.unlock();
+        bool added = chain_.addBlock(block);
+        lock.lock();
+        if (!added) {
+          item.state = State::Pending;
+          item.avoid = item.peer;
+          ++stats_.rerequests;
+          if (++item.failures > peers_.size()) {
+            ok = false;
+            next_ = items_.size();
+          }
+          break;
+        }
+        ++next_;
+        ++stats_.blocks;
+      }
+
+      if (aliveCount_ == 0 && next_ < items_.size()) {
+        ok = false;
+        break;
+      }
+      reassignStalled(Clock::now());
+    }
+    done_ = true;
+    lock.unlock();
+    cv_.notify_all();
+    for (auto &t : workers) {
+      t.join();
+    }
+    return ok;
+  }
+
+  // Caller holds mutex_
+  void reassignStalled(Clock::time_point now) {
+    size_t end = std::min(items_.size(), next_ + config_.windowBlocks);
+    for (size_t i = next_; i < end; ++i) {
+      Item &item = items_[i];
+      if (item.state != State::InFlight ||
+          now - item.sentAt < config_.stallTimeout) {
+        continue;
+      }
+      Peer &slow = *peers_[item.peer];
+      slow.requested.erase(i);
+      if (slow.benchedUntil <= now) {
+        ++stats_.stalls;
+      }
+      slow.benchedUntil = now + config_.stallTimeout;
+      item.state = State::Pending;
+      item.avoid = item.peer;
+      ++stats_.rerequests;
+    }
+  }
+
+  // Caller holds mutex_
+  void failPeer(size_t id) {
+    Peer &p = *peers_[id];
+    if (!p.alive) {
+      return;
+    }
+    p.alive = false;
+    --aliveCount_;
+    for (size_t i : p.requested) {
+      if (items_[i].state == State::InFlight && items_[i].peer == id) {
+        items_[i].state = State::Pending;
+        items_[i].avoid = id;
+      }
+    }
+    p.requested.clear();
+    cv_.notify_all();
+  }
+
+  void worker(size_t id) {
+    Peer &p = *peers_[id];
+    std::vector<size_t> batch;
+    while (true) {
+      batch.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (done_ || !p.alive) {
+          return;
+        }
+        auto now = Clock::now();
+        if (now >= p.benchedUntil) {
+          const bool others = aliveCount_ > 1;
+          size_t end = std::min(items_.size(), next_ + config_.windowBlocks);
+          for (size_t i = next_;
+               i < end && p.requested.size() < config_.maxInFlightPerPeer;
+               ++i) {
+            Item &item = items_[i];
+            if (item.state != State::Pending || (others && item.avoid == id)) {
+              continue;
+            }
+            item.state = State::InFlight;
+            item.peer = id;
+            item.sentAt = now;
+            p.requested.insert(i);
+            batch.push_back(i);
+          }
+        }
+      }
+
+      if (!batch.empty()) {
+        P2P::GetDataMessage request;
+        request.items.reserve(batch.size());
+        for (size_t i : batch) {
+          request.items.push_back({P2P::INV_BLOCK, headers_[i].hash});
+        }
+        p.out.push(P2P::MessageType::GETDATA, request);
+      }
+      P2P::Frame frame;
+      ReadResult result = ReadResult::Closed;
+      if (p.out.flush(p.fd)) {
+        result = readFrame(p, frame, Clock::now() + config_.pollInterval);
+      }
+      if (result == ReadResult::Timeout) {
+        continue;
+      }
+      if (result == ReadResult::Closed || !handleFrame(id, frame)) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failPeer(id);
+        return;
+      }
+    }
+  }
+
+  // False if the peer misbehaved
+  bool handleFrame(size_t id, const P2P::Frame &frame) {
+    Peer &p = *peers_[id];
+    if (frame.type == P2P::MessageType::BLOCK) {
+      auto msg = P2P::BlockMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      auto it = indexByHash_.find(msg->block.hash);
+      if (it == indexByHash_.end()) {
+        return true; // Unsolicited; ignore
+      }
+      const size_t i = it->second;
+      const bool valid = matchesHeader(msg->block, headers_[i]);
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      p.requested.erase(i);
+      Item &item = items_[i];
+      if (!valid) {
+        if (item.state == State::InFlight && item.peer == id) {
+          item.state = State::Pending;
+          item.avoid = id;
+          ++stats_.rerequests;
+        }
+        return false;
+      }
+      if (item.state != State::Received) {
+        if (item.state == State::InFlight && item.peer != id) {
+          peers_[item.peer]->requested.erase(i); // Late reply won the race
+        }
+        item.state = State::Received;
+        item.peer = id;
+        item.block = std::move(msg->block);
+        cv_.notify_all();
+      }
+      return true;
+    }
+    if (frame.type == P2P::MessageType::NOTFOUND) {
+      auto msg = P2P::InvMessage::decode(frame.payload);
+      if (!msg) {
+        return false;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto &inv : msg->items) {
+        auto it = indexByHash_.find(inv.hash);
+        if (it == indexByHash_.end()) {
+          continue;
+        }
+        p.requested.erase(it->second);
+        Item &item = items_[it->second];
+        if (item.state == State::InFlight && item.peer == id) {
+          item.state = State::Pending;
+          item.avoid = id;
+          ++stats_.rerequests;
+        }
+      }
+      return true;
+    }
+    answerPing(p, frame);
+    return true;
+  }
+
+  // Body belongs to the header: same fields and a matching merkle root
+  bool matchesHeader(const Blockchain::Block &body,
+                     const Blockchain::Block &header) const {
+    return body.prevHash == header.prevHash &&
+           body.merkleRoot == header.merkleRoot &&
+           body.timestamp == header.timestamp &&
+           body.nonce == header.nonce &&
+           body.difficulty == header.difficulty &&
+           body.shardId == header.shardId &&
+           Blockchain::Block::computeMerkleRoot(
+               body.transactions, chain_.getCryptoManager(), body.shardId) ==
+               header.merkleRoot;
+  }
+};
+
+} // namespace QuantumPulse::Network
+
+#endif // QUANTUMPULSE_SYNC_V7_H
@@ -0,0 +1,151 @@
+#ifndef QUANTUMPULSE_THREADPOOL_V7_H
+#define QUANTUMPULSE_THREADPOOL_V7_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace QuantumPulse::Concurrency {
+
+// Fixed-size worker pool shared by CPU-bound subsystems (merkle building,
+// block validation). Tasks are plain closures; parallelFor lets the calling
+// thread take part, so nested use from a worker cannot deadlock.
+class ThreadPool final {
+public:
+  explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+    threads = std::max<size_t>(1, threads);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] { workerLoop(); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex_);
+      stopping_ = true;
+    }
+    queueCv_.notify_all();
+    for (auto &w : workers_) {
+      if (w.joinable()) {
+        w.join();
+      }
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Process-wide pool sized to the hardware
+  [[nodiscard]] static ThreadPool &getInstance() {
+    static ThreadPool instance;
+    return instance;
+  }
+
+  // Queue a task and get a future for its result
+  template <typename Fn>
+  [[nodiscard]] auto submit(Fn &&fn) -> std::future<decltype(fn())> {
+    using Result = decltype(fn());
+    auto task =
+        std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+    std::future<Result> future = task->get_future();
+    enqueue([task] { (*task)(); });
+    return future;
+  }
+
+  // Fire-and-forget task
+  void post(std::function<void()> fn) { enqueue(std::move(fn)); }
+
+  // Run fn(begin, end) over [0, count) in chunks of `grain`; blocks until
+  // every chunk has run. The caller executes chunks too.
+  void parallelFor(size_t count, size_t grain,
+                   const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0) {
+      return;
+    }
+    grain = std::max<size_t>(1, grain);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers_.size() == 1) {
+      fn(0, count);
+      return;
+    }
+
+    struct State {
+      std::atomic<size_t> next{0};
+      std::atomic<size_t> done{0};
+      std::mutex mutex;
+      std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+
+    // `fn` lives on the caller's stack; helpers only touch it while a chunk
+    // is outstanding, and the caller does not return until all are done
+    auto runChunks = [state, count, grain, chunks, &fn] {
+      size_t c;
+      while ((c = state->next.fetch_add(1)) < chunks) {
+        size_t begin = c * grain;
+        fn(begin, std::min(count, begin + grain));
+        if (state->done.fetch_add(1) + 1 == chunks) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->cv.notify_all();
+        }
+      }
+    };
+
+    size_t helpers = std::min(workers_.size(), chunks - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+      enqueue(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == chunks; });
+  }
+
+  [[nodiscard]] size_t getThreadCount() const noexcept {
+    return workers_.size();
+  }
+
+private:
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex queueMutex_;
+  std::condition_variable queueCv_;
+  bool stopping_{false};
+
+  void enqueue(std::function<void()> fn) {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex_);
+      tasks_.push(std::move(fn));
+    }
+    queueCv_.notify_one();
+  }
+
+  void workerLoop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(queueMutex_);
+        queueCv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (stopping_ && tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+};
+
+} // namespace QuantumPulse::Concurrency
+
+#endif // QUANTUMPULSE_THREADPOOL_V7_H
@@ -0,0 +1,335 @@
+#ifndef QUANTUMPULSE_TRACE_V7_H
+#define QUANTUMPULSE_TRACE_V7_H
+
+#include "quantumpulse_jsonrpc_v7.h"
+#include "quantumpulse_metrics_v7.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Hot-path latency tracing. A span times one scope at a named call site.
+// Finished spans go to a fixed ring owned by the recording thread (no
+// locks, no allocation) and, when a metrics registry is attached, into a
+// per-site Prometheus histogram. Rings are read only on export.
+//
+//   QP_TRACE_SCOPE("block.add", "chain");        // until end of scope
+//   QP_TRACE_SPAN(wait, "block.lock", "chain");  // named, end early with
+//   QP_TRACE_END(wait);                          // QP_TRACE_END
+//
+// Building with QUANTUMPULSE_DISABLE_TRACING removes every span; at run
+// time a span that is neither recorded nor measured costs one atomic load.
+namespace QuantumPulse::Trace {
+
+// A named call site; owned by the Tracer and never destroyed
+class Site {
+public:
+  Site(std::string name, std::string category)
+      : name_(std::move(name)), category_(std::move(category)) {}
+
+  [[nodiscard]] const std::string &name() const noexcept { return name_; }
+  [[nodiscard]] const std::string &category() const noexcept {
+    return category_;
+  }
+
+private:
+  friend class Tracer;
+  std::string name_;
+  std::string category_;
+  Metrics::Histogram histogram_; // Valid once measured_ is set
+  std::atomic<bool> measured_{false};
+};
+
+// Per-thread ring of finished spans. Only the owning thread writes; the
+// exporter copies slots and discards any the writer may have lapped.
+struct ThreadBuffer {
+  static constexpr size_t CAPACITY = 4096;
+
+  struct Slot {
+    std::atomic<const Site *> site{nullptr};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> durationNs{0};
+  };
+
+  explicit ThreadBuffer(uint32_t id) noexcept : tid(id) {}
+
+  void push(const Site *site, uint64_t start, uint64_t duration) noexcept {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[h % CAPACITY];
+    // Pairs with the fence in snapshot(): a reader that sees any of these
+    // stores also sees head >= h and drops the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.site.store(site, std::memory_order_relaxed);
+    slot.startNs.store(start, std::memory_order_relaxed);
+    slot.durationNs.store(duration, std::memory_order_relaxed);
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  std::array<Slot, CAPACITY> slots;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> floor{0}; // Spans before this were cleared
+  const uint32_t tid;
+};
+
+// One exported span
+struct SpanRecord {
+  const Site *site;
+  uint32_t tid;
+  uint64_t startNs; // Since Tracer construction
+  uint64_t durationNs;
+};
+
+class Tracer final {
+public:
+  [[nodiscard]] static Tracer &getInstance() noexcept {
+    static Tracer instance;
+    return instance;
+  }
+
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
+
+  // Get or create the site for `name`; the reference stays valid
+  Site &site(const std::string &name, const std::string &category) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &s : sites_) {
+      if (s.name() == name) {
+        return s;
+      }
+    }
+    Site &s = sites_.emplace_back(name, category);
+    if (metrics_) {
+      measure(s);
+    }
+    return s;
+  }
+
+  // Keep finished spans in per-thread rings for exportChromeTrace()
+  void setRecording(bool on) noexcept {
+    recording_.store(on, std::memory_order_relaxed);
+    refreshActive();
+  }
+
+  [[nodiscard]] bool isRecording() const noexcept {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  // Feed every span into quantumpulse_span_duration_seconds{span=...}.
+  // Call once at startup; the registry must outlive all tracing.
+  void attachMetrics(Metrics::PrometheusExporter &metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_ = &metrics;
+    for (auto &s : sites_) {
+      measure(s);
+    }
+    measuring_.store(true, std::memory_order_relaxed);
+    refreshActive();
+  }
+
+  [[nodiscard]] bool active() const noexcept {
+    return active_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint64_t now() const noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_)
+            .count());
+  }
+
+  void finish(Site &site, uint64_t start) noexcept {
+    const uint64_t duration = now() - start;
+    if (site.measured_.load(std::memory_order_acquire)) {
+      site.histogram_.observe(duration);
+    }
+    if (recording_.load(std::memory_order_relaxed)) {
+      if (ThreadBuffer *buffer = threadBuffer()) {
+        buffer->push(&site, start, duration);
+      }
+    }
+  }
+
+  // Recorded spans still held in the rings, oldest first per thread
+  [[nodiscard]] std::vector<SpanRecord> snapshot() const {
+    std::vector<SpanRecord> out;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &buffer : buffers_) {
+      const uint64_t end = buffer->head.load(std::memory_order_acquire);
+      const uint64_t begin = std::max(
+          end > ThreadBuffer::CAPACITY ? end - ThreadBuffer::CAPACITY : 0,
+          std::min(end, buffer->floor.load(std::memory_order_relaxed)));
+      const size_t mark = out.size();
+      for (uint64_t i = begin; i < end; ++i) {
+        const auto &slot = buffer->slots[i % ThreadBuffer::CAPACITY];
+        out.push_back({slot.site.load(std::memory_order_relaxed), buffer->tid,
+                       slot.startNs.load(std::memory_order_relaxed),
+                       slot.durationNs.load(std::memory_order_relaxed)});
+      }
+      // Slots the writer reused while we copied are unreliable, and so is
+      // the one it may be writing now (index `after`). The fence orders
+      // the relaxed slot loads above before the head reload.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint64_t after = buffer->head.load(std::memory_order_relaxed);
+      if (after >= ThreadBuffer::CAPACITY) {
+        const uint64_t oldest = after - ThreadBuffer::CAPACITY + 1;
+        if (oldest > begin) {
+          const size_t stale = static_cast<size_t>(
+              std::min<uint64_t>(oldest - begin, end - begin));
+          out.erase(out.begin() + static_cast<std::ptrdiff_t>(mark),
+                    out.begin() + static_cast<std::ptrdiff_t>(mark + stale));
+        }
+      }
+    }
+    return out;
+  }
+
+  // Chrome trace-event JSON (chrome://tracing, Perfetto)
+  [[nodiscard]] std::string exportChromeTrace() const {
+    const auto spans = snapshot();
+    std::string out;
+    out.reserve(64 + spans.size() * 96);
+    JsonRpc::Writer w(out);
+    w.beginObject().key("traceEvents").beginArray();
+    for (const auto &span : spans) {
+      w.beginObject()
+          .key("name")
+          .string(span.site->name())
+          .key("cat")
+          .string(span.site->category())
+          .key("ph")
+          .string("X")
+          .key("ts")
+          .number(static_cast<double>(span.startNs) / 1000.0)
+          .key("dur")
+          .number(static_cast<double>(span.durationNs) / 1000.0)
+          .key("pid")
+          .number(1)
+          .key("tid")
+          .number(span.tid)
+          .endObject();
+    }
+    w.endArray().key("displayTimeUnit").string("ns").endObject();
+    return out;
+  }
+
+  bool writeChromeTrace(const std::string &path) const {
+    std::ofstream file(path, std::ios::trunc);
+    file << exportChromeTrace();
+    return static_cast<bool>(file);
+  }
+
+  // Drop recorded spans (rings of exited threads are released)
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::erase_if(buffers_,
+                  [](const auto &buffer) { return buffer.use_count() == 1; });
+    for (auto &buffer : buffers_) {
+      buffer->floor.store(buffer->head.load(std::memory_order_acquire),
+                          std::memory_order_relaxed);
+    }
+  }
+
+private:
+  Tracer() = default;
+
+  const std::chrono::steady_clock::time_point epoch_ =
+      std::chrono::steady_clock::now();
+  std::atomic<bool> recording_{false};
+  std::atomic<bool> measuring_{false};
+  std::atomic<bool> active_{false};
+  mutable std::mutex mutex_;
+  std::deque<Site> sites_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  Metrics::PrometheusExporter *metrics_{nullptr};
+  uint32_t nextTid_{1};
+
+  void refreshActive() noexcept {
+    active_.store(recording_.load(std::memory_order_relaxed) ||
+                      measuring_.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+  }
+
+  void measure(Site &s) {
+    s.histogram_ =
+        metrics_->histogram("quantumpulse_span_duration_seconds",
+                            "Duration of traced code sections", 1e-9,
+                            "span=\"" + s.name() + "\"");
+    s.measured_.store(true, std::memory_order_release);
+  }
+
+  // The calling thread's ring, registered on first use
+  ThreadBuffer *threadBuffer() noexcept {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+      try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer = std::make_shared<ThreadBuffer>(nextTid_++);
+        buffers_.push_back(buffer);
+      } catch (...) {
+        return nullptr;
+      }
+    }
+    return buffer.get();
+  }
+};
+
+// Times its own lifetime (or until finish()) at `site`
+class ScopedSpan {
+public:
+  explicit ScopedSpan(Site &site) noexcept
+      : site_(Tracer::getInstance().active() ? &site : nullptr) {
+    if (site_) {
+      start_ = Tracer::getInstance().now();
+    }
+  }
+
+  ~ScopedSpan() { finish(); }
+
+  ScopedSpan(const ScopedSpan &) = delete;
+  ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+  void finish() noexcept {
+    if (site_) {
+      Tracer::getInstance().finish(*site_, start_);
+      site_ = nullptr;
+    }
+  }
+
+private:
+  Site *site_;
+  uint64_t start_{0};
+};
+
+} // namespace QuantumPulse::Trace
+
+#define QP_TRACE_CONCAT_(a, b) a##b
+#define QP_TRACE_CONCAT(a, b) QP_TRACE_CONCAT_(a, b)
+
+#ifndef QUANTUMPULSE_DISABLE_TRACING
+
+#define QP_TRACE_SPAN(var, name, category)                                     \
+  static ::QuantumPulse::Trace::Site &QP_TRACE_CONCAT(var, _site) =            \
+      ::QuantumPulse::Trace::Tracer::getInstance().site(name, category);       \
+  ::QuantumPulse::Trace::ScopedSpan var(QP_TRACE_CONCAT(var, _site))
+#define QP_TRACE_SITE_SPAN(var, site)                                          \
+  ::QuantumPulse::Trace::ScopedSpan var(site)
+#define QP_TRACE_END(var) var.finish()
+
+#else
+
+#define QP_TRACE_SPAN(var, name, category) static_cast<void>(0)
+#define QP_TRACE_SITE_SPAN(var, site) static_cast<void>(site)
+#define QP_TRACE_END(var) static_cast<void>(0)
+
+#endif
+
+#define QP_TRACE_SCOPE(name, category)                                         \
+  QP_TRACE_SPAN(QP_TRACE_CONCAT(qpTraceSpan, __LINE__), name, category)
+
+#endif // QUANTUMPULSE_TRACE_V7_H
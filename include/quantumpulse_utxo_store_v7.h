@@ -0,0 +1,784 @@
+#ifndef QUANTUMPULSE_UTXO_STORE_V7_H
+#define QUANTUMPULSE_UTXO_STORE_V7_H
+
+#include "quantumpulse_checksum_v7.h"
+#include "quantumpulse_logging_v7.h"
+#include "quantumpulse_serialize_v7.h"
+#include "quantumpulse_utxo_v7.h"
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+namespace QuantumPulse::UTXO {
+
+// Serialized form of a UTXO record (little-endian, length-prefixed strings)
+inline std::string encodeUTXO(const UTXOutput &u) {
+  std::string out;
+  out.reserve(64 + u.txid.size() + u.address.size() + u.scriptPubKey.size());
+  Serialize::putBytes(out, u.txid);
+  Serialize::putU32(out, static_cast<uint32_t>(u.vout));
+  Serialize::putBytes(out, u.address);
+  uint64_t amountBits;
+  std::memcpy(&amountBits, &u.amount, sizeof(amountBits));
+  Serialize::putU64(out, amountBits);
+  Serialize::putBytes(out, u.scriptPubKey);
+  Serialize::putU64(out, static_cast<uint64_t>(u.blockHeight));
+  out.push_back(u.coinbase ? 1 : 0);
+  Serialize::putU32(out, static_cast<uint32_t>(u.confirmations));
+  return out;
+}
+
+inline std::optional<UTXOutput> decodeUTXO(std::string_view data) {
+  Serialize::ByteReader r(data);
+  UTXOutput u{};
+  uint32_t vout, confirmations;
+  uint64_t amountBits, height;
+  uint8_t coinbase;
+  if (!r.bytes(u.txid) || !r.u32(vout) || !r.bytes(u.address) ||
+      !r.u64(amountBits) || !r.bytes(u.scriptPubKey) || !r.u64(height) ||
+      !r.u8(coinbase) || !r.u32(confirmations) || !r.done()) {
+    return std::nullopt;
+  }
+  u.vout = static_cast<int>(vout);
+  std::memcpy(&u.amount, &amountBits, sizeof(amountBits));
+  u.blockHeight = static_cast<int64_t>(height);
+  u.coinbase = coinbase != 0;
+  u.confirmations = static_cast<int>(confirmations);
+  return u;
+}
+
+// Embedded log-structured UTXO store. The file is a sequence of
+// checksummed batches, each holding put/erase records keyed by OutPoint;
+// an in-memory index maps every live outpoint to its value's file offset,
+// so a lookup is one pread(). A batch is applied on reopen only if it is
+// complete and its CRC matches, which makes each writeBatch() atomic across
+// crashes. Once dead records outweigh live ones the log is rewritten.
+//
+// File layout:
+//   "QPUTXO01"
+//   batch*:  u32 magic | u32 records | u64 payload bytes | u32 crc32c | payload
+//   record:  u8 op | 32-byte txid | u32 vout | u32 value bytes | value
+class UTXODiskStore final {
+public:
+  // Put when `value` is set, erase otherwise
+  struct BatchOp {
+    OutPoint key;
+    const UTXOutput *value;
+  };
+
+  static constexpr char FILE_MAGIC[8] = {'Q', 'P', 'U', 'T',
+                                         'X', 'O', '0', '1'};
+  static constexpr uint32_t BATCH_MAGIC = 0x48544142; // "BATH"
+  static constexpr size_t BATCH_HEADER_BYTES = 20;
+  static constexpr size_t RECORD_HEADER_BYTES = 1 + OutPoint::TXID_BYTES + 8;
+  static constexpr uint64_t COMPACT_MIN_DEAD_BYTES = 4 * 1024 * 1024;
+  static constexpr size_t COMPACT_BATCH_BYTES = 4 * 1024 * 1024;
+
+  explicit UTXODiskStore(std::string path, bool syncWrites = true) noexcept
+      : path_(std::move(path)), syncWrites_(syncWrites) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (openLocked()) {
+      Logging::Logger::getInstance().info(
+          "UTXO store opened: " + path_ + " (" + std::to_string(index_.size()) +
+              " outputs)",
+          "UTXO", 0);
+    } else {
+      Logging::Logger::getInstance().error(
+          "Failed to open UTXO store: " + path_, "UTXO", 0);
+    }
+  }
+
+  ~UTXODiskStore() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  UTXODiskStore(const UTXODiskStore &) = delete;
+  UTXODiskStore &operator=(const UTXODiskStore &) = delete;
+
+  [[nodiscard]] bool isOpen() const noexcept { return fd_ >= 0; }
+
+  std::optional<UTXOutput> get(const OutPoint &key) const noexcept {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return std::nullopt;
+    }
+    try {
+      std::string buf(it->second.length, '\0');
+      if (!readAt(fd_, buf.data(), buf.size(), it->second.offset)) {
+        return std::nullopt;
+      }
+      return decodeUTXO(buf);
+    } catch (...) {
+      return std::nullopt;
+    }
+  }
+
+  bool contains(const OutPoint &key) const noexcept {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_.count(key) > 0;
+  }
+
+  // Append all ops as one atomic batch
+  bool writeBatch(const std::vector<BatchOp> &ops) noexcept {
+    if (ops.empty()) {
+      return true;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (fd_ < 0) {
+      return false;
+    }
+    try {
+      Batch batch;
+      for (const auto &op : ops) {
+        batch.add(op.key, op.value);
+      }
+      if (!appendBatch(fd_, fileBytes_, batch, index_, deadBytes_)) {
+        return false;
+      }
+      if (deadBytes_ >= COMPACT_MIN_DEAD_BYTES &&
+          deadBytes_ * 2 > fileBytes_) {
+        compactLocked();
+      }
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }
+
+  // Rewrite the log with live records only
+  bool compact() noexcept {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    try {
+      return compactLocked();
+    } catch (...) {
+      return false;
+    }
+  }
+
+  size_t size() const noexcept {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return index_.size();
+  }
+
+  uint64_t getFileBytes() const noexcept {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return fileBytes_;
+  }
+
+  uint64_t getDeadBytes() const noexcept {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return deadBytes_;
+  }
+
+private:
+  struct Location {
+    uint64_t offset;
+    uint32_t length;
+  };
+  using Index = std::unordered_map<OutPoint, Location, OutPointHasher>;
+
+  // Encoded batch payload plus where each value landed inside it
+  struct Batch {
+    struct Record {
+      OutPoint key;
+      bool put;
+      uint32_t valueOffset;
+      uint32_t valueLength;
+    };
+    std::string payload;
+    std::vector<Record> records;
+
+    void add(const OutPoint &key, const UTXOutput *value) {
+      std::string encoded = value ? encodeUTXO(*value) : std::string();
+      addEncoded(key, value != nullptr, encoded);
+    }
+
+    void addEncoded(const OutPoint &key, bool put, std::string_view value) {
+      payload.push_back(put ? 1 : 0);
+      payload.append(reinterpret_cast<const char *>(key.txid.data()),
+                     key.txid.size());
+      Serialize::putU32(payload, key.vout);
+      Serialize::putU32(payload, static_cast<uint32_t>(value.size()));
+      records.push_back({key, put, static_cast<uint32_t>(payload.size()),
+                         static_cast<uint32_t>(value.size())});
+      payload.append(value);
+    }
+  };
+
+  std::string path_;
+  bool syncWrites_;
+  int fd_{-1};
+  mutable std::shared_mutex mutex_;
+  Index index_;
+  uint64_t fileBytes_{0};
+  uint64_t deadBytes_{0};
+
+  static bool readAt(int fd, void *buf, size_t len, uint64_t offset) noexcept {
+    auto *p = static_cast<char *>(buf);
+    while (len > 0) {
+      ssize_t n = ::pread(fd, p, len, static_cast<off_t>(offset));
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      len -= static_cast<size_t>(n);
+      offset += static_cast<uint64_t>(n);
+    }
+    return true;
+  }
+
+  static bool writeAt(int fd, const void *buf, size_t len,
+                      uint64_t offset) noexcept {
+    const auto *p = static_cast<const char *>(buf);
+    while (len > 0) {
+      ssize_t n = ::pwrite(fd, p, len, static_cast<off_t>(offset));
+      if (n <= 0) {
+        return false;
+      }
+      p += n;
+      len -= static_cast<size_t>(n);
+      offset += static_cast<uint64_t>(n);
+    }
+    return true;
+  }
+
+  static void applyRecord(Index &index, uint64_t &deadBytes,
+                          const Batch::Record &rec, uint64_t payloadStart) {
+    auto it = index.find(rec.key);
+    if (it != index.end()) {
+      deadBytes += RECORD_HEADER_BYTES + it->second.length;
+    }
+    if (rec.put) {
+      index[rec.key] = {payloadStart + rec.valueOffset, rec.valueLength};
+    } else {
+      if (it != index.end()) {
+        index.erase(it);
+      }
+      deadBytes += RECORD_HEADER_BYTES; // The tombstone itself
+    }
+  }
+
+  bool appendBatch(int fd, uint64_t &end, const Batch &batch, Index &index,
+                   uint64_t &deadBytes) const {
+    std::string frame;
+    frame.reserve(BATCH_HEADER_BYTES + batch.payload.size());
+    Serialize::putU32(frame, BATCH_MAGIC);
+    Serialize::putU32(frame, static_cast<uint32_t>(batch.records.size()));
+    Serialize::putU64(frame, batch.payload.size());
+    Serialize::putU32(frame, Checksum::crc32c(batch.payload.data(),
+                                           batch.payload.size()));
+    frame.append(batch.payload);
+
+    if (!writeAt(fd, frame.data(), frame.size(), end)) {
+      return false;
+    }
+    if (syncWrites_ && ::fdatasync(fd) != 0) {
+      return false;
+    }
+    uint64_t payloadStart = end + BATCH_HEADER_BYTES;
+    for (const auto &rec : batch.records) {
+      applyRecord(index, deadBytes, rec, payloadStart);
+    }
+    end += frame.size();
+    return true;
+  }
+
+  // Open or create the file and rebuild the index; a torn or corrupt tail
+  // batch is cut off
+  bool openLocked() {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      return false;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+      return closeOnError();
+    }
+    if (st.st_size == 0) {
+      if (!writeAt(fd_, FILE_MAGIC, sizeof(FILE_MAGIC), 0)) {
+        return closeOnError();
+      }
+      fileBytes_ = sizeof(FILE_MAGIC);
+      return true;
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    if (!readAt(fd_, magic, sizeof(magic), 0) ||
+        std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0) {
+      return closeOnError();
+    }
+
+    const auto size = static_cast<uint64_t>(st.st_size);
+    uint64_t pos = sizeof(FILE_MAGIC);
+    std::string payload;
+    while (pos + BATCH_HEADER_BYTES <= size) {
+      unsigned char header[BATCH_HEADER_BYTES];
+      if (!readAt(fd_, header, sizeof(header), pos)) {
+        break;
+      }
+      uint64_t payloadBytes = Serialize::getLE(header + 8, 8);
+      if (Serialize::getLE(header, 4) != BATCH_MAGIC ||
+          payloadBytes > size - pos - BATCH_HEADER_BYTES) {
+        break;
+      }
+      payload.resize(payloadBytes);
+      if (!readAt(fd_, payload.data(), payloadBytes,
+                  pos + BATCH_HEADER_BYTES) ||
+          Checksum::crc32c(payload.data(), payload.size()) !=
+              Serialize::getLE(header + 16, 4)) {
+        break;
+      }
+      auto records = parseBatch(payload, Serialize::getLE(header + 4, 4));
+      if (!records) {
+        break;
+      }
+      for (const auto &rec : *records) {
+        applyRecord(index_, deadBytes_, rec, pos + BATCH_HEADER_BYTES);
+      }
+      pos += BATCH_HEADER_BYTES + payloadBytes;
+    }
+
+    if (pos != size) {
+      Logging::Logger::getInstance().warning(
+          "UTXO store: discarding " + std::to_string(size - pos) +
+              " bytes of incomplete batch data",
+          "UTXO", 0);
+      if (::ftruncate(fd_, static_cast<off_t>(pos)) != 0) {
+        return closeOnError();
+      }
+    }
+    fileBytes_ = pos;
+    return true;
+  }
+
+  static std::optional<std::vector<Batch::Record>>
+  parseBatch(std::string_view payload, uint64_t count) {
+    std::vector<Batch::Record> records;
+    Serialize::ByteReader r(payload);
+    for (uint64_t i = 0; i < count; ++i) {
+      Batch::Record rec{};
+      uint8_t op;
+      std::string_view value;
+      if (!r.u8(op) || !r.raw(rec.key.txid.data(), rec.key.txid.size()) ||
+          !r.u32(rec.key.vout) || !r.u32(rec.valueLength)) {
+        return std::nullopt;
+      }
+      rec.put = op != 0;
+      rec.valueOffset = static_cast<uint32_t>(r.position());
+      if (!r.view(value, rec.valueLength)) {
+        return std::nullopt;
+      }
+      records.push_back(rec);
+    }
+    if (!r.done()) {
+      return std::nullopt;
+    }
+    return records;
+  }
+
+  bool closeOnError() noexcept {
+    ::close(fd_);
+    fd_ = -1;
+    return false;
+  }
+
+  bool compactLocked() {
+    if (fd_ < 0) {
+      return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    const std::string tmpPath = path_ + ".compact";
+    int tmp = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                     0644);
+    if (tmp < 0) {
+      return false;
+    }
+    auto abandon = [&] {
+      ::close(tmp);
+      ::unlink(tmpPath.c_str());
+      return false;
+    };
+
+    Index fresh;
+    uint64_t end = sizeof(FILE_MAGIC);
+    uint64_t dead = 0;
+    if (!writeAt(tmp, FILE_MAGIC, sizeof(FILE_MAGIC), 0)) {
+      return abandon();
+    }
+
+    Batch batch;
+    std::string value;
+    for (const auto &[key, loc] : index_) {
+      value.resize(loc.length);
+      if (!readAt(fd_, value.data(), value.size(), loc.offset)) {
+        return abandon();
+      }
+      batch.addEncoded(key, true, value);
+      if (batch.payload.size() >= COMPACT_BATCH_BYTES) {
+        if (!appendBatch(tmp, end, batch, fresh, dead)) {
+          return abandon();
+        }
+        batch = Batch{};
+      }
+    }
+    if (!batch.records.empty() && !appendBatch(tmp, end, batch, fresh, dead)) {
+      return abandon();
+    }
+    if (::fsync(tmp) != 0 || std::rename(tmpPath.c_str(), path_.c_str()) != 0) {
+      return abandon();
+    }
+    // The rename is only durable once the directory entry is on disk
+    const bool durable = syncDirectory(path_);
+
+    ::close(fd_);
+    fd_ = tmp;
+    index_ = std::move(fresh);
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    Logging::Logger::getInstance().info(
+        "UTXO store compacted: " + std::to_string(fileBytes_) + " -> " +
+            std::to_string(end) + " bytes in " + std::to_string(elapsedMs) +
+            " ms",
+        "UTXO", 0);
+    fileBytes_ = end;
+    deadBytes_ = 0;
+    if (!durable) {
+      Logging::Logger::getInstance().warning(
+          "UTXO store: could not sync directory of " + path_, "UTXO", 0);
+    }
+    return durable;
+  }
+
+  // fsync() the directory holding `path`
+  static bool syncDirectory(const std::string &path) {
+    const size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? "."
+                            : slash == 0               ? "/"
+                                                       : path.substr(0, slash);
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+      return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+  }
+};
+
+// Tunables for the in-memory tier in front of UTXODiskStore
+struct UTXOCacheConfig {
+  size_t maxMemoryBytes{64 * 1024 * 1024}; // Clean entries evicted above this
+  int flushIntervalBlocks{100};            // Flush at least this often
+};
+
+// Bounded write-back cache of hot outpoints over UTXODiskStore (Bitcoin
+// Core's CCoinsViewCache model). Entries are DIRTY when they differ from
+// disk and FRESH when disk has never seen them, so a coin created and spent
+// between flushes costs no I/O at all. Dirty state is written as one batch
+// from onBlockConnected() every flushIntervalBlocks blocks, or earlier when
+// dirty entries alone exceed the memory ceiling. Only clean entries sit on
+// the LRU list, so eviction never has to skip over unflushed state.
+//
+// Address lookups are not served at this tier; UTXOSet keeps that index.
+class UTXOCache final {
+public:
+  UTXOCache(UTXODiskStore &store,
+            const UTXOCacheConfig &config = UTXOCacheConfig{}) noexcept
+      : store_(store), config_(config) {}
+
+  ~UTXOCache() { flush(); }
+
+  UTXOCache(const UTXOCache &) = delete;
+  UTXOCache &operator=(const UTXOCache &) = delete;
+
+  // Get UTXO
+  std::optional<UTXOutput> getUTXO(const std::string &txid,
+                                   int vout) noexcept {
+    return get(OutPoint::from(txid, vout));
+  }
+
+  std::optional<UTXOutput> get(const OutPoint &key) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+      Entry *entry = fetch(key);
+      std::optional<UTXOutput> coin = entry ? entry->coin : std::nullopt;
+      trimToCeiling();
+      return coin;
+    } catch (...) {
+      return std::nullopt;
+    }
+  }
+
+  // Add UTXO
+  void addUTXO(const UTXOutput &utxo) noexcept {
+    OutPoint key = OutPoint::from(utxo.txid, utxo.vout);
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+      auto it = entries_.find(key);
+      if (it == entries_.end()) {
+        Entry entry;
+        entry.coin = utxo;
+        entry.flags = DIRTY | (store_.contains(key) ? 0 : FRESH);
+        it = entries_.emplace(key, std::move(entry)).first;
+        account(it->second, true);
+      } else {
+        account(it->second, false);
+        it->second.coin = utxo;
+        markDirty(it->second);
+        account(it->second, true);
+      }
+    } catch (...) {
+    }
+  }
+
+  // Spend UTXO
+  bool spendUTXO(const std::string &txid, int vout) noexcept {
+    OutPoint key = OutPoint::from(txid, vout);
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+      Entry *entry = fetch(key);
+      if (!entry || !entry->coin) {
+        return false;
+      }
+      auto it = entries_.find(key);
+      if (entry->flags & FRESH) {
+        // Never reached disk - forget it entirely
+        account(*entry, false);
+        unlinkLru(*entry);
+        entries_.erase(it);
+        return true;
+      }
+      account(*entry, false);
+      entry->coin.reset();
+      markDirty(*entry);
+      account(*entry, true);
+      trimToCeiling();
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }
+
+  // Block boundary hook; flushes when the interval elapses or dirty state
+  // outgrows the memory ceiling. Returns true if a flush ran.
+  bool onBlockConnected() noexcept {
+    bool due;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++blocksSinceFlush_;
+      due = blocksSinceFlush_ >= config_.flushIntervalBlocks ||
+            dirtyBytes_ > config_.maxMemoryBytes;
+    }
+    return due && flush();
+  }
+
+  // Write every dirty entry to disk as one batch
+  bool flush() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<UTXODiskStore::BatchOp> ops;
+      ops.reserve(dirtyCount_);
+      for (auto &[key, entry] : entries_) {
+        if (entry.flags & DIRTY) {
+          ops.push_back({key, entry.coin ? &*entry.coin : nullptr});
+        }
+      }
+      if (!store_.writeBatch(ops)) {
+        Logging::Logger::getInstance().error(
+            "UTXO cache flush failed (" + std::to_string(ops.size()) +
+                " entries kept dirty)",
+            "UTXO", 0);
+        return false;
+      }
+
+      for (const auto &op : ops) {
+        auto it = entries_.find(op.key);
+        Entry &entry = it->second;
+        account(entry, false);
+        if (!entry.coin) {
+          entries_.erase(it);
+          continue;
+        }
+        entry.flags = 0;
+        account(entry, true);
+        linkLru(it);
+      }
+      dirtyCount_ = 0;
+      blocksSinceFlush_ = 0;
+      trimToCeiling();
+
+      auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+      ++flushCount_;
+      flushedEntries_ += ops.size();
+      lastFlushMicros_ = static_cast<uint64_t>(micros);
+      totalFlushMicros_ += static_cast<uint64_t>(micros);
+      return true;
+    } catch (...) {
+      return false;
+    }
+  }
+
+  size_t getCacheSize() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  size_t getDirtyCount() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dirtyCount_;
+  }
+
+  size_t getMemoryUsage() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memoryBytes_;
+  }
+
+  double getHitRate() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = hits_ + misses_;
+    return total ? static_cast<double>(hits_) / total : 0.0;
+  }
+
+  // Get cache stats
+  std::map<std::string, double> getStats() const noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::string, double> stats;
+    uint64_t total = hits_ + misses_;
+    stats["entries"] = entries_.size();
+    stats["dirty"] = dirtyCount_;
+    stats["memory_bytes"] = memoryBytes_;
+    stats["memory_limit"] = config_.maxMemoryBytes;
+    stats["hits"] = hits_;
+    stats["misses"] = misses_;
+    stats["hit_rate"] = total ? static_cast<double>(hits_) / total : 0.0;
+    stats["flushes"] = flushCount_;
+    stats["flushed_entries"] = flushedEntries_;
+    stats["last_flush_ms"] = lastFlushMicros_ / 1000.0;
+    stats["avg_flush_ms"] =
+        flushCount_ ? totalFlushMicros_ / 1000.0 / flushCount_ : 0.0;
+    stats["evictions"] = evictions_;
+    return stats;
+  }
+
+private:
+  static constexpr uint8_t DIRTY = 1;
+  static constexpr uint8_t FRESH = 2;
+
+  struct Entry {
+    std::optional<UTXOutput> coin; // Empty = spent, pending erase on disk
+    uint8_t flags{0};
+    bool inLru{false};
+    std::list<OutPoint>::iterator lru;
+  };
+  using EntryMap = std::unordered_map<OutPoint, Entry, OutPointHasher>;
+
+  UTXODiskStore &store_;
+  UTXOCacheConfig config_;
+  mutable std::mutex mutex_;
+  EntryMap entries_;
+  std::list<OutPoint> lru_; // Clean entries, most recent first
+  size_t memoryBytes_{0};
+  size_t dirtyBytes_{0};
+  size_t dirtyCount_{0};
+  int blocksSinceFlush_{0};
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  uint64_t evictions_{0};
+  uint64_t flushCount_{0};
+  uint64_t flushedEntries_{0};
+  uint64_t lastFlushMicros_{0};
+  uint64_t totalFlushMicros_{0};
+
+  // Approximate heap footprint: hash node, list node and string payloads
+  static size_t footprint(const Entry &e) noexcept {
+    size_t bytes = sizeof(OutPoint) + sizeof(Entry) + 4 * sizeof(void *);
+    if (e.coin) {
+      bytes += e.coin->txid.capacity() + e.coin->address.capacity() +
+               e.coin->scriptPubKey.capacity();
+    }
+    return bytes;
+  }
+
+  void account(const Entry &e, bool add) noexcept {
+    size_t bytes = footprint(e);
+    memoryBytes_ = add ? memoryBytes_ + bytes : memoryBytes_ - bytes;
+    if (e.flags & DIRTY) {
+      dirtyBytes_ = add ? dirtyBytes_ + bytes : dirtyBytes_ - bytes;
+      dirtyCount_ = add ? dirtyCount_ + 1 : dirtyCount_ - 1;
+    }
+  }
+
+  void markDirty(Entry &e) noexcept {
+    e.flags |= DIRTY;
+    unlinkLru(e);
+  }
+
+  void linkLru(EntryMap::iterator it) {
+    lru_.push_front(it->first);
+    it->second.lru = lru_.begin();
+    it->second.inLru = true;
+  }
+
+  void unlinkLru(Entry &e) noexcept {
+    if (e.inLru) {
+      lru_.erase(e.lru);
+      e.inLru = false;
+    }
+  }
+
+  // Cached entry for `key`, loading from disk on a miss. Callers trim to
+  // the memory ceiling once they are done with the entry.
+  Entry *fetch(const OutPoint &key) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      ++hits_;
+      if (it->second.inLru) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+      }
+      return &it->second;
+    }
+    ++misses_;
+    auto coin = store_.get(key);
+    if (!coin) {
+      return nullptr;
+    }
+    Entry entry;
+    entry.coin = std::move(coin);
+    it = entries_.emplace(key, std::move(entry)).first;
+    account(it->second, true);
+    linkLru(it);
+    return &it->second;
+  }
+
+  void trimToCeiling() noexcept {
+    while (memoryBytes_ > config_.maxMemoryBytes && !lru_.empty()) {
+      auto it = entries_.find(lru_.back());
+      lru_.pop_back();
+      account(it->second, false);
+      entries_.erase(it);
+      ++evictions_;
+    }
+  }
+};
+
+} // namespace QuantumPulse::UTXO
+
+#endif // QUANTUMPULSE_UTXO_STORE_V7_H
@@ -3,10 +3,15 @@
 
 #include "quantumpulse_crypto_v7.h"
 #include "quantumpulse_logging_v7.h"
-#include <map>
-#include <mutex>
-#include <set>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace QuantumPulse::UTXO {
@@ -56,48 +61,160 @@ struct Transaction {
   int confirmations;          // Confirmation count
 };
 
-// UTXO Set Manager (Bitcoin Core-like)
+// Fixed-size binary outpoint. Hex txids (the normal case) are decoded; any
+// other txid string is reduced to its SHA-512 prefix, so keys never
+// allocate and hash in a couple of instructions.
+struct OutPoint {
+  static constexpr size_t TXID_BYTES = 32;
+
+  std::array<unsigned char, TXID_BYTES> txid{};
+  uint32_t vout{0};
+
+  static OutPoint from(std::string_view txidStr, int vout) noexcept {
+    OutPoint op;
+    op.vout = static_cast<uint32_t>(vout);
+    if (!decodeHexPrefix(txidStr, op.txid)) {
+      Crypto::Digest512 digest;
+      if (Crypto::Hashing::sha512(txidStr, digest)) {
+        std::memcpy(op.txid.data(), digest.data(), TXID_BYTES);
+      }
+    }
+    return op;
+  }
+
+  bool operator==(const OutPoint &other) const noexcept {
+    return vout == other.vout && txid == other.txid;
+  }
+
+  // Txid bytes are already uniformly distributed; mix in the index
+  [[nodiscard]] uint64_t hash() const noexcept {
+    uint64_t h;
+    std::memcpy(&h, txid.data(), sizeof(h));
+    return h ^ (static_cast<uint64_t>(vout) * 0x9E3779B97F4A7C15ULL);
+  }
+
+private:
+  static int hexValue(char c) noexcept {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  }
+
+  // Decode the leading bytes of an all-hex txid of at least 64 chars
+  static bool decodeHexPrefix(std::string_view hex,
+                              std::array<unsigned char, TXID_BYTES> &out) {
+    if (hex.size() < TXID_BYTES * 2 || hex.size() % 2 != 0) {
+      return false;
+    }
+    for (char c : hex) {
+      if (hexValue(c) < 0) {
+        return false;
+      }
+    }
+    for (size_t i = 0; i < TXID_BYTES; ++i) {
+      out[i] = static_cast<unsigned char>(hexValue(hex[2 * i]) << 4 |
+                                          hexValue(hex[2 * i + 1]));
+    }
+    return true;
+  }
+};
+
+struct OutPointHasher {
+  size_t operator()(const OutPoint &op) const noexcept {
+    return static_cast<size_t>(op.hash());
+  }
+};
+
+// UTXO Set Manager (Bitcoin Core-like). Outputs live in a power-of-two
+// number of hash-table shards, each behind its own reader/writer lock, so
+// lookups from validation and balance queries only contend with writers
+// touching the same shard. The address index is sharded the same way and
+// keeps (outpoint, amount) pairs, letting getBalance() run without visiting
+// the output shards at all.
+//
+// Add/spend update the output shard first and the address shard second; a
+// reader racing a writer may briefly see one without the other.
 class UTXOSet final {
 public:
-  UTXOSet() noexcept {
-    Logging::Logger::getInstance().info("UTXO Set initialized", "UTXO", 0);
+  static constexpr size_t DEFAULT_SHARD_COUNT = 64;
+
+  explicit UTXOSet(size_t shardCount = DEFAULT_SHARD_COUNT) noexcept
+      : shardMask_(roundUpPow2(shardCount) - 1),
+        shards_(std::make_unique<Shard[]>(shardMask_ + 1)),
+        addressShards_(std::make_unique<AddressShard[]>(shardMask_ + 1)) {
+    Logging::Logger::getInstance().info("UTXO Set initialized (" +
+                                            std::to_string(shardMask_ + 1) +
+                                            " shards)",
+                                        "UTXO", 0);
 
     // Add genesis UTXO (pre-mined coins)
     addGenesisUTXO();
   }
 
-  // Add UTXO
+  // Add UTXO (replaces an existing entry for the same outpoint)
   void addUTXO(const UTXOutput &utxo) noexcept {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string key = utxo.txid + ":" + std::to_string(utxo.vout);
-    utxos_[key] = utxo;
-    addressUtxos_[utxo.address].insert(key);
+    OutPoint op = OutPoint::from(utxo.txid, utxo.vout);
+    std::optional<UTXOutput> replaced;
+    {
+      Shard &shard = shardFor(op);
+      std::unique_lock<std::shared_mutex> lock(shard.mutex);
+      auto [it, inserted] = shard.utxos.try_emplace(op, utxo);
+      if (!inserted) {
+        replaced = std::move(it->second);
+        it->second = utxo;
+      } else {
+        count_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    if (replaced) {
+      unindexAddress(replaced->address, op);
+    }
+    indexAddress(utxo.address, op, utxo.amount);
   }
 
   // Spend UTXO (remove from set)
   bool spendUTXO(const std::string &txid, int vout) noexcept {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string key = txid + ":" + std::to_string(vout);
-
-    if (!utxos_.count(key)) {
-      return false; // UTXO not found
+    OutPoint op = OutPoint::from(txid, vout);
+    std::string address;
+    {
+      Shard &shard = shardFor(op);
+      std::unique_lock<std::shared_mutex> lock(shard.mutex);
+      auto it = shard.utxos.find(op);
+      if (it == shard.utxos.end()) {
+        return false; // UTXO not found
+      }
+      address = std::move(it->second.address);
+      shard.utxos.erase(it);
     }
-
-    auto &utxo = utxos_[key];
-    addressUtxos_[utxo.address].erase(key);
-    utxos_.erase(key);
-
+    count_.fetch_sub(1, std::memory_order_relaxed);
+    unindexAddress(address, op);
     return true;
   }
 
   // Get UTXO
   std::optional<UTXOutput> getUTXO(const std::string &txid,
                                    int vout) const noexcept {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::string key = txid + ":" + std::to_string(vout);
+    OutPoint op = OutPoint::from(txid, vout);
+    const Shard &shard = shardFor(op);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.utxos.find(op);
+    if (it != shard.utxos.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
 
-    if (utxos_.count(key)) {
-      return utxos_.at(key);
+  // Amount of an unspent output, without copying the whole record
+  std::optional<double> getAmount(const OutPoint &op) const noexcept {
+    const Shard &shard = shardFor(op);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.utxos.find(op);
+    if (it != shard.utxos.end()) {
+      return it->second.amount;
     }
     return std::nullopt;
   }
@@ -105,14 +222,13 @@ public:
   // Get all UTXOs for address
   std::vector<UTXOutput>
   getAddressUTXOs(const std::string &address) const noexcept {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<UTXOutput> result;
-
-    if (addressUtxos_.count(address)) {
-      for (const auto &key : addressUtxos_.at(address)) {
-        if (utxos_.count(key)) {
-          result.push_back(utxos_.at(key));
-        }
+    for (const auto &coin : addressCoins(address)) {
+      const Shard &shard = shardFor(coin.outpoint);
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      auto it = shard.utxos.find(coin.outpoint);
+      if (it != shard.utxos.end()) {
+        result.push_back(it->second);
       }
     }
     return result;
@@ -120,10 +236,15 @@ public:
 
   // Calculate balance from UTXOs
   double getBalance(const std::string &address) const noexcept {
-    auto utxos = getAddressUTXOs(address);
+    const AddressShard &shard = addressShardFor(address);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.coins.find(address);
+    if (it == shard.coins.end()) {
+      return 0.0;
+    }
     double balance = 0.0;
-    for (const auto &utxo : utxos) {
-      balance += utxo.amount;
+    for (const auto &coin : it->second) {
+      balance += coin.amount;
     }
     return balance;
   }
@@ -133,11 +254,11 @@ public:
     double inputSum = 0.0;
 
     for (const auto &input : tx.vin) {
-      auto utxo = getUTXO(input.txid, input.vout);
-      if (!utxo) {
+      auto amount = getAmount(OutPoint::from(input.txid, input.vout));
+      if (!amount) {
         return false; // Input not found in UTXO set
       }
-      inputSum += utxo->amount;
+      inputSum += *amount;
     }
 
     double outputSum = 0.0;
@@ -151,14 +272,83 @@ public:
 
   // Get UTXO count
   size_t getUTXOCount() const noexcept {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return utxos_.size();
+    return count_.load(std::memory_order_relaxed);
   }
 
+  size_t getShardCount() const noexcept { return shardMask_ + 1; }
+
 private:
-  mutable std::mutex mutex_;
-  std::map<std::string, UTXOutput> utxos_; // key = txid:vout
-  std::map<std::string, std::set<std::string>> addressUtxos_;
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<OutPoint, UTXOutput, OutPointHasher> utxos;
+  };
+
+  struct AddressCoin {
+    OutPoint outpoint;
+    double amount;
+  };
+
+  // Per-address coins are a flat vector; spends swap-remove
+  struct alignas(64) AddressShard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, std::vector<AddressCoin>> coins;
+  };
+
+  size_t shardMask_;
+  std::unique_ptr<Shard[]> shards_;
+  std::unique_ptr<AddressShard[]> addressShards_;
+  std::atomic<size_t> count_{0};
+
+  static size_t roundUpPow2(size_t n) noexcept {
+    size_t p = 1;
+    while (p < n && p < (size_t{1} << 16)) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  // High bits pick the shard; the table inside uses the low bits
+  Shard &shardFor(const OutPoint &op) const noexcept {
+    return shards_[(op.hash() >> 48) & shardMask_];
+  }
+
+  AddressShard &addressShardFor(const std::string &address) const noexcept {
+    return addressShards_[std::hash<std::string>{}(address) & shardMask_];
+  }
+
+  std::vector<AddressCoin> addressCoins(const std::string &address) const {
+    const AddressShard &shard = addressShardFor(address);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.coins.find(address);
+    return it == shard.coins.end() ? std::vector<AddressCoin>{} : it->second;
+  }
+
+  void indexAddress(const std::string &address, const OutPoint &op,
+                    double amount) {
+    AddressShard &shard = addressShardFor(address);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.coins[address].push_back({op, amount});
+  }
+
+  void unindexAddress(const std::string &address, const OutPoint &op) {
+    AddressShard &shard = addressShardFor(address);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.coins.find(address);
+    if (it == shard.coins.end()) {
+      return;
+    }
+    auto &coins = it->second;
+    for (size_t i = 0; i < coins.size(); ++i) {
+      if (coins[i].outpoint == op) {
+        coins[i] = coins.back();
+        coins.pop_back();
+        break;
+      }
+    }
+    if (coins.empty()) {
+      shard.coins.erase(it);
+    }
+  }
 
   void addGenesisUTXO() {
     // Pre-mined coins for founder
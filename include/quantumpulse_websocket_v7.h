@@ -1,20 +1,31 @@
 #ifndef QUANTUMPULSE_WEBSOCKET_V7_H
 #define QUANTUMPULSE_WEBSOCKET_V7_H
 
+#include "quantumpulse_jsonrpc_v7.h"
 #include "quantumpulse_logging_v7.h"
+#include "quantumpulse_orderbook_v7.h"
+#include <array>
 #include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <cstring>
+#include <deque>
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <netinet/in.h>
 #include <openssl/sha.h>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
+#include <unordered_map>
 #include <vector>
 
 namespace QuantumPulse::WebSocket {
@@ -43,7 +54,313 @@ enum class EventType {
   PRICE_UPDATE,
   MINING_STATUS,
   PEER_CONNECTED,
-  PEER_DISCONNECTED
+  PEER_DISCONNECTED,
+  BOOK_SNAPSHOT, // Full order book; sent on connect and after a gap
+  BOOK_DELTA,    // Changed price levels since the previous delta
+  TRADE
+};
+
+constexpr size_t EVENT_TYPE_COUNT = static_cast<size_t>(EventType::TRADE) + 1;
+
+inline const char *eventName(EventType event) noexcept {
+  switch (event) {
+  case EventType::NEW_BLOCK:
+    return "new_block";
+  case EventType::NEW_TRANSACTION:
+    return "new_transaction";
+  case EventType::PRICE_UPDATE:
+    return "price_update";
+  case EventType::MINING_STATUS:
+    return "mining_status";
+  case EventType::PEER_CONNECTED:
+    return "peer_connected";
+  case EventType::PEER_DISCONNECTED:
+    return "peer_disconnected";
+  case EventType::BOOK_SNAPSHOT:
+    return "book_snapshot";
+  case EventType::BOOK_DELTA:
+    return "book_delta";
+  case EventType::TRADE:
+    return "trade";
+  }
+  return "";
+}
+
+// Wire bytes of one frame, shared by every queue it is in
+using Frame = std::shared_ptr<const std::string>;
+
+// Server frames are never masked
+inline Frame encodeFrame(std::string_view payload,
+                         MessageType type = MessageType::TEXT) {
+  std::string frame;
+  frame.reserve(payload.size() + 10);
+  frame.push_back(static_cast<char>(0x80 | static_cast<int>(type))); // FIN
+  if (payload.size() <= 125) {
+    frame.push_back(static_cast<char>(payload.size()));
+  } else if (payload.size() <= 65535) {
+    frame.push_back(126);
+    frame.push_back(static_cast<char>((payload.size() >> 8) & 0xFF));
+    frame.push_back(static_cast<char>(payload.size() & 0xFF));
+  } else {
+    frame.push_back(127);
+    for (int i = 7; i >= 0; --i) {
+      frame.push_back(static_cast<char>((payload.size() >> (8 * i)) & 0xFF));
+    }
+  }
+  frame.append(payload);
+  return std::make_shared<const std::string>(std::move(frame));
+}
+
+// What publishing does for a subscriber whose queue is full
+enum class SlowConsumerPolicy {
+  DROP,      // Skip the frame for it; book deltas then show a gap
+  DISCONNECT // Close it; the client reconnects and gets a new snapshot
+};
+
+// Publish/subscribe core of the WebSocket server, independent of sockets.
+// Each subscriber has an event mask, a place in one set per subscribed
+// EventType and a bounded queue of shared frames. publish() encodes
+// nothing and never blocks on a subscriber: it appends the frame to the
+// queue of everyone in that event's set and reports subscribers whose
+// queue just became non-empty through takeReady(); the I/O side writes
+// them out with drain() as their sockets accept data.
+class FanOut final {
+public:
+  static constexpr uint32_t ALL = (1u << EVENT_TYPE_COUNT) - 1;
+
+  struct Config {
+    size_t maxQueuedBytes{1 << 20}; // Per subscriber
+    SlowConsumerPolicy policy{SlowConsumerPolicy::DISCONNECT};
+  };
+
+  class Subscriber {
+  public:
+    explicit Subscriber(uint64_t id) noexcept : id_(id) {}
+
+    [[nodiscard]] uint64_t id() const noexcept { return id_; }
+
+    // Closed by the slow-consumer policy, a write error or unsubscribe()
+    [[nodiscard]] bool closed() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return closed_;
+    }
+
+    [[nodiscard]] uint64_t dropped() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return dropped_;
+    }
+
+    [[nodiscard]] size_t queuedBytes() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return bytes_;
+    }
+
+  private:
+    friend class FanOut;
+    const uint64_t id_;
+    mutable std::mutex mutex_; // Guards the queue fields
+    std::deque<Frame> queue_;
+    size_t offset_{0}; // Bytes of queue_.front() already written
+    size_t bytes_{0};  // Unwritten bytes in queue_
+    uint64_t dropped_{0};
+    bool closed_{false};
+    bool scheduled_{false}; // Reported by takeReady() and not yet drained
+    // Guarded by FanOut::setsMutex_
+    uint32_t mask_{0};
+    std::array<uint32_t, EVENT_TYPE_COUNT> slot_{}; // Index in each set
+  };
+  using Handle = std::shared_ptr<Subscriber>;
+
+  enum class Drain { EMPTY, BLOCKED, CLOSED };
+
+  FanOut() : FanOut(Config{}) {}
+
+  // `onReady` runs after a publish() or send() that made some subscriber
+  // ready, at most once per call
+  explicit FanOut(Config config, std::function<void()> onReady = {})
+      : config_(config), onReady_(std::move(onReady)) {}
+
+  FanOut(const FanOut &) = delete;
+  FanOut &operator=(const FanOut &) = delete;
+
+  [[nodiscard]] const Config &config() const noexcept { return config_; }
+
+  Handle subscribe(uint64_t id, uint32_t mask) {
+    auto sub = std::make_shared<Subscriber>(id);
+    setMask(sub, mask);
+    return sub;
+  }
+
+  // Events `sub` receives from publish(); 0 = none
+  void setMask(const Handle &sub, uint32_t mask) {
+    std::unique_lock<std::shared_mutex> lock(setsMutex_);
+    for (size_t e = 0; e < EVENT_TYPE_COUNT; ++e) {
+      const uint32_t bit = 1u << e;
+      if ((mask & bit) && !(sub->mask_ & bit)) {
+        sub->slot_[e] = static_cast<uint32_t>(sets_[e].size());
+        sets_[e].push_back(sub);
+      } else if (!(mask & bit) && (sub->mask_ & bit)) {
+        leave(e, *sub);
+      }
+    }
+    sub->mask_ = mask & ALL;
+  }
+
+  [[nodiscard]] uint32_t mask(const Handle &sub) const {
+    std::shared_lock<std::shared_mutex> lock(setsMutex_);
+    return sub->mask_;
+  }
+
+  // Leave every set and discard the queue
+  void unsubscribe(const Handle &sub) {
+    setMask(sub, 0);
+    std::lock_guard<std::mutex> lock(sub->mutex_);
+    sub->closed_ = true;
+    sub->queue_.clear();
+    sub->bytes_ = 0;
+  }
+
+  // Queue `frame` for every subscriber of `event`; returns how many
+  size_t publish(EventType event, const Frame &frame) {
+    std::vector<Handle> ready;
+    size_t queued = 0;
+    {
+      std::shared_lock<std::shared_mutex> lock(setsMutex_);
+      for (const Handle &sub : sets_[static_cast<size_t>(event)]) {
+        queued += offer(sub, frame, ready);
+      }
+    }
+    schedule(ready);
+    return queued;
+  }
+
+  // Queue `frame` for one subscriber whatever its mask
+  bool send(const Handle &sub, const Frame &frame) {
+    std::vector<Handle> ready;
+    const bool queued = offer(sub, frame, ready);
+    schedule(ready);
+    return queued;
+  }
+
+  // Move subscribers with something to write (or newly closed) to `out`
+  void takeReady(std::vector<Handle> &out) {
+    std::lock_guard<std::mutex> lock(readyMutex_);
+    out.swap(ready_);
+    ready_.clear();
+  }
+
+  // Write queued frames with `write(const char *, size_t)`, which returns
+  // bytes written, 0 if it would block or -1 on error. After BLOCKED the
+  // caller drains again once the socket is writable; after CLOSED it
+  // disconnects and unsubscribes.
+  template <typename Write> Drain drain(Subscriber &sub, Write &&write) {
+    std::lock_guard<std::mutex> lock(sub.mutex_);
+    while (!sub.closed_ && !sub.queue_.empty()) {
+      const std::string &bytes = *sub.queue_.front();
+      const ssize_t n =
+          write(bytes.data() + sub.offset_, bytes.size() - sub.offset_);
+      if (n == 0) {
+        return Drain::BLOCKED;
+      }
+      if (n < 0) {
+        sub.closed_ = true;
+        break;
+      }
+      sub.offset_ += static_cast<size_t>(n);
+      sub.bytes_ -= static_cast<size_t>(n);
+      if (sub.offset_ == bytes.size()) {
+        sub.queue_.pop_front();
+        sub.offset_ = 0;
+      }
+    }
+    if (sub.closed_) {
+      sub.queue_.clear();
+      sub.bytes_ = 0;
+      return Drain::CLOSED;
+    }
+    sub.scheduled_ = false;
+    return Drain::EMPTY;
+  }
+
+  [[nodiscard]] size_t subscriberCount(EventType event) const {
+    std::shared_lock<std::shared_mutex> lock(setsMutex_);
+    return sets_[static_cast<size_t>(event)].size();
+  }
+
+  [[nodiscard]] uint64_t droppedFrames() const noexcept {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint64_t slowDisconnects() const noexcept {
+    return disconnects_.load(std::memory_order_relaxed);
+  }
+
+private:
+  const Config config_;
+  const std::function<void()> onReady_;
+  mutable std::shared_mutex setsMutex_; // Shared by publishers
+  std::array<std::vector<Handle>, EVENT_TYPE_COUNT> sets_;
+  std::mutex readyMutex_;
+  std::vector<Handle> ready_;
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> disconnects_{0};
+
+  // Swap-erase `sub` from set `e`; setsMutex_ held exclusively
+  void leave(size_t e, Subscriber &sub) {
+    auto &set = sets_[e];
+    const uint32_t slot = sub.slot_[e];
+    if (slot + 1 != set.size()) {
+      set[slot] = std::move(set.back());
+      set[slot]->slot_[e] = slot;
+    }
+    set.pop_back();
+  }
+
+  bool offer(const Handle &sub, const Frame &frame,
+             std::vector<Handle> &ready) {
+    std::lock_guard<std::mutex> lock(sub->mutex_);
+    if (sub->closed_) {
+      return false;
+    }
+    // An empty queue takes any frame, so one large snapshot still fits
+    if (sub->bytes_ > 0 &&
+        sub->bytes_ + frame->size() > config_.maxQueuedBytes) {
+      if (config_.policy == SlowConsumerPolicy::DROP) {
+        ++sub->dropped_;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      sub->closed_ = true;
+      sub->queue_.clear();
+      sub->bytes_ = 0;
+      disconnects_.fetch_add(1, std::memory_order_relaxed);
+      // Report it even if already scheduled: a blocked socket may never
+      // become writable again
+      ready.push_back(sub);
+      return false;
+    }
+    sub->queue_.push_back(frame);
+    sub->bytes_ += frame->size();
+    if (!sub->scheduled_) {
+      sub->scheduled_ = true;
+      ready.push_back(sub);
+    }
+    return true;
+  }
+
+  void schedule(std::vector<Handle> &ready) {
+    if (ready.empty()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(readyMutex_);
+      ready_.insert(ready_.end(), std::make_move_iterator(ready.begin()),
+                    std::make_move_iterator(ready.end()));
+    }
+    if (onReady_) {
+      onReady_();
+    }
+  }
 };
 
 // WebSocket client
@@ -52,7 +369,11 @@ struct WSClient {
   std::string address;
   time_t connectedAt{0};
   bool isAuthenticated{false};
-  std::vector<EventType> subscriptions;
+  FanOut::Handle subscriber; // Subscribed once the handshake completes
+  bool upgraded{false};
+  bool narrowed{false}; // Sent a subscribe; no longer on every event
+  std::string in;       // Unparsed input
+  bool closed{false};
 };
 
 // Base64 encoding for WebSocket handshake
@@ -77,17 +398,44 @@ inline std::string base64Encode(const unsigned char *data, size_t len) {
   return result;
 }
 
-// WebSocket Server
+// WebSocket server. One I/O thread owns every socket through an
+// edge-triggered epoll set: it accepts, completes handshakes, answers
+// pings and subscription requests, and writes each client's FanOut queue
+// whenever its socket can take more. broadcast() only queues one shared
+// frame for the event's subscribers, so a slow client never holds up the
+// others; FanOut::Config decides what happens once its queue is full.
+//
+// Clients get every event until they send {"subscribe":["trade",...]};
+// {"unsubscribe":[...]} drops events again.
 class WebSocketServer final {
 public:
-  explicit WebSocketServer(int port = WSConfig::DEFAULT_PORT) noexcept
-      : port_(port), running_(false), serverSocket_(-1) {
+  explicit WebSocketServer(int port = WSConfig::DEFAULT_PORT,
+                           FanOut::Config fanOut = {}) noexcept
+      : port_(port), running_(false), serverSocket_(-1),
+        epollFd_(epoll_create1(EPOLL_CLOEXEC)),
+        wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        fanOut_(fanOut, [this] { wake(); }) {
+    if (epollFd_ >= 0 && wakeFd_ >= 0) {
+      epoll_event ev{};
+      ev.events = EPOLLIN | EPOLLET;
+      ev.data.ptr = &wakeFd_;
+      epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    }
     Logging::Logger::getInstance().info(
         "WebSocket server initialized on port " + std::to_string(port),
         "WebSocket", 0);
   }
 
-  ~WebSocketServer() noexcept { stop(); }
+  ~WebSocketServer() noexcept {
+    detachOrderBook();
+    stop();
+    if (wakeFd_ >= 0) {
+      close(wakeFd_);
+    }
+    if (epollFd_ >= 0) {
+      close(epollFd_);
+    }
+  }
 
   // Non-copyable
   WebSocketServer(const WebSocketServer &) = delete;
@@ -95,10 +443,11 @@ public:
 
   // Start server
   bool start() noexcept {
-    if (running_.load())
+    if (running_.load() || epollFd_ < 0 || wakeFd_ < 0)
       return false;
 
-    serverSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+    serverSocket_ =
+        socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (serverSocket_ < 0)
       return false;
 
@@ -112,18 +461,30 @@ public:
 
     if (bind(serverSocket_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
         0) {
-      close(serverSocket_);
+      closeListener();
       return false;
     }
-
-    if (listen(serverSocket_, WSConfig::MAX_CLIENTS) < 0) {
-      close(serverSocket_);
+    socklen_t len = sizeof(addr);
+    getsockname(serverSocket_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port); // Resolves port 0
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &serverSocket_;
+    if (listen(serverSocket_, WSConfig::MAX_CLIENTS) < 0 ||
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, serverSocket_, &ev) < 0) {
+      closeListener();
       return false;
     }
 
     running_.store(true);
-    acceptThread_ = std::thread(&WebSocketServer::acceptLoop, this);
-    pingThread_ = std::thread(&WebSocketServer::pingLoop, this);
+    try {
+      ioThread_ = std::thread(&WebSocketServer::ioLoop, this);
+    } catch (...) {
+      running_.store(false);
+      closeListener();
+      return false;
+    }
 
     Logging::Logger::getInstance().info(
         "WebSocket server started at ws://localhost:" + std::to_string(port_),
@@ -131,56 +492,62 @@ public:
     return true;
   }
 
-  // Stop server
+  // Stop server; the I/O thread closes every client on its way out
   void stop() noexcept {
     if (!running_.load())
       return;
 
     running_.store(false);
+    wake();
+    if (ioThread_.joinable())
+      ioThread_.join();
+    closeListener();
+  }
 
-    if (serverSocket_ >= 0) {
-      shutdown(serverSocket_, SHUT_RDWR);
-      close(serverSocket_);
-      serverSocket_ = -1;
+  // Stream `book` to clients. Each client gets a book_snapshot when it
+  // connects, then book_delta messages {"from","to","bids","asks"} with
+  // [price, quantity] pairs (0 removes the level) and trade messages.
+  // A client applies deltas whose "to" is past the snapshot "seq" and
+  // expects each "from" to follow the previous "to"; a new book_snapshot
+  // replaces its copy. The feed thread waits on the book's event ring
+  // instead of polling it. `book` must outlive detachOrderBook().
+  bool attachOrderBook(Trading::OrderBook &book) noexcept {
+    if (feedThread_.joinable()) {
+      return false;
     }
-
-    // Close all clients
-    {
-      std::lock_guard<std::mutex> lock(clientsMutex_);
-      for (auto &[id, client] : clients_) {
-        if (client.socket >= 0) {
-          close(client.socket);
-        }
-      }
-      clients_.clear();
+    try {
+      book_.store(&book);
+      feedRunning_.store(true);
+      feedThread_ = std::thread(&WebSocketServer::feedLoop, this);
+      return true;
+    } catch (...) {
+      book_.store(nullptr);
+      feedRunning_.store(false);
+      return false;
     }
+  }
 
-    if (acceptThread_.joinable())
-      acceptThread_.join();
-    if (pingThread_.joinable())
-      pingThread_.join();
+  void detachOrderBook() noexcept {
+    if (!feedThread_.joinable()) {
+      return;
+    }
+    feedRunning_.store(false);
+    Trading::OrderBook *book = book_.load();
+    book->wakeEventWaiters();
+    feedThread_.join();
+    // Holding the lock waits out a connecting client's snapshot
+    std::lock_guard<std::mutex> lock(feedMutex_);
+    book_.store(nullptr);
   }
 
-  // Broadcast message to all clients
+  // Queue one encoded frame for every subscriber of `event`
   void broadcast(EventType event, const std::string &data) noexcept {
-    std::string message = formatEvent(event, data);
-
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    for (auto &[id, client] : clients_) {
-      bool subscribed = client.subscriptions.empty();
-      for (const auto &sub : client.subscriptions) {
-        if (sub == event) {
-          subscribed = true;
-          break;
-        }
-      }
-
-      if (subscribed) {
-        sendMessage(client.socket, message);
-      }
+    try {
+      fanOut_.publish(event, encodeFrame(formatEvent(event, data)));
+    } catch (...) {
+      // Out of memory; the event is lost
     }
-
-    broadcastCount_++;
+    broadcastCount_.fetch_add(1, std::memory_order_relaxed);
   }
 
   // Broadcast to specific event subscribers
@@ -204,132 +571,495 @@ public:
 
   // Get stats
   [[nodiscard]] size_t getClientCount() const noexcept {
-    std::lock_guard<std::mutex> lock(clientsMutex_);
-    return clients_.size();
+    return clientCount_.load(std::memory_order_relaxed);
   }
 
   [[nodiscard]] size_t getBroadcastCount() const noexcept {
-    return broadcastCount_;
+    return broadcastCount_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] size_t getSubscriberCount(EventType event) const {
+    return fanOut_.subscriberCount(event);
+  }
+
+  // Frames skipped for (SlowConsumerPolicy::DROP) or clients closed
+  // because of (DISCONNECT) a full outbound queue
+  [[nodiscard]] uint64_t getDroppedFrames() const noexcept {
+    return fanOut_.droppedFrames();
+  }
+
+  [[nodiscard]] uint64_t getSlowDisconnects() const noexcept {
+    return fanOut_.slowDisconnects();
   }
 
   [[nodiscard]] bool isRunning() const noexcept { return running_.load(); }
 
+  [[nodiscard]] int getPort() const noexcept { return port_; }
+
 private:
+  static constexpr int MAX_EVENTS = 256;
+  static constexpr size_t READ_CHUNK = 16 * 1024;
+
   int port_;
   std::atomic<bool> running_;
   int serverSocket_;
-  std::thread acceptThread_;
-  std::thread pingThread_;
-  std::map<int, WSClient> clients_;
-  mutable std::mutex clientsMutex_;
-  size_t broadcastCount_{0};
-  int nextClientId_{0};
-
-  void acceptLoop() noexcept {
+  int epollFd_;
+  int wakeFd_;
+  std::thread ioThread_;
+  FanOut fanOut_;
+  // I/O thread only; keyed by subscriber id
+  std::unordered_map<uint64_t, std::unique_ptr<WSClient>> clients_;
+  std::vector<std::unique_ptr<WSClient>> graveyard_;
+  uint64_t nextClientId_{0};
+  std::atomic<size_t> clientCount_{0};
+  std::atomic<size_t> broadcastCount_{0};
+  std::atomic<Trading::OrderBook *> book_{nullptr};
+  std::atomic<bool> feedRunning_{false};
+  std::mutex feedMutex_; // Snapshots for new clients vs. book broadcasts
+  std::thread feedThread_;
+
+  void wake() noexcept {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wakeFd_, &one, sizeof(one));
+  }
+
+  void closeListener() noexcept {
+    if (serverSocket_ >= 0) {
+      close(serverSocket_); // Also leaves the epoll set
+      serverSocket_ = -1;
+    }
+  }
+
+  void ioLoop() noexcept {
+    epoll_event events[MAX_EVENTS];
+    std::vector<FanOut::Handle> ready;
+    const auto pingInterval = std::chrono::seconds(WSConfig::PING_INTERVAL_SEC);
+    auto nextPing = std::chrono::steady_clock::now() + pingInterval;
     while (running_.load()) {
-      sockaddr_in clientAddr{};
-      socklen_t len = sizeof(clientAddr);
+      const int n = epoll_wait(epollFd_, events, MAX_EVENTS, 1000);
+      for (int i = 0; i < n; ++i) {
+        void *tag = events[i].data.ptr;
+        if (tag == &wakeFd_) {
+          uint64_t value;
+          while (read(wakeFd_, &value, sizeof(value)) > 0) {
+          }
+        } else if (tag == &serverSocket_) {
+          acceptAll();
+        } else {
+          handleEvent(*static_cast<WSClient *>(tag), events[i].events);
+        }
+      }
+      fanOut_.takeReady(ready);
+      for (const auto &sub : ready) {
+        auto it = clients_.find(sub->id());
+        if (it != clients_.end()) {
+          flush(*it->second);
+        }
+      }
+      ready.clear();
+      graveyard_.clear(); // Closed this round; no stale events remain
+
+      if (std::chrono::steady_clock::now() >= nextPing) {
+        try {
+          const Frame ping = encodeFrame("", MessageType::PING);
+          for (auto &[id, client] : clients_) {
+            if (client->upgraded) {
+              fanOut_.send(client->subscriber, ping);
+            }
+          }
+        } catch (...) {
+        }
+        nextPing = std::chrono::steady_clock::now() + pingInterval;
+      }
+    }
 
-      int clientSocket = accept(
-          serverSocket_, reinterpret_cast<sockaddr *>(&clientAddr), &len);
+    for (auto &[id, client] : clients_) {
+      fanOut_.unsubscribe(client->subscriber);
+      close(client->socket);
+    }
+    clients_.clear();
+    clientCount_.store(0);
+  }
 
+  void acceptAll() noexcept {
+    while (true) {
+      int clientSocket = accept4(serverSocket_, nullptr, nullptr,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
       if (clientSocket < 0) {
-        if (running_.load())
+        if (errno == EINTR)
           continue;
-        break;
+        return; // EAGAIN, or out of descriptors until the next edge
+      }
+      if (clientCount_.load() >= WSConfig::MAX_CLIENTS) {
+        close(clientSocket);
+        continue;
+      }
+      try {
+        auto client = std::make_unique<WSClient>();
+        client->socket = clientSocket;
+        client->connectedAt = std::time(nullptr);
+        client->subscriber = fanOut_.subscribe(nextClientId_++, 0);
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = client.get();
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, clientSocket, &ev) < 0) {
+          close(clientSocket);
+          continue;
+        }
+        const uint64_t id = client->subscriber->id();
+        clients_.emplace(id, std::move(client));
+        clientCount_.fetch_add(1);
+      } catch (...) {
+        close(clientSocket);
       }
-
-      std::thread(&WebSocketServer::handleClient, this, clientSocket).detach();
     }
   }
 
-  void handleClient(int clientSocket) noexcept {
-    // Receive HTTP upgrade request
-    char buffer[WSConfig::BUFFER_SIZE];
-    ssize_t bytes = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-
-    if (bytes <= 0) {
-      close(clientSocket);
+  void handleEvent(WSClient &client, uint32_t events) noexcept {
+    if (client.closed) {
       return;
     }
-
-    buffer[bytes] = '\0';
-
-    // Parse WebSocket key
-    std::string key = extractWebSocketKey(buffer);
-    if (key.empty()) {
-      close(clientSocket);
+    if (events & (EPOLLERR | EPOLLHUP)) {
+      disconnect(client);
       return;
     }
+    if ((events & EPOLLOUT) && !flush(client)) {
+      return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP)) {
+      readClient(client);
+    }
+  }
 
-    // Send upgrade response
-    std::string acceptKey = computeAcceptKey(key);
-    std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
-                           "Upgrade: websocket\r\n"
-                           "Connection: Upgrade\r\n"
-                           "Sec-WebSocket-Accept: " +
-                           acceptKey + "\r\n\r\n";
-
-    send(clientSocket, response.c_str(), response.length(), 0);
-
-    // Add client
-    int clientId;
-    {
-      std::lock_guard<std::mutex> lock(clientsMutex_);
-      clientId = nextClientId_++;
-      clients_[clientId] = {clientSocket, "", std::time(nullptr), false, {}};
+  // Write the client's queue until it is empty or the socket is full;
+  // false if the client was disconnected
+  bool flush(WSClient &client) noexcept {
+    const int fd = client.socket;
+    auto result = fanOut_.drain(
+        *client.subscriber, [fd](const char *data, size_t size) -> ssize_t {
+          while (true) {
+            const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+            if (n >= 0) {
+              return n;
+            }
+            if (errno != EINTR) {
+              return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+            }
+          }
+        });
+    if (result == FanOut::Drain::CLOSED) {
+      disconnect(client);
+      return false;
     }
+    return true;
+  }
 
-    Logging::Logger::getInstance().info("WebSocket client connected: " +
-                                            std::to_string(clientId),
-                                        "WebSocket", 0);
+  void readClient(WSClient &client) noexcept {
+    char buffer[READ_CHUNK];
+    while (true) {
+      const ssize_t bytes = recv(client.socket, buffer, sizeof(buffer), 0);
+      if (bytes > 0) {
+        try {
+          client.in.append(buffer, static_cast<size_t>(bytes));
+        } catch (...) {
+          disconnect(client);
+          return;
+        }
+        if (!parseInput(client)) {
+          return;
+        }
+        continue;
+      }
+      if (bytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return;
+      }
+      disconnect(client); // Closed by the peer, or failed
+      return;
+    }
+  }
 
-    // Handle messages
-    while (running_.load()) {
-      bytes = recv(clientSocket, buffer, sizeof(buffer), 0);
-      if (bytes <= 0)
-        break;
+  // Complete the handshake, then act on whole frames; false if the
+  // client was disconnected
+  bool parseInput(WSClient &client) noexcept {
+    try {
+      if (!client.upgraded) {
+        const size_t end = client.in.find("\r\n\r\n");
+        if (end == std::string::npos) {
+          if (client.in.size() > WSConfig::BUFFER_SIZE) {
+            disconnect(client);
+            return false;
+          }
+          return true;
+        }
+        std::string key = extractWebSocketKey(client.in.c_str());
+        if (key.empty()) {
+          disconnect(client);
+          return false;
+        }
+        client.in.erase(0, end + 4);
+        fanOut_.send(client.subscriber,
+                     std::make_shared<const std::string>(
+                         "HTTP/1.1 101 Switching Protocols\r\n"
+                         "Upgrade: websocket\r\n"
+                         "Connection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " +
+                         computeAcceptKey(key) + "\r\n\r\n"));
+        client.upgraded = true;
+        welcome(client);
+        Logging::Logger::getInstance().info(
+            "WebSocket client connected: " +
+                std::to_string(client.subscriber->id()),
+            "WebSocket", 0);
+      }
 
-      // Parse WebSocket frame (simplified)
-      if (bytes >= 2) {
-        uint8_t opcode = buffer[0] & 0x0F;
+      size_t pos = 0;
+      while (client.in.size() - pos >= 2) {
+        const auto *p =
+            reinterpret_cast<const uint8_t *>(client.in.data() + pos);
+        const size_t available = client.in.size() - pos;
+        const uint8_t opcode = p[0] & 0x0F;
+        const bool masked = p[1] & 0x80;
+        uint64_t length = p[1] & 0x7F;
+        size_t header = 2;
+        if (length == 126) {
+          if (available < 4)
+            break;
+          length = static_cast<uint64_t>(p[2]) << 8 | p[3];
+          header = 4;
+        } else if (length == 127) {
+          if (available < 10)
+            break;
+          length = 0;
+          for (int i = 0; i < 8; ++i) {
+            length = length << 8 | p[2 + i];
+          }
+          header = 10;
+        }
+        if (length > WSConfig::BUFFER_SIZE) {
+          disconnect(client);
+          return false;
+        }
+        const size_t maskAt = header;
+        header += masked ? 4 : 0;
+        if (available < header + length) {
+          break;
+        }
+        std::string payload(client.in, pos + header, length);
+        if (masked) {
+          for (size_t i = 0; i < payload.size(); ++i) {
+            payload[i] = static_cast<char>(payload[i] ^ p[maskAt + i % 4]);
+          }
+        }
+        pos += header + length;
 
         if (opcode == 0x08) { // Close
-          break;
+          disconnect(client);
+          return false;
         } else if (opcode == 0x09) { // Ping
-          buffer[0] = 0x8A;          // Pong
-          send(clientSocket, buffer, bytes, 0);
+          fanOut_.send(client.subscriber,
+                       encodeFrame(payload, MessageType::PONG));
+        } else if (opcode == 0x01) { // Text
+          handleRequest(client, payload);
         }
       }
+      client.in.erase(0, pos);
+      if (client.in.size() > WSConfig::BUFFER_SIZE + 14) {
+        disconnect(client);
+        return false;
+      }
+      return true;
+    } catch (...) {
+      disconnect(client);
+      return false;
     }
+  }
 
-    // Remove client
-    {
-      std::lock_guard<std::mutex> lock(clientsMutex_);
-      clients_.erase(clientId);
+  // Under feedMutex_, so the snapshot is queued ahead of every delta the
+  // feed publishes after it
+  void welcome(WSClient &client) {
+    std::lock_guard<std::mutex> lock(feedMutex_);
+    if (Trading::OrderBook *book = book_.load()) {
+      fanOut_.send(client.subscriber,
+                   encodeFrame(formatEvent(
+                       EventType::BOOK_SNAPSHOT,
+                       encodeSnapshot(*book, book->getSnapshot()))));
     }
+    fanOut_.setMask(client.subscriber, FanOut::ALL);
+  }
 
-    close(clientSocket);
+  // {"subscribe":[names]} narrows a client to the named events (adding
+  // to earlier subscribes); {"unsubscribe":[names]} removes events
+  void handleRequest(WSClient &client, std::string_view text) {
+    JsonRpc::detail::Reader r(text);
+    std::string_view key;
+    bool escaped;
+    if (!r.consume('{') || !r.string(key, escaped) || !r.consume(':') ||
+        !r.consume('[')) {
+      return;
+    }
+    const bool add = key == "subscribe";
+    if (!add && key != "unsubscribe") {
+      return;
+    }
+    uint32_t events = 0;
+    if (!r.consume(']')) {
+      do {
+        std::string_view name;
+        if (!r.string(name, escaped)) {
+          return;
+        }
+        for (size_t e = 0; e < EVENT_TYPE_COUNT; ++e) {
+          if (name == eventName(static_cast<EventType>(e))) {
+            events |= 1u << e;
+          }
+        }
+      } while (r.consume(','));
+      if (!r.consume(']')) {
+        return;
+      }
+    }
+    uint32_t mask = fanOut_.mask(client.subscriber);
+    if (add) {
+      mask = (client.narrowed ? mask : 0) | events;
+      client.narrowed = true;
+    } else {
+      mask &= ~events;
+    }
+    fanOut_.setMask(client.subscriber, mask);
+  }
 
-    Logging::Logger::getInstance().info("WebSocket client disconnected: " +
-                                            std::to_string(clientId),
-                                        "WebSocket", 0);
+  void disconnect(WSClient &client) noexcept {
+    if (client.closed) {
+      return;
+    }
+    client.closed = true;
+    try {
+      fanOut_.unsubscribe(client.subscriber);
+    } catch (...) {
+    }
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, client.socket, nullptr);
+    close(client.socket);
+    clientCount_.fetch_sub(1);
+    if (client.upgraded) {
+      Logging::Logger::getInstance().info(
+          "WebSocket client disconnected: " +
+              std::to_string(client.subscriber->id()),
+          "WebSocket", 0);
+    }
+    // Keep the object alive until the current event batch is done
+    auto it = clients_.find(client.subscriber->id());
+    try {
+      graveyard_.push_back(std::move(it->second));
+    } catch (...) {
+      it->second.release(); // Leaked rather than freed under the batch
+    }
+    clients_.erase(it);
   }
 
-  void pingLoop() noexcept {
-    while (running_.load()) {
-      std::this_thread::sleep_for(
-          std::chrono::seconds(WSConfig::PING_INTERVAL_SEC));
-
-      std::lock_guard<std::mutex> lock(clientsMutex_);
-      for (auto &[id, client] : clients_) {
-        // Send ping frame
-        char ping[2] = {static_cast<char>(0x89), 0x00};
-        send(client.socket, ping, 2, 0);
+  // Turns book events into book_delta and trade broadcasts, one of each
+  // per wakeup however many events arrived
+  void feedLoop() noexcept {
+    Trading::OrderBook &book = *book_.load();
+    uint64_t cursor = book.getEventSequence();
+    std::vector<Trading::MarketEvent> events;
+    std::map<Trading::Ticks, Trading::Lots, std::greater<>> bids;
+    std::map<Trading::Ticks, Trading::Lots> asks;
+    std::string trades;
+    while (feedRunning_.load()) {
+      book.waitForEvents(cursor, &feedRunning_);
+      if (!feedRunning_.load()) {
+        break;
+      }
+      try {
+        events.clear();
+        if (!book.readEvents(cursor, events)) {
+          // Fell a whole ring behind; clients start over
+          const Trading::BookSnapshot snapshot = book.getSnapshot();
+          cursor = snapshot.sequence;
+          std::lock_guard<std::mutex> lock(feedMutex_);
+          broadcast(EventType::BOOK_SNAPSHOT, encodeSnapshot(book, snapshot));
+          continue;
+        }
+        if (events.empty()) {
+          continue;
+        }
+        bids.clear();
+        asks.clear();
+        trades.clear();
+        JsonRpc::Writer tw(trades);
+        tw.beginArray();
+        for (const auto &event : events) {
+          if (event.kind == Trading::MarketEvent::Kind::LEVEL) {
+            if (event.side == Trading::OrderSide::BUY) {
+              bids[event.price] = event.quantity;
+            } else {
+              asks[event.price] = event.quantity;
+            }
+            continue;
+          }
+          tw.beginObject()
+              .key("seq")
+              .number(event.sequence)
+              .key("price")
+              .number(book.fromTicks(event.price))
+              .key("quantity")
+              .number(book.fromLots(event.quantity))
+              .key("side")
+              .string(event.side == Trading::OrderSide::BUY ? "buy" : "sell")
+              .key("time")
+              .number(event.timestamp)
+              .endObject();
+        }
+        tw.endArray();
+
+        const uint64_t from = cursor + 1;
+        cursor = events.back().sequence;
+        std::lock_guard<std::mutex> lock(feedMutex_);
+        if (!bids.empty() || !asks.empty()) {
+          std::string delta;
+          JsonRpc::Writer w(delta);
+          w.beginObject().key("from").number(from).key("to").number(cursor);
+          writeLevels(w.key("bids"), book, bids);
+          writeLevels(w.key("asks"), book, asks);
+          w.endObject();
+          broadcast(EventType::BOOK_DELTA, delta);
+        }
+        if (trades.size() > 2) {
+          broadcast(EventType::TRADE, trades);
+        }
+      } catch (...) {
+        // Out of memory; resume from the ring on the next wakeup
       }
     }
   }
 
+  template <typename Levels>
+  static void writeLevels(JsonRpc::Writer &w, const Trading::OrderBook &book,
+                          const Levels &levels) {
+    w.beginArray();
+    for (const auto &[price, lots] : levels) {
+      w.beginArray()
+          .number(book.fromTicks(price))
+          .number(book.fromLots(lots))
+          .endArray();
+    }
+    w.endArray();
+  }
+
+  static std::string encodeSnapshot(const Trading::OrderBook &book,
+                                    const Trading::BookSnapshot &snapshot) {
+    std::string out;
+    JsonRpc::Writer w(out);
+    w.beginObject().key("seq").number(snapshot.sequence);
+    writeLevels(w.key("bids"), book, snapshot.bids);
+    writeLevels(w.key("asks"), book, snapshot.asks);
+    w.endObject();
+    return out;
+  }
+
   [[nodiscard]] std::string
   extractWebSocketKey(const char *request) const noexcept {
     const char *keyHeader = "Sec-WebSocket-Key: ";
@@ -358,54 +1088,8 @@ private:
 
   [[nodiscard]] std::string
   formatEvent(EventType event, const std::string &data) const noexcept {
-    std::string eventName;
-    switch (event) {
-    case EventType::NEW_BLOCK:
-      eventName = "new_block";
-      break;
-    case EventType::NEW_TRANSACTION:
-      eventName = "new_transaction";
-      break;
-    case EventType::PRICE_UPDATE:
-      eventName = "price_update";
-      break;
-    case EventType::MINING_STATUS:
-      eventName = "mining_status";
-      break;
-    case EventType::PEER_CONNECTED:
-      eventName = "peer_connected";
-      break;
-    case EventType::PEER_DISCONNECTED:
-      eventName = "peer_disconnected";
-      break;
-    }
-
-    return "{\"event\":\"" + eventName + "\",\"data\":" + data + "}";
-  }
-
-  void sendMessage(int socket, const std::string &message) noexcept {
-    if (socket < 0 || message.empty())
-      return;
-
-    std::vector<char> frame;
-    frame.push_back(static_cast<char>(0x81)); // Text frame, FIN
-
-    if (message.length() <= 125) {
-      frame.push_back(static_cast<char>(message.length()));
-    } else if (message.length() <= 65535) {
-      frame.push_back(126);
-      frame.push_back(static_cast<char>((message.length() >> 8) & 0xFF));
-      frame.push_back(static_cast<char>(message.length() & 0xFF));
-    } else {
-      frame.push_back(127);
-      for (int i = 7; i >= 0; --i) {
-        frame.push_back(
-            static_cast<char>((message.length() >> (8 * i)) & 0xFF));
-      }
-    }
-
-    frame.insert(frame.end(), message.begin(), message.end());
-    send(socket, frame.data(), frame.size(), 0);
+    return "{\"event\":\"" + std::string(eventName(event)) +
+           "\",\"data\":" + data + "}";
   }
 };
 
@@ -0,0 +1,179 @@
+// QuantumPulse log decoder (quantumpulse-logdump)
+// Renders binary .qplog files written by the node as text or JSON lines
+
+#include "../include/quantumpulse_jsonrpc_v7.h"
+#include "../include/quantumpulse_logformat_v7.h"
+#include "../include/quantumpulse_logging_v7.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace QuantumPulse;
+using Logging::Binary::ArgType;
+
+namespace {
+
+struct Options {
+  bool json{false};
+  uint8_t minLevel{0};
+  std::string module;
+};
+
+void printHelp() {
+  std::cout << "QuantumPulse log decoder v7.0.0\n\n";
+  std::cout << "Usage: quantumpulse-logdump [options] <file.qplog>...\n\n";
+  std::cout << "Options:\n";
+  std::cout << "  -json               One JSON object per line\n";
+  std::cout << "  -level=<LEVEL>      Skip entries below LEVEL, e.g. WARNING\n";
+  std::cout << "  -module=<name>      Only entries from this module\n";
+}
+
+// "[YYYY-mm-dd HH:MM:SS.mmm][LEVEL][module][Shard:N] message"
+void printText(const Logging::Binary::Event &ev, std::string &out) {
+  out += '[';
+  out += Logging::Binary::formatTimestamp(ev.timestampNs);
+  out += "][";
+  out += Logging::logLevelToString(static_cast<Logging::LogLevel>(ev.level));
+  out += "][";
+  out += ev.module;
+  out += "][Shard:";
+  out += std::to_string(ev.shardId);
+  out += "] ";
+  out += Logging::Binary::renderMessage(ev);
+  out += '\n';
+}
+
+void printJson(const Logging::Binary::Event &ev, std::string &out) {
+  JsonRpc::Writer w(out);
+  w.beginObject()
+      .key("ts")
+      .number(ev.timestampNs)
+      .key("time")
+      .string(Logging::Binary::formatTimestamp(ev.timestampNs))
+      .key("level")
+      .string(Logging::logLevelToString(
+          static_cast<Logging::LogLevel>(ev.level)))
+      .key("module")
+      .string(ev.module)
+      .key("shard")
+      .number(ev.shardId)
+      .key("message")
+      .string(Logging::Binary::renderMessage(ev));
+  if (!ev.plain) {
+    w.key("format").string(ev.format).key("args").beginArray();
+    Logging::Binary::forEachArg(
+        ev.args, [&](ArgType type, int64_t i, uint64_t u, double d,
+                     std::string_view s) {
+          switch (type) {
+          case ArgType::INT:
+            w.number(i);
+            break;
+          case ArgType::UINT:
+            w.number(u);
+            break;
+          case ArgType::DOUBLE:
+            w.number(d);
+            break;
+          case ArgType::BOOL:
+            w.boolean(u != 0);
+            break;
+          default:
+            w.string(s);
+          }
+        });
+    w.endArray();
+  }
+  w.endObject();
+  out += '\n';
+}
+
+// Returns false if the file is unreadable or damaged
+bool dump(const std::string &path, const Options &opts) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cerr << path << ": cannot open\n";
+    return false;
+  }
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  Logging::Binary::Reader reader(data);
+  if (!reader.valid()) {
+    std::cerr << path << ": not a QuantumPulse binary log\n";
+    return false;
+  }
+
+  std::string out;
+  Logging::Binary::Event ev;
+  auto status = Logging::Binary::Reader::Status::Event;
+  while ((status = reader.next(ev)) ==
+         Logging::Binary::Reader::Status::Event) {
+    if (ev.level < opts.minLevel ||
+        (!opts.module.empty() && ev.module != opts.module)) {
+      continue;
+    }
+    opts.json ? printJson(ev, out) : printText(ev, out);
+    if (out.size() >= 64 * 1024) {
+      std::cout << out;
+      out.clear();
+    }
+  }
+  std::cout << out;
+
+  if (reader.dropped() > 0) {
+    std::cerr << path << ": " << reader.dropped()
+              << " messages were dropped by the logger (ring full)\n";
+  }
+  if (status == Logging::Binary::Reader::Status::Corrupt) {
+    // A node killed mid-write leaves a partial last entry
+    std::cerr << path << ": stopped at byte " << reader.position()
+              << " of " << data.size() << " (truncated or corrupt)\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options opts;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-help" || arg == "--help" || arg == "-h") {
+      printHelp();
+      return 0;
+    } else if (arg == "-json") {
+      opts.json = true;
+    } else if (arg.find("-level=") == 0) {
+      std::string level = arg.substr(7);
+      bool known = false;
+      for (uint8_t l = 0; l <= static_cast<uint8_t>(Logging::AUDIT); ++l) {
+        if (Logging::logLevelToString(static_cast<Logging::LogLevel>(l)) ==
+            level) {
+          opts.minLevel = l;
+          known = true;
+        }
+      }
+      if (!known) {
+        std::cerr << "unknown level: " << level << "\n";
+        return 1;
+      }
+    } else if (arg.find("-module=") == 0) {
+      opts.module = arg.substr(8);
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.empty()) {
+    printHelp();
+    return 1;
+  }
+
+  bool ok = true;
+  for (const auto &path : files) {
+    ok &= dump(path, opts);
+  }
+  return ok ? 0 : 1;
+}
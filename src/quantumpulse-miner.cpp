@@ -2,6 +2,7 @@
 // Bitcoin-like standalone mining client with HIGH difficulty and HALVING
 
 #include "../include/quantumpulse_crypto_v7.h"
+#include "../include/quantumpulse_pow_v7.h"
 
 #include <atomic>
 #include <chrono>
@@ -26,6 +27,7 @@ constexpr int MAX_DIFFICULTY = 16;            // Maximum difficulty
 constexpr int TARGET_BLOCK_TIME = 600;        // 10 minutes
 constexpr double INITIAL_BLOCK_REWARD = 50.0; // Start at 50 QP
 constexpr double MIN_PRICE = 600000.0;        // $600,000 minimum ALWAYS
+constexpr uint64_t NONCES_PER_WORKER_BATCH = 1 << 18; // Template refresh rate
 
 void signalHandler(int) {
   std::cout << "\n[miner] Stopping..." << std::endl;
@@ -69,116 +71,116 @@ std::string getEraName(int blockHeight) {
   }
 }
 
-// Calculate hash
-std::string calculateHash(const std::string &data, int shardId) {
-  Crypto::CryptoManager cm;
-  return cm.sha3_512_v11(data, shardId);
+// Build the fixed-layout header template for the current chain tip
+Mining::PowHeader buildHeader(int blockHeight, int difficulty,
+                              int64_t timestamp,
+                              const std::string &minerAddress) {
+  Mining::PowHeader header;
+  header.difficulty = static_cast<uint32_t>(difficulty);
+  header.timestamp = timestamp;
+  std::string merkle = "MERKLE:" + std::to_string(blockHeight);
+  [[maybe_unused]] bool ok =
+      Crypto::Hashing::sha512(merkle, header.merkleRoot);
+  header.setMiner(minerAddress);
+  return header;
 }
 
-// Check if hash meets difficulty target
-bool meetsTarget(const std::string &hash, int difficulty) {
-  for (int i = 0; i < difficulty && i < static_cast<int>(hash.length()); i++) {
-    if (hash[i] != '0')
-      return false;
+// Announce a found block and apply halving / difficulty adjustment
+void reportBlock(const Mining::PowResult &result, int difficulty,
+                 double blockReward, double blockTime,
+                 const std::string &minerAddress) {
+  g_blocksFound++;
+  g_totalBlocksMined++;
+  int newTotal = g_totalBlocksMined.load();
+  std::string hashHex = Crypto::Hashing::toHex(result.hash);
+
+  std::cout << "\n🎉 ══════════════════════════════════════════════════"
+            << std::endl;
+  std::cout << "   BLOCK FOUND by thread " << result.workerId << "!"
+            << std::endl;
+  std::cout << "   Hash: " << hashHex.substr(0, 32) << "..." << std::endl;
+  std::cout << "   Nonce: " << result.nonce << std::endl;
+  std::cout << "   Difficulty: " << difficulty
+            << " (target: " << std::string(difficulty, '0') << "...)"
+            << std::endl;
+  std::cout << "   Block Time: " << std::fixed << std::setprecision(1)
+            << blockTime << " seconds" << std::endl;
+  std::cout << "   Block Height: " << newTotal << std::endl;
+  std::cout << "   Era: " << getEraName(newTotal) << std::endl;
+  std::cout << "   Reward: " << std::fixed << std::setprecision(8)
+            << blockReward << " QP -> " << minerAddress << std::endl;
+  std::cout << "   Value: $" << std::fixed << std::setprecision(0)
+            << (blockReward * MIN_PRICE) << " USD (min $" << MIN_PRICE
+            << "/QP)" << std::endl;
+  std::cout << "══════════════════════════════════════════════════════"
+            << std::endl;
+
+  // Check for halving
+  if (newTotal % HALVING_INTERVAL == 0 && newTotal > 0) {
+    double newReward = calculateBlockReward(newTotal);
+    std::cout << "\n🔔 ═══════════════════════════════════════════════════"
+              << std::endl;
+    std::cout << "   HALVING EVENT! Block reward reduced to " << newReward
+              << " QP!" << std::endl;
+    std::cout << "══════════════════════════════════════════════════════\n"
+              << std::endl;
   }
-  return true;
-}
 
-// Mining worker thread - Bitcoin-like algorithm with halving
-void mineWorker(int threadId, const std::string &minerAddress) {
-  uint64_t localHashes = 0;
-  uint64_t nonce = threadId * 10000000000ULL;
+  // Difficulty adjustment every 10 blocks
+  if (g_blocksFound % 10 == 0 && g_blocksFound > 0) {
+    if (blockTime < TARGET_BLOCK_TIME * 0.5) {
+      int newDiff = std::min(g_currentDifficulty.load() + 1, MAX_DIFFICULTY);
+      g_currentDifficulty.store(newDiff);
+      std::cout << "\n⬆️  DIFFICULTY INCREASED to " << newDiff
+                << " (target: " << std::string(newDiff, '0') << "...)"
+                << std::endl;
+    } else if (blockTime > TARGET_BLOCK_TIME * 2 &&
+               g_currentDifficulty > INITIAL_DIFFICULTY - 2) {
+      int newDiff = g_currentDifficulty.load() - 1;
+      g_currentDifficulty.store(newDiff);
+      std::cout << "\n⬇️  Difficulty decreased to " << newDiff << std::endl;
+    }
+  }
+}
 
+// Mining loop - midstate PoW over nonce ranges partitioned across workers.
+// The header template is rebuilt only when the timestamp, difficulty or
+// height changes; between rebuilds the nonce keeps advancing.
+void mineLoop(Mining::PowEngine &engine, const std::string &minerAddress) {
   auto lastBlockTime = std::chrono::steady_clock::now();
+  const uint64_t batch = NONCES_PER_WORKER_BATCH * engine.getThreadCount();
+
+  Mining::PowHeader header;
+  uint64_t nextNonce = 0;
+  bool haveTemplate = false;
 
   while (g_mining) {
     int64_t timestamp = std::time(nullptr);
     int difficulty = g_currentDifficulty.load();
     int currentBlock = g_totalBlocksMined.load();
-    double blockReward = calculateBlockReward(currentBlock);
-
-    // Block header format
-    std::string blockHeader =
-        "VERSION:7|" + std::string(64, '0') + "|" + // Previous hash
-        "MERKLE:" + std::to_string(currentBlock) + "|" +
-        "TIME:" + std::to_string(timestamp) + "|" +
-        "DIFF:" + std::to_string(difficulty) + "|" +
-        "NONCE:" + std::to_string(nonce) + "|" + "MINER:" + minerAddress;
 
-    // Double SHA3-512 (like Bitcoin's double SHA256)
-    std::string hash1 = calculateHash(blockHeader, threadId);
-    std::string hash2 = calculateHash(hash1, threadId);
+    if (!haveTemplate || header.timestamp != timestamp ||
+        static_cast<int>(header.difficulty) != difficulty) {
+      header = buildHeader(currentBlock, difficulty, timestamp, minerAddress);
+      nextNonce = 0;
+      haveTemplate = true;
+    }
 
-    localHashes++;
-    nonce++;
+    auto result = engine.search(header, nextNonce, batch, g_mining);
+    nextNonce += batch;
+    g_totalHashes.store(engine.getTotalHashes());
 
-    // Check if block found
-    if (meetsTarget(hash2, difficulty)) {
+    if (result) {
       auto now = std::chrono::steady_clock::now();
-      auto blockTime =
+      double blockTime =
           std::chrono::duration<double>(now - lastBlockTime).count();
       lastBlockTime = now;
 
-      g_blocksFound++;
-      g_totalBlocksMined++;
-      int newTotal = g_totalBlocksMined.load();
-
-      std::cout << "\n🎉 ══════════════════════════════════════════════════"
-                << std::endl;
-      std::cout << "   BLOCK FOUND by thread " << threadId << "!" << std::endl;
-      std::cout << "   Hash: " << hash2.substr(0, 32) << "..." << std::endl;
-      std::cout << "   Difficulty: " << difficulty
-                << " (target: " << std::string(difficulty, '0') << "...)"
-                << std::endl;
-      std::cout << "   Block Time: " << std::fixed << std::setprecision(1)
-                << blockTime << " seconds" << std::endl;
-      std::cout << "   Block Height: " << newTotal << std::endl;
-      std::cout << "   Era: " << getEraName(newTotal) << std::endl;
-      std::cout << "   Reward: " << std::fixed << std::setprecision(8)
-                << blockReward << " QP -> " << minerAddress << std::endl;
-      std::cout << "   Value: $" << std::fixed << std::setprecision(0)
-                << (blockReward * MIN_PRICE) << " USD (min $" << MIN_PRICE
-                << "/QP)" << std::endl;
-      std::cout << "══════════════════════════════════════════════════════"
-                << std::endl;
-
-      // Check for halving
-      if (newTotal % HALVING_INTERVAL == 0 && newTotal > 0) {
-        double newReward = calculateBlockReward(newTotal);
-        std::cout << "\n🔔 ═══════════════════════════════════════════════════"
-                  << std::endl;
-        std::cout << "   HALVING EVENT! Block reward reduced to " << newReward
-                  << " QP!" << std::endl;
-        std::cout << "══════════════════════════════════════════════════════\n"
-                  << std::endl;
-      }
-
-      // Difficulty adjustment every 10 blocks
-      if (g_blocksFound % 10 == 0 && g_blocksFound > 0) {
-        if (blockTime < TARGET_BLOCK_TIME * 0.5) {
-          int newDiff =
-              std::min(g_currentDifficulty.load() + 1, MAX_DIFFICULTY);
-          g_currentDifficulty.store(newDiff);
-          std::cout << "\n⬆️  DIFFICULTY INCREASED to " << newDiff
-                    << " (target: " << std::string(newDiff, '0') << "...)"
-                    << std::endl;
-        } else if (blockTime > TARGET_BLOCK_TIME * 2 &&
-                   g_currentDifficulty > INITIAL_DIFFICULTY - 2) {
-          int newDiff = g_currentDifficulty.load() - 1;
-          g_currentDifficulty.store(newDiff);
-          std::cout << "\n⬇️  Difficulty decreased to " << newDiff << std::endl;
-        }
-      }
-    }
-
-    // Update global hash counter
-    if (localHashes % 10000 == 0) {
-      g_totalHashes += localHashes;
-      localHashes = 0;
+      reportBlock(*result, difficulty, calculateBlockReward(currentBlock),
+                  blockTime, minerAddress);
+      haveTemplate = false;
     }
   }
-
-  g_totalHashes += localHashes;
 }
 
 // Stats display thread
@@ -317,14 +319,8 @@ int main(int argc, char *argv[]) {
 
   std::thread stats(statsThread);
 
-  std::vector<std::thread> workers;
-  for (int i = 0; i < numThreads; i++) {
-    workers.emplace_back(mineWorker, i, minerAddress);
-  }
-
-  for (auto &t : workers) {
-    t.join();
-  }
+  Mining::PowEngine engine(static_cast<unsigned>(std::max(1, numThreads)));
+  mineLoop(engine, minerAddress);
   stats.join();
 
   double totalEarned = 0;
@@ -17,14 +17,13 @@ bool deepValidateChain(const std::vector<Block> &chain,
   if (chain.empty())
     return true;
 
-  for (size_t i = 1; i < chain.size(); ++i) {
-    // Validate each block
-    if (!chain[i].validate(crypto)) {
-      Logging::Logger::getInstance().log("Deep validation failed at block " +
-                                             std::to_string(i),
-                                         Logging::CRITICAL, "Blockchain", 0);
-      return false;
-    }
+  auto result = ChainValidator(crypto).validate(chain);
+  if (!result.valid) {
+    Logging::Logger::getInstance().log(
+        "Deep validation failed at block " +
+            std::to_string(result.failedIndex) + ": " + result.reason,
+        Logging::CRITICAL, "Blockchain", 0);
+    return false;
   }
   return true;
 }
@@ -42,21 +41,25 @@ std::string constructMerkleRoot(const std::vector<Transaction> &transactions,
     return crypto.sha3_512_v11("empty_block", shardId);
   }
 
-  std::vector<std::string> hashes;
+  // Each level is a set of independent, equal-length inputs, so hash it
+  // through the multi-buffer kernel
+  std::vector<std::string> leaves;
+  leaves.reserve(transactions.size());
   for (const auto &tx : transactions) {
-    hashes.push_back(crypto.sha3_512_v11(tx.txId, shardId));
+    leaves.push_back(tx.txId);
   }
+  std::vector<std::string> hashes = crypto.sha3_512_v11_batch(leaves, shardId);
 
   while (hashes.size() > 1) {
-    std::vector<std::string> newHashes;
+    std::vector<std::string> combined;
+    combined.reserve((hashes.size() + 1) / 2);
     for (size_t i = 0; i < hashes.size(); i += 2) {
-      std::string combined = hashes[i];
+      combined.push_back(hashes[i]);
       if (i + 1 < hashes.size()) {
-        combined += hashes[i + 1];
+        combined.back() += hashes[i + 1];
       }
-      newHashes.push_back(crypto.sha3_512_v11(combined, shardId));
     }
-    hashes = std::move(newHashes);
+    hashes = crypto.sha3_512_v11_batch(combined, shardId);
   }
 
   return hashes[0];
@@ -3,255 +3,365 @@
 
 #include "../include/quantumpulse_blockchain_v7.h"
 #include "../include/quantumpulse_crypto_v7.h"
+#include "../include/quantumpulse_http_v7.h"
+#include "../include/quantumpulse_jsonrpc_v7.h"
 #include "../include/quantumpulse_logging_v7.h"
+#include "../include/quantumpulse_metrics_v7.h"
+#include "../include/quantumpulse_p2p_protocol_v7.h"
+#include "../include/quantumpulse_sync_v7.h"
+#include "../include/quantumpulse_trace_v7.h"
 
 #include <arpa/inet.h>
+#include <atomic>
 #include <csignal>
 
 #include <iostream>
+#include <mutex>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 using namespace QuantumPulse;
 
 // Global daemon state
-static bool g_running = true;
+static std::atomic<bool> g_running{true};
 static std::unique_ptr<Blockchain::Blockchain> g_blockchain;
+static std::unique_ptr<Metrics::PrometheusExporter> g_metrics;
 static int g_rpcPort = 8332;
 static int g_p2pPort = 8333;
 
+// Result of the last initial block download
+static std::mutex g_syncMutex;
+static Network::SyncStats g_syncStats;
+static bool g_syncComplete = false;
+
+// Relayed transactions, used to rebuild compact blocks
+static P2P::TxRelayPool g_txPool;
+
+// Live peer connections that accepted blocks and transactions relay to
+static std::unique_ptr<P2P::NetworkManager> g_network;
+
 // Signal handler
 void signalHandler(int) {
   std::cout << "\n[quantumpulsed] Shutting down..." << std::endl;
   g_running = false;
 }
 
-// JSON-RPC Server (Bitcoin-compatible)
+// JSON-RPC Server (Bitcoin-compatible). Connections are served by the
+// epoll reactor in Http::Server with keep-alive; RPC methods run on its
+// worker pool. Request bodies may be single calls or JSON-RPC 2.0 batches.
+// GET /metrics on the same port returns the Prometheus text format.
 class RPCServer {
 public:
-  RPCServer(int port) : port_(port) {}
+  RPCServer(int port) : port_(port) { registerMethods(); }
 
   void start() {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
-      Logging::Logger::getInstance().error("Failed to create RPC socket", "RPC",
-                                           0);
-      return;
-    }
-
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    struct sockaddr_in address;
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(port_);
+    Http::ServerConfig config;
+    config.port = static_cast<uint16_t>(port_);
+    Http::Server server(config, [this](const Http::Request &request) {
+      Http::Response response;
+      if (request.method == "GET" && request.target == "/metrics") {
+        g_metrics->setGauge(
+            "quantumpulse_chain_length",
+            static_cast<double>(g_blockchain->getChainLength()));
+        response.contentType = "text/plain; version=0.0.4";
+        g_metrics->scrapeTo(response.body);
+        return response;
+      }
+      QP_TRACE_SCOPE("rpc.request", "rpc");
+      response.body.reserve(256);
+      dispatcher_.handle(request.body, response.body);
+      if (response.body.empty()) {
+        response.status = 204; // Only notifications
+      }
+      return response;
+    });
 
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    if (!server.start()) {
       Logging::Logger::getInstance().error("Failed to bind RPC port", "RPC", 0);
-      close(server_fd);
       return;
     }
-
-    listen(server_fd, 10);
     Logging::Logger::getInstance().info(
         "RPC server listening on port " + std::to_string(port_), "RPC", 0);
 
     while (g_running) {
-      struct sockaddr_in client_addr;
-      socklen_t client_len = sizeof(client_addr);
-
-      fd_set readfds;
-      FD_ZERO(&readfds);
-      FD_SET(server_fd, &readfds);
-
-      struct timeval tv = {1, 0};
-      if (select(server_fd + 1, &readfds, nullptr, nullptr, &tv) > 0) {
-        int client_fd =
-            accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
-        if (client_fd >= 0) {
-          std::thread(&RPCServer::handleClient, this, client_fd).detach();
-        }
-      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
-
-    close(server_fd);
+    server.stop();
   }
 
 private:
-  int port_;
-
-  void handleClient(int client_fd) {
-    char buffer[8192] = {0};
-    read(client_fd, buffer, sizeof(buffer) - 1);
-
-    std::string request(buffer);
-    std::string response = processRPC(request);
-
-    std::string httpResponse = "HTTP/1.1 200 OK\r\n"
-                               "Content-Type: application/json\r\n"
-                               "Content-Length: " +
-                               std::to_string(response.length()) +
-                               "\r\n"
-                               "\r\n" +
-                               response;
-
-    write(client_fd, httpResponse.c_str(), httpResponse.length());
-    close(client_fd);
-  }
-
-  std::string processRPC(const std::string &request) {
-    // Parse JSON-RPC request
-    auto methodStart = request.find("\"method\"");
-    if (methodStart == std::string::npos) {
-      return R"({"error": "Invalid request"})";
-    }
-
-    // Extract method
-    auto colonPos = request.find(":", methodStart);
-    auto quoteStart = request.find("\"", colonPos);
-    auto quoteEnd = request.find("\"", quoteStart + 1);
-    std::string method =
-        request.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
-
-    // Handle RPC methods (Bitcoin-compatible)
-    if (method == "getblockchaininfo") {
-      return R"({"result": {"chain": "quantumpulse", "blocks": )" +
-             std::to_string(g_blockchain->getChainLength()) +
-             R"(, "headers": )" +
-             std::to_string(g_blockchain->getChainLength()) +
-             R"(, "difficulty": 4, "mediantime": )" +
-             std::to_string(std::time(nullptr)) +
-             R"(, "verificationprogress": 1.0, "pruned": false}, "error": null, "id": 1})";
-    }
-
-    if (method == "getbalance") {
-      // Privacy: Balance only shown with valid auth token in params
-      return R"({"result": "**PRIVATE**", "error": null, "id": 1, "note": "Use wallet CLI with auth token"})";
-    }
-
-    if (method == "getblockcount") {
-      return R"({"result": )" + std::to_string(g_blockchain->getChainLength()) +
-             R"(, "error": null, "id": 1})";
-    }
-
-    if (method == "getdifficulty") {
-      return R"({"result": 4, "error": null, "id": 1})";
-    }
-
-    if (method == "getmininginfo") {
-      return R"({"result": {"blocks": )" +
-             std::to_string(g_blockchain->getChainLength()) +
-             R"(, "difficulty": 4, "networkhashps": 150000000, "pooledtx": 0, "chain": "quantumpulse"}, "error": null, "id": 1})";
-    }
+  using Params = JsonRpc::Params;
+  using Reply = JsonRpc::Reply;
 
-    if (method == "getpeerinfo") {
-      return R"({"result": [], "error": null, "id": 1})";
-    }
-
-    if (method == "getnetworkinfo") {
-      return R"({"result": {"version": 70000, "subversion": "/QuantumPulse:7.0.0/", "protocolversion": 70001, "connections": 0, "networks": []}, "error": null, "id": 1})";
+  int port_;
+  JsonRpc::Dispatcher dispatcher_;
+
+  // Registers each method with its own trace site, "rpc.<method>"
+  struct TracedMethods {
+    JsonRpc::Dispatcher &dispatcher;
+
+    void add(std::string name, JsonRpc::MethodHandler handler) {
+      auto &site = Trace::Tracer::getInstance().site("rpc." + name, "rpc");
+      dispatcher.add(std::move(name),
+                     [&site, handler = std::move(handler)](
+                         const Params &params, Reply &reply) {
+                       QP_TRACE_SITE_SPAN(span, site);
+                       handler(params, reply);
+                     });
     }
-
-    if (method == "getnewaddress") {
+  };
+
+  // Handlers run concurrently on the HTTP worker pool
+  void registerMethods() {
+    TracedMethods d{dispatcher_};
+
+    d.add("getblockchaininfo", [](const Params &, Reply &reply) {
+      uint64_t blocks = g_blockchain->getChainLength();
+      reply.result()
+          .beginObject()
+          .key("chain")
+          .string("quantumpulse")
+          .key("blocks")
+          .number(blocks)
+          .key("headers")
+          .number(blocks)
+          .key("difficulty")
+          .number(4)
+          .key("mediantime")
+          .number(static_cast<int64_t>(std::time(nullptr)))
+          .key("verificationprogress")
+          .number(1.0)
+          .key("pruned")
+          .boolean(false)
+          .endObject();
+    });
+
+    // Privacy: Balance only shown with valid auth token via wallet CLI
+    d.add("getbalance", [](const Params &, Reply &reply) {
+      reply.result().string("**PRIVATE**");
+    });
+
+    d.add("getblockcount", [](const Params &, Reply &reply) {
+      reply.result().number(
+          static_cast<uint64_t>(g_blockchain->getChainLength()));
+    });
+
+    d.add("getblockhash", [](const Params &params, Reply &reply) {
+      auto height = params.getInteger(0);
+      if (!height || *height < 0) {
+        reply.error(JsonRpc::INVALID_PARAMS, "Usage: getblockhash height");
+        return;
+      }
+      auto block = g_blockchain->getBlock(static_cast<size_t>(*height));
+      if (!block) {
+        reply.error(-8, "Block height out of range");
+        return;
+      }
+      reply.result().string(block->hash);
+    });
+
+    // getblock accepts a block hash (Bitcoin-compatible) or a height
+    d.add("getblock", [](const Params &params, Reply &reply) {
+      std::string scratch;
+      std::optional<size_t> height;
+      if (auto hash = params.getString(0, scratch)) {
+        height = g_blockchain->getBlockHeight(std::string(*hash));
+      } else if (auto h = params.getInteger(0); h && *h >= 0) {
+        height = static_cast<size_t>(*h);
+      } else {
+        reply.error(JsonRpc::INVALID_PARAMS, "Usage: getblock hash|height");
+        return;
+      }
+      auto block = height ? g_blockchain->getBlock(*height) : std::nullopt;
+      if (!block) {
+        reply.error(-5, "Block not found");
+        return;
+      }
+      auto &w = reply.result();
+      w.beginObject()
+          .key("hash")
+          .string(block->hash)
+          .key("height")
+          .number(static_cast<uint64_t>(*height))
+          .key("version")
+          .number(block->version)
+          .key("merkleroot")
+          .string(block->merkleRoot)
+          .key("time")
+          .number(static_cast<int64_t>(block->timestamp))
+          .key("nonce")
+          .number(block->nonce)
+          .key("difficulty")
+          .number(block->difficulty)
+          .key("reward")
+          .number(block->reward)
+          .key("shardid")
+          .number(block->shardId)
+          .key("previousblockhash")
+          .string(block->prevHash)
+          .key("nTx")
+          .number(static_cast<uint64_t>(block->transactions.size()))
+          .key("tx")
+          .beginArray();
+      for (const auto &tx : block->transactions) {
+        w.string(tx.txId);
+      }
+      w.endArray().endObject();
+    });
+
+    d.add("getdifficulty",
+          [](const Params &, Reply &reply) { reply.result().number(4); });
+
+    d.add("getmininginfo", [](const Params &, Reply &reply) {
+      reply.result()
+          .beginObject()
+          .key("blocks")
+          .number(static_cast<uint64_t>(g_blockchain->getChainLength()))
+          .key("difficulty")
+          .number(4)
+          .key("networkhashps")
+          .number(150000000)
+          .key("pooledtx")
+          .number(0)
+          .key("chain")
+          .string("quantumpulse")
+          .endObject();
+    });
+
+    d.add("getpeerinfo", [](const Params &, Reply &reply) {
+      reply.result().beginArray().endArray();
+    });
+
+    d.add("getnetworkinfo", [](const Params &, Reply &reply) {
+      reply.result().raw(
+          R"({"version": 70000, "subversion": "/QuantumPulse:7.0.0/", )"
+          R"("protocolversion": 70001, "connections": 0, "networks": []})");
+    });
+
+    d.add("getnewaddress", [](const Params &, Reply &reply) {
       Crypto::CryptoManager cm;
-      auto keyPair = cm.generateKeyPair(0);
-      return R"({"result": ")" + keyPair.publicKey +
-             R"(", "error": null, "id": 1})";
-    }
+      reply.result().string(cm.generateKeyPair(0).publicKey);
+    });
 
-    if (method == "getprice") {
-      return R"({"result": {"price": 600000, "minimum": 600000, "currency": "USD"}, "error": null, "id": 1})";
-    }
+    d.add("getprice", [](const Params &, Reply &reply) {
+      reply.result().raw(
+          R"({"price": 600000, "minimum": 600000, "currency": "USD"})");
+    });
 
-    if (method == "stop") {
+    d.add("stop", [](const Params &, Reply &reply) {
       g_running = false;
-      return R"({"result": "QuantumPulse server stopping", "error": null, "id": 1})";
-    }
+      reply.result().string("QuantumPulse server stopping");
+    });
 
     // Bitcoin-like sendtoaddress - Transfer QP to any wallet
-    if (method == "sendtoaddress") {
-      try {
-        auto paramsStart = request.find("\"params\"");
-        if (paramsStart != std::string::npos) {
-          auto bracketStart = request.find("[", paramsStart);
-          auto bracketEnd = request.find("]", bracketStart);
-          if (bracketStart != std::string::npos &&
-              bracketEnd != std::string::npos) {
-            std::string paramsStr =
-                request.substr(bracketStart + 1, bracketEnd - bracketStart - 1);
-            auto firstQuote = paramsStr.find("\"");
-            auto secondQuote = paramsStr.find("\"", firstQuote + 1);
-            if (firstQuote == std::string::npos ||
-                secondQuote == std::string::npos) {
-              return R"({"result": null, "error": {"code": -1, "message": "Invalid parameters"}, "id": 1})";
-            }
-            std::string toAddress =
-                paramsStr.substr(firstQuote + 1, secondQuote - firstQuote - 1);
-
-            // Security: Validate address format (prevent injection)
-            if (toAddress.empty() || toAddress.length() > 128 ||
-                toAddress.find(';') != std::string::npos ||
-                toAddress.find('<') != std::string::npos ||
-                toAddress.find('>') != std::string::npos ||
-                toAddress.find("DROP") != std::string::npos ||
-                toAddress.find("SELECT") != std::string::npos) {
-              return R"({"result": null, "error": {"code": -5, "message": "Invalid address format"}, "id": 1})";
-            }
-
-            auto comma = paramsStr.find(",", secondQuote);
-            double amount = 0.0;
-            if (comma != std::string::npos) {
-              std::string amountStr = paramsStr.substr(comma + 1);
-              amountStr.erase(0, amountStr.find_first_not_of(" "));
-              size_t endPos = amountStr.find_first_not_of("0123456789.-");
-              if (endPos != std::string::npos) {
-                amountStr = amountStr.substr(0, endPos);
-              }
-              if (amountStr.empty()) {
-                return R"({"result": null, "error": {"code": -3, "message": "Invalid amount"}, "id": 1})";
-              }
-              amount = std::stod(amountStr);
-            }
-            // Security: Amount validation
-            if (amount <= 0 || amount > 5000000) {
-              return R"({"result": null, "error": {"code": -3, "message": "Invalid amount"}, "id": 1})";
-            }
-            Crypto::CryptoManager cm;
-            std::string txid =
-                cm.sha3_512_v11(toAddress + std::to_string(amount) +
-                                    std::to_string(std::time(nullptr)),
-                                0);
-            txid = txid.substr(0, 64);
-            double valueUSD = amount * 600000.0;
-            return R"({"result": {"txid": ")" + txid + R"(", "amount": )" +
-                   std::to_string(amount) + R"(, "to": ")" + toAddress +
-                   R"(", "fee": 0.0001, "value_usd": )" +
-                   std::to_string(valueUSD) +
-                   R"(, "min_price": 600000, "status": "sent"}, "error": null, "id": 1})";
-          }
-        }
-      } catch (const std::exception &e) {
-        return R"({"result": null, "error": {"code": -1, "message": "Parse error"}, "id": 1})";
+    d.add("sendtoaddress", [](const Params &params, Reply &reply) {
+      std::string scratch;
+      auto address = params.getString(0, scratch);
+      if (!address) {
+        reply.error(-1, "Usage: sendtoaddress address amount");
+        return;
+      }
+      std::string toAddress(*address);
+
+      // Security: Validate address format (prevent injection)
+      if (toAddress.empty() || toAddress.length() > 128 ||
+          toAddress.find(';') != std::string::npos ||
+          toAddress.find('<') != std::string::npos ||
+          toAddress.find('>') != std::string::npos ||
+          toAddress.find("DROP") != std::string::npos ||
+          toAddress.find("SELECT") != std::string::npos) {
+        reply.error(-5, "Invalid address format");
+        return;
       }
-      return R"({"result": null, "error": {"code": -1, "message": "Usage: sendtoaddress address amount"}, "id": 1})";
-    }
-
-    if (method == "listtransactions") {
-      return R"({"result": [], "error": null, "id": 1, "note": "Transaction history is private"})";
-    }
-
-    if (method == "getwalletinfo") {
-      return R"({"result": {"balance": "**PRIVATE**", "min_price_usd": 600000}, "error": null, "id": 1})";
-    }
-
-    if (method == "getpreminedinfo") {
-      return R"({"result": {"premined": 2000000, "min_price_usd": 600000, "note": "Founder wallet is private"}, "error": null, "id": 1})";
-    }
 
-    return R"({"result": null, "error": {"code": -32601, "message": "Method not found"}, "id": 1})";
+      // Security: Amount validation
+      auto amount = params.getNumber(1);
+      if (!amount || !(*amount > 0) || *amount > 5000000) {
+        reply.error(-3, "Invalid amount");
+        return;
+      }
+      Crypto::CryptoManager cm;
+      std::string txid =
+          cm.sha3_512_v11(toAddress + std::to_string(*amount) +
+                              std::to_string(std::time(nullptr)),
+                          0);
+      txid.resize(64);
+      reply.result()
+          .beginObject()
+          .key("txid")
+          .string(txid)
+          .key("amount")
+          .number(*amount)
+          .key("to")
+          .string(toAddress)
+          .key("fee")
+          .number(0.0001)
+          .key("value_usd")
+          .number(*amount * 600000.0)
+          .key("min_price")
+          .number(600000)
+          .key("status")
+          .string("sent")
+          .endObject();
+    });
+
+    // Transaction history is private
+    d.add("listtransactions", [](const Params &, Reply &reply) {
+      reply.result().beginArray().endArray();
+    });
+
+    d.add("getwalletinfo", [](const Params &, Reply &reply) {
+      reply.result().raw(
+          R"({"balance": "**PRIVATE**", "min_price_usd": 600000})");
+    });
+
+    d.add("getpreminedinfo", [](const Params &, Reply &reply) {
+      reply.result().raw(R"({"premined": 2000000, "min_price_usd": 600000, )"
+                         R"("note": "Founder wallet is private"})");
+    });
+
+    d.add("getsyncinfo", [](const Params &, Reply &reply) {
+      Network::SyncStats stats;
+      bool complete;
+      {
+        std::lock_guard<std::mutex> lock(g_syncMutex);
+        stats = g_syncStats;
+        complete = g_syncComplete;
+      }
+      auto &network = g_blockchain->getNetworkManager();
+      reply.result()
+          .beginObject()
+          .key("syncing")
+          .boolean(network.isSyncing())
+          .key("attempts")
+          .number(static_cast<uint64_t>(network.getSyncCount()))
+          .key("complete")
+          .boolean(complete)
+          .key("blocks")
+          .number(static_cast<uint64_t>(g_blockchain->getChainLength()))
+          .key("peers")
+          .number(static_cast<uint64_t>(stats.peers))
+          .key("headers")
+          .number(stats.headers)
+          .key("downloaded")
+          .number(stats.blocks)
+          .key("bytes")
+          .number(stats.bytesReceived)
+          .key("stalls")
+          .number(stats.stalls)
+          .key("rerequests")
+          .number(stats.rerequests)
+          .key("headerseconds")
+          .number(stats.headerSeconds)
+          .key("blockseconds")
+          .number(stats.blockSeconds)
+          .key("blockspersec")
+          .number(stats.blocksPerSecond())
+          .endObject();
+    });
   }
 };
 
@@ -295,7 +405,12 @@ public:
         int client_fd =
             accept(server_fd, (struct sockaddr *)&client_addr, &client_len);
         if (client_fd >= 0) {
-          std::thread(&P2PServer::handlePeer, this, client_fd).detach();
+          char ip[INET_ADDRSTRLEN] = "";
+          inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+          std::string peerKey = std::string(ip) + ":" +
+                                std::to_string(ntohs(client_addr.sin_port));
+          std::thread(&P2PServer::handlePeer, this, client_fd, peerKey)
+              .detach();
           peerCount_++;
         }
       }
@@ -310,34 +425,65 @@ private:
   int port_;
   std::atomic<int> peerCount_{0};
 
-  void handlePeer(int peer_fd) {
-    char buffer[65536];
-    while (g_running) {
-      int bytes = read(peer_fd, buffer, sizeof(buffer) - 1);
-      if (bytes <= 0)
-        break;
-
-      buffer[bytes] = '\0';
-      processMessage(peer_fd, buffer, bytes);
+  void handlePeer(int peer_fd, const std::string &peerKey) {
+    if (auto relay = g_network->attachPeer(peerKey, true)) {
+      Network::PeerService service(*g_blockchain, &g_txPool, g_network.get());
+      service.serve(peer_fd, g_running, {relay.get(), peerKey, false});
+      g_network->disconnectPeer(peerKey);
     }
     close(peer_fd);
     peerCount_--;
   }
+};
 
-  void processMessage(int peer_fd, const char *data, int len) {
-    if (len >= 4) {
-      std::string msgType(data, 4);
+// Keep an outbound connection to a -connect peer after the initial
+// download so new blocks and transactions relay both ways
+void relayWithPeer(const std::string &endpoint) {
+  int fd = Network::connectEndpoint(endpoint);
+  if (fd < 0) {
+    return;
+  }
+  if (auto relay = g_network->attachPeer(endpoint, false)) {
+    Network::PeerService service(*g_blockchain, &g_txPool, g_network.get());
+    service.serve(fd, g_running, {relay.get(), endpoint, true});
+    g_network->disconnectPeer(endpoint);
+  }
+  close(fd);
+}
 
-      if (msgType == "vers") {
-        const char *verack = "vack";
-        write(peer_fd, verack, 4);
-      } else if (msgType == "ping") {
-        const char *pong = "pong";
-        write(peer_fd, pong, 4);
+// Extend the local chain with freshly mined blocks carrying signed
+// transfers, giving other nodes something to download (-regtestblocks)
+void mineRegtestBlocks(size_t count, size_t txsPerBlock) {
+  auto &crypto = g_blockchain->getCryptoManager();
+  auto keyPair = crypto.generateKeyPair(0);
+  const std::string sender = "regtest_miner";
+  uint64_t serial = 0;
+
+  for (size_t b = 0; b < count; ++b) {
+    std::vector<Blockchain::Transaction> txs;
+    txs.reserve(txsPerBlock);
+    while (txs.size() < txsPerBlock) {
+      Blockchain::Transaction tx(
+          sender, "regtest_" + std::to_string(serial++), 1.0, 0.001, keyPair,
+          0, crypto, g_blockchain->getAIManager(),
+          g_blockchain->getShardingManager());
+      if (tx.signature.empty()) {
+        // Signing is rate limited; back off and retry
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        continue;
       }
+      txs.push_back(std::move(tx));
+    }
+
+    auto tip = g_blockchain->getBlockHash(g_blockchain->getChainLength() - 1);
+    Blockchain::Block block(*tip, std::move(txs), 2, 50.0, 0, crypto);
+    if (!block.mine(g_blockchain->getMiningManager(), crypto) ||
+        !g_blockchain->addBlock(block)) {
+      Logging::Logger::getInstance().error("Regtest block rejected", "Main", 0);
+      return;
     }
   }
-};
+}
 
 // Print banner
 void printBanner() {
@@ -373,6 +519,13 @@ void printHelp() {
   std::cout << "  -port=<port>     P2P port (default: 8333)\n";
   std::cout << "  -datadir=<dir>   Data directory\n";
   std::cout << "  -testnet         Use testnet\n";
+  std::cout << "  -connect=<ip:port>[,...]\n";
+  std::cout << "                   Download the chain from these peers\n";
+  std::cout << "  -regtestblocks=<n>\n";
+  std::cout << "                   Mine n local blocks at startup\n";
+  std::cout << "  -regtesttxs=<n>  Transfers per regtest block (default: 4)\n";
+  std::cout << "  -trace=<file>    Record trace spans; write a Chrome trace\n";
+  std::cout << "                   to <file> on shutdown\n";
   std::cout << "  -printtoconsole  Print to console\n";
   std::cout << "  -help            Show this help\n";
   std::cout << "\nQuantumPulse Core Daemon v7.0.0\n";
@@ -381,6 +534,10 @@ void printHelp() {
 int main(int argc, char *argv[]) {
   bool daemon = false;
   std::string dataDir = "./data";
+  std::vector<std::string> connectPeers;
+  size_t regtestBlocks = 0;
+  size_t regtestTxs = 4;
+  std::string traceFile;
 
   for (int i = 1; i < argc; i++) {
     std::string arg = argv[i];
@@ -395,6 +552,21 @@ int main(int argc, char *argv[]) {
       g_p2pPort = std::stoi(arg.substr(6));
     } else if (arg.find("-datadir=") == 0) {
       dataDir = arg.substr(9);
+    } else if (arg.find("-connect=") == 0) {
+      std::string list = arg.substr(9);
+      for (size_t pos = 0; pos <= list.size();) {
+        size_t comma = std::min(list.find(',', pos), list.size());
+        if (comma > pos) {
+          connectPeers.push_back(list.substr(pos, comma - pos));
+        }
+        pos = comma + 1;
+      }
+    } else if (arg.find("-regtestblocks=") == 0) {
+      regtestBlocks = std::stoul(arg.substr(15));
+    } else if (arg.find("-regtesttxs=") == 0) {
+      regtestTxs = std::stoul(arg.substr(12));
+    } else if (arg.find("-trace=") == 0) {
+      traceFile = arg.substr(7);
     }
   }
 
@@ -408,8 +580,20 @@ int main(int argc, char *argv[]) {
   Logging::Logger::getInstance().info("QuantumPulse Core starting...", "Main",
                                       0);
 
+  // Every trace site feeds quantumpulse_span_duration_seconds
+  g_metrics = std::make_unique<Metrics::PrometheusExporter>();
+  Trace::Tracer::getInstance().attachMetrics(*g_metrics);
+  if (!traceFile.empty()) {
+    Trace::Tracer::getInstance().setRecording(true);
+  }
+
   std::cout << "[quantumpulsed] Initializing blockchain..." << std::endl;
   g_blockchain = std::make_unique<Blockchain::Blockchain>();
+  if (regtestBlocks > 0) {
+    std::cout << "[quantumpulsed] Mining " << regtestBlocks
+              << " regtest blocks..." << std::endl;
+    mineRegtestBlocks(regtestBlocks, regtestTxs);
+  }
   std::cout << "[quantumpulsed] Blockchain loaded. Height: "
             << g_blockchain->getChainLength() << std::endl;
 
@@ -420,6 +604,7 @@ int main(int argc, char *argv[]) {
 
   std::cout << "[quantumpulsed] Starting P2P server on port " << g_p2pPort
             << "..." << std::endl;
+  g_network = std::make_unique<P2P::NetworkManager>(g_p2pPort);
   P2PServer p2pServer(g_p2pPort);
   std::thread p2pThread([&p2pServer]() { p2pServer.start(); });
 
@@ -428,6 +613,31 @@ int main(int argc, char *argv[]) {
   RPCServer rpcServer(g_rpcPort);
   std::thread rpcThread([&rpcServer]() { rpcServer.start(); });
 
+  std::thread syncThread;
+  if (!connectPeers.empty()) {
+    auto &network = g_blockchain->getNetworkManager();
+    for (const auto &peer : connectPeers) {
+      (void)network.addPeer(peer);
+    }
+    network.setSyncHandler([](const std::vector<std::string> &peers, int) {
+      Network::HeadersFirstSync sync(*g_blockchain);
+      bool ok = sync.run(peers);
+      std::lock_guard<std::mutex> lock(g_syncMutex);
+      g_syncStats = sync.getStats();
+      g_syncComplete = ok;
+    });
+    syncThread = std::thread([&network, &connectPeers] {
+      network.syncChain(0);
+      std::vector<std::thread> relays;
+      for (const auto &peer : connectPeers) {
+        relays.emplace_back(relayWithPeer, peer);
+      }
+      for (auto &relay : relays) {
+        relay.join();
+      }
+    });
+  }
+
   std::cout << "\n[quantumpulsed] QuantumPulse Core is running!" << std::endl;
   std::cout
       << "[quantumpulsed] Use 'quantumpulse-cli' to interact with the node."
@@ -439,11 +649,20 @@ int main(int argc, char *argv[]) {
   }
 
   std::cout << "[quantumpulsed] Waiting for threads to finish..." << std::endl;
+  if (syncThread.joinable())
+    syncThread.join();
   if (p2pThread.joinable())
     p2pThread.join();
   if (rpcThread.joinable())
     rpcThread.join();
 
+  if (!traceFile.empty()) {
+    bool written = Trace::Tracer::getInstance().writeChromeTrace(traceFile);
+    std::cout << "[quantumpulsed] "
+              << (written ? "Trace written to " : "Could not write trace to ")
+              << traceFile << std::endl;
+  }
+
   std::cout << "[quantumpulsed] Shutdown complete." << std::endl;
   return 0;
 }
@@ -4,12 +4,35 @@
  * Simple test framework without external dependencies (like gtest)
  */
 
+#include "quantumpulse_api_v7.h"
 #include "quantumpulse_blockchain_v7.h"
+#include "quantumpulse_http_v7.h"
+#include "quantumpulse_jsonrpc_v7.h"
+#include "quantumpulse_logging_v7.h"
+#include "quantumpulse_mempool_v7.h"
+#include "quantumpulse_merkle_v7.h"
+#include "quantumpulse_metrics_v7.h"
+#include "quantumpulse_orderbook_v7.h"
+#include "quantumpulse_p2p_protocol_v7.h"
+#include "quantumpulse_pow_v7.h"
+#include "quantumpulse_sync_v7.h"
+#include "quantumpulse_trace_v7.h"
+#include "quantumpulse_utxo_store_v7.h"
+#include "quantumpulse_websocket_v7.h"
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define TEST(name) void test_##name()
 #define RUN_TEST(name)                                                         \
@@ -114,6 +137,2096 @@ TEST(CryptoHashing) {
   EXPECT_FALSE(hash1.empty());
 }
 
+// Test: Lock-free hashing path matches the managed hash and is thread-safe
+TEST(LockFreeHashing) {
+  QuantumPulse::Crypto::CryptoManager crypto;
+  namespace Hashing = QuantumPulse::Crypto::Hashing;
+
+  QuantumPulse::Crypto::Digest512 digest;
+  EXPECT_TRUE(Hashing::sha512("test_data", digest));
+  EXPECT_EQ(crypto.sha3_512_v11("test_data", 3),
+            Hashing::toHex(digest) + "_v11_3");
+
+  // SHA-512("abc") known-answer prefix
+  EXPECT_TRUE(Hashing::sha512("abc", digest));
+  EXPECT_EQ(Hashing::toHex(digest).substr(0, 16), "ddaf35a193617aba");
+
+  std::atomic<int> mismatches{0};
+  std::vector<std::thread> threads;
+  const std::string expected = crypto.sha3_512_v11("shared_input", 0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 500; ++i) {
+        if (crypto.sha3_512_v11("shared_input", 0) != expected) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  EXPECT_EQ(mismatches.load(), 0);
+}
+
+// Test: Midstate PoW hashing matches a full double SHA-512 of the header
+TEST(PowMidstateEngine) {
+  namespace Mining = QuantumPulse::Mining;
+  namespace Hashing = QuantumPulse::Crypto::Hashing;
+
+  Mining::PowHeader header;
+  header.difficulty = 3;
+  header.timestamp = 1700000000;
+  header.setMiner("pow_test_miner");
+  EXPECT_TRUE(Hashing::sha512("merkle", header.merkleRoot));
+
+  Mining::PowMidstate midstate(header);
+  for (uint64_t nonce : {0ULL, 1ULL, 0xFFFFFFFFFFULL}) {
+    header.nonce = nonce;
+    unsigned char bytes[Mining::PowHeader::SIZE];
+    header.serialize(bytes);
+
+    QuantumPulse::Crypto::Digest512 inner, expected, actual;
+    EXPECT_TRUE(Hashing::sha512(
+        std::string_view(reinterpret_cast<char *>(bytes), sizeof(bytes)),
+        inner));
+    EXPECT_TRUE(Hashing::sha512(
+        std::string_view(reinterpret_cast<char *>(inner.data()), inner.size()),
+        expected));
+    midstate.hash(nonce, actual);
+    EXPECT_TRUE(actual == expected);
+  }
+
+  QuantumPulse::Crypto::Digest512 digest{};
+  digest[0] = 0x00;
+  digest[1] = 0x0F;
+  EXPECT_TRUE(Mining::meetsTarget(digest, 3));
+  EXPECT_FALSE(Mining::meetsTarget(digest, 4));
+
+  Mining::PowEngine engine(2);
+  std::atomic<bool> running{true};
+  auto result = engine.search(header, 0, 1 << 20, running);
+  EXPECT_TRUE(result.has_value());
+  QuantumPulse::Crypto::Digest512 check;
+  midstate.hash(result->nonce, check);
+  EXPECT_TRUE(check == result->hash);
+  EXPECT_TRUE(Mining::meetsTarget(check, 3));
+  EXPECT_GT(engine.getTotalHashes(), 0ULL);
+}
+
+// Test: Every available multi-buffer kernel matches OpenSSL SHA-512
+TEST(BatchSha512Kernels) {
+  namespace Sha512 = QuantumPulse::Crypto::Sha512;
+  namespace Hashing = QuantumPulse::Crypto::Hashing;
+
+  // Mixed lengths around the one/two padding-block boundaries
+  std::vector<std::string> inputs;
+  for (size_t len : {0, 1, 63, 111, 112, 127, 128, 129, 184, 255, 300, 1000}) {
+    inputs.emplace_back(len, static_cast<char>('a' + len % 26));
+  }
+  std::vector<std::string_view> views(inputs.begin(), inputs.end());
+
+  std::vector<QuantumPulse::Crypto::Digest512> expected(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    EXPECT_TRUE(Hashing::sha512(views[i], expected[i]));
+  }
+
+  for (auto kernel :
+       {Sha512::BatchKernel::Scalar, Sha512::BatchKernel::AVX2,
+        Sha512::BatchKernel::AVX512}) {
+    if (!Sha512::batchKernelSupported(kernel)) {
+      continue;
+    }
+    std::vector<QuantumPulse::Crypto::Digest512> out(inputs.size());
+    Sha512::hashBatch(views.data(), views.size(), out.data(), kernel);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      EXPECT_TRUE(out[i] == expected[i]);
+    }
+  }
+
+  QuantumPulse::Crypto::CryptoManager crypto;
+  std::vector<std::string> batchInputs = {"tx_a", "tx_b", "", "tx_d", "tx_e"};
+  auto hashes = crypto.sha3_512_v11_batch(batchInputs, 2);
+  for (size_t i = 0; i < batchInputs.size(); ++i) {
+    EXPECT_EQ(hashes[i], crypto.sha3_512_v11(batchInputs[i], 2));
+  }
+}
+
+// Test: Binary merkle engine - parallel build, cached proofs
+TEST(MerkleEngine) {
+  namespace Merkle = QuantumPulse::Merkle;
+  namespace Sha512 = QuantumPulse::Crypto::Sha512;
+
+  std::vector<std::string> txids;
+  for (int i = 0; i < 2001; ++i) {
+    txids.push_back("tx_" + std::to_string(i));
+  }
+
+  QuantumPulse::Concurrency::ThreadPool pool(3);
+  Merkle::MerkleEngine parallel(&pool);
+  Merkle::MerkleEngine serial;
+  parallel.buildFromTxids(txids);
+  serial.buildFromTxids(txids);
+  EXPECT_TRUE(parallel.root() == serial.root());
+  EXPECT_EQ(parallel.leafCount(), txids.size());
+
+  // Reference: naive level-by-level build on copies
+  std::vector<Merkle::MerkleEngine::Node> level(txids.size());
+  for (size_t i = 0; i < txids.size(); ++i) {
+    Sha512::hash(txids[i].data(), txids[i].size(), level[i].data());
+  }
+  while (level.size() > 1) {
+    std::vector<Merkle::MerkleEngine::Node> next((level.size() + 1) / 2);
+    for (size_t i = 0; i < next.size(); ++i) {
+      unsigned char pair[128];
+      const auto &right = (2 * i + 1 < level.size()) ? level[2 * i + 1]
+                                                       : level[2 * i];
+      std::memcpy(pair, level[2 * i].data(), 64);
+      std::memcpy(pair + 64, right.data(), 64);
+      Sha512::hash(pair, sizeof(pair), next[i].data());
+    }
+    level = std::move(next);
+  }
+  EXPECT_TRUE(parallel.root() == level[0]);
+
+  for (size_t index : {0, 1, 999, 2000}) {
+    auto proof = parallel.getProof(index);
+    EXPECT_EQ(proof.size(), parallel.levelCount() - 1);
+    EXPECT_TRUE(Merkle::MerkleEngine::verifyProof(parallel.leaf(index), proof,
+                                                  parallel.root()));
+  }
+  auto bad = parallel.getProof(5);
+  EXPECT_FALSE(Merkle::MerkleEngine::verifyProof(parallel.leaf(6), bad,
+                                                 parallel.root()));
+
+  // Legacy string tree: cached levels still produce valid proofs
+  Merkle::MerkleTree tree;
+  std::vector<std::string> small(txids.begin(), txids.begin() + 7);
+  std::string root = tree.buildTree(small);
+  for (size_t i = 0; i < small.size(); ++i) {
+    EXPECT_TRUE(tree.verifyProof(small[i], tree.getProof(small, i), root));
+  }
+}
+
+// Test: Incremental merkle root matches a full rebuild after every edit
+TEST(IncrementalMerkle) {
+  namespace Merkle = QuantumPulse::Merkle;
+  using Node = Merkle::MerkleEngine::Node;
+
+  auto leafFor = [](int i) {
+    Node n;
+    std::string s = "leaf_" + std::to_string(i);
+    QuantumPulse::Crypto::Sha512::hash(s.data(), s.size(), n.data());
+    return n;
+  };
+
+  Merkle::IncrementalMerkleTree inc;
+  std::vector<Node> leaves;
+  auto matches = [&] {
+    Merkle::MerkleEngine full;
+    full.build(leaves);
+    return inc.root() == full.root();
+  };
+
+  EXPECT_TRUE(inc.root() == Node{});
+  for (int i = 0; i < 37; ++i) {
+    leaves.push_back(leafFor(i));
+    inc.append(leaves.back());
+    EXPECT_TRUE(matches());
+  }
+  for (int i : {0, 17, 36}) {
+    leaves[i] = leafFor(1000 + i);
+    EXPECT_TRUE(inc.replaceAt(i, leaves[i]));
+    EXPECT_TRUE(matches());
+  }
+  EXPECT_FALSE(inc.replaceAt(37, leafFor(0)));
+  while (leaves.size() > 1) {
+    leaves.pop_back();
+    EXPECT_TRUE(inc.removeTail());
+    EXPECT_TRUE(matches());
+  }
+  EXPECT_TRUE(inc.root() == leaves[0]);
+
+  // Template root only rehashes what changed
+  QuantumPulse::Mempool::TemplateMerkleRoot tmpl;
+  std::vector<QuantumPulse::UTXO::Transaction> txs(10);
+  for (size_t i = 0; i < txs.size(); ++i) {
+    txs[i].txid = "tmpl_tx_" + std::to_string(i);
+  }
+  EXPECT_EQ(tmpl.update(txs), 10u);
+  txs[4].txid = "tmpl_tx_new";
+  txs.pop_back();
+  EXPECT_EQ(tmpl.update(txs), 1u);
+
+  Merkle::MerkleEngine full;
+  std::vector<std::string> ids;
+  for (const auto &tx : txs) {
+    ids.push_back(tx.txid);
+  }
+  full.buildFromTxids(ids);
+  EXPECT_TRUE(tmpl.root() == full.root());
+}
+
+// Loopback HTTP client helpers shared by the server tests
+static int connectLoopback(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  timeval tv{5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+static void sendAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, 0);
+    if (n <= 0)
+      return;
+    sent += static_cast<size_t>(n);
+  }
+}
+
+// Read until `count` complete responses (or EOF) have arrived
+static std::string readResponses(int fd, size_t count) {
+  std::string in;
+  char buf[4096];
+  auto complete = [&] {
+    size_t seen = 0, pos = 0;
+    while (seen < count) {
+      size_t end = in.find("\r\n\r\n", pos);
+      if (end == std::string::npos)
+        return false;
+      size_t len = in.find("Content-Length: ", pos);
+      size_t body = len < end ? std::strtoul(&in[len + 16], nullptr, 10) : 0;
+      pos = end + 4 + body;
+      if (pos > in.size())
+        return false;
+      ++seen;
+    }
+    return true;
+  };
+  while (!complete()) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0)
+      break;
+    in.append(buf, static_cast<size_t>(n));
+  }
+  return in;
+}
+
+// Test: Indexed mempool - fee ordering, eviction and expiry
+TEST(IndexedMempool) {
+  namespace Mempool = QuantumPulse::Mempool;
+
+  auto makeTx = [](const std::string &id, double fee, int size) {
+    QuantumPulse::UTXO::Transaction tx{};
+    tx.txid = id;
+    tx.fee = fee;
+    tx.size = size;
+    tx.vsize = size;
+    tx.weight = size * 4;
+    return tx;
+  };
+
+  Mempool::TransactionMempool pool(1000);
+  EXPECT_TRUE(pool.addTransaction(makeTx("low", 1.0, 200)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("high", 50.0, 200)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("mid", 10.0, 200)));
+  EXPECT_FALSE(pool.addTransaction(makeTx("mid", 10.0, 200)));
+  EXPECT_EQ(pool.getBytes(), 600u);
+
+  auto tmpl = pool.getBlockTemplate();
+  EXPECT_EQ(tmpl.size(), 3u);
+  EXPECT_EQ(tmpl[0].txid, "high");
+  EXPECT_EQ(tmpl[1].txid, "mid");
+  EXPECT_EQ(tmpl[2].txid, "low");
+
+  // Weight limit keeps only what fits, best first
+  auto small = pool.getBlockTemplate(1600);
+  EXPECT_EQ(small.size(), 2u);
+
+  // Full pool: cheaper tx rejected, richer tx evicts the lowest fee rate
+  EXPECT_TRUE(pool.addTransaction(makeTx("fill", 20.0, 400)));
+  EXPECT_FALSE(pool.addTransaction(makeTx("cheap", 0.5, 200)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("rich", 100.0, 200)));
+  EXPECT_FALSE(pool.hasTransaction("low"));
+  EXPECT_TRUE(pool.hasTransaction("rich"));
+  EXPECT_LT(pool.getBytes(), 1001u);
+
+  EXPECT_TRUE(pool.removeTransaction("rich"));
+  EXPECT_FALSE(pool.removeTransaction("rich"));
+  EXPECT_EQ(pool.getSize(), 3u);
+
+  EXPECT_EQ(pool.expireOlderThan(std::time(nullptr) + 10), 3u);
+  EXPECT_EQ(pool.getSize(), 0u);
+  EXPECT_EQ(pool.getBytes(), 0u);
+}
+
+TEST(MempoolPackages) {
+  namespace Mempool = QuantumPulse::Mempool;
+
+  auto makeTx = [](const std::string &id, double fee, int size,
+                   std::vector<std::string> parents = {}) {
+    QuantumPulse::UTXO::Transaction tx{};
+    tx.txid = id;
+    tx.fee = fee;
+    tx.size = size;
+    tx.vsize = size;
+    tx.weight = size * 4;
+    for (const auto &p : parents) {
+      QuantumPulse::UTXO::TxInput in{};
+      in.txid = p;
+      tx.vin.push_back(in);
+    }
+    return tx;
+  };
+
+  Mempool::TransactionMempool pool(2000);
+  EXPECT_TRUE(pool.addTransaction(makeTx("parent", 1.0, 200)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("mid", 20.0, 200)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("child", 60.0, 200, {"parent"})));
+  EXPECT_TRUE(pool.addTransaction(
+      makeTx("grandchild", 1.0, 200, {"child", "parent"})));
+
+  auto parent = pool.getEntry("parent");
+  EXPECT_TRUE(parent.has_value());
+  EXPECT_EQ(parent->descendantCount, 3);
+  EXPECT_EQ(parent->descendantVsize, 600);
+  auto grandchild = pool.getEntry("grandchild");
+  EXPECT_EQ(grandchild->ancestorCount, 3);
+  EXPECT_TRUE(std::abs(grandchild->ancestorFees - 62.0) < 1e-9);
+
+  // Child pays for its parent: the package outranks "mid", and parents
+  // always precede their children
+  auto tmpl = pool.getBlockTemplate();
+  EXPECT_EQ(tmpl.size(), 4u);
+  EXPECT_EQ(tmpl[0].txid, "parent");
+  EXPECT_EQ(tmpl[1].txid, "child");
+  EXPECT_EQ(tmpl[2].txid, "mid");
+  EXPECT_EQ(tmpl[3].txid, "grandchild");
+
+  // Package that does not fit is skipped whole
+  auto small = pool.getBlockTemplate(800);
+  EXPECT_EQ(small.size(), 1u);
+  EXPECT_EQ(small[0].txid, "mid");
+
+  // Removing a middle entry updates totals on both sides
+  EXPECT_TRUE(pool.removeTransaction("child"));
+  parent = pool.getEntry("parent");
+  EXPECT_EQ(parent->descendantCount, 2);
+  grandchild = pool.getEntry("grandchild");
+  EXPECT_EQ(grandchild->ancestorCount, 2);
+  EXPECT_TRUE(std::abs(grandchild->ancestorFees - 2.0) < 1e-9);
+
+  // Evicting or expiring a parent never leaves its children behind; "c2"
+  // lifts its parent's descendant score, so "p2" goes first and takes "c2"
+  EXPECT_EQ(pool.removeWithDescendants("parent"), 2u);
+  EXPECT_FALSE(pool.hasTransaction("grandchild"));
+  EXPECT_TRUE(pool.addTransaction(makeTx("p2", 0.1, 600)));
+  EXPECT_TRUE(pool.addTransaction(makeTx("c2", 0.5, 600, {"p2"})));
+  EXPECT_TRUE(pool.addTransaction(makeTx("big", 90.0, 1000)));
+  EXPECT_FALSE(pool.hasTransaction("p2"));
+  EXPECT_FALSE(pool.hasTransaction("c2"));
+  EXPECT_EQ(pool.getSize(), 2u);
+
+  // Removing the middle of a chain a -> b -> c disconnects a from c
+  Mempool::TransactionMempool chain(2000);
+  EXPECT_TRUE(chain.addTransaction(makeTx("a", 1.0, 100)));
+  EXPECT_TRUE(chain.addTransaction(makeTx("b", 2.0, 100, {"a"})));
+  EXPECT_TRUE(chain.addTransaction(makeTx("c", 4.0, 100, {"b"})));
+  EXPECT_TRUE(chain.removeTransaction("b"));
+  auto a = chain.getEntry("a");
+  EXPECT_EQ(a->descendantCount, 1);
+  EXPECT_EQ(a->descendantVsize, 100);
+  EXPECT_TRUE(std::abs(a->descendantFees - 1.0) < 1e-9);
+  auto c = chain.getEntry("c");
+  EXPECT_EQ(c->ancestorCount, 1);
+  EXPECT_EQ(c->ancestorWeight, 400);
+  EXPECT_TRUE(std::abs(c->ancestorFees - 4.0) < 1e-9);
+
+  // A child that arrives before its parent is linked once the parent does
+  EXPECT_TRUE(chain.addTransaction(makeTx("late", 50.0, 100, {"early"})));
+  EXPECT_TRUE(chain.addTransaction(makeTx("early", 1.0, 100, {"c"})));
+  auto early = chain.getEntry("early");
+  EXPECT_EQ(early->ancestorCount, 2);
+  EXPECT_EQ(early->descendantCount, 2);
+  auto late = chain.getEntry("late");
+  EXPECT_EQ(late->ancestorCount, 3);
+  EXPECT_TRUE(std::abs(late->ancestorFees - 55.0) < 1e-9);
+  EXPECT_EQ(chain.getEntry("c")->descendantCount, 3);
+  auto ordered = chain.getBlockTemplate();
+  EXPECT_EQ(ordered.size(), 4u);
+  EXPECT_EQ(ordered[0].txid, "c");
+  EXPECT_EQ(ordered[1].txid, "early");
+  EXPECT_EQ(ordered[2].txid, "late");
+  EXPECT_EQ(ordered[3].txid, "a");
+}
+
+TEST(ShardedUTXOSet) {
+  namespace UTXO = QuantumPulse::UTXO;
+
+  auto makeUtxo = [](const std::string &txid, int vout,
+                     const std::string &address, double amount) {
+    UTXO::UTXOutput u{};
+    u.txid = txid;
+    u.vout = vout;
+    u.address = address;
+    u.amount = amount;
+    return u;
+  };
+
+  // Hex txids decode to the same key regardless of case
+  std::string hexId(128, 'a');
+  std::string upperId(128, 'A');
+  EXPECT_TRUE(UTXO::OutPoint::from(hexId, 1) ==
+              UTXO::OutPoint::from(upperId, 1));
+  EXPECT_FALSE(UTXO::OutPoint::from(hexId, 1) ==
+               UTXO::OutPoint::from(hexId, 2));
+  EXPECT_FALSE(UTXO::OutPoint::from("tx_a", 0) ==
+               UTXO::OutPoint::from("tx_b", 0));
+
+  UTXO::UTXOSet set(8);
+  EXPECT_EQ(set.getShardCount(), 8u);
+  EXPECT_EQ(set.getUTXOCount(), 1u); // Genesis
+  EXPECT_TRUE(std::abs(set.getBalance("FOUNDER_WALLET") - 2000000.0) < 1e-6);
+
+  set.addUTXO(makeUtxo(hexId, 0, "alice", 5.0));
+  set.addUTXO(makeUtxo("tx_a", 0, "alice", 7.0));
+  set.addUTXO(makeUtxo("tx_a", 1, "bob", 3.0));
+  EXPECT_EQ(set.getUTXOCount(), 4u);
+  EXPECT_TRUE(std::abs(set.getBalance("alice") - 12.0) < 1e-9);
+  EXPECT_EQ(set.getAddressUTXOs("alice").size(), 2u);
+  EXPECT_EQ(set.getUTXO("tx_a", 1)->address, "bob");
+
+  // Re-adding an outpoint moves it between addresses
+  set.addUTXO(makeUtxo("tx_a", 1, "carol", 3.0));
+  EXPECT_EQ(set.getUTXOCount(), 4u);
+  EXPECT_TRUE(set.getBalance("bob") == 0.0);
+  EXPECT_TRUE(std::abs(set.getBalance("carol") - 3.0) < 1e-9);
+
+  UTXO::Transaction tx{};
+  tx.vin.push_back({hexId, 0, "", "", 0});
+  tx.vin.push_back({"tx_a", 0, "", "", 0});
+  tx.vout.push_back({11.0, "", "bob"});
+  EXPECT_TRUE(set.validateInputs(tx));
+  tx.vout[0].amount = 13.0;
+  EXPECT_FALSE(set.validateInputs(tx));
+
+  EXPECT_TRUE(set.spendUTXO(hexId, 0));
+  EXPECT_FALSE(set.spendUTXO(hexId, 0));
+  EXPECT_FALSE(set.validateInputs(tx));
+  EXPECT_TRUE(std::abs(set.getBalance("alice") - 7.0) < 1e-9);
+
+  // Concurrent writers on disjoint outpoints, readers throughout
+  constexpr int THREADS = 4, PER_THREAD = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      const std::string addr = 'w' + std::to_string(t);
+      const std::string txid = 'c' + std::to_string(t);
+      for (int i = 0; i < PER_THREAD; ++i) {
+        set.addUTXO(makeUtxo(txid, i, addr, 1.0));
+        [[maybe_unused]] double b = set.getBalance("alice");
+      }
+      for (int i = 0; i < PER_THREAD; i += 2) {
+        set.spendUTXO(txid, i);
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  EXPECT_EQ(set.getUTXOCount(), 3u + THREADS * PER_THREAD / 2);
+  for (int t = 0; t < THREADS; ++t) {
+    EXPECT_TRUE(std::abs(set.getBalance("w" + std::to_string(t)) -
+                         PER_THREAD / 2) < 1e-9);
+  }
+}
+
+TEST(UTXODiskCache) {
+  namespace UTXO = QuantumPulse::UTXO;
+
+  auto makeUtxo = [](const std::string &txid, int vout, double amount) {
+    UTXO::UTXOutput u{};
+    u.txid = txid;
+    u.vout = vout;
+    u.address = "addr_" + txid;
+    u.amount = amount;
+    u.scriptPubKey = "OP_TRUE";
+    u.blockHeight = 7;
+    return u;
+  };
+
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "qp_test_utxo_store.dat")
+          .string();
+  std::remove(path.c_str());
+
+  {
+    UTXO::UTXODiskStore store(path, false);
+    EXPECT_TRUE(store.isOpen());
+
+    UTXO::UTXOCacheConfig config;
+    config.flushIntervalBlocks = 2;
+    UTXO::UTXOCache cache(store, config);
+
+    cache.addUTXO(makeUtxo("a", 0, 1.5));
+    cache.addUTXO(makeUtxo("b", 0, 2.5));
+    cache.addUTXO(makeUtxo("temp", 0, 9.0));
+    EXPECT_EQ(cache.getDirtyCount(), 3u);
+
+    // Created and spent before a flush: never written
+    EXPECT_TRUE(cache.spendUTXO("temp", 0));
+    EXPECT_FALSE(cache.spendUTXO("temp", 0));
+    EXPECT_FALSE(cache.onBlockConnected());
+    EXPECT_EQ(store.size(), 0u);
+    EXPECT_TRUE(cache.onBlockConnected());
+    EXPECT_EQ(store.size(), 2u);
+    EXPECT_EQ(cache.getDirtyCount(), 0u);
+
+    // Spending a flushed coin leaves a tombstone until the next flush
+    EXPECT_TRUE(cache.spendUTXO("a", 0));
+    EXPECT_FALSE(cache.getUTXO("a", 0).has_value());
+    EXPECT_TRUE(store.get(UTXO::OutPoint::from("a", 0)).has_value());
+    EXPECT_TRUE(cache.flush());
+    EXPECT_FALSE(store.get(UTXO::OutPoint::from("a", 0)).has_value());
+  }
+
+  // Reopen: state survives; a torn tail batch is discarded
+  {
+    FILE *f = std::fopen(path.c_str(), "ab");
+    std::fputs("garbage", f);
+    std::fclose(f);
+
+    UTXO::UTXODiskStore store(path, false);
+    EXPECT_TRUE(store.isOpen());
+    EXPECT_EQ(store.size(), 1u);
+    auto b = store.get(UTXO::OutPoint::from("b", 0));
+    EXPECT_TRUE(b.has_value());
+    EXPECT_EQ(b->address, "addr_b");
+    EXPECT_EQ(b->blockHeight, 7);
+    EXPECT_TRUE(std::abs(b->amount - 2.5) < 1e-12);
+
+    // Tight ceiling: reads miss once, then hit until evicted
+    UTXO::UTXOCacheConfig config;
+    config.maxMemoryBytes = 1;
+    UTXO::UTXOCache cache(store, config);
+    EXPECT_TRUE(cache.getUTXO("b", 0).has_value());
+    EXPECT_EQ(cache.getCacheSize(), 0u);
+    for (int i = 0; i < 50; ++i) {
+      cache.addUTXO(makeUtxo("n" + std::to_string(i), 0, 1.0));
+    }
+    EXPECT_TRUE(cache.flush());
+    EXPECT_EQ(cache.getCacheSize(), 0u);
+    EXPECT_EQ(store.size(), 51u);
+
+    UTXO::UTXOCache roomy(store);
+    EXPECT_TRUE(roomy.getUTXO("n3", 0).has_value());
+    EXPECT_TRUE(roomy.getUTXO("n3", 0).has_value());
+    EXPECT_FALSE(roomy.getUTXO("missing", 0).has_value());
+    auto stats = roomy.getStats();
+    EXPECT_EQ(stats["hits"], 1.0);
+    EXPECT_EQ(stats["misses"], 2.0);
+
+    for (int i = 0; i < 50; i += 2) {
+      EXPECT_TRUE(roomy.spendUTXO("n" + std::to_string(i), 0));
+    }
+    EXPECT_TRUE(roomy.flush());
+    uint64_t before = store.getFileBytes();
+    EXPECT_TRUE(store.compact());
+    EXPECT_LT(store.getFileBytes(), before);
+    EXPECT_EQ(store.getDeadBytes(), 0u);
+    EXPECT_EQ(store.size(), 26u);
+  }
+
+  UTXO::UTXODiskStore reopened(path, false);
+  EXPECT_EQ(reopened.size(), 26u);
+  EXPECT_TRUE(reopened.get(UTXO::OutPoint::from("n49", 0)).has_value());
+  EXPECT_FALSE(reopened.get(UTXO::OutPoint::from("n48", 0)).has_value());
+  std::remove(path.c_str());
+}
+
+TEST(ParallelChainValidation) {
+  namespace BC = QuantumPulse::Blockchain;
+  QuantumPulse::Crypto::CryptoManager crypto;
+  QuantumPulse::Concurrency::ThreadPool pool(4);
+
+  auto makeTx = [](const std::string &id) {
+    BC::Transaction tx;
+    tx.sender = "alice";
+    tx.receiver = "bob";
+    tx.txId = id;
+    tx.signature = "signed_v11_" + id;
+    tx.zkProof = "zk_proof_v11_" + id;
+    tx.multiSignatures.assign(10, "sig_ok");
+    tx.expiresAt = time(nullptr) + 3600;
+    return tx;
+  };
+
+  std::vector<BC::Block> chain(1);
+  chain[0].prevHash = "genesis_0";
+  chain[0].hash = "genesis_hash";
+  for (int i = 1; i <= 200; ++i) {
+    BC::Block block;
+    block.prevHash = chain.back().hash;
+    block.hash = "00" + std::to_string(i);
+    block.difficulty = 2;
+    for (int t = 0; t < 5; ++t) {
+      block.transactions.push_back(
+          makeTx("tx" + std::to_string(i) + "_" + std::to_string(t)));
+    }
+    block.merkleRoot =
+        BC::Block::computeMerkleRoot(block.transactions, crypto, 0);
+    chain.push_back(block);
+  }
+
+  BC::ChainValidator validator(crypto, pool);
+  EXPECT_TRUE(validator.validate(chain).valid);
+
+  // Lowest failing index wins regardless of which stage finds it
+  auto broken = chain;
+  broken[150].isOrphaned = true;
+  broken[90].transactions[3].multiSignatures.clear();
+  broken[120].hash = "1bad";
+  auto result = validator.validate(broken);
+  EXPECT_FALSE(result.valid);
+  EXPECT_EQ(result.failedIndex, 90u);
+  EXPECT_EQ(result.reason, "transaction verification failed");
+
+  broken = chain;
+  broken[120].hash = "1bad";
+  broken[150].isOrphaned = true;
+  result = validator.validate(broken);
+  EXPECT_EQ(result.failedIndex, 120u);
+  EXPECT_EQ(result.reason, "hash does not meet difficulty target");
+
+  // Same rules as Block::validate(): nothing beyond the per-block checks
+  broken = chain;
+  broken[60].transactions[0] = chain[59].transactions[0];
+  broken[70].merkleRoot = "stale";
+  EXPECT_TRUE(validator.validate(broken).valid);
+  for (size_t i = 1; i < broken.size(); ++i) {
+    EXPECT_TRUE(broken[i].validate(crypto));
+  }
+}
+
+TEST(HttpReactorServer) {
+  namespace Http = QuantumPulse::Http;
+
+  Http::ServerConfig config;
+  config.bindAddress = "127.0.0.1";
+  config.workerThreads = 2;
+  config.maxBodyBytes = 256 * 1024;
+  Http::Server server(config, [](const Http::Request &req) {
+    Http::Response res;
+    res.body = std::string(req.path()) + ":" + std::to_string(req.body.size());
+    return res;
+  });
+  EXPECT_TRUE(server.start());
+  EXPECT_GT(server.getPort(), 0);
+
+  auto connectClient = [&] { return connectLoopback(server.getPort()); };
+
+  // Pipelined keep-alive requests, answered in order
+  int fd = connectClient();
+  std::string big(100000, 'x');
+  sendAll(fd, "GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+              "POST /b HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+              "POST /c HTTP/1.1\r\nContent-Length: " +
+                  std::to_string(big.size()) + "\r\n\r\n" + big);
+  std::string replies = readResponses(fd, 3);
+  size_t a = replies.find("/a:0"), b = replies.find("/b:5"),
+         c = replies.find("/c:100000");
+  EXPECT_TRUE(a != std::string::npos && b != std::string::npos &&
+              c != std::string::npos);
+  EXPECT_TRUE(a < b && b < c);
+  EXPECT_TRUE(replies.find("Connection: keep-alive") != std::string::npos);
+
+  // Same connection still usable; Connection: close is honoured
+  sendAll(fd, "GET /d HTTP/1.1\r\nConnection: close\r\n\r\n");
+  replies = readResponses(fd, 1);
+  EXPECT_TRUE(replies.find("/d:0") != std::string::npos);
+  EXPECT_TRUE(replies.find("Connection: close") != std::string::npos);
+  char byte;
+  EXPECT_EQ(recv(fd, &byte, 1, 0), 0);
+  close(fd);
+
+  // Body arriving in a later read than the head
+  fd = connectClient();
+  sendAll(fd, "POST /f HTTP/1.1\r\nContent-Length: 5\r\n\r\n");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  sendAll(fd, "world");
+  replies = readResponses(fd, 1);
+  EXPECT_TRUE(replies.find("/f:5") != std::string::npos);
+  close(fd);
+
+  // Oversized body rejected before it is read
+  fd = connectClient();
+  sendAll(fd, "POST /e HTTP/1.1\r\nContent-Length: 999999999\r\n\r\n");
+  replies = readResponses(fd, 1);
+  EXPECT_TRUE(replies.find("413 Payload Too Large") != std::string::npos);
+  close(fd);
+
+  EXPECT_EQ(server.getRequestCount(), 5u);
+  server.stop();
+}
+
+// Test: JSON-RPC dispatcher - envelopes, batches, notifications, errors
+TEST(JsonRpcDispatcher) {
+  namespace JsonRpc = QuantumPulse::JsonRpc;
+
+  JsonRpc::Dispatcher d;
+  d.add("count", [](const JsonRpc::Params &, JsonRpc::Reply &reply) {
+    reply.result().number(uint64_t{42});
+  });
+  d.add("echo", [](const JsonRpc::Params &params, JsonRpc::Reply &reply) {
+    std::string scratch;
+    auto s = params.getString(0, scratch);
+    if (!s) {
+      reply.error(JsonRpc::INVALID_PARAMS, "need a string");
+      return;
+    }
+    reply.result().beginObject().key("s").string(*s).key("n").number(
+        params.getNumber(1).value_or(-1.5));
+    reply.result().endObject();
+  });
+  d.add("throws", [](const JsonRpc::Params &, JsonRpc::Reply &) {
+    throw std::runtime_error("boom");
+  });
+
+  // Legacy envelope keeps the Bitcoin Core shape and echoes the id
+  EXPECT_EQ(d.handle(R"({"jsonrpc": "1.0", "id": "cli", "method": "count"})"),
+            std::string(R"({"result":42,"error":null,"id":"cli"})"));
+  EXPECT_EQ(d.handle(R"({"jsonrpc":"2.0","id":7,"method":"count"})"),
+            std::string(R"({"jsonrpc":"2.0","result":42,"id":7})"));
+
+  // Escapes are decoded on input and re-encoded on output
+  EXPECT_EQ(
+      d.handle(
+          R"({"jsonrpc":"2.0","id":1,"method":"echo","params":["a\"bé\n",2]})"),
+      std::string("{\"jsonrpc\":\"2.0\",\"result\":{\"s\":\"a\\\"b\xC3\xA9\\n\","
+                  "\"n\":2},\"id\":1}"));
+
+  // Batch: results in order, notifications omitted, errors per call
+  std::string out = d.handle(
+      R"([{"jsonrpc":"2.0","id":1,"method":"count"},)"
+      R"({"jsonrpc":"2.0","method":"count"},)"
+      R"({"jsonrpc":"2.0","id":2,"method":"nope"},)"
+      R"({"jsonrpc":"2.0","id":3,"method":"echo","params":[5]},)"
+      R"({"jsonrpc":"2.0","id":4,"method":"throws"},)"
+      R"(17])");
+  EXPECT_EQ(out,
+            std::string(
+                R"([{"jsonrpc":"2.0","result":42,"id":1},)"
+                R"({"jsonrpc":"2.0","error":{"code":-32601,)"
+                R"("message":"Method not found"},"id":2},)"
+                R"({"jsonrpc":"2.0","error":{"code":-32602,)"
+                R"("message":"need a string"},"id":3},)"
+                R"({"jsonrpc":"2.0","error":{"code":-32603,)"
+                R"("message":"Internal error"},"id":4},)"
+                R"({"result":null,"error":{"code":-32600,)"
+                R"("message":"Invalid Request"},"id":null}])"));
+
+  // A batch of notifications produces no response body at all
+  EXPECT_TRUE(d.handle(R"([{"jsonrpc":"2.0","method":"count"}])").empty());
+
+  // Malformed JSON and empty batches
+  EXPECT_TRUE(d.handle(R"({"method":"count")").find("-32700") !=
+              std::string::npos);
+  EXPECT_TRUE(d.handle(R"({"method":"count"} x)").find("-32700") !=
+              std::string::npos);
+  EXPECT_TRUE(d.handle("[]").find("-32600") != std::string::npos);
+  EXPECT_TRUE(d.handle(R"({"id":1})").find("-32600") != std::string::npos);
+
+  // Large batch round trip
+  std::string batch = "[";
+  for (int i = 0; i < 500; ++i) {
+    batch += (i ? "," : "") + std::string(R"({"jsonrpc":"2.0","id":)") +
+             std::to_string(i) + R"(,"method":"count"})";
+  }
+  batch += "]";
+  out = d.handle(batch);
+  EXPECT_TRUE(out.find(R"("id":0})") != std::string::npos);
+  EXPECT_TRUE(out.find(R"("id":499}])") != std::string::npos);
+
+  // Escaped method names stay valid while the batch's call list grows
+  batch = "[";
+  for (int i = 0; i < 40; ++i) {
+    batch += i ? "," : "";
+    batch += R"({"jsonrpc":"2.0","id":)" + std::to_string(i) +
+             R"(,"method":"co\u0075nt"})";
+  }
+  batch += "]";
+  out = d.handle(batch);
+  size_t answered = 0;
+  for (size_t pos = 0; (pos = out.find(R"("result":42)", pos)) !=
+                       std::string::npos;
+       ++pos) {
+    ++answered;
+  }
+  EXPECT_EQ(answered, 40u);
+}
+
+// Test: REST API - route trie, path params, pipelining, large bodies
+TEST(APIServerRouting) {
+  namespace API = QuantumPulse::API;
+  QuantumPulse::Blockchain::Blockchain bc;
+  API::APIServer api(bc, 0);
+  api.addRoute(API::HttpMethod::GET, "/api/item/:id/tag/:tag",
+               [](const API::HttpRequest &req) {
+                 API::HttpResponse res;
+                 res.setJSON("param:" + req.getParam("id") + "/" +
+                             req.getParam("tag") + "/" + req.getParam("q"));
+                 return res;
+               });
+  api.addRoute(API::HttpMethod::GET, "/api/item/latest/tag/:tag",
+               [](const API::HttpRequest &req) {
+                 API::HttpResponse res;
+                 res.setJSON("literal:" + req.getParam("tag"));
+                 return res;
+               });
+  api.addRoute(API::HttpMethod::POST, "/api/item/latest",
+               [](const API::HttpRequest &) {
+                 API::HttpResponse res;
+                 res.setJSON("posted");
+                 return res;
+               });
+  api.addRoute(API::HttpMethod::GET, "/api/item/:id",
+               [](const API::HttpRequest &req) {
+                 API::HttpResponse res;
+                 res.setJSON("item:" + req.getParam("id"));
+                 return res;
+               });
+  // Same position, different parameter name
+  EXPECT_FALSE(api.addRoute(API::HttpMethod::GET, "/api/item/:name/x",
+                            [](const API::HttpRequest &) {
+                              return API::HttpResponse{};
+                            }));
+  api.addRoute(API::HttpMethod::POST, "/api/upload",
+               [](const API::HttpRequest &req) {
+                 API::HttpResponse res;
+                 res.setJSON("size:" + std::to_string(req.body.size()) +
+                             ":" + req.body.substr(req.body.size() - 3));
+                 return res;
+               });
+  EXPECT_TRUE(api.start());
+  EXPECT_GT(api.getPort(), 0);
+
+  // Pipelined on one keep-alive connection, answered in order
+  int fd = connectLoopback(api.getPort());
+  sendAll(fd, "GET /api/item/7/tag/red?q=1 HTTP/1.1\r\n\r\n"
+              "GET /api/item/latest/tag/blue HTTP/1.1\r\n\r\n"
+              "GET /api/item/latest/tag HTTP/1.1\r\n\r\n"
+              "POST /api/price HTTP/1.1\r\nContent-Length: 0\r\n\r\n"
+              "GET /api/balance/QPabc HTTP/1.1\r\n\r\n"
+              "GET /api/price/ HTTP/1.1\r\n\r\n");
+  std::string replies = readResponses(fd, 6);
+  size_t a = replies.find("param:7/red/1");
+  size_t b = replies.find("literal:blue");
+  size_t c = replies.find("404 Not Found");
+  size_t d = replies.find("405 Method Not Allowed");
+  size_t e = replies.find(R"("address":"QPabc")");
+  size_t f = replies.find(R"("minimumPrice":600000)");
+  EXPECT_TRUE(a < b && b < c && c < d && d < e && e < f &&
+              f != std::string::npos);
+  EXPECT_TRUE(replies.find("Access-Control-Allow-Origin: *") !=
+              std::string::npos);
+
+  // A literal path without a handler for the method falls back to the
+  // parameter route that has one
+  sendAll(fd, "GET /api/item/latest HTTP/1.1\r\n\r\n"
+              "POST /api/item/latest HTTP/1.1\r\nContent-Length: 0\r\n\r\n"
+              "DELETE /api/item/latest HTTP/1.1\r\n\r\n");
+  replies = readResponses(fd, 3);
+  a = replies.find("item:latest");
+  b = replies.find("posted");
+  d = replies.find("405 Method Not Allowed");
+  EXPECT_TRUE(a < b && b < d && d != std::string::npos);
+
+  // A 2 MB body arriving in small pieces on the same connection
+  std::string body(2 * 1024 * 1024, 'b');
+  body.replace(body.size() - 3, 3, "end");
+  sendAll(fd, "POST /api/upload HTTP/1.1\r\nContent-Length: " +
+                  std::to_string(body.size()) + "\r\n\r\n");
+  for (size_t off = 0; off < body.size(); off += 64 * 1024) {
+    sendAll(fd, body.substr(off, 64 * 1024));
+  }
+  replies = readResponses(fd, 1);
+  EXPECT_TRUE(replies.find("size:2097152:end") != std::string::npos);
+  close(fd);
+
+  api.stop();
+  EXPECT_FALSE(api.isRunning());
+}
+
+// Test: P2P framing - split/coalesced reads, codecs, batched writev
+TEST(P2PWireFraming) {
+  namespace P2P = QuantumPulse::P2P;
+  namespace BC = QuantumPulse::Blockchain;
+
+  BC::Transaction tx;
+  tx.sender = "alice";
+  tx.receiver = "bob";
+  tx.txId = "tx1";
+  tx.signature = std::string("sig\0nul", 7);
+  tx.multiSignatures = {"m1", "m2"};
+  tx.amount = 1.25;
+  tx.fee = 0.001;
+  tx.timestamp = 1700000000;
+  tx.shardId = 3;
+  BC::Block block;
+  block.prevHash = "prev";
+  block.hash = "hash";
+  block.merkleRoot = "root";
+  block.timestamp = 1700000001;
+  block.nonce = 42;
+  block.transactions = {tx, tx};
+
+  std::string wire;
+  P2P::InvMessage inv{{{P2P::INV_TX, "tx1"}, {P2P::INV_BLOCK, "hash"}}};
+  std::string payload;
+  inv.encode(payload);
+  P2P::appendFrame(wire, P2P::MessageType::INV, payload);
+  payload.clear();
+  P2P::BlockMessage{block}.encode(payload);
+  P2P::appendFrame(wire, P2P::MessageType::BLOCK, payload);
+  payload.clear();
+  P2P::HeadersMessage{{block, block, block}}.encode(payload);
+  P2P::appendFrame(wire, P2P::MessageType::HEADERS, payload);
+  P2P::appendFrame(wire, P2P::MessageType::VERACK, {});
+
+  // Same frames whether bytes arrive one at a time or all at once
+  for (size_t step : {size_t{1}, size_t{7}, wire.size()}) {
+    P2P::FrameDecoder decoder;
+    std::vector<std::pair<P2P::MessageType, std::string>> frames;
+    for (size_t off = 0; off < wire.size(); off += step) {
+      decoder.feed(wire.data() + off, std::min(step, wire.size() - off));
+      P2P::Frame f;
+      while (decoder.next(f) == P2P::FrameDecoder::Status::Ready) {
+        frames.emplace_back(f.type, std::string(f.payload));
+      }
+    }
+    EXPECT_EQ(frames.size(), 4u);
+    EXPECT_EQ(decoder.buffered(), 0u);
+    EXPECT_TRUE(frames[3].first == P2P::MessageType::VERACK);
+
+    auto gotInv = P2P::InvMessage::decode(frames[0].second);
+    EXPECT_TRUE(gotInv && gotInv->items.size() == 2);
+    EXPECT_EQ(gotInv->items[1].hash, "hash");
+    auto gotBlock = P2P::BlockMessage::decode(frames[1].second);
+    EXPECT_TRUE(gotBlock.has_value());
+    EXPECT_EQ(gotBlock->block.nonce, 42);
+    EXPECT_EQ(gotBlock->block.transactions.size(), 2u);
+    const auto &t = gotBlock->block.transactions[1];
+    EXPECT_EQ(t.signature, tx.signature);
+    EXPECT_EQ(t.multiSignatures.size(), 2u);
+    EXPECT_EQ(t.amount, 1.25);
+    EXPECT_EQ(t.shardId, 3);
+    EXPECT_EQ(t.serialize(), tx.serialize());
+    auto gotHeaders = P2P::HeadersMessage::decode(frames[2].second);
+    EXPECT_TRUE(gotHeaders && gotHeaders->headers.size() == 3);
+    EXPECT_TRUE(gotHeaders->headers[0].transactions.empty());
+  }
+
+  // Corruption, wrong magic and truncated payloads are rejected
+  std::string bad = wire;
+  bad[P2P::FRAME_HEADER_SIZE + 2] ^= 1;
+  P2P::FrameDecoder decoder;
+  decoder.feed(bad.data(), bad.size());
+  P2P::Frame f;
+  EXPECT_TRUE(decoder.next(f) == P2P::FrameDecoder::Status::Error);
+  EXPECT_TRUE(decoder.error() == P2P::FrameDecoder::Error::BadChecksum);
+  P2P::FrameDecoder other(0x01020304);
+  other.feed(wire.data(), wire.size());
+  EXPECT_TRUE(other.next(f) == P2P::FrameDecoder::Status::Error);
+  EXPECT_FALSE(P2P::BlockMessage::decode(payload.substr(0, 20)).has_value());
+
+  // Queued small messages leave in a single writev
+  int fds[2];
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  P2P::SendQueue queue;
+  for (uint64_t i = 0; i < 50; ++i) {
+    queue.push(P2P::MessageType::PING, P2P::PingMessage{i});
+  }
+  EXPECT_EQ(queue.pendingFrames(), 50u);
+  EXPECT_TRUE(queue.flush(fds[0]));
+  EXPECT_EQ(queue.getWriteCalls(), 1u);
+  EXPECT_EQ(queue.pendingBytes(), 0u);
+  P2P::FrameDecoder reader;
+  char *buf = reader.prepare(4096);
+  ssize_t n = recv(fds[1], buf, 4096, 0);
+  reader.commit(n > 0 ? static_cast<size_t>(n) : 0);
+  uint64_t expect = 0;
+  while (reader.next(f) == P2P::FrameDecoder::Status::Ready) {
+    auto ping = P2P::PingMessage::decode(f.payload);
+    EXPECT_TRUE(ping && ping->nonce == expect);
+    ++expect;
+  }
+  EXPECT_EQ(expect, 50u);
+  close(fds[0]);
+  close(fds[1]);
+
+  // Manager queues a binary VERSION on connect
+  P2P::NetworkManager manager;
+  EXPECT_TRUE(manager.connectPeer("10.0.0.1", 8333));
+  auto peerQueue = manager.getSendQueue("10.0.0.1:8333");
+  EXPECT_TRUE(peerQueue != nullptr);
+  EXPECT_EQ(peerQueue->pendingFrames(), 1u);
+  manager.announceBlock("hash", 1);
+  EXPECT_EQ(peerQueue->pendingFrames(), 2u);
+}
+
+// Test: Headers-first download survives a peer that never sends bodies
+TEST(HeadersFirstSyncStall) {
+  namespace P2P = QuantumPulse::P2P;
+  namespace BC = QuantumPulse::Blockchain;
+  namespace Net = QuantumPulse::Network;
+
+  BC::Blockchain source;
+  auto &crypto = source.getCryptoManager();
+  for (int b = 0; b < 30; ++b) {
+    std::vector<BC::Transaction> txs;
+    for (int t = 0; t < 3; ++t) {
+      BC::Transaction tx;
+      tx.sender = "alice";
+      tx.receiver = "bob";
+      tx.txId = "ibd" + std::to_string(b) + "_" + std::to_string(t);
+      tx.signature = "signed_v11_" + tx.txId;
+      tx.zkProof = "zk_proof_v11_" + tx.txId;
+      tx.multiSignatures.assign(10, "sig_ok");
+      tx.expiresAt = time(nullptr) + 3600;
+      txs.push_back(tx);
+    }
+    auto tip = source.getBlockHash(source.getChainLength() - 1);
+    BC::Block block(*tip, std::move(txs), 1, 50.0, 0, crypto);
+    EXPECT_TRUE(block.mine(source.getMiningManager(), crypto));
+    EXPECT_TRUE(source.addBlock(block));
+  }
+
+  // Two honest peers and one that answers everything except GETDATA
+  Net::PeerService service(source);
+  std::atomic<bool> running{true};
+  std::vector<std::thread> peers;
+  std::vector<int> ours;
+  for (int i = 0; i < 3; ++i) {
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ours.push_back(fds[0]);
+    peers.emplace_back([&, fd = fds[1], stall = i == 1] {
+      if (!stall) {
+        service.serve(fd, running);
+      } else {
+        P2P::FrameDecoder decoder;
+        P2P::SendQueue out;
+        ssize_t n;
+        while ((n = recv(fd, decoder.prepare(4096), 4096, 0)) > 0) {
+          decoder.commit(static_cast<size_t>(n));
+          P2P::Frame f;
+          while (decoder.next(f) == P2P::FrameDecoder::Status::Ready) {
+            if (f.type != P2P::MessageType::GETDATA) {
+              service.handle(f, out);
+            }
+          }
+          out.flush(fd);
+        }
+      }
+      close(fd);
+    });
+  }
+
+  Net::SyncConfig config;
+  config.windowBlocks = 12;
+  config.maxInFlightPerPeer = 4;
+  config.stallTimeout = std::chrono::milliseconds(200);
+  config.pollInterval = std::chrono::milliseconds(20);
+  BC::Blockchain target;
+  Net::HeadersFirstSync sync(target, config);
+  EXPECT_TRUE(sync.runOnSockets(ours));
+  for (auto &t : peers) {
+    t.join();
+  }
+
+  EXPECT_EQ(target.getChainLength(), source.getChainLength());
+  EXPECT_EQ(*target.getBlockHash(target.getChainLength() - 1),
+            *source.getBlockHash(source.getChainLength() - 1));
+  auto last = target.getBlock(target.getChainLength() - 1);
+  EXPECT_TRUE(last && last->transactions.size() == 3);
+  auto stats = sync.getStats();
+  EXPECT_EQ(stats.headers, 30u);
+  EXPECT_EQ(stats.blocks, 30u);
+  EXPECT_EQ(stats.peers, 3u);
+  EXPECT_TRUE(stats.stalls >= 1);
+  EXPECT_TRUE(stats.rerequests >= 1);
+}
+
+// Test: Compact block relay rebuilds from the pool, fetching only misses
+TEST(CompactBlockRelay) {
+  namespace P2P = QuantumPulse::P2P;
+  namespace BC = QuantumPulse::Blockchain;
+  namespace Net = QuantumPulse::Network;
+
+  BC::Blockchain node;
+  auto &crypto = node.getCryptoManager();
+  std::vector<BC::Transaction> txs;
+  for (int t = 0; t < 40; ++t) {
+    BC::Transaction tx;
+    tx.sender = "alice";
+    tx.receiver = "bob" + std::to_string(t);
+    tx.txId = crypto.sha3_512_v11("cmpct" + std::to_string(t), 0);
+    tx.signature = "signed_v11_" + tx.txId;
+    tx.zkProof = "zk_proof_v11_" + tx.txId;
+    tx.multiSignatures.assign(10, "sig_ok");
+    tx.expiresAt = time(nullptr) + 3600;
+    txs.push_back(tx);
+  }
+  auto tip = node.getBlockHash(node.getChainLength() - 1);
+  BC::Block block(*tip, std::vector<BC::Transaction>(txs), 1, 50.0, 0,
+                  crypto);
+  EXPECT_TRUE(block.mine(node.getMiningManager(), crypto));
+
+  // Header plus 6-byte IDs is a small fraction of the full block
+  auto compact = P2P::CompactBlockMessage::fromBlock(block, 7);
+  std::string compactBytes, fullBytes;
+  compact.encode(compactBytes);
+  P2P::BlockMessage{block}.encode(fullBytes);
+  EXPECT_TRUE(compactBytes.size() * 10 < fullBytes.size());
+  auto decoded = P2P::CompactBlockMessage::decode(compactBytes);
+  EXPECT_TRUE(decoded && decoded->shortIds == compact.shortIds);
+
+  // Pool knows all but two transactions
+  P2P::TxRelayPool pool;
+  for (int t = 0; t < 40; ++t) {
+    if (t != 5 && t != 31) {
+      pool.add(txs[t]);
+    }
+  }
+  P2P::PartialBlock partial;
+  EXPECT_TRUE(partial.init(*decoded, pool) ==
+              P2P::PartialBlock::Status::NeedTxs);
+  EXPECT_TRUE(partial.missing() == std::vector<uint32_t>({5, 31}));
+  P2P::PartialBlock tampered = partial;
+  EXPECT_TRUE(partial.fill({block.hash, {txs[5], txs[31]}}) ==
+              P2P::PartialBlock::Status::Complete);
+  auto rebuilt = partial.take(crypto);
+  EXPECT_TRUE(rebuilt && rebuilt->serialize() == block.serialize());
+  tampered.fill({block.hash, {txs[31], txs[5]}});
+  EXPECT_FALSE(tampered.take(crypto).has_value());
+
+  // Over the wire: CMPCTBLOCK -> GETBLOCKTXN -> BLOCKTXN -> connected
+  Net::PeerService service(node, &pool);
+  std::atomic<bool> running{true};
+  int fds[2];
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  std::thread server([&] {
+    service.serve(fds[1], running);
+    close(fds[1]);
+  });
+  P2P::FrameDecoder reader;
+  auto send = [&](P2P::MessageType type, const auto &msg) {
+    P2P::SendQueue out;
+    out.push(type, msg);
+    out.flush(fds[0]);
+  };
+  auto receive = [&] {
+    P2P::Frame f;
+    while (reader.next(f) != P2P::FrameDecoder::Status::Ready) {
+      ssize_t n = recv(fds[0], reader.prepare(65536), 65536, 0);
+      reader.commit(n > 0 ? static_cast<size_t>(n) : 0);
+    }
+    return std::make_pair(f.type, std::string(f.payload));
+  };
+  const size_t before = node.getChainLength();
+  send(P2P::MessageType::CMPCTBLOCK, compact);
+  auto [type, payload] = receive();
+  EXPECT_TRUE(type == P2P::MessageType::GETBLOCKTXN);
+  auto request = P2P::GetBlockTxnMessage::decode(payload);
+  EXPECT_TRUE(request &&
+              request->indexes == std::vector<uint32_t>({5, 31}));
+  send(P2P::MessageType::BLOCKTXN,
+       P2P::BlockTxnMessage{block.hash, {txs[5], txs[31]}});
+
+  // Once connected, the node serves GETBLOCKTXN for the block itself
+  send(P2P::MessageType::GETBLOCKTXN,
+       P2P::GetBlockTxnMessage{block.hash, {0, 39}});
+  std::tie(type, payload) = receive();
+  EXPECT_TRUE(type == P2P::MessageType::BLOCKTXN);
+  auto served = P2P::BlockTxnMessage::decode(payload);
+  EXPECT_TRUE(served && served->txs.size() == 2);
+  EXPECT_EQ(served->txs[1].txId, txs[39].txId);
+  close(fds[0]);
+  server.join();
+  EXPECT_EQ(node.getChainLength(), before + 1);
+  EXPECT_EQ(*node.getBlockHash(before), block.hash);
+  EXPECT_EQ(pool.size(), 0u);
+}
+
+// Test: Blocks and transactions accepted from one peer reach the others
+TEST(BlockAndTxRelay) {
+  namespace P2P = QuantumPulse::P2P;
+  namespace BC = QuantumPulse::Blockchain;
+  namespace Net = QuantumPulse::Network;
+
+  // origin -> relay node -> far node, the last link dialled by far
+  BC::Blockchain relayNode, farNode;
+  P2P::TxRelayPool relayPool, farPool;
+  P2P::NetworkManager relayNet(18444), farNet(18445);
+  Net::PeerService relayService(relayNode, &relayPool, &relayNet);
+  Net::PeerService farService(farNode, &farPool, &farNet);
+  std::atomic<bool> running{true};
+  int origin[2], link[2];
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, origin), 0);
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, link), 0);
+  auto toOrigin = relayNet.attachPeer("10.0.0.1:8333", true);
+  auto toFar = relayNet.attachPeer("10.0.0.2:8333", true);
+  auto toRelay = farNet.attachPeer("10.0.0.3:8333", false);
+  EXPECT_TRUE(toOrigin && toFar && toRelay);
+  EXPECT_TRUE(relayNet.attachPeer("10.0.0.1:8333", true) == nullptr);
+  std::thread fromOrigin([&] {
+    relayService.serve(origin[1], running,
+                       {toOrigin.get(), "10.0.0.1:8333", false});
+  });
+  std::thread fromFar([&] {
+    relayService.serve(link[0], running, {toFar.get(), "10.0.0.2:8333", false});
+  });
+  std::thread fromRelay([&] {
+    farService.serve(link[1], running, {toRelay.get(), "10.0.0.3:8333", true});
+  });
+
+  auto &crypto = relayNode.getCryptoManager();
+  std::vector<BC::Transaction> txs;
+  for (int t = 0; t < 3; ++t) {
+    BC::Transaction tx;
+    tx.sender = "alice";
+    tx.receiver = "bob" + std::to_string(t);
+    tx.txId = crypto.sha3_512_v11("relay" + std::to_string(t), 0);
+    tx.signature = "signed_v11_" + tx.txId;
+    tx.zkProof = "zk_proof_v11_" + tx.txId;
+    tx.multiSignatures.assign(10, "sig_ok");
+    tx.expiresAt = time(nullptr) + 3600;
+    txs.push_back(tx);
+  }
+  auto tip = relayNode.getBlockHash(relayNode.getChainLength() - 1);
+  EXPECT_TRUE(tip && tip == farNode.getBlockHash(farNode.getChainLength() - 1));
+  BC::Block block(*tip, std::vector<BC::Transaction>(txs), 1, 50.0, 0,
+                  crypto);
+  EXPECT_TRUE(block.mine(relayNode.getMiningManager(), crypto));
+
+  // Transactions first, so the far node rebuilds the compact block from
+  // its own pool without a GETBLOCKTXN round trip
+  P2P::SendQueue out;
+  for (const auto &tx : txs) {
+    out.push(P2P::MessageType::TX, P2P::TxMessage{tx});
+  }
+  out.push(P2P::MessageType::CMPCTBLOCK,
+           P2P::CompactBlockMessage::fromBlock(block, 3));
+  const size_t before = farNode.getChainLength();
+  EXPECT_TRUE(out.flush(origin[0]));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (farNode.getChainLength() == before &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(relayNode.getChainLength(), before + 1);
+  EXPECT_EQ(farNode.getChainLength(), before + 1);
+  EXPECT_EQ(*farNode.getBlockHash(before), block.hash);
+  EXPECT_EQ(farPool.size(), 0u);
+  EXPECT_EQ(relayNet.getStats()["txRelayed"], 3);
+  EXPECT_EQ(relayNet.getStats()["blocksRelayed"], 1);
+  EXPECT_EQ(farNet.getStats()["blocksRelayed"], 1);
+
+  // Nothing is echoed back to the origin
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+      3 * Net::PeerService::RELAY_POLL_MS));
+  char byte;
+  EXPECT_TRUE(recv(origin[0], &byte, 1, MSG_DONTWAIT) < 0);
+
+  running = false;
+  fromOrigin.join();
+  fromFar.join();
+  fromRelay.join();
+  for (int fd : {origin[0], origin[1], link[0], link[1]}) {
+    close(fd);
+  }
+}
+
+// Test: Lock-free log ring
+TEST(LogRingMpsc) {
+  using QuantumPulse::Logging::LogLevel;
+  using QuantumPulse::Logging::LogRecord;
+  using QuantumPulse::Logging::LogRing;
+
+  // A full ring rejects pushes; records come out in FIFO order
+  LogRing small(3);
+  EXPECT_EQ(small.capacity(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(small.tryPush([&](LogRecord &r) {
+      r.set("m" + std::to_string(i), LogLevel::INFO, "Test", i);
+    }));
+  }
+  EXPECT_FALSE(small.tryPush([](LogRecord &) {}));
+  EXPECT_EQ(small.front()->payloadView(), std::string_view("m0"));
+  small.pop();
+  EXPECT_TRUE(small.tryPush([](LogRecord &r) {
+    r.set(std::string(300, 'x'), LogLevel::ERROR, "Test", 9);
+  }));
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_EQ(small.front()->shardId, i);
+    small.pop();
+  }
+  EXPECT_EQ(small.front()->payloadLength, LogRecord::PAYLOAD_CAPACITY);
+  small.pop();
+  EXPECT_TRUE(small.front() == nullptr);
+
+  // Concurrent producers: every record arrives exactly once
+  constexpr int PRODUCERS = 4;
+  constexpr int PER_PRODUCER = 20000;
+  LogRing ring(256);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([&ring, p] {
+      for (int i = 0; i < PER_PRODUCER; ++i) {
+        while (!ring.tryPush([&](LogRecord &r) {
+          r.set(std::to_string(i), LogLevel::DEBUG, "Test", p);
+        })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::vector<int> next(PRODUCERS, 0);
+  bool ordered = true;
+  for (int received = 0; received < PRODUCERS * PER_PRODUCER;) {
+    const LogRecord *r = ring.front();
+    if (!r) {
+      std::this_thread::yield();
+      continue;
+    }
+    ordered &= std::string(r->payloadView()) ==
+               std::to_string(next[r->shardId]++);
+    ring.pop();
+    ++received;
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(ring.front() == nullptr);
+
+  // The logger drains asynchronously; flush() waits for the writer
+  auto &logger = QuantumPulse::Logging::Logger::getInstance();
+  logger.info("log ring test", "Test");
+  logger.flush();
+  EXPECT_EQ(logger.getQueueSize(), 0u);
+}
+
+// Test: Binary log format round trip
+TEST(BinaryLogFormat) {
+  namespace Binary = QuantumPulse::Logging::Binary;
+  using QuantumPulse::Logging::LogLevel;
+
+  // The logger writes EVENT entries that decode back to the original text
+  auto &logger = QuantumPulse::Logging::Logger::getInstance();
+  logger.logf(LogLevel::WARNING, "BinLogTest", -3,
+              "height {} of {} at {} ok={} peer {}", int64_t{-7}, 42u, 2.5,
+              true, std::string_view("10.0.0.1"));
+  logger.log("plain message", LogLevel::INFO, "BinLogTest", 1);
+  logger.flush();
+
+  // One file per process, so concurrent runs never share it
+  EXPECT_TRUE(logger.getLogPath().ends_with(
+      "_" + std::to_string(getpid()) + ".qplog"));
+  std::ifstream file(logger.getLogPath(), std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  Binary::Reader reader(data);
+  EXPECT_TRUE(reader.valid());
+  std::vector<std::string> messages;
+  Binary::Event ev;
+  while (reader.next(ev) == Binary::Reader::Status::Event) {
+    if (ev.module == "BinLogTest") {
+      messages.push_back(Binary::renderMessage(ev) + "|" +
+                         std::to_string(ev.shardId));
+    }
+  }
+  EXPECT_EQ(messages.size(), 2u);
+  EXPECT_EQ(messages[0], "height -7 of 42 at 2.5 ok=true peer 10.0.0.1|-3");
+  EXPECT_EQ(messages[1], "plain message|1");
+
+  // Oversized string arguments are cut to fit the record
+  const uint64_t truncatedBefore = logger.getTruncatedCount();
+  logger.logf(LogLevel::DEBUG, "BinLogTest", 0, "{}", std::string(500, 'x'));
+  EXPECT_EQ(logger.getTruncatedCount(), truncatedBefore + 1);
+
+  // A second session appended to the file restarts the id tables; a
+  // partial trailing entry is reported as corrupt
+  std::string twoSessions = data + data;
+  twoSessions.push_back(static_cast<char>(Binary::EntryType::EVENT));
+  Binary::Reader again(twoSessions);
+  size_t events = 0;
+  auto status = Binary::Reader::Status::Event;
+  while ((status = again.next(ev)) == Binary::Reader::Status::Event) {
+    events += ev.module == "BinLogTest";
+  }
+  EXPECT_EQ(events, 4u);
+  EXPECT_TRUE(status == Binary::Reader::Status::Corrupt);
+}
+
+// Test: Metrics registry
+TEST(MetricsRegistry) {
+  using Layout = QuantumPulse::Metrics::detail::HistogramLayout;
+  QuantumPulse::Metrics::PrometheusExporter metrics;
+
+  // Log-linear buckets are contiguous and bound their values
+  bool layoutOk = true;
+  for (uint64_t v : {0ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 123456789ull}) {
+    size_t i = Layout::index(v);
+    layoutOk &= v <= Layout::upperBound(i) &&
+                (i == 0 || v > Layout::upperBound(i - 1));
+  }
+  EXPECT_TRUE(layoutOk);
+  EXPECT_EQ(Layout::index(uint64_t{1} << 40), Layout::BUCKETS - 1);
+
+  // Handles update striped cells from many threads without losing counts
+  auto requests = metrics.counter("test_requests_total", "Requests");
+  auto latency = metrics.histogram("test_latency_seconds", "Latency", 1e-6);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      for (uint64_t i = 1; i <= 1000; ++i) {
+        requests.inc();
+        latency.observe(i);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(requests.value(), 8000u);
+  auto snap = latency.snapshot();
+  EXPECT_EQ(snap.count, 8000u);
+  EXPECT_EQ(snap.sum, 8u * 500500u);
+  EXPECT_TRUE(snap.quantile(0.5) >= 500 && snap.quantile(0.5) < 563);
+  EXPECT_TRUE(snap.quantile(1.0) >= 1000);
+
+  // Name-based helpers and the Prometheus text output
+  metrics.recordAPIRequest("blocks");
+  metrics.recordAPIRequest("blocks");
+  metrics.recordAPIRequest("say \"hi\"\\\n");
+  metrics.setGauge("quantumpulse_chain_length", 42);
+  EXPECT_EQ(metrics.getMetricValue("quantumpulse_api_requests_total"), 3.0);
+  std::string_view text = metrics.scrape();
+  const char *buffer = text.data();
+  EXPECT_TRUE(text.find("test_requests_total 8000\n") != std::string::npos);
+  EXPECT_TRUE(text.find("# TYPE test_latency_seconds histogram\n") !=
+              std::string::npos);
+  EXPECT_TRUE(text.find("test_latency_seconds_bucket{le=\"+Inf\"} 8000\n") !=
+              std::string::npos);
+  EXPECT_TRUE(text.find("test_latency_seconds_count 8000\n") !=
+              std::string::npos);
+  EXPECT_TRUE(text.find("quantumpulse_api_endpoint_requests_total{endpoint="
+                        "\"blocks\"} 2\n") != std::string::npos);
+  EXPECT_TRUE(text.find("{endpoint=\"say \\\"hi\\\"\\\\\\n\"} 1\n") !=
+              std::string::npos);
+  EXPECT_TRUE(text.find("quantumpulse_chain_length 42\n") !=
+              std::string::npos);
+  EXPECT_TRUE(metrics.scrape().data() == buffer); // Buffer is reused
+}
+
+// Test: Trace spans
+TEST(TraceSpans) {
+  namespace Trace = QuantumPulse::Trace;
+  static QuantumPulse::Metrics::PrometheusExporter metrics;
+  auto &tracer = Trace::Tracer::getInstance();
+  tracer.attachMetrics(metrics);
+  tracer.setRecording(true);
+  tracer.clear();
+
+  auto work = [] {
+    QP_TRACE_SCOPE("test.outer", "test");
+    QP_TRACE_SPAN(inner, "test.inner", "test");
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+    QP_TRACE_END(inner);
+  };
+  std::thread other([&] {
+    for (int i = 0; i < 3; ++i) {
+      work();
+    }
+  });
+  for (int i = 0; i < 2; ++i) {
+    work();
+  }
+  other.join();
+
+  // Instrumented pipelines feed the same sites
+  QuantumPulse::Mempool::TransactionMempool pool(1000);
+  QuantumPulse::UTXO::Transaction tx{};
+  tx.txid = "traced";
+  tx.fee = 1.0;
+  tx.size = tx.vsize = 100;
+  EXPECT_TRUE(pool.addTransaction(tx));
+
+  size_t outer = 0, inner = 0, mempool = 0;
+  bool nested = true;
+  for (const auto &span : tracer.snapshot()) {
+    outer += span.site->name() == "test.outer";
+    inner += span.site->name() == "test.inner";
+    mempool += span.site->name() == "mempool.add";
+    if (span.site->name() == "test.inner") {
+      nested &= span.durationNs >= 50000;
+    }
+  }
+  EXPECT_EQ(outer, 5u);
+  EXPECT_EQ(inner, 5u);
+  EXPECT_EQ(mempool, 1u);
+  EXPECT_TRUE(nested);
+
+  std::string json = tracer.exportChromeTrace();
+  EXPECT_TRUE(json.rfind(R"({"traceEvents":[{"name":")", 0) == 0);
+  EXPECT_TRUE(json.find(R"("name":"test.inner","cat":"test","ph":"X")") !=
+              std::string::npos);
+  std::string text = metrics.exportMetrics();
+  EXPECT_TRUE(text.find("quantumpulse_span_duration_seconds_count{span=\""
+                        "test.outer\"} 5\n") != std::string::npos);
+
+  tracer.clear();
+  EXPECT_TRUE(tracer.snapshot().empty());
+  tracer.setRecording(false);
+}
+
+// Test: Order book matching
+TEST(OrderBookMatching) {
+  namespace Trading = QuantumPulse::Trading;
+  using Trading::OrderSide;
+  using Trading::OrderStatus;
+  using Trading::OrderType;
+  Trading::OrderBook book;
+
+  std::string s1 = book.placeOrder("alice", OrderSide::SELL, OrderType::LIMIT,
+                                   100.0, 2.0);
+  std::string s2 = book.placeOrder("alice", OrderSide::SELL, OrderType::LIMIT,
+                                   100.0, 3.0);
+  std::string s3 = book.placeOrder("carol", OrderSide::SELL, OrderType::LIMIT,
+                                   101.0, 5.0);
+  EXPECT_EQ(book.getOpenOrderCount(), 3u);
+  EXPECT_TRUE(book.placeOrder("bob", OrderSide::BUY, OrderType::LIMIT, 100.0,
+                              0.0)
+                  .empty());
+
+  // Crosses at the maker price, oldest order at the level first
+  std::string b1 = book.placeOrder("bob", OrderSide::BUY, OrderType::LIMIT,
+                                   100.5, 4.0);
+  EXPECT_EQ(book.getOrder(b1)->status, OrderStatus::FILLED);
+  EXPECT_EQ(book.getOrder(s1)->status, OrderStatus::FILLED);
+  EXPECT_EQ(book.getOrder(s2)->status, OrderStatus::PARTIAL);
+  EXPECT_TRUE(std::fabs(book.getOrder(s2)->remainingQuantity() - 1.0) <
+              1e-9);
+  auto trades = book.getRecentTrades();
+  EXPECT_EQ(trades.size(), 2u);
+  EXPECT_EQ(trades[0].sellOrderId, s1);
+  EXPECT_EQ(trades[1].buyOrderId, b1);
+  EXPECT_TRUE(std::fabs(trades[1].price - 100.0) < 1e-9);
+
+  auto [bids, asks] = book.getDepth();
+  EXPECT_TRUE(bids.empty());
+  EXPECT_EQ(asks.size(), 2u);
+  EXPECT_TRUE(std::fabs(asks[0].second - 1.0) < 1e-9);
+  EXPECT_TRUE(std::fabs(book.getBestBidAsk().second - 100.0) < 1e-9);
+
+  // Only the owner cancels, and only once
+  EXPECT_FALSE(book.cancelOrder(s2, "bob"));
+  EXPECT_TRUE(book.cancelOrder(s2, "alice"));
+  EXPECT_FALSE(book.cancelOrder(s2, "alice"));
+  EXPECT_FALSE(book.cancelOrder("ord_999", "alice"));
+  EXPECT_TRUE(std::fabs(book.getBestBidAsk().second - 101.0) < 1e-9);
+
+  // A market order sweeps what is there and never rests
+  std::string m = book.placeOrder("bob", OrderSide::BUY, OrderType::MARKET, 0,
+                                  8.0);
+  EXPECT_EQ(book.getOrder(m)->status, OrderStatus::CANCELLED);
+  EXPECT_TRUE(std::fabs(book.getOrder(m)->filled - 5.0) < 1e-9);
+  EXPECT_EQ(book.getOrder(s3)->status, OrderStatus::FILLED);
+  EXPECT_EQ(book.getOpenOrderCount(), 0u);
+  EXPECT_EQ(book.getTradeCount(), 3u);
+  EXPECT_TRUE(book.getUserOrders("bob").empty()); // Open orders only
+
+  // Handles of finished orders stay dead after their slot is reused
+  Trading::MatchingEngine engine;
+  auto noFill = [](const Trading::Fill &) {};
+  auto a = engine.submit(1, OrderSide::BUY, OrderType::LIMIT, 500, 7, noFill);
+  EXPECT_NE(a.handle, 0u);
+  EXPECT_EQ(engine.cancel(a.handle), 7);
+  auto b = engine.submit(2, OrderSide::BUY, OrderType::LIMIT, 499, 3, noFill);
+  EXPECT_NE(a.handle, b.handle);
+  EXPECT_EQ(engine.cancel(a.handle), 0);
+  EXPECT_EQ(engine.remaining(b.handle), 3);
+  EXPECT_EQ(*engine.bestBid(), 499);
+}
+
+// Test: Order book sequencer
+TEST(OrderBookSequencer) {
+  namespace Trading = QuantumPulse::Trading;
+  using Command = Trading::OrderBook::Command;
+  using Trading::OrderSide;
+  using Trading::OrderType;
+  std::vector<Command> journal;
+  Trading::OrderBook::Config config;
+  config.journal = [&](const Command &c) { journal.push_back(c); };
+  Trading::OrderBook book(config);
+
+  // Readers poll while four traders race; the book must never look
+  // crossed or unsorted
+  std::atomic<bool> done{false};
+  bool sane = true;
+  std::thread reader([&] {
+    while (!done.load()) {
+      auto [bids, asks] = book.getDepth(64);
+      for (size_t i = 1; i < bids.size(); ++i) {
+        sane &= bids[i].first < bids[i - 1].first;
+      }
+      for (size_t i = 1; i < asks.size(); ++i) {
+        sane &= asks[i].first > asks[i - 1].first;
+      }
+      if (!bids.empty() && !asks.empty()) {
+        sane &= bids[0].first < asks[0].first;
+      }
+      (void)book.getRecentTrades(20);
+      // Lookups read the published index, never a half-applied order
+      for (const auto &order : book.getUserOrders("trader0")) {
+        sane &= order.filled < order.quantity &&
+                order.status != Trading::OrderStatus::FILLED;
+      }
+    }
+  });
+  std::vector<std::thread> traders;
+  for (int t = 0; t < 4; ++t) {
+    traders.emplace_back([&, t] {
+      const std::string user = "trader" + std::to_string(t);
+      std::vector<std::string> mine;
+      for (int i = 0; i < 500; ++i) {
+        const auto side = (i + t) % 2 ? OrderSide::BUY : OrderSide::SELL;
+        const double price = 100.0 + ((i * 7 + t * 3) % 21 - 10) * 0.01;
+        mine.push_back(book.placeOrder(user, side, OrderType::LIMIT, price,
+                                       1.0 + i % 3));
+        if (i % 5 == 4) {
+          (void)book.cancelOrder(mine[mine.size() / 2], user);
+        }
+      }
+    });
+  }
+  for (auto &t : traders) {
+    t.join();
+  }
+  done = true;
+  reader.join();
+  EXPECT_TRUE(sane);
+  EXPECT_GT(book.getTradeCount(), 0u);
+
+  // One totally ordered command stream
+  EXPECT_EQ(journal.size(), 2400u);
+  bool ordered = true;
+  for (size_t i = 0; i < journal.size(); ++i) {
+    ordered &= journal[i].sequence == i + 1;
+  }
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(book.getSequence(), 2400u);
+
+  // Replaying it rebuilds the same book, fill for fill
+  Trading::OrderBook copy;
+  for (const auto &command : journal) {
+    (void)copy.replay(command);
+  }
+  EXPECT_TRUE(copy.getDepth(64) == book.getDepth(64));
+  EXPECT_EQ(copy.getTradeCount(), book.getTradeCount());
+  EXPECT_EQ(copy.getOpenOrderCount(), book.getOpenOrderCount());
+  auto original = book.getRecentTrades(1000);
+  auto replayed = copy.getRecentTrades(1000);
+  EXPECT_EQ(original.size(), replayed.size());
+  bool same = true;
+  for (size_t i = 0; i < original.size(); ++i) {
+    same &= original[i].tradeId == replayed[i].tradeId &&
+            original[i].buyOrderId == replayed[i].buyOrderId &&
+            original[i].sellOrderId == replayed[i].sellOrderId &&
+            original[i].price == replayed[i].price &&
+            original[i].quantity == replayed[i].quantity &&
+            original[i].timestamp == replayed[i].timestamp;
+  }
+  EXPECT_TRUE(same);
+}
+
+// Test: Order book market data events
+TEST(OrderBookEvents) {
+  namespace Trading = QuantumPulse::Trading;
+  using Trading::OrderSide;
+  using Trading::OrderType;
+  Trading::OrderBook book;
+  auto limit = [&](OrderSide side, double price, double qty) {
+    return book.placeOrder("u", side, OrderType::LIMIT, price, qty);
+  };
+
+  limit(OrderSide::BUY, 99.0, 2.0);
+  limit(OrderSide::SELL, 101.0, 3.0);
+  EXPECT_EQ(book.getEventSequence(), 2u);
+
+  // A late joiner snapshots, then follows the events after it
+  Trading::BookSnapshot first = book.getSnapshot();
+  EXPECT_EQ(first.sequence, 2u);
+  EXPECT_EQ(first.bids.size(), 1u);
+  std::string resting = limit(OrderSide::BUY, 100.0, 1.0);
+  limit(OrderSide::SELL, 101.0, 1.0);
+  limit(OrderSide::BUY, 101.0, 4.0); // Sweeps both asks at 101
+  EXPECT_TRUE(book.cancelOrder(resting, "u"));
+
+  std::vector<Trading::MarketEvent> events;
+  EXPECT_TRUE(book.readEvents(first.sequence, events));
+  size_t trades = 0;
+  bool gapless = true;
+  for (size_t i = 0; i < events.size(); ++i) {
+    gapless &= events[i].sequence == first.sequence + 1 + i;
+    trades += events[i].kind == Trading::MarketEvent::Kind::TRADE;
+  }
+  EXPECT_TRUE(gapless);
+  EXPECT_EQ(trades, 2u);
+  // The sweep reports the emptied ask level once, as 0
+  bool askGone = false;
+  for (const auto &e : events) {
+    if (e.kind == Trading::MarketEvent::Kind::LEVEL &&
+        e.side == OrderSide::SELL) {
+      askGone = e.price == book.toTicks(101.0) && e.quantity == 0;
+    }
+  }
+  EXPECT_TRUE(askGone);
+
+  Trading::L2Book mirror;
+  mirror.load(first);
+  bool applied = true;
+  for (const auto &e : events) {
+    applied &= mirror.apply(e);
+  }
+  EXPECT_TRUE(applied);
+  Trading::BookSnapshot now = book.getSnapshot();
+  EXPECT_EQ(mirror.sequence(), now.sequence);
+  using Levels = std::vector<std::pair<Trading::Ticks, Trading::Lots>>;
+  Levels mirrored(mirror.bids().begin(), mirror.bids().end());
+  EXPECT_TRUE(mirrored == now.bids);
+  EXPECT_TRUE(mirror.asks().empty() && now.asks.empty());
+  Trading::MarketEvent skipped;
+  skipped.sequence = mirror.sequence() + 2;
+  EXPECT_FALSE(mirror.apply(skipped));
+
+  // Waiters wake on new events or when released
+  uint64_t seen = 0;
+  std::thread waiter([&] { seen = book.waitForEvents(now.sequence); });
+  limit(OrderSide::SELL, 105.0, 1.0);
+  waiter.join();
+  EXPECT_EQ(seen, now.sequence + 1);
+  std::thread released([&] { book.waitForEvents(book.getEventSequence()); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  book.wakeEventWaiters();
+  released.join();
+  std::atomic<bool> stopped{false};
+  EXPECT_EQ(book.waitForEvents(book.getEventSequence(), &stopped),
+            book.getEventSequence()); // Already stopped: no wait
+
+  // WebSocket clients get a snapshot, then deltas and trades pushed
+  QuantumPulse::WebSocket::WebSocketServer ws(0);
+  EXPECT_TRUE(ws.start());
+  EXPECT_TRUE(ws.attachOrderBook(book));
+  int fd = connectLoopback(static_cast<uint16_t>(ws.getPort()));
+  sendAll(fd, "GET / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+              "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n");
+  std::string received;
+  auto readUntil = [&](const std::string &needle) {
+    char buf[4096];
+    while (received.find(needle) == std::string::npos) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        return false;
+      }
+      received.append(buf, static_cast<size_t>(n));
+    }
+    return true;
+  };
+  EXPECT_TRUE(readUntil("\"event\":\"book_snapshot\""));
+  EXPECT_TRUE(readUntil("[105,1]]}}"));
+  limit(OrderSide::BUY, 105.0, 0.5);
+  EXPECT_TRUE(readUntil("\"event\":\"trade\""));
+  EXPECT_TRUE(readUntil("\"asks\":[[105,0.5]]"));
+  close(fd);
+  ws.detachOrderBook();
+  ws.stop();
+}
+
+// Test: Order book archive
+TEST(OrderBookArchive) {
+  namespace Trading = QuantumPulse::Trading;
+  namespace Archive = QuantumPulse::Trading::Archive;
+  using Command = Trading::OrderBook::Command;
+  using Trading::OrderSide;
+  using Trading::OrderType;
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "qp_test_orderbook.qparc")
+          .string();
+  std::remove(path.c_str());
+  constexpr int64_t DAY = 86400000;
+
+  Trading::OrderBook::Config config;
+  config.recentOrders = 4;
+  config.archivePath = path;
+  {
+    Trading::OrderBook book(config);
+    // Two sessions two days apart, ten crossing pairs each
+    auto session = [&](int64_t start) {
+      for (int i = 0; i < 10; ++i) {
+        Command sell;
+        sell.side = OrderSide::SELL;
+        sell.type = OrderType::LIMIT;
+        sell.price = 10000;
+        sell.quantity = 5;
+        sell.userId = "maker";
+        sell.timestamp = start + i;
+        Command buy = sell;
+        buy.side = OrderSide::BUY;
+        buy.userId = "taker";
+        EXPECT_TRUE(book.replay(sell));
+        EXPECT_TRUE(book.replay(buy));
+      }
+    };
+    Command rest;
+    rest.side = OrderSide::BUY;
+    rest.type = OrderType::LIMIT;
+    rest.price = 9000;
+    rest.quantity = 5;
+    rest.userId = "maker";
+    session(DAY);
+    rest.timestamp = DAY + 50;
+    EXPECT_TRUE(book.replay(rest)); // ord_21, cancelled two days later
+    book.flushArchive();
+    session(3 * DAY);
+    Command cancel;
+    cancel.kind = Command::Kind::CANCEL;
+    cancel.order = 21;
+    cancel.userId = "maker";
+    cancel.timestamp = 3 * DAY + 20;
+    EXPECT_TRUE(book.replay(cancel));
+    rest.timestamp = 3 * DAY + 30;
+    EXPECT_TRUE(book.replay(rest)); // ord_42, still open at shutdown
+
+    // Only open orders are indexed; old finished ones leave memory
+    EXPECT_EQ(book.getUserOrders("maker").size(), 1u);
+    EXPECT_TRUE(book.getUserOrders("taker").empty());
+    EXPECT_TRUE(book.getOrder("ord_42").has_value());
+    EXPECT_EQ(book.getOrder("ord_41")->status,
+              Trading::OrderStatus::FILLED);
+    EXPECT_FALSE(book.getOrder("ord_1").has_value());
+
+    // The tape answers for a time window as well as a count
+    EXPECT_EQ(book.getRecentTrades(100, 3 * DAY).size(), 10u);
+    auto window = book.getRecentTrades(100, 3 * DAY + 5);
+    EXPECT_TRUE(window.size() == 5 && window[0].timestamp == 3 * DAY + 5 &&
+                window[4].tradeId == "trd_20");
+    EXPECT_EQ(book.getRecentTrades(3, 3 * DAY).size(), 3u);
+  } // Shutdown seals the second session
+
+  std::ifstream file(path, std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+  Archive::Reader reader(data);
+  EXPECT_TRUE(reader.valid());
+  size_t orders = 0, trades = 0;
+  bool inRange = true, lateCancel = false;
+  EXPECT_TRUE(reader.scan(
+      3 * DAY, 4 * DAY,
+      [&](const Archive::OrderRow &row) {
+        // Filed under the time it finished, not when it was placed
+        ++orders;
+        inRange &= row.finished >= 3 * DAY && row.finished <= 4 * DAY &&
+                   row.filled == (row.number == 21 ? 0 : 5);
+        lateCancel |= row.number == 21 && row.timestamp == DAY + 50 &&
+                      row.finished == 3 * DAY + 20;
+      },
+      [&](const Archive::TradeRow &row) {
+        ++trades;
+        inRange &= row.price == 10000 && row.quantity == 5 &&
+                   row.sellOrder + 1 == row.buyOrder;
+      }));
+  EXPECT_EQ(orders, 21u);
+  EXPECT_EQ(trades, 10u);
+  EXPECT_TRUE(inRange && lateCancel);
+  EXPECT_GE(reader.segmentsSkipped(), 2u); // First session, undecoded
+
+  orders = trades = 0;
+  EXPECT_TRUE(reader.scan(
+      0, std::numeric_limits<int64_t>::max(),
+      [&](const Archive::OrderRow &) { ++orders; },
+      [&](const Archive::TradeRow &) { ++trades; }));
+  EXPECT_EQ(orders, 42u);
+  EXPECT_EQ(trades, 20u);
+  EXPECT_EQ(reader.segmentsSkipped(), 0u);
+
+  // A crash mid-write leaves a torn segment. Reopening cuts it off, and
+  // numbering continues after the archived orders and trades.
+  {
+    std::ofstream torn(path, std::ios::app | std::ios::binary);
+    torn.write("\x01\x80", 2);
+  }
+  {
+    Trading::OrderBook book(config);
+    EXPECT_EQ(book.placeOrder("maker", OrderSide::SELL, OrderType::LIMIT,
+                              100.0, 1.0),
+              "ord_43");
+    EXPECT_EQ(book.placeOrder("taker", OrderSide::BUY, OrderType::LIMIT,
+                              100.0, 1.0),
+              "ord_44");
+    auto recent = book.getRecentTrades();
+    EXPECT_TRUE(recent.size() == 1 && recent[0].tradeId == "trd_21");
+  }
+  std::ifstream reopened(path, std::ios::binary);
+  const std::string appended((std::istreambuf_iterator<char>(reopened)),
+                             std::istreambuf_iterator<char>());
+  Archive::Reader again(appended);
+  orders = trades = 0;
+  EXPECT_TRUE(again.scan(
+      0, std::numeric_limits<int64_t>::max(),
+      [&](const Archive::OrderRow &) { ++orders; },
+      [&](const Archive::TradeRow &) { ++trades; }));
+  EXPECT_EQ(orders, 44u);
+  EXPECT_EQ(trades, 21u);
+  std::remove(path.c_str());
+}
+
+// Test: WebSocket fan-out
+TEST(WebSocketFanOut) {
+  namespace WS = QuantumPulse::WebSocket;
+  using WS::EventType;
+  using WS::FanOut;
+
+  // One encoded frame is shared by every queue it goes to
+  FanOut fanOut;
+  auto all = fanOut.subscribe(1, FanOut::ALL);
+  auto trades = fanOut.subscribe(2, 1u << static_cast<int>(EventType::TRADE));
+  WS::Frame frame = WS::encodeFrame("{\"x\":1}");
+  EXPECT_EQ(fanOut.publish(EventType::TRADE, frame), 2u);
+  EXPECT_EQ(fanOut.publish(EventType::NEW_BLOCK, frame), 1u);
+  EXPECT_EQ(frame.use_count(), 4);
+  std::vector<FanOut::Handle> ready;
+  fanOut.takeReady(ready);
+  EXPECT_EQ(ready.size(), 2u);
+
+  // Drains resume where a full socket stopped them
+  std::string written;
+  size_t budget = 12;
+  auto write = [&](const char *data, size_t size) -> ssize_t {
+    size = std::min(size, budget);
+    budget -= size;
+    written.append(data, size);
+    return static_cast<ssize_t>(size);
+  };
+  EXPECT_TRUE(fanOut.drain(*all, write) == FanOut::Drain::BLOCKED);
+  budget = 100;
+  EXPECT_TRUE(fanOut.drain(*all, write) == FanOut::Drain::EMPTY);
+  EXPECT_EQ(written, *frame + *frame);
+  fanOut.unsubscribe(trades);
+  EXPECT_EQ(fanOut.subscriberCount(EventType::TRADE), 1u);
+  EXPECT_EQ(fanOut.publish(EventType::TRADE, frame), 1u);
+
+  // Full queues drop frames or close the subscriber
+  WS::Frame big = WS::encodeFrame(std::string(600, 'x'));
+  FanOut dropping({1000, WS::SlowConsumerPolicy::DROP});
+  auto lagging = dropping.subscribe(1, FanOut::ALL);
+  EXPECT_EQ(dropping.publish(EventType::TRADE, big), 1u);
+  EXPECT_EQ(dropping.publish(EventType::TRADE, big), 0u);
+  EXPECT_EQ(lagging->dropped(), 1u);
+  EXPECT_FALSE(lagging->closed());
+  FanOut strict({1000, WS::SlowConsumerPolicy::DISCONNECT});
+  auto slow = strict.subscribe(1, FanOut::ALL);
+  strict.publish(EventType::TRADE, big);
+  strict.publish(EventType::TRADE, big);
+  EXPECT_TRUE(slow->closed());
+  EXPECT_EQ(strict.slowDisconnects(), 1u);
+  EXPECT_TRUE(strict.drain(*slow, write) == FanOut::Drain::CLOSED);
+
+  // Over sockets: a client that stops reading is cut off while another
+  // keeps up and sees only the events it subscribed to
+  WS::WebSocketServer ws(0, {256 * 1024, WS::SlowConsumerPolicy::DISCONNECT});
+  EXPECT_TRUE(ws.start());
+  const std::string handshake =
+      "GET / HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n";
+  int stalled = socket(AF_INET, SOCK_STREAM, 0);
+  int small = 4096;
+  setsockopt(stalled, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(ws.getPort()));
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  EXPECT_EQ(connect(stalled, reinterpret_cast<sockaddr *>(&addr),
+                    sizeof(addr)),
+            0);
+  sendAll(stalled, handshake);
+  int fd = connectLoopback(static_cast<uint16_t>(ws.getPort()));
+  sendAll(fd, handshake);
+  auto sendMasked = [&](uint8_t opcode, const std::string &text) {
+    std::string out{static_cast<char>(0x80 | opcode),
+                    static_cast<char>(0x80 | text.size()), 1, 2, 3, 4};
+    for (size_t i = 0; i < text.size(); ++i) {
+      out.push_back(static_cast<char>(text[i] ^ (1 + i % 4)));
+    }
+    sendAll(fd, out);
+  };
+  std::string received;
+  size_t searched = 0;
+  auto readUntil = [&](const std::string &needle) {
+    char buf[65536];
+    while (true) {
+      size_t at = received.find(needle, searched);
+      if (at != std::string::npos) {
+        searched = at + needle.size();
+        return true;
+      }
+      searched = received.size() > needle.size()
+                     ? received.size() - needle.size()
+                     : 0;
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) {
+        return false;
+      }
+      received.append(buf, static_cast<size_t>(n));
+    }
+  };
+  EXPECT_TRUE(readUntil("\r\n\r\n"));
+  sendMasked(0x9, "hi");
+  EXPECT_TRUE(readUntil("\x8a\x02hi"));
+  sendMasked(0x1, "{\"subscribe\":[\"new_block\"]}");
+  for (int i = 0; i < 500 && ws.getSubscriberCount(EventType::TRADE) != 1;
+       ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(ws.getSubscriberCount(EventType::TRADE), 1u);
+  EXPECT_EQ(ws.getSubscriberCount(EventType::NEW_BLOCK), 2u);
+
+  ws.broadcast(EventType::TRADE, "\"not for fd\"");
+  const std::string filler(32 * 1024, 'b');
+  bool kept = true;
+  for (int i = 0; i < 400 && kept; ++i) {
+    ws.broadcastNewBlock(filler, i);
+    kept = readUntil("\"height\":" + std::to_string(i) + "}");
+  }
+  EXPECT_TRUE(kept);
+  EXPECT_EQ(received.find("not for fd"), std::string::npos);
+  for (int i = 0; i < 500 && ws.getClientCount() != 1; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(ws.getClientCount(), 1u);
+  EXPECT_EQ(ws.getSlowDisconnects(), 1u);
+  close(stalled);
+  close(fd);
+  ws.stop();
+}
+
 // Test: Key pair generation
 TEST(KeyPairGeneration) {
   QuantumPulse::Crypto::CryptoManager crypto;
@@ -260,6 +2373,32 @@ int main() {
   RUN_TEST(DataLeakPrevention);
   RUN_TEST(NoOverflowInPrice);
   RUN_TEST(CryptoHashing);
+  RUN_TEST(LockFreeHashing);
+  RUN_TEST(PowMidstateEngine);
+  RUN_TEST(BatchSha512Kernels);
+  RUN_TEST(MerkleEngine);
+  RUN_TEST(IncrementalMerkle);
+  RUN_TEST(IndexedMempool);
+  RUN_TEST(MempoolPackages);
+  RUN_TEST(ShardedUTXOSet);
+  RUN_TEST(UTXODiskCache);
+  RUN_TEST(ParallelChainValidation);
+  RUN_TEST(HttpReactorServer);
+  RUN_TEST(JsonRpcDispatcher);
+  RUN_TEST(APIServerRouting);
+  RUN_TEST(P2PWireFraming);
+  RUN_TEST(HeadersFirstSyncStall);
+  RUN_TEST(CompactBlockRelay);
+  RUN_TEST(BlockAndTxRelay);
+  RUN_TEST(LogRingMpsc);
+  RUN_TEST(BinaryLogFormat);
+  RUN_TEST(MetricsRegistry);
+  RUN_TEST(TraceSpans);
+  RUN_TEST(OrderBookMatching);
+  RUN_TEST(OrderBookSequencer);
+  RUN_TEST(OrderBookEvents);
+  RUN_TEST(OrderBookArchive);
+  RUN_TEST(WebSocketFanOut);
   RUN_TEST(KeyPairGeneration);
   RUN_TEST(TransactionValidation);
   RUN_TEST(ZKProof);